@@ -0,0 +1,311 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Aligned Array
+*****************************************************************
+**	Owning heap array aligned to cache lines or pages
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	malloc and new int[] only promise 16 byte alignment.
+**		A 32 or 64 byte vector load from a 16 byte aligned address can straddle two cache lines
+**		Two threads writing neighboring chunks can write the same cache line (false sharing)
+**	AlignedArray<T,Align> owns size elements starting on an Align boundary.
+**	The allocation is rounded up to a multiple of Align so no other allocation shares its last line.
+**	Align is a power of two, at least alignof(T), at most a page (4096). Default is a cache line.
+**
+**	Like new T[], elements of trivial types are not initialized unless a value is given.
+**	It plugs into the handlers of example.cpp
+**		data(), size()				int *, int handlers
+**		Span<T>, Span<const T>		implicit conversion
+**		view( rows, cols )			View2d<T> of the elements as a row-major block
+**	Copy is deep, move steals the buffer. Construction throws std::bad_alloc on failure, as new does.
+****************************************************************/
+
+#ifndef ALIGNED_ARRAY_H_
+#define ALIGNED_ARRAY_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstdlib>		//for posix_memalign, free
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <new>			//for placement new, std::bad_alloc
+#include <utility>		//for std::swap
+#include <type_traits>	//for std::is_trivially_destructible
+//User libraries
+#include "array_view.h"	//for Span, View2d
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Size of a cache line on x86-64 and most aarch64
+#define ALIGNED_CACHE_LINE	64
+//Largest supported alignment
+#define ALIGNED_PAGE		4096
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	AlignedArray
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements of T, first element on an Align boundary
+****************************************************************************/
+
+template <typename T, size_t Align = ALIGNED_CACHE_LINE>
+class AlignedArray
+{
+	static_assert( (Align & (Align -1)) == 0, "Align must be a power of two" );
+	static_assert( Align >= alignof(T), "Align must be at least the alignment of T" );
+	static_assert( Align <= ALIGNED_PAGE, "Align must be at most a page" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Empty array. Allocates nothing
+		AlignedArray( void ) : g_data( NULL ), g_size( 0 )
+		{
+		}
+
+		//size elements. Trivial types are left uninitialized, like new T[]
+		explicit AlignedArray( size_t size_arg ) : g_data( NULL ), g_size( 0 )
+		{
+			g_data = allocate( size_arg );
+			try
+			{
+				//g_size counts the elements built so far
+				for (g_size = 0;g_size < size_arg;g_size++)
+				{
+					new (g_data +g_size) T;
+				}
+			}
+			catch (...)
+			{
+				//No destructor runs for a half built object: destroy the elements built and free the block
+				release();
+				throw;
+			}
+		}
+
+		//size copies of value
+		AlignedArray( size_t size_arg, const T &value ) : g_data( NULL ), g_size( 0 )
+		{
+			g_data = allocate( size_arg );
+			try
+			{
+				//g_size counts the elements built so far
+				for (g_size = 0;g_size < size_arg;g_size++)
+				{
+					new (g_data +g_size) T( value );
+				}
+			}
+			catch (...)
+			{
+				//Like the constructor above
+				release();
+				throw;
+			}
+		}
+
+		//Deep copy
+		AlignedArray( const AlignedArray &array_arg ) : g_data( NULL ), g_size( 0 )
+		{
+			g_data = allocate( array_arg.g_size );
+			try
+			{
+				//g_size counts the elements built so far
+				for (g_size = 0;g_size < array_arg.g_size;g_size++)
+				{
+					new (g_data +g_size) T( array_arg.g_data[g_size] );
+				}
+			}
+			catch (...)
+			{
+				//Like the constructor above
+				release();
+				throw;
+			}
+		}
+
+		//Steal the buffer. noexcept, or std::vector and the SoA tuple copy on growth
+		AlignedArray( AlignedArray &&array_arg ) noexcept : g_data( array_arg.g_data ), g_size( array_arg.g_size )
+		{
+			array_arg.g_data = NULL;
+			array_arg.g_size = 0;
+		}
+
+		~AlignedArray( void )
+		{
+			release();
+		}
+
+		//Copy and swap. The copy is made at the call site, an rvalue is moved in and never throws
+		AlignedArray &operator=( AlignedArray array_arg ) noexcept
+		{
+			std::swap( g_data, array_arg.g_data );
+			std::swap( g_size, array_arg.g_size );
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void )
+		{
+			return g_data;
+		}
+
+		const T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		static constexpr size_t alignment( void )
+		{
+			return Align;
+		}
+
+		T &operator[]( size_t index )
+		{
+			return g_data[index];
+		}
+
+		const T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T *begin( void )
+		{
+			return g_data;
+		}
+
+		T *end( void )
+		{
+			return g_data +g_size;
+		}
+
+		const T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		const T *end( void ) const
+		{
+			return g_data +g_size;
+		}
+
+		///--------------------------------------------------------------------------
+		///	VIEWS
+		///--------------------------------------------------------------------------
+
+		operator Span<T>( void )
+		{
+			return Span<T>( g_data, g_size );
+		}
+
+		operator Span<const T>( void ) const
+		{
+			return Span<const T>( g_data, g_size );
+		}
+
+		//Elements as a rows x cols row-major block. rows*cols must not exceed size()
+		View2d<T> view( size_t rows, size_t cols )
+		{
+			return View2d<T>( g_data, rows, cols );
+		}
+
+		View2d<const T> view( size_t rows, size_t cols ) const
+		{
+			return View2d<const T>( g_data, rows, cols );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		//Room for size elements, rounded up to a multiple of Align
+		static T *allocate( size_t size_arg )
+		{
+			void *ret = NULL;
+			size_t bytes;
+
+			if (size_arg == 0)
+			{
+				return NULL;
+			}
+			if (size_arg > ((size_t)-1 -Align) /sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			bytes = (size_arg *sizeof(T) +Align -1) & ~(Align -1);
+			//posix_memalign wants at least the alignment of a pointer
+			if (posix_memalign( &ret, (Align < sizeof(void *)) ?(sizeof(void *)) :(Align), bytes ) != 0)
+			{
+				throw std::bad_alloc();
+			}
+
+			return (T *)ret;
+		}
+
+		void release( void )
+		{
+			//fast counter
+			size_t t;
+
+			if (std::is_trivially_destructible<T>::value == false)
+			{
+				for (t = 0;t < g_size;t++)
+				{
+					g_data[t].~T();
+				}
+			}
+			free( g_data );
+			g_data = NULL;
+			g_size = 0;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//First element, Align aligned
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+};	//end class: AlignedArray
+
+#endif	//ALIGNED_ARRAY_H_
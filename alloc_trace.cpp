@@ -0,0 +1,1088 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Allocation Trace
+*****************************************************************
+**	Replacement malloc, free and global new, delete that count
+**	by scope. Link this file in to turn the trace on
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	See alloc_trace.h for the interface.
+**
+**	Every block is allocated HEADER bytes larger. The header sits right before the pointer given to the user:
+**	bytes asked for, scope that allocated, family of the function that allocated, and the offset from the
+**	block of the C library. Blocks with an alignment above 16 bytes leave a gap of one alignment for it.
+**	A free reads the header back: the scope to count in, the family to check, the block to give back.
+**
+**	malloc and friends are replaced the way the glibc manual describes: the program defines malloc, free,
+**	calloc, realloc and the aligned ones, the C library and libstdc++ call them, they call __libc_malloc.
+**	Nothing here calls malloc, so nothing recurses.
+****************************************************************/
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//The real functions, not the empty inline ones
+#ifndef ALLOC_TRACE
+#define ALLOC_TRACE
+#endif
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uint64_t, uint32_t, uint16_t, uint8_t
+#include <cstdlib>		//for atexit
+#include <cstring>		//for strcmp, memcpy
+#include <cerrno>		//for errno, ENOMEM, EINVAL
+#include <cstdio>		//for fprintf
+#include <unistd.h>		//for sysconf
+#if defined( __GLIBC__ )
+#include <malloc.h>		//for memalign, pvalloc, malloc_usable_size
+#endif
+//Standard C++ libraries
+#include <new>			//for std::bad_alloc, std::nothrow_t, std::get_new_handler
+#include <atomic>		//for std::atomic
+#include <mutex>		//for std::mutex, std::lock_guard
+#include <algorithm>	//for std::max
+//User libraries
+#include "aligned_array.h"	//for ALIGNED_CACHE_LINE
+#include "alloc_trace.h"	//for Alloc_trace_stats
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//malloc is replaced only where the real one can still be called
+#if defined( __GLIBC__ )
+#define ALLOC_TRACE_MALLOC
+#endif
+
+//Marks a header written here
+#define ALLOC_TRACE_MAGIC		0xA77C
+//Bytes of the header, also the alignment of the blocks of malloc
+#define ALLOC_TRACE_HEADER		16
+//Largest alignment the offset of the header can hold
+#define ALLOC_TRACE_MAX_ALIGN	((size_t)1 << 31)
+//Threads with counters of their own. The threads after them share one set
+#define ALLOC_TRACE_MAX_THREADS	128
+//Bytes a thread allocates, net of frees, in a scope before it adds them to the live bytes of the scope
+#define ALLOC_TRACE_SLACK		((int64_t)64 *1024)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Function that allocated a block, must match the one that frees it
+typedef enum _Alloc_family
+{
+	ALLOC_FAMILY_MALLOC,
+	ALLOC_FAMILY_NEW,
+	ALLOC_FAMILY_NEW_ARRAY,
+	ALLOC_FAMILY_NUM
+} Alloc_family;
+
+//Right before the user pointer
+typedef struct _Alloc_header
+{
+	//Bytes asked for
+	uint64_t size;
+	//From the block of the C library to the user pointer
+	uint32_t offset;
+	uint16_t magic;
+	uint8_t scope;
+	uint8_t family;
+} Alloc_header;
+
+static_assert( sizeof(Alloc_header) == ALLOC_TRACE_HEADER, "Alloc_header must keep the 16 byte alignment of malloc" );
+static_assert( ALLOC_TRACE_MAX_SCOPES <= 256, "scope of Alloc_header is a byte" );
+
+//Counters of a scope kept by one thread. Only that thread writes them: no atomic add, no shared cache line.
+//The report reads them, hence atomic
+typedef struct _Alloc_counters
+{
+	std::atomic<size_t> allocs;
+	std::atomic<size_t> frees;
+	//Bytes allocated, bytes freed
+	std::atomic<size_t> bytes;
+	std::atomic<size_t> freed;
+	std::atomic<size_t> mismatches;
+	//Bytes allocated minus freed, not yet added to Alloc_live, and the most they reached since
+	std::atomic<int64_t> pending;
+	std::atomic<int64_t> high;
+} Alloc_counters;
+
+//Counters of every scope kept by one thread
+typedef struct alignas( ALIGNED_CACHE_LINE ) _Alloc_thread
+{
+	Alloc_counters scope[ALLOC_TRACE_MAX_SCOPES];
+	//pending and high of all the scopes together, for g_alloc_total
+	std::atomic<int64_t> pending;
+	std::atomic<int64_t> high;
+} Alloc_thread;
+
+//Live bytes of a scope, shared by the threads. Below zero for a while when a thread frees what another
+//allocated before the other adds it
+typedef struct alignas( ALIGNED_CACHE_LINE ) _Alloc_live
+{
+	std::atomic<int64_t> live;
+	std::atomic<int64_t> peak;
+} Alloc_live;
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+#ifdef ALLOC_TRACE_MALLOC
+//Allocator of glibc behind malloc
+extern "C"
+{
+	extern void *__libc_malloc( size_t size );
+	extern void *__libc_calloc( size_t num, size_t size );
+	extern void *__libc_realloc( void *ptr, size_t size );
+	extern void *__libc_memalign( size_t align, size_t size );
+	extern void __libc_free( void *ptr );
+}
+#endif
+
+static inline Alloc_thread *alloc_trace_thread( void );
+static inline void alloc_trace_count_alloc( unsigned int scope, size_t size );
+static inline void alloc_trace_count_free( unsigned int scope, size_t size );
+static inline Alloc_header *alloc_trace_header( void *ptr );
+static void *alloc_trace_alloc( size_t size, size_t align, Alloc_family family, bool zero );
+static void alloc_trace_free( void *ptr, Alloc_family family );
+static void *alloc_trace_realloc( void *ptr, size_t size );
+static void *alloc_trace_new( size_t size, Alloc_family family );
+static int alloc_trace_find( const char *name, int num_scopes );
+static void alloc_trace_sum( int scope, Alloc_trace_stats &stats );
+static void alloc_trace_at_exit( void );
+
+/****************************************************************
+**	GLOBAL VARIABILE
+****************************************************************/
+
+//All static, constant initialized: ready before the first malloc of the program
+static Alloc_thread g_alloc_threads[ALLOC_TRACE_MAX_THREADS];
+static Alloc_thread g_alloc_shared;
+static std::atomic<size_t> g_alloc_num_threads( 0 );
+static Alloc_live g_alloc_live[ALLOC_TRACE_MAX_SCOPES];
+static Alloc_live g_alloc_total;
+//Names of the scopes, written once under the mutex, then read without it
+static const char *g_alloc_names[ALLOC_TRACE_MAX_SCOPES] = { "(global)" };
+static std::atomic<int> g_alloc_num_scopes( 1 );
+static std::mutex g_alloc_mutex;
+//Scope and counters of this thread
+static thread_local int g_alloc_scope = 0;
+static thread_local Alloc_thread *g_alloc_thread = NULL;
+//Report at exit
+static int g_alloc_report_registered = atexit( alloc_trace_at_exit );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	alloc_trace_thread
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	Counters of this thread
+**	DESCRIPTION:
+**	The first call of a thread takes the next set. Sets are never given back: the counts of a thread
+**	outlive it. After ALLOC_TRACE_MAX_THREADS threads, the new ones share g_alloc_shared
+****************************************************************************/
+
+static inline Alloc_thread *alloc_trace_thread( void )
+{
+	size_t index;
+
+	if (g_alloc_thread == NULL)
+	{
+		index = g_alloc_num_threads.fetch_add( 1, std::memory_order_relaxed );
+		g_alloc_thread = (index < ALLOC_TRACE_MAX_THREADS) ?(&g_alloc_threads[index]) :(&g_alloc_shared);
+	}
+
+	return g_alloc_thread;
+}	//end function: alloc_trace_thread
+
+/****************************************************************************
+**	alloc_trace_add | Alloc_thread *, std::atomic<size_t> &, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Add value to a counter of thread. A load and a store, the atomic add only on the shared set
+****************************************************************************/
+
+static inline void alloc_trace_add( Alloc_thread *thread, std::atomic<size_t> &counter, size_t value )
+{
+	if (thread == &g_alloc_shared)
+	{
+		counter.fetch_add( value, std::memory_order_relaxed );
+	}
+	else
+	{
+		counter.store( counter.load( std::memory_order_relaxed ) +value, std::memory_order_relaxed );
+	}
+}	//end function: alloc_trace_add | Alloc_thread *, std::atomic<size_t> &, size_t
+
+/****************************************************************************
+**	alloc_trace_publish | Alloc_live &, int64_t, int64_t
+*****************************************************************************
+**	PARAMETER:
+**	high: most the bytes reached while the thread kept them, at least bytes
+**	RETURN:
+**	DESCRIPTION:
+**	Add bytes to the live bytes, raise the peak to the live bytes before plus high.
+**	Another thread may raise it first: compare_exchange reloads peak
+****************************************************************************/
+
+static inline void alloc_trace_publish( Alloc_live &counters, int64_t bytes, int64_t high )
+{
+	int64_t live = counters.live.fetch_add( bytes, std::memory_order_relaxed ) +high;
+	int64_t peak = counters.peak.load( std::memory_order_relaxed );
+
+	while ((live > peak) && (counters.peak.compare_exchange_weak( peak, live, std::memory_order_relaxed ) == false))
+	{
+	}
+}	//end function: alloc_trace_publish | Alloc_live &, int64_t, int64_t
+
+/****************************************************************************
+**	alloc_trace_keep | std::atomic<int64_t> &, std::atomic<int64_t> &, Alloc_live &, int64_t
+*****************************************************************************
+**	PARAMETER:
+**	pending, high: of the thread, written by it only. A load and a store each, no atomic add
+**	RETURN:
+**	DESCRIPTION:
+**	Keep bytes in pending and the most pending reached in high until pending reaches ALLOC_TRACE_SLACK,
+**	then add them to counters
+****************************************************************************/
+
+static inline void alloc_trace_keep( std::atomic<int64_t> &pending, std::atomic<int64_t> &high, Alloc_live &counters, int64_t bytes )
+{
+	int64_t now = pending.load( std::memory_order_relaxed ) +bytes;
+	int64_t top = high.load( std::memory_order_relaxed );
+
+	top = (now > top) ?(now) :(top);
+	if ((now < ALLOC_TRACE_SLACK) && (now > -ALLOC_TRACE_SLACK))
+	{
+		pending.store( now, std::memory_order_relaxed );
+		high.store( top, std::memory_order_relaxed );
+		return;
+	}
+	pending.store( 0, std::memory_order_relaxed );
+	high.store( 0, std::memory_order_relaxed );
+	alloc_trace_publish( counters, now, top );
+}	//end function: alloc_trace_keep | std::atomic<int64_t> &, std::atomic<int64_t> &, Alloc_live &, int64_t
+
+/****************************************************************************
+**	alloc_trace_pending | Alloc_thread *, unsigned int, int64_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	bytes allocated, below zero freed, in scope. Kept by the thread until they reach ALLOC_TRACE_SLACK,
+**	then added to the live bytes of the scope and of the total: two atomic adds every 64 KB, not every call.
+**	The most kept goes into the peak with them. alloc_trace_sum adds in what the threads still keep
+****************************************************************************/
+
+static inline void alloc_trace_pending( Alloc_thread *thread, unsigned int scope, int64_t bytes )
+{
+	if (thread == &g_alloc_shared)
+	{
+		alloc_trace_publish( g_alloc_live[scope], bytes, (bytes > 0) ?(bytes) :(0) );
+		alloc_trace_publish( g_alloc_total, bytes, (bytes > 0) ?(bytes) :(0) );
+		return;
+	}
+	alloc_trace_keep( thread->scope[scope].pending, thread->scope[scope].high, g_alloc_live[scope], bytes );
+	alloc_trace_keep( thread->pending, thread->high, g_alloc_total, bytes );
+}	//end function: alloc_trace_pending | Alloc_thread *, unsigned int, int64_t
+
+/****************************************************************************
+**	alloc_trace_count_alloc | unsigned int, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Count an allocation of size bytes in scope
+****************************************************************************/
+
+static inline void alloc_trace_count_alloc( unsigned int scope, size_t size )
+{
+	Alloc_thread *thread = alloc_trace_thread();
+
+	alloc_trace_add( thread, thread->scope[scope].allocs, 1 );
+	alloc_trace_add( thread, thread->scope[scope].bytes, size );
+	alloc_trace_pending( thread, scope, (int64_t)size );
+}	//end function: alloc_trace_count_alloc | unsigned int, size_t
+
+/****************************************************************************
+**	alloc_trace_count_free | unsigned int, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Count a free of size bytes allocated in scope
+****************************************************************************/
+
+static inline void alloc_trace_count_free( unsigned int scope, size_t size )
+{
+	Alloc_thread *thread = alloc_trace_thread();
+
+	alloc_trace_add( thread, thread->scope[scope].frees, 1 );
+	alloc_trace_add( thread, thread->scope[scope].freed, size );
+	alloc_trace_pending( thread, scope, -(int64_t)size );
+}	//end function: alloc_trace_count_free | unsigned int, size_t
+
+/****************************************************************************
+**	alloc_trace_count_mismatch
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Count a mismatch in the scope of this thread
+****************************************************************************/
+
+static inline void alloc_trace_count_mismatch( void )
+{
+	Alloc_thread *thread = alloc_trace_thread();
+
+	alloc_trace_add( thread, thread->scope[g_alloc_scope].mismatches, 1 );
+}	//end function: alloc_trace_count_mismatch
+
+/****************************************************************************
+**	alloc_trace_header | void *
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	Header of ptr, NULL when ptr was not allocated here
+**	DESCRIPTION:
+**	delete of new T[] with a destructor gets a pointer 8 bytes past the start of the block.
+**	Its "header" is then the last half of the real one and the element count, which doesn't hold the magic
+****************************************************************************/
+
+static inline Alloc_header *alloc_trace_header( void *ptr )
+{
+	Alloc_header *header = (Alloc_header *)ptr -1;
+
+	if ((header->magic != ALLOC_TRACE_MAGIC) || (header->family >= ALLOC_FAMILY_NUM) || (header->scope >= ALLOC_TRACE_MAX_SCOPES))
+	{
+		return NULL;
+	}
+
+	return header;
+}	//end function: alloc_trace_header | void *
+
+/****************************************************************************
+**	alloc_trace_sys_alloc | size_t, size_t, bool
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Block of the C library. align above 16 bytes only from the aligned allocators
+****************************************************************************/
+
+static inline void *alloc_trace_sys_alloc( size_t size, size_t align, bool zero )
+{
+	#ifdef ALLOC_TRACE_MALLOC
+	if (align > ALLOC_TRACE_HEADER)
+	{
+		return __libc_memalign( align, size );
+	}
+	return (zero == true) ?(__libc_calloc( 1, size )) :(__libc_malloc( size ));
+	#else
+	//Only new and delete are replaced, always 16 bytes
+	(void)align;
+	return (zero == true) ?(calloc( 1, size )) :(malloc( size ));
+	#endif
+}	//end function: alloc_trace_sys_alloc | size_t, size_t, bool
+
+static inline void alloc_trace_sys_free( void *ptr )
+{
+	#ifdef ALLOC_TRACE_MALLOC
+	__libc_free( ptr );
+	#else
+	free( ptr );
+	#endif
+}	//end function: alloc_trace_sys_free | void *
+
+/****************************************************************************
+**	alloc_trace_alloc | size_t, size_t, Alloc_family, bool
+*****************************************************************************
+**	PARAMETER:
+**	size: bytes for the user
+**	align: power of two
+**	zero: memory set to zero, for calloc
+**	RETURN:
+**	NULL and errno ENOMEM when out of memory
+**	DESCRIPTION:
+**	Allocate with a header and count it in the scope of this thread
+****************************************************************************/
+
+static void *alloc_trace_alloc( size_t size, size_t align, Alloc_family family, bool zero )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	size_t offset = (align > ALLOC_TRACE_HEADER) ?(align) :(ALLOC_TRACE_HEADER);
+	char *block;
+	Alloc_header *header;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if ((offset > ALLOC_TRACE_MAX_ALIGN) || (size > (size_t)-1 -offset))
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	block = (char *)alloc_trace_sys_alloc( size +offset, align, zero );
+	if (block == NULL)
+	{
+		return NULL;
+	}
+	header = (Alloc_header *)(block +offset) -1;
+	header->size = size;
+	header->offset = (uint32_t)offset;
+	header->magic = ALLOC_TRACE_MAGIC;
+	header->scope = (uint8_t)g_alloc_scope;
+	header->family = (uint8_t)family;
+	alloc_trace_count_alloc( header->scope, size );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return block +offset;
+}	//end function: alloc_trace_alloc | size_t, size_t, Alloc_family, bool
+
+/****************************************************************************
+**	alloc_trace_free | void *, Alloc_family
+*****************************************************************************
+**	PARAMETER:
+**	family: of the function called to free ptr
+**	RETURN:
+**	DESCRIPTION:
+**	Count the free in the scope that allocated ptr and give the block back.
+**	A block of another family is a mismatch, freed anyway. A block without a header is a mismatch, leaked
+****************************************************************************/
+
+static void alloc_trace_free( void *ptr, Alloc_family family )
+{
+	Alloc_header *header;
+
+	if (ptr == NULL)
+	{
+		return;
+	}
+	header = alloc_trace_header( ptr );
+	if (header == NULL)
+	{
+		alloc_trace_count_mismatch();
+		return;
+	}
+	if (header->family != family)
+	{
+		alloc_trace_count_mismatch();
+	}
+	alloc_trace_count_free( header->scope, (size_t)header->size );
+	//A second free of the same pointer finds no magic, unless the block was reused
+	header->magic = 0;
+	alloc_trace_sys_free( (char *)ptr -header->offset );
+}	//end function: alloc_trace_free | void *, Alloc_family
+
+/****************************************************************************
+**	alloc_trace_realloc | void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	NULL when out of memory, ptr is still valid
+**	DESCRIPTION:
+**	Counted as a free in the scope of ptr and an allocation in the scope of this thread.
+**	Aligned blocks are copied into a new block of malloc
+****************************************************************************/
+
+static void *alloc_trace_realloc( void *ptr, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	Alloc_header *header;
+	Alloc_header old;
+	char *block;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (ptr == NULL)
+	{
+		return alloc_trace_alloc( size, ALLOC_TRACE_HEADER, ALLOC_FAMILY_MALLOC, false );
+	}
+	//As glibc: realloc to zero bytes frees
+	if (size == 0)
+	{
+		alloc_trace_free( ptr, ALLOC_FAMILY_MALLOC );
+		return NULL;
+	}
+	header = alloc_trace_header( ptr );
+	if (header == NULL)
+	{
+		alloc_trace_count_mismatch();
+		errno = ENOMEM;
+		return NULL;
+	}
+	if (header->family != ALLOC_FAMILY_MALLOC)
+	{
+		alloc_trace_count_mismatch();
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	old = *header;
+	if (old.offset != ALLOC_TRACE_HEADER)
+	{
+		block = (char *)alloc_trace_alloc( size, ALLOC_TRACE_HEADER, ALLOC_FAMILY_MALLOC, false );
+		if (block != NULL)
+		{
+			memcpy( block, ptr, (size < old.size) ?(size) :((size_t)old.size) );
+			alloc_trace_free( ptr, (Alloc_family)old.family );
+		}
+		return block;
+	}
+	#ifdef ALLOC_TRACE_MALLOC
+	if (size > (size_t)-1 -ALLOC_TRACE_HEADER)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	block = (char *)__libc_realloc( (char *)ptr -ALLOC_TRACE_HEADER, size +ALLOC_TRACE_HEADER );
+	if (block == NULL)
+	{
+		return NULL;
+	}
+	header = (Alloc_header *)block;
+	header->size = size;
+	header->scope = (uint8_t)g_alloc_scope;
+	header->family = ALLOC_FAMILY_MALLOC;
+	alloc_trace_count_free( old.scope, (size_t)old.size );
+	alloc_trace_count_alloc( header->scope, size );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return block +ALLOC_TRACE_HEADER;
+	#else
+	return NULL;
+	#endif
+}	//end function: alloc_trace_realloc | void *, size_t
+
+/****************************************************************************
+**	alloc_trace_new | size_t, Alloc_family
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	As the operator new of the standard: call the new handler until it gives memory,
+**	std::bad_alloc when there is no handler
+****************************************************************************/
+
+static void *alloc_trace_new( size_t size, Alloc_family family )
+{
+	void *ret;
+	std::new_handler handler;
+
+	//new of zero bytes still gives a unique pointer
+	if (size == 0)
+	{
+		size = 1;
+	}
+	while (true)
+	{
+		ret = alloc_trace_alloc( size, ALLOC_TRACE_HEADER, family, false );
+		if (ret != NULL)
+		{
+			return ret;
+		}
+		handler = std::get_new_handler();
+		if (handler == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}	//end function: alloc_trace_new | size_t, Alloc_family
+
+/****************************************************************************
+**	alloc_trace_find | const char *, int
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	Scope of name among the first num_scopes, -1 when not there
+**	DESCRIPTION:
+****************************************************************************/
+
+static int alloc_trace_find( const char *name, int num_scopes )
+{
+	//fast counter
+	int t;
+
+	for (t = 0;t < num_scopes;t++)
+	{
+		if ((g_alloc_names[t] == name) || (strcmp( g_alloc_names[t], name ) == 0))
+		{
+			return t;
+		}
+	}
+
+	return -1;
+}	//end function: alloc_trace_find | const char *, int
+
+/****************************************************************************
+**	alloc_trace_at_exit
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Report to stderr. Registered with atexit
+****************************************************************************/
+
+static void alloc_trace_at_exit( void )
+{
+	(void)g_alloc_report_registered;
+	alloc_trace_report( stderr );
+}	//end function: alloc_trace_at_exit
+
+/****************************************************************************
+**	alloc_trace_enabled
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+bool alloc_trace_enabled( void )
+{
+	return true;
+}	//end function: alloc_trace_enabled
+
+/****************************************************************************
+**	alloc_trace_scope | const char *
+*****************************************************************************
+**	PARAMETER:
+**	name: string that lives until exit. NULL is "(global)"
+**	RETURN:
+**	Previous scope of this thread
+**	DESCRIPTION:
+**	A name seen before is found without locking. A new one is added under the mutex
+****************************************************************************/
+
+int alloc_trace_scope( const char *name )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	int ret = g_alloc_scope;
+	int scope = 0;
+	int num_scopes;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	if (name != NULL)
+	{
+		scope = alloc_trace_find( name, g_alloc_num_scopes.load( std::memory_order_acquire ) );
+		if (scope < 0)
+		{
+			std::lock_guard<std::mutex> lock( g_alloc_mutex );
+			num_scopes = g_alloc_num_scopes.load( std::memory_order_relaxed );
+			scope = alloc_trace_find( name, num_scopes );
+			if (scope < 0)
+			{
+				//Table full: "(global)"
+				scope = 0;
+				if (num_scopes < ALLOC_TRACE_MAX_SCOPES)
+				{
+					g_alloc_names[num_scopes] = name;
+					g_alloc_num_scopes.store( num_scopes +1, std::memory_order_release );
+					scope = num_scopes;
+				}
+			}
+		}
+	}
+	g_alloc_scope = scope;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return ret;
+}	//end function: alloc_trace_scope | const char *
+
+/****************************************************************************
+**	alloc_trace_restore | int
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+void alloc_trace_restore( int scope )
+{
+	g_alloc_scope = ((scope >= 0) && (scope < g_alloc_num_scopes.load( std::memory_order_acquire ))) ?(scope) :(0);
+}	//end function: alloc_trace_restore | int
+
+/****************************************************************************
+**	alloc_trace_sum | int, Alloc_trace_stats &
+*****************************************************************************
+**	PARAMETER:
+**	scope: -1 for the total of all scopes
+**	RETURN:
+**	DESCRIPTION:
+**	Add up the counters of every thread. Live bytes are exact: bytes allocated minus bytes freed.
+**	The peak is the largest of the peak seen by alloc_trace_publish, the live bytes added so far plus
+**	the most a thread still keeps, and the live bytes now. Exact for one thread; with several, the bytes
+**	the others keep at that moment are not in it
+****************************************************************************/
+
+static void alloc_trace_sum( int scope, Alloc_trace_stats &stats )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int first = (scope < 0) ?(0) :(scope);
+	int last = (scope < 0) ?(g_alloc_num_scopes.load( std::memory_order_acquire ) -1) :(scope);
+	size_t freed = 0;
+	int64_t peak;
+	int64_t high = 0;
+	Alloc_thread *thread;
+	Alloc_live &counters = (scope < 0) ?(g_alloc_total) :(g_alloc_live[scope]);
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	stats.name = (scope < 0) ?("Total") :(g_alloc_names[scope]);
+	stats.allocs = 0;
+	stats.frees = 0;
+	stats.bytes = 0;
+	stats.mismatches = 0;
+	for (t = 0;t <= ALLOC_TRACE_MAX_THREADS;t++)
+	{
+		thread = (t < ALLOC_TRACE_MAX_THREADS) ?(&g_alloc_threads[t]) :(&g_alloc_shared);
+		for (s = first;s <= last;s++)
+		{
+			stats.allocs += thread->scope[s].allocs.load( std::memory_order_relaxed );
+			stats.frees += thread->scope[s].frees.load( std::memory_order_relaxed );
+			stats.bytes += thread->scope[s].bytes.load( std::memory_order_relaxed );
+			freed += thread->scope[s].freed.load( std::memory_order_relaxed );
+			stats.mismatches += thread->scope[s].mismatches.load( std::memory_order_relaxed );
+		}
+		high = std::max( high, (scope < 0) ?(thread->high.load( std::memory_order_relaxed )) :(thread->scope[scope].high.load( std::memory_order_relaxed )) );
+	}
+	stats.live = stats.bytes -freed;
+	peak = std::max( counters.peak.load( std::memory_order_relaxed ), counters.live.load( std::memory_order_relaxed ) +high );
+	stats.peak = ((peak > 0) && ((size_t)peak > stats.live)) ?((size_t)peak) :(stats.live);
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: alloc_trace_sum | int, Alloc_trace_stats &
+
+/****************************************************************************
+**	alloc_trace_stats | Alloc_trace_stats *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	Number of scopes written to dst
+**	DESCRIPTION:
+**	Threads still allocating make the counters a little out of step with each other
+****************************************************************************/
+
+size_t alloc_trace_stats( Alloc_trace_stats *dst, size_t max )
+{
+	//fast counter
+	size_t t;
+	size_t num_scopes = (size_t)g_alloc_num_scopes.load( std::memory_order_acquire );
+
+	if (num_scopes > max)
+	{
+		num_scopes = max;
+	}
+	for (t = 0;t < num_scopes;t++)
+	{
+		alloc_trace_sum( (int)t, dst[t] );
+	}
+
+	return num_scopes;
+}	//end function: alloc_trace_stats | Alloc_trace_stats *, size_t
+
+/****************************************************************************
+**	alloc_trace_report | FILE *
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	One row per scope that allocated or freed the wrong way, then the total.
+**	The peak of the total is the most bytes live at once, not the sum of the peaks.
+**	fprintf to an unbuffered stderr doesn't allocate
+****************************************************************************/
+
+void alloc_trace_report( FILE *stream )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	size_t num_scopes;
+	Alloc_trace_stats stats[ALLOC_TRACE_MAX_SCOPES +1];
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	num_scopes = alloc_trace_stats( stats, ALLOC_TRACE_MAX_SCOPES );
+	alloc_trace_sum( -1, stats[num_scopes] );
+	fprintf( stream, "\nAllocation trace\n" );
+	fprintf( stream, "%-42s | %-10s | %-10s | %-14s | %-14s | %-14s | %-10s\n", "Scope", "Allocs", "Frees", "Bytes", "Peak bytes", "Live bytes", "Mismatches" );
+	for (t = 0;t <= num_scopes;t++)
+	{
+		if ((t == num_scopes) || (stats[t].allocs > 0) || (stats[t].mismatches > 0))
+		{
+			fprintf( stream, "%-42s | %-10zu | %-10zu | %-14zu | %-14zu | %-14zu | %-10zu\n", stats[t].name, stats[t].allocs, stats[t].frees, stats[t].bytes, stats[t].peak, stats[t].live, stats[t].mismatches );
+		}
+	}
+	fflush( stream );
+
+	return;
+}	//end function: alloc_trace_report | FILE *
+
+/****************************************************************
+**	GLOBAL NEW AND DELETE
+****************************************************************/
+
+void *operator new( size_t size )
+{
+	return alloc_trace_new( size, ALLOC_FAMILY_NEW );
+}
+
+void *operator new[]( size_t size )
+{
+	return alloc_trace_new( size, ALLOC_FAMILY_NEW_ARRAY );
+}
+
+void *operator new( size_t size, const std::nothrow_t & ) noexcept
+{
+	try
+	{
+		return alloc_trace_new( size, ALLOC_FAMILY_NEW );
+	}
+	catch (...)
+	{
+		return NULL;
+	}
+}
+
+void *operator new[]( size_t size, const std::nothrow_t & ) noexcept
+{
+	try
+	{
+		return alloc_trace_new( size, ALLOC_FAMILY_NEW_ARRAY );
+	}
+	catch (...)
+	{
+		return NULL;
+	}
+}
+
+void operator delete( void *ptr ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW );
+}
+
+void operator delete[]( void *ptr ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW_ARRAY );
+}
+
+void operator delete( void *ptr, const std::nothrow_t & ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW );
+}
+
+void operator delete[]( void *ptr, const std::nothrow_t & ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW_ARRAY );
+}
+
+//C++14 calls these when it knows the size
+#ifdef __cpp_sized_deallocation
+void operator delete( void *ptr, size_t ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW );
+}
+
+void operator delete[]( void *ptr, size_t ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_NEW_ARRAY );
+}
+#endif
+
+/****************************************************************
+**	C LIBRARY
+****************************************************************/
+
+#ifdef ALLOC_TRACE_MALLOC
+
+//Power of two at least align
+static inline size_t alloc_trace_round_align( size_t align )
+{
+	size_t ret = ALLOC_TRACE_HEADER;
+
+	while ((ret < align) && (ret <= ALLOC_TRACE_MAX_ALIGN))
+	{
+		ret <<= 1;
+	}
+
+	return ret;
+}
+
+extern "C"
+{
+
+void *malloc( size_t size ) noexcept
+{
+	return alloc_trace_alloc( size, ALLOC_TRACE_HEADER, ALLOC_FAMILY_MALLOC, false );
+}
+
+void *calloc( size_t num, size_t size ) noexcept
+{
+	if ((size != 0) && (num > (size_t)-1 /size))
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	return alloc_trace_alloc( num *size, ALLOC_TRACE_HEADER, ALLOC_FAMILY_MALLOC, true );
+}
+
+void *realloc( void *ptr, size_t size ) noexcept
+{
+	return alloc_trace_realloc( ptr, size );
+}
+
+void *reallocarray( void *ptr, size_t num, size_t size ) noexcept
+{
+	if ((size != 0) && (num > (size_t)-1 /size))
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	return alloc_trace_realloc( ptr, num *size );
+}
+
+void free( void *ptr ) noexcept
+{
+	alloc_trace_free( ptr, ALLOC_FAMILY_MALLOC );
+}
+
+void *memalign( size_t align, size_t size ) noexcept
+{
+	return alloc_trace_alloc( size, alloc_trace_round_align( align ), ALLOC_FAMILY_MALLOC, false );
+}
+
+void *aligned_alloc( size_t align, size_t size ) noexcept
+{
+	if ((align & (align -1)) != 0)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+	return alloc_trace_alloc( size, align, ALLOC_FAMILY_MALLOC, false );
+}
+
+int posix_memalign( void **ptr, size_t align, size_t size ) noexcept
+{
+	void *ret;
+	int error = errno;
+
+	if ((align < sizeof(void *)) || ((align & (align -1)) != 0))
+	{
+		return EINVAL;
+	}
+	ret = alloc_trace_alloc( size, align, ALLOC_FAMILY_MALLOC, false );
+	//posix_memalign reports the error without touching errno
+	errno = error;
+	if (ret == NULL)
+	{
+		return ENOMEM;
+	}
+	*ptr = ret;
+
+	return 0;
+}
+
+void *valloc( size_t size ) noexcept
+{
+	return alloc_trace_alloc( size, (size_t)sysconf( _SC_PAGESIZE ), ALLOC_FAMILY_MALLOC, false );
+}
+
+void *pvalloc( size_t size ) noexcept
+{
+	size_t page = (size_t)sysconf( _SC_PAGESIZE );
+
+	if (size > (size_t)-1 -page)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	return alloc_trace_alloc( (size +page -1) & ~(page -1), page, ALLOC_FAMILY_MALLOC, false );
+}
+
+//Bytes asked for: the rest of the block is not the user's to use here
+size_t malloc_usable_size( void *ptr ) noexcept
+{
+	Alloc_header *header;
+
+	if (ptr == NULL)
+	{
+		return 0;
+	}
+	header = alloc_trace_header( ptr );
+
+	return (header == NULL) ?(0) :((size_t)header->size);
+}
+
+}	//end extern "C"
+
+#endif	//ALLOC_TRACE_MALLOC
@@ -0,0 +1,181 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Allocation Trace
+*****************************************************************
+**	Count, bytes and peak of malloc and new, by named scope
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	Which part of the program allocates, how much, and how much at once?
+**	alloc_trace.cpp replaces malloc, calloc, realloc, free, the aligned allocators of the C library
+**	and the global operator new and delete. Linking it in turns the trace on. Build with -DALLOC_TRACE
+**	so the scopes of this header reach it:
+**		g++ -std=c++11 -O2 -DALLOC_TRACE example.cpp alloc_trace.cpp -o example
+**	Without ALLOC_TRACE the functions here are empty inline and cost nothing.
+**
+**	SCOPES
+**	Each thread has a current scope. An allocation is counted in the current scope and remembers it:
+**	its free is counted in the same scope, whatever thread and scope free it.
+**		alloc_trace_scope( name )		name is the scope of this thread until the next call. Returns the previous one
+**		alloc_trace_restore( scope )	back to a scope returned by alloc_trace_scope
+**		AllocTraceScope scope( name )	name until scope is destroyed
+**	Allocations out of any scope go to "(global)". Names are compared as strings and must live until exit:
+**	string literals. Past ALLOC_TRACE_MAX_SCOPES names, new names go to "(global)" too.
+**
+**	REPORT
+**	Per scope: allocations, frees, bytes asked for, live bytes, peak of the live bytes, mismatches.
+**	A mismatch is a block given back by the wrong function: delete of new[], free of new, delete[] of malloc...
+**	It is counted in the scope that frees it, then the block is freed the right way.
+**	The report goes to stderr at exit. alloc_trace_report( stream ) prints it at any time.
+**
+**	COST
+**	Each block gets a 16 byte header with its size, scope and the function that allocated it.
+**	Each thread counts in a set of counters of its own, no atomic add, no cache line shared with other threads.
+**	Live bytes are added to the shared count of the scope every 64 KB a thread allocates or frees there,
+**	with the most the thread kept in between for the peak. Counts, bytes and live bytes are exact, and so is
+**	the peak of a scope used by one thread. Threads allocating in the same scope at once can each hide
+**	up to 64 KB from the peak of the other.
+**	Past 128 threads, the new threads share one set, with atomic adds.
+**	About 10-20 ns on top of a 25 ns malloc and free: a program spending 1% of its time in malloc slows by
+**	less than 1%. The alloc suite of the benchmark, built with and without alloc_trace.cpp, measures it.
+**
+**	LIMITS
+**	malloc is replaced through the __libc_malloc family of glibc. Elsewhere only new and delete are traced.
+**	delete of new T[] when T has a destructor gets a pointer past the element count the compiler stores
+**	before the elements: the header is not found, the block is counted as a mismatch and leaked.
+**	mmap is not traced (mapped_array.h).
+****************************************************************/
+
+#ifndef ALLOC_TRACE_H_
+#define ALLOC_TRACE_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdio>		//for FILE, stderr
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Scopes with a name of their own, "(global)" included
+#define ALLOC_TRACE_MAX_SCOPES	64
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Counters of a scope
+typedef struct _Alloc_trace_stats
+{
+	const char *name;
+	//Calls that allocated, calls that freed. realloc is both
+	size_t allocs;
+	size_t frees;
+	//Bytes asked for, in total
+	size_t bytes;
+	//Bytes allocated and not yet freed, now and at most. See COST for the peak
+	size_t live;
+	size_t peak;
+	//Blocks freed by a function of another family
+	size_t mismatches;
+} Alloc_trace_stats;
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+#ifdef ALLOC_TRACE
+
+//true when alloc_trace.cpp is linked in
+extern bool alloc_trace_enabled( void );
+//Make name the scope of this thread. Return the previous scope
+extern int alloc_trace_scope( const char *name );
+//Back to a scope returned by alloc_trace_scope
+extern void alloc_trace_restore( int scope );
+//Counters of up to max scopes in use, "(global)" first. Return how many
+extern size_t alloc_trace_stats( Alloc_trace_stats *dst, size_t max );
+//Table of the scopes that allocated, and the total
+extern void alloc_trace_report( FILE *stream );
+
+#else
+
+inline bool alloc_trace_enabled( void )
+{
+	return false;
+}
+
+inline int alloc_trace_scope( const char * )
+{
+	return 0;
+}
+
+inline void alloc_trace_restore( int )
+{
+}
+
+inline size_t alloc_trace_stats( Alloc_trace_stats *, size_t )
+{
+	return 0;
+}
+
+inline void alloc_trace_report( FILE * )
+{
+}
+
+#endif
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	AllocTraceScope
+*****************************************************************************
+**	DESCRIPTION:
+**	name is the scope of this thread while the object lives
+****************************************************************************/
+
+class AllocTraceScope
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		explicit AllocTraceScope( const char *name ) : g_previous( alloc_trace_scope( name ) )
+		{
+		}
+
+		~AllocTraceScope( void )
+		{
+			alloc_trace_restore( g_previous );
+		}
+
+		AllocTraceScope( const AllocTraceScope & ) = delete;
+		AllocTraceScope &operator=( const AllocTraceScope & ) = delete;
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Scope to go back to
+		int g_previous;
+};	//end class: AllocTraceScope
+
+#endif	//ALLOC_TRACE_H_
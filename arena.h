@@ -0,0 +1,367 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Arena
+*****************************************************************
+**	Monotonic (bump) allocator for short lived arrays
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	malloc/free and new/delete pay bookkeeping on every array.
+**	When many arrays are made and dropped together, e.g. once per frame,
+**	an arena hands out memory by bumping an offset inside big blocks
+**	and gives everything back at once by moving the offset back.
+**
+**	Arena
+**		allocate( size, align )		bump allocate. NULL on failure. align must be a power of two
+**		allocate_array<T>( num )	num elements of T, aligned for T. Elements are not constructed
+**		mark() / rewind( marker )	go back to a previous point. Everything allocated after it is dropped
+**		reset()						drop everything. Blocks are kept for reuse
+**		release()					drop everything and free the blocks
+**	ArenaScope
+**		marks on construction, rewinds on destruction. Reset-per-scope
+**	ArenaAllocator<T>
+**		std allocator adapter. std::vector<int, ArenaAllocator<int>> draws from the arena
+**		deallocate does nothing, memory comes back when the arena is rewound
+**
+**	Blocks are never moved: pointers stay valid until the arena is rewound past them.
+**	Destructors of objects in the arena are not called. Meant for arrays of trivial types.
+**	An arena is not thread safe. Use one per thread.
+****************************************************************/
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstdlib>		//for malloc, free
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uintptr_t
+//Standard C++ libraries
+#include <vector>		//for std::vector
+#include <new>			//for std::bad_alloc
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Size of the first block. Later blocks double
+#define ARENA_DEFAULT_BLOCK_SIZE	(64 *1024)
+//Alignment of allocate() when none is given. Same as malloc
+#define ARENA_DEFAULT_ALIGN			alignof(std::max_align_t)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//A point in the arena to rewind to
+struct ArenaMarker
+{
+	//Block in use
+	size_t block;
+	//First free byte of the block
+	size_t offset;
+};
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	Arena
+*****************************************************************************
+**	DESCRIPTION:
+**	List of blocks. Allocation bumps the offset of the current block,
+**	moves to the next block when the current is full, adds a block when there is no next
+****************************************************************************/
+
+class Arena
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//No block is allocated until the first allocation
+		explicit Arena( size_t block_size_arg = ARENA_DEFAULT_BLOCK_SIZE ) : g_block( 0 ), g_offset( 0 ), g_block_size( block_size_arg )
+		{
+		}
+
+		~Arena( void )
+		{
+			release();
+		}
+
+		//Blocks belong to one arena
+		Arena( const Arena & ) = delete;
+		Arena &operator=( const Arena & ) = delete;
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		//Bump allocate size bytes aligned to align. NULL on failure
+		void *allocate( size_t size, size_t align = ARENA_DEFAULT_ALIGN )
+		{
+			uintptr_t base;
+			size_t start;
+
+			//Fast path: fits in the current block
+			if (g_block < g_blocks.size())
+			{
+				base = (uintptr_t)g_blocks[g_block].data;
+				start = (size_t)(((base +g_offset +align -1) & ~((uintptr_t)align -1)) -base);
+				if ((start <= g_blocks[g_block].size) && (size <= g_blocks[g_block].size -start))
+				{
+					g_offset = start +size;
+					return g_blocks[g_block].data +start;
+				}
+			}
+
+			return allocate_slow( size, align );
+		}
+
+		//num elements of T. Not constructed. NULL on failure
+		template <typename T>
+		T *allocate_array( size_t num )
+		{
+			if (num > (size_t)-1 /sizeof(T))
+			{
+				return NULL;
+			}
+			return (T *)allocate( num *sizeof(T), alignof(T) );
+		}
+
+		ArenaMarker mark( void ) const
+		{
+			ArenaMarker marker = { g_block, g_offset };
+			return marker;
+		}
+
+		//Drop everything allocated after the marker
+		void rewind( ArenaMarker marker )
+		{
+			g_block = marker.block;
+			g_offset = marker.offset;
+		}
+
+		//Drop everything. Blocks are kept for reuse
+		void reset( void )
+		{
+			g_block = 0;
+			g_offset = 0;
+		}
+
+		//Drop everything and free the blocks
+		void release( void )
+		{
+			//fast counter
+			size_t t;
+
+			for (t = 0;t < g_blocks.size();t++)
+			{
+				free( g_blocks[t].data );
+			}
+			g_blocks.clear();
+			g_block = 0;
+			g_offset = 0;
+		}
+
+		//Bytes held by the arena
+		size_t capacity( void ) const
+		{
+			//fast counter
+			size_t t;
+			size_t ret = 0;
+
+			for (t = 0;t < g_blocks.size();t++)
+			{
+				ret += g_blocks[t].size;
+			}
+
+			return ret;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE TYPES
+		///--------------------------------------------------------------------------
+
+		struct Block
+		{
+			char *data;
+			size_t size;
+		};
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		//Current block is full. Try the next blocks, then add one
+		void *allocate_slow( size_t size, size_t align )
+		{
+			size_t new_size;
+			Block new_block;
+
+			//Blocks kept from before a reset or rewind
+			while (g_block +1 < g_blocks.size())
+			{
+				g_block++;
+				g_offset = 0;
+				//It fits, the fast path of allocate succeeds
+				if (fits( g_blocks[g_block], size, align ) == true)
+				{
+					return allocate( size, align );
+				}
+			}
+
+			//Double the size of the last block, enough for the request
+			new_size = (g_blocks.empty() == true) ?(g_block_size) :(g_blocks.back().size *2);
+			if (size > (size_t)-1 -align)
+			{
+				return NULL;
+			}
+			if (new_size < size +align)
+			{
+				new_size = size +align;
+			}
+
+			new_block.data = (char *)malloc( new_size );
+			if (new_block.data == NULL)
+			{
+				return NULL;
+			}
+			new_block.size = new_size;
+			g_blocks.push_back( new_block );
+			g_block = g_blocks.size() -1;
+			g_offset = 0;
+
+			return allocate( size, align );
+		}
+
+		static bool fits( const Block &block, size_t size, size_t align )
+		{
+			uintptr_t base = (uintptr_t)block.data;
+			size_t start = (size_t)(((base +align -1) & ~((uintptr_t)align -1)) -base);
+
+			return ((start <= block.size) && (size <= block.size -start));
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Blocks in allocation order
+		std::vector<Block> g_blocks;
+		//Block in use
+		size_t g_block;
+		//First free byte of the block in use
+		size_t g_offset;
+		//Size of the first block
+		size_t g_block_size;
+};	//end class: Arena
+
+/****************************************************************************
+**	ArenaScope
+*****************************************************************************
+**	DESCRIPTION:
+**	Everything allocated from the arena during the life of the scope is dropped when it ends
+****************************************************************************/
+
+class ArenaScope
+{
+	public:
+		explicit ArenaScope( Arena &arena_arg ) : g_arena( arena_arg ), g_marker( arena_arg.mark() )
+		{
+		}
+
+		~ArenaScope( void )
+		{
+			g_arena.rewind( g_marker );
+		}
+
+		ArenaScope( const ArenaScope & ) = delete;
+		ArenaScope &operator=( const ArenaScope & ) = delete;
+
+	private:
+		Arena &g_arena;
+		ArenaMarker g_marker;
+};	//end class: ArenaScope
+
+/****************************************************************************
+**	ArenaAllocator
+*****************************************************************************
+**	DESCRIPTION:
+**	Minimal C++11 allocator drawing from an Arena
+**	Throws std::bad_alloc when the arena can't allocate, as std containers expect
+****************************************************************************/
+
+template <typename T>
+class ArenaAllocator
+{
+	public:
+		typedef T value_type;
+
+		explicit ArenaAllocator( Arena &arena_arg ) : g_arena( &arena_arg )
+		{
+		}
+
+		//Rebind: containers make allocators of their internal types from this one
+		template <typename U>
+		ArenaAllocator( const ArenaAllocator<U> &allocator_arg ) : g_arena( &allocator_arg.arena() )
+		{
+		}
+
+		T *allocate( size_t num )
+		{
+			T *ret = g_arena->allocate_array<T>( num );
+			if (ret == NULL)
+			{
+				throw std::bad_alloc();
+			}
+			return ret;
+		}
+
+		//Memory comes back when the arena is rewound
+		void deallocate( T *data_arg, size_t num )
+		{
+			(void)data_arg;
+			(void)num;
+		}
+
+		Arena &arena( void ) const
+		{
+			return *g_arena;
+		}
+
+	private:
+		Arena *g_arena;
+};	//end class: ArenaAllocator
+
+//Allocators are equal when memory from one can be given back to the other
+template <typename T, typename U>
+inline bool operator==( const ArenaAllocator<T> &a, const ArenaAllocator<U> &b )
+{
+	return (&a.arena() == &b.arena());
+}
+
+template <typename T, typename U>
+inline bool operator!=( const ArenaAllocator<T> &a, const ArenaAllocator<U> &b )
+{
+	return (&a.arena() != &b.arena());
+}
+
+#endif	//ARENA_H_
@@ -0,0 +1,962 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Array Copy
+*****************************************************************
+**	Copy and fill of arrays with a strategy picked by size and overlap
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	memcpy is not one algorithm. A copy of 16 bytes is two moves of registers, a copy of 16 KB is a loop
+**	the CPU runs best as a single rep movsb, a copy of 1 GB goes through the cache and evicts everything
+**	in it for nothing. A copy of 10 GB is bound by the memory bandwidth one core can reach, not by the memory.
+**	array_copy picks one of these by size:
+**
+**	STRATEGIES
+**		COPY_INLINE		up to COPY_INLINE_BYTES. Two overlapping loads of a fixed size, then two stores:
+**						no call, no loop, no branch on alignment. Safe on overlapping arrays
+**		COPY_MEMCPY		memcpy of the C library, memmove when the arrays overlap
+**		COPY_REP_MOVSB	the rep movsb instruction. CPUs with ERMS (enhanced rep movsb) copy whole cache lines
+**						with it, without the setup of a vector loop
+**		COPY_STREAM		32 byte AVX loads and non-temporal stores (16 byte SSE2 without AVX). Stores go to memory
+**						around the cache: the cache keeps what it held, no line is read before it is written.
+**						Pays off when the destination does not fit in the last level cache anyway
+**		COPY_PARALLEL	COPY_STREAM on chunks, on every thread of thread_pool_default(). One core can't use
+**						the whole bandwidth of the memory
+**	COPY_AUTO, the default, picks by the thresholds of copy_thresholds(). Arrays that overlap are
+**	always COPY_INLINE or COPY_MEMCPY: the others copy forward and would read elements already overwritten.
+**	A strategy the CPU lacks, rep movsb without ERMS or anything off x86, becomes COPY_MEMCPY.
+**
+**	FUNCTIONS
+**		array_copy( dst, src, num )				num elements of trivially copyable T
+**		array_fill( dst, num, value )			num copies of value
+**		array_copy_bytes( dst, src, bytes )		raw bytes, like memmove
+**		array_fill_bytes( dst, byte, bytes )	like memset. rep stosb instead of rep movsb
+**		copy_choose( dst, src, bytes )			what COPY_AUTO would do
+**
+**	THRESHOLDS
+**	Defaults: rep movsb from COPY_MOVSB_BYTES, stream from the size of the last level cache, parallel
+**	from COPY_PARALLEL_BYTES with more than one thread. The best values depend on the CPU:
+**	the copy suite of the benchmark measures them on the host. Set them through copy_thresholds().
+**
+**	The streaming stores are not ordered with other stores: an sfence ends each streaming copy,
+**	the copy is visible to other threads when array_copy returns.
+****************************************************************/
+
+#ifndef ARRAY_COPY_H_
+#define ARRAY_COPY_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uintptr_t, uint64_t
+#include <cstring>		//for memcpy, memmove, memset
+#include <unistd.h>		//for sysconf
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>	//for _mm256_stream_si256, _mm_stream_si128, _mm_sfence
+#include <cpuid.h>		//for __get_cpuid_count
+#endif
+//Standard C++ libraries
+#include <type_traits>	//for std::is_trivially_copyable
+#include <algorithm>	//for std::min
+//User libraries
+#include "parallel.h"	//for thread_pool_default, parallel_for_range
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	#define COPY_X86
+#endif
+
+//Largest copy of COPY_INLINE. Two loads of up to half of it
+#define COPY_INLINE_BYTES		64
+//Default first size of rep movsb. Below it the vector loops of the C library win, even with ERMS
+#define COPY_MOVSB_BYTES		(64 *1024)
+//Last level cache when the C library can't tell
+#define COPY_LLC_DEFAULT_BYTES	((size_t)8 << 20)
+//Default first size of the parallel copy
+#define COPY_PARALLEL_BYTES		((size_t)256 << 20)
+//Smallest chunk of the parallel copy. A multiple of the page size
+#define COPY_PARALLEL_GRAIN		((size_t)4 << 20)
+//Block of a fill of a value of many bytes: filled by a loop, then copied over the rest
+#define COPY_FILL_BLOCK			4096
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+typedef enum _Copy_strategy
+{
+	COPY_AUTO,
+	COPY_INLINE,
+	COPY_MEMCPY,
+	COPY_REP_MOVSB,
+	COPY_STREAM,
+	COPY_PARALLEL,
+	COPY_NUM_STRATEGIES
+} Copy_strategy;
+
+//Sizes in bytes where COPY_AUTO switches strategy. Each applies from its size up
+typedef struct _Copy_thresholds
+{
+	size_t movsb;
+	size_t stream;
+	size_t parallel;
+} Copy_thresholds;
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	copy_detect_erms | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	true when rep movsb and rep stosb are fast: CPUID leaf 7, EBX bit 9
+**	DESCRIPTION:
+****************************************************************************/
+
+inline bool copy_detect_erms( void )
+{
+#if defined( COPY_X86 )
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) == 0)
+	{
+		return false;
+	}
+
+	return (((ebx >> 9) & 1) != 0);
+#else
+	return false;
+#endif
+}	//end function: copy_detect_erms | void
+
+inline bool copy_detect_avx( void )
+{
+#if defined( COPY_X86 )
+	__builtin_cpu_init();
+
+	return (__builtin_cpu_supports( "avx" ) != 0);
+#else
+	return false;
+#endif
+}	//end function: copy_detect_avx | void
+
+//Detected once. Function local static: a single instance across translation units
+inline bool copy_has_erms( void )
+{
+	static const bool erms = copy_detect_erms();
+
+	return erms;
+}	//end function: copy_has_erms | void
+
+inline bool copy_has_avx( void )
+{
+	static const bool avx = copy_detect_avx();
+
+	return avx;
+}	//end function: copy_has_avx | void
+
+/****************************************************************************
+**	copy_llc_bytes | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	size of the last level cache, COPY_LLC_DEFAULT_BYTES when unknown
+**	DESCRIPTION:
+**	glibc reads it from CPUID. Other C libraries may answer 0 or -1
+****************************************************************************/
+
+inline size_t copy_llc_bytes( void )
+{
+	long ret = -1;
+
+#if defined( _SC_LEVEL3_CACHE_SIZE )
+	ret = sysconf( _SC_LEVEL3_CACHE_SIZE );
+	if (ret <= 0)
+	{
+		ret = sysconf( _SC_LEVEL2_CACHE_SIZE );
+	}
+#endif
+
+	return (ret > 0) ?((size_t)ret) :(COPY_LLC_DEFAULT_BYTES);
+}	//end function: copy_llc_bytes | void
+
+/****************************************************************************
+**	copy_thresholds | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	thresholds of COPY_AUTO, writable. Function local static: a single instance across translation units
+**	DESCRIPTION:
+****************************************************************************/
+
+inline Copy_thresholds &copy_thresholds( void )
+{
+	static Copy_thresholds thresholds = { COPY_MOVSB_BYTES, copy_llc_bytes(), COPY_PARALLEL_BYTES };
+
+	return thresholds;
+}	//end function: copy_thresholds | void
+
+inline const char *copy_strategy_name( Copy_strategy strategy )
+{
+	switch (strategy)
+	{
+		case COPY_INLINE:
+			return "inline";
+		case COPY_MEMCPY:
+			return "memcpy";
+		case COPY_REP_MOVSB:
+			return "rep_movsb";
+		case COPY_STREAM:
+			return "stream";
+		case COPY_PARALLEL:
+			return "parallel";
+		default:
+			return "auto";
+	}
+}	//end function: copy_strategy_name | Copy_strategy
+
+/****************************************************************************
+**	copy_overlap | const void *, const void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	true when the bytes bytes at dst and at src share at least one byte
+**	DESCRIPTION:
+****************************************************************************/
+
+inline bool copy_overlap( const void *dst, const void *src, size_t bytes )
+{
+	uintptr_t d = (uintptr_t)dst;
+	uintptr_t s = (uintptr_t)src;
+
+	return ((d < s +bytes) && (s < d +bytes));
+}	//end function: copy_overlap | const void *, const void *, size_t
+
+/****************************************************************************
+**	copy_choose | const void *, const void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	src			NULL for a fill
+**	RETURN:
+**	strategy of COPY_AUTO
+**	DESCRIPTION:
+****************************************************************************/
+
+inline Copy_strategy copy_choose( const void *dst, const void *src, size_t bytes )
+{
+	const Copy_thresholds &thresholds = copy_thresholds();
+
+	if (bytes <= COPY_INLINE_BYTES)
+	{
+		return COPY_INLINE;
+	}
+	if ((src != NULL) && (copy_overlap( dst, src, bytes ) == true))
+	{
+		return COPY_MEMCPY;
+	}
+	if ((bytes >= thresholds.parallel) && (thread_pool_default().size() > 1))
+	{
+		return COPY_PARALLEL;
+	}
+	if (bytes >= thresholds.stream)
+	{
+		return COPY_STREAM;
+	}
+	if (bytes >= thresholds.movsb)
+	{
+		return COPY_REP_MOVSB;
+	}
+
+	return COPY_MEMCPY;
+}	//end function: copy_choose | const void *, const void *, size_t
+
+/****************************************************************************
+**	KERNELS
+*****************************************************************************
+**	One function per strategy. Callers have checked the CPU has what the kernel needs
+****************************************************************************/
+
+/****************************************************************************
+**	copy_inline | void *, const void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	bytes		up to COPY_INLINE_BYTES
+**	RETURN:
+**	DESCRIPTION:
+**	Head and tail of the same size W, overlapping in the middle, cover any size between W and 2W.
+**	memcpy of a constant size compiles to one load or store
+****************************************************************************/
+
+inline void copy_inline( void *dst, const void *src, size_t bytes )
+{
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)src;
+	unsigned char head[32], tail[32];
+
+	if (bytes >= 32)
+	{
+		memcpy( head, s, 32 );
+		memcpy( tail, s +bytes -32, 32 );
+		memcpy( d, head, 32 );
+		memcpy( d +bytes -32, tail, 32 );
+	}
+	else if (bytes >= 16)
+	{
+		memcpy( head, s, 16 );
+		memcpy( tail, s +bytes -16, 16 );
+		memcpy( d, head, 16 );
+		memcpy( d +bytes -16, tail, 16 );
+	}
+	else if (bytes >= 8)
+	{
+		memcpy( head, s, 8 );
+		memcpy( tail, s +bytes -8, 8 );
+		memcpy( d, head, 8 );
+		memcpy( d +bytes -8, tail, 8 );
+	}
+	else if (bytes >= 4)
+	{
+		memcpy( head, s, 4 );
+		memcpy( tail, s +bytes -4, 4 );
+		memcpy( d, head, 4 );
+		memcpy( d +bytes -4, tail, 4 );
+	}
+	else if (bytes > 0)
+	{
+		//1 to 3 bytes: first, middle, last
+		head[0] = s[0];
+		head[1] = s[bytes >> 1];
+		head[2] = s[bytes -1];
+		d[0] = head[0];
+		d[bytes >> 1] = head[1];
+		d[bytes -1] = head[2];
+	}
+}	//end function: copy_inline | void *, const void *, size_t
+
+//The fill of copy_inline: the same stores, of a repeated byte
+inline void fill_inline( void *dst, unsigned char value, size_t bytes )
+{
+	unsigned char *d = (unsigned char *)dst;
+	unsigned char pattern[32];
+
+	memset( pattern, value, sizeof( pattern ) );
+	if (bytes >= 32)
+	{
+		memcpy( d, pattern, 32 );
+		memcpy( d +bytes -32, pattern, 32 );
+	}
+	else if (bytes >= 16)
+	{
+		memcpy( d, pattern, 16 );
+		memcpy( d +bytes -16, pattern, 16 );
+	}
+	else if (bytes >= 8)
+	{
+		memcpy( d, pattern, 8 );
+		memcpy( d +bytes -8, pattern, 8 );
+	}
+	else if (bytes >= 4)
+	{
+		memcpy( d, pattern, 4 );
+		memcpy( d +bytes -4, pattern, 4 );
+	}
+	else if (bytes > 0)
+	{
+		d[0] = value;
+		d[bytes >> 1] = value;
+		d[bytes -1] = value;
+	}
+}	//end function: fill_inline | void *, unsigned char, size_t
+
+/****************************************************************************
+**	copy_rep_movsb | void *, const void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Forward copy of rcx bytes from rsi to rdi. The direction flag is clear, as the ABI requires
+****************************************************************************/
+
+inline void copy_rep_movsb( void *dst, const void *src, size_t bytes )
+{
+#if defined( COPY_X86 )
+	__asm__ __volatile__( "rep movsb" : "+D"( dst ), "+S"( src ), "+c"( bytes ) : : "memory" );
+#else
+	memcpy( dst, src, bytes );
+#endif
+}	//end function: copy_rep_movsb | void *, const void *, size_t
+
+inline void fill_rep_stosb( void *dst, unsigned char value, size_t bytes )
+{
+#if defined( COPY_X86 )
+	__asm__ __volatile__( "rep stosb" : "+D"( dst ), "+c"( bytes ) : "a"( value ) : "memory" );
+#else
+	memset( dst, value, bytes );
+#endif
+}	//end function: fill_rep_stosb | void *, unsigned char, size_t
+
+#if defined( COPY_X86 )
+
+/****************************************************************************
+**	copy_stream_avx | void *, const void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Head up to the first 32 byte boundary of dst with memcpy, 128 bytes per iteration of aligned
+**	non-temporal stores, tail with memcpy. src may be misaligned: loads are unaligned
+****************************************************************************/
+
+__attribute__(( target( "avx" ) )) inline void copy_stream_avx( void *dst, const void *src, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)src;
+	size_t head = std::min( (32 -((uintptr_t)d & 31)) & 31, bytes );
+	__m256i v0, v1, v2, v3;
+
+	memcpy( d, s, head );
+	d += head;
+	s += head;
+	bytes -= head;
+	for (t = 0;t +128 <= bytes;t += 128)
+	{
+		v0 = _mm256_loadu_si256( (const __m256i *)(s +t) );
+		v1 = _mm256_loadu_si256( (const __m256i *)(s +t +32) );
+		v2 = _mm256_loadu_si256( (const __m256i *)(s +t +64) );
+		v3 = _mm256_loadu_si256( (const __m256i *)(s +t +96) );
+		_mm256_stream_si256( (__m256i *)(d +t), v0 );
+		_mm256_stream_si256( (__m256i *)(d +t +32), v1 );
+		_mm256_stream_si256( (__m256i *)(d +t +64), v2 );
+		_mm256_stream_si256( (__m256i *)(d +t +96), v3 );
+	}
+	_mm_sfence();
+	memcpy( d +t, s +t, bytes -t );
+}	//end function: copy_stream_avx | void *, const void *, size_t
+
+__attribute__(( target( "avx" ) )) inline void fill_stream_avx( void *dst, unsigned char value, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	size_t head = std::min( (32 -((uintptr_t)d & 31)) & 31, bytes );
+	__m256i v = _mm256_set1_epi8( (char)value );
+
+	memset( d, value, head );
+	d += head;
+	bytes -= head;
+	for (t = 0;t +128 <= bytes;t += 128)
+	{
+		_mm256_stream_si256( (__m256i *)(d +t), v );
+		_mm256_stream_si256( (__m256i *)(d +t +32), v );
+		_mm256_stream_si256( (__m256i *)(d +t +64), v );
+		_mm256_stream_si256( (__m256i *)(d +t +96), v );
+	}
+	_mm_sfence();
+	memset( d +t, value, bytes -t );
+}	//end function: fill_stream_avx | void *, unsigned char, size_t
+
+//Same with 16 byte SSE2 vectors, part of every x86-64 CPU
+inline void copy_stream_sse2( void *dst, const void *src, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)src;
+	size_t head = std::min( (16 -((uintptr_t)d & 15)) & 15, bytes );
+	__m128i v0, v1, v2, v3;
+
+	memcpy( d, s, head );
+	d += head;
+	s += head;
+	bytes -= head;
+	for (t = 0;t +64 <= bytes;t += 64)
+	{
+		v0 = _mm_loadu_si128( (const __m128i *)(s +t) );
+		v1 = _mm_loadu_si128( (const __m128i *)(s +t +16) );
+		v2 = _mm_loadu_si128( (const __m128i *)(s +t +32) );
+		v3 = _mm_loadu_si128( (const __m128i *)(s +t +48) );
+		_mm_stream_si128( (__m128i *)(d +t), v0 );
+		_mm_stream_si128( (__m128i *)(d +t +16), v1 );
+		_mm_stream_si128( (__m128i *)(d +t +32), v2 );
+		_mm_stream_si128( (__m128i *)(d +t +48), v3 );
+	}
+	_mm_sfence();
+	memcpy( d +t, s +t, bytes -t );
+}	//end function: copy_stream_sse2 | void *, const void *, size_t
+
+inline void fill_stream_sse2( void *dst, unsigned char value, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	size_t head = std::min( (16 -((uintptr_t)d & 15)) & 15, bytes );
+	__m128i v = _mm_set1_epi8( (char)value );
+
+	memset( d, value, head );
+	d += head;
+	bytes -= head;
+	for (t = 0;t +64 <= bytes;t += 64)
+	{
+		_mm_stream_si128( (__m128i *)(d +t), v );
+		_mm_stream_si128( (__m128i *)(d +t +16), v );
+		_mm_stream_si128( (__m128i *)(d +t +32), v );
+		_mm_stream_si128( (__m128i *)(d +t +48), v );
+	}
+	_mm_sfence();
+	memset( d +t, value, bytes -t );
+}	//end function: fill_stream_sse2 | void *, unsigned char, size_t
+
+/****************************************************************************
+**	fill_stream_pattern_avx | void *, const void *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	seed		period +32 bytes of the pattern, from its first byte. dst starts on the first byte too
+**	period		bytes after which the pattern repeats, the size of an element
+**	RETURN:
+**	DESCRIPTION:
+**	fill_stream_avx of a pattern instead of a byte. When period divides 32 every vector is the same:
+**	one register for all the stores. Otherwise each store loads its 32 bytes from seed, at the offset
+**	of its first byte in the pattern. seed stays in the L1 cache
+****************************************************************************/
+
+__attribute__(( target( "avx" ) )) inline void fill_stream_pattern_avx( void *dst, const void *seed, size_t period, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)seed;
+	size_t head = std::min( (32 -((uintptr_t)d & 31)) & 31, bytes );
+	//Offset in the pattern of the byte at d +t, and how much it moves for each vector
+	size_t offset = head %period;
+	size_t step = 32 %period;
+	__m256i v;
+
+	memcpy( d, s, head );
+	d += head;
+	bytes -= head;
+	t = 0;
+	if (step == 0)
+	{
+		v = _mm256_loadu_si256( (const __m256i *)(s +offset) );
+		for (t = 0;t +128 <= bytes;t += 128)
+		{
+			_mm256_stream_si256( (__m256i *)(d +t), v );
+			_mm256_stream_si256( (__m256i *)(d +t +32), v );
+			_mm256_stream_si256( (__m256i *)(d +t +64), v );
+			_mm256_stream_si256( (__m256i *)(d +t +96), v );
+		}
+	}
+	for (;t +32 <= bytes;t += 32)
+	{
+		_mm256_stream_si256( (__m256i *)(d +t), _mm256_loadu_si256( (const __m256i *)(s +offset) ) );
+		offset += step;
+		offset -= (offset >= period) ?(period) :(0);
+	}
+	_mm_sfence();
+	memcpy( d +t, s +offset, bytes -t );
+}	//end function: fill_stream_pattern_avx | void *, const void *, size_t, size_t
+
+//Same with 16 byte SSE2 vectors. seed holds period +16 bytes
+inline void fill_stream_pattern_sse2( void *dst, const void *seed, size_t period, size_t bytes )
+{
+	//fast counter
+	size_t t;
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)seed;
+	size_t head = std::min( (16 -((uintptr_t)d & 15)) & 15, bytes );
+	size_t offset = head %period;
+	size_t step = 16 %period;
+	__m128i v;
+
+	memcpy( d, s, head );
+	d += head;
+	bytes -= head;
+	t = 0;
+	if (step == 0)
+	{
+		v = _mm_loadu_si128( (const __m128i *)(s +offset) );
+		for (t = 0;t +64 <= bytes;t += 64)
+		{
+			_mm_stream_si128( (__m128i *)(d +t), v );
+			_mm_stream_si128( (__m128i *)(d +t +16), v );
+			_mm_stream_si128( (__m128i *)(d +t +32), v );
+			_mm_stream_si128( (__m128i *)(d +t +48), v );
+		}
+	}
+	for (;t +16 <= bytes;t += 16)
+	{
+		_mm_stream_si128( (__m128i *)(d +t), _mm_loadu_si128( (const __m128i *)(s +offset) ) );
+		offset += step;
+		offset -= (offset >= period) ?(period) :(0);
+	}
+	_mm_sfence();
+	memcpy( d +t, s +offset, bytes -t );
+}	//end function: fill_stream_pattern_sse2 | void *, const void *, size_t, size_t
+
+#endif
+
+//Non-temporal copy with the widest vectors the CPU has. memcpy off x86
+inline void copy_stream( void *dst, const void *src, size_t bytes )
+{
+#if defined( COPY_X86 )
+	if (copy_has_avx() == true)
+	{
+		copy_stream_avx( dst, src, bytes );
+	}
+	else
+	{
+		copy_stream_sse2( dst, src, bytes );
+	}
+#else
+	memcpy( dst, src, bytes );
+#endif
+}	//end function: copy_stream | void *, const void *, size_t
+
+inline void fill_stream( void *dst, unsigned char value, size_t bytes )
+{
+#if defined( COPY_X86 )
+	if (copy_has_avx() == true)
+	{
+		fill_stream_avx( dst, value, bytes );
+	}
+	else
+	{
+		fill_stream_sse2( dst, value, bytes );
+	}
+#else
+	memset( dst, value, bytes );
+#endif
+}	//end function: fill_stream | void *, unsigned char, size_t
+
+//Non-temporal fill with a pattern of period bytes, see fill_stream_pattern_avx. seed holds period +32 bytes
+inline void fill_stream_pattern( void *dst, const void *seed, size_t period, size_t bytes )
+{
+#if defined( COPY_X86 )
+	if (copy_has_avx() == true)
+	{
+		fill_stream_pattern_avx( dst, seed, period, bytes );
+	}
+	else
+	{
+		fill_stream_pattern_sse2( dst, seed, period, bytes );
+	}
+#else
+	//fast counter
+	size_t t;
+
+	for (t = 0;t < bytes;t += period)
+	{
+		memcpy( (unsigned char *)dst +t, seed, std::min( period, bytes -t ) );
+	}
+#endif
+}	//end function: fill_stream_pattern | void *, const void *, size_t, size_t
+
+/****************************************************************************
+**	copy_parallel_grain | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	bytes per task: a few tasks per thread, whole multiples of COPY_PARALLEL_GRAIN
+**	DESCRIPTION:
+**	Chunks start on the same offset from a page boundary as dst: the streaming stores of each chunk are aligned
+****************************************************************************/
+
+inline size_t copy_parallel_grain( size_t bytes )
+{
+	size_t num_tasks = (size_t)thread_pool_default().size() *PARALLEL_TASKS_PER_THREAD;
+	size_t grain = (bytes +num_tasks -1) /num_tasks;
+
+	return (grain +COPY_PARALLEL_GRAIN -1) /COPY_PARALLEL_GRAIN *COPY_PARALLEL_GRAIN;
+}	//end function: copy_parallel_grain | size_t
+
+/****************************************************************************
+**	copy_dispatch | void *, const void *, size_t, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	array_copy_bytes past the inline sizes. Out of line: the callers stay small
+****************************************************************************/
+
+inline __attribute__(( noinline )) void copy_dispatch( void *dst, const void *src, size_t bytes, Copy_strategy strategy )
+{
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if ((bytes == 0) || (dst == src))
+	{
+		return;
+	}
+	if (strategy == COPY_AUTO)
+	{
+		strategy = copy_choose( dst, src, bytes );
+	}
+	//Forced strategies that can't do it
+	if ((strategy == COPY_INLINE) && (bytes > COPY_INLINE_BYTES))
+	{
+		strategy = COPY_MEMCPY;
+	}
+	if ((strategy != COPY_INLINE) && (copy_overlap( dst, src, bytes ) == true))
+	{
+		strategy = COPY_MEMCPY;
+	}
+	if ((strategy == COPY_REP_MOVSB) && (copy_has_erms() == false))
+	{
+		strategy = COPY_MEMCPY;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	switch (strategy)
+	{
+		case COPY_INLINE:
+			copy_inline( dst, src, bytes );
+			break;
+		case COPY_REP_MOVSB:
+			copy_rep_movsb( dst, src, bytes );
+			break;
+		case COPY_STREAM:
+			copy_stream( dst, src, bytes );
+			break;
+		case COPY_PARALLEL:
+			parallel_for_range( 0, bytes, [&]( size_t chunk_begin, size_t chunk_end )
+			{
+				copy_stream( (unsigned char *)dst +chunk_begin, (const unsigned char *)src +chunk_begin, chunk_end -chunk_begin );
+			}, Parallel_options( copy_parallel_grain( bytes ) ) );
+			break;
+		default:
+			memmove( dst, src, bytes );
+			break;
+	}
+
+	return;
+}	//end function: copy_dispatch | void *, const void *, size_t, Copy_strategy
+
+/****************************************************************************
+**	fill_dispatch | void *, unsigned char, size_t, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	array_fill_bytes past the inline sizes
+****************************************************************************/
+
+inline __attribute__(( noinline )) void fill_dispatch( void *dst, unsigned char value, size_t bytes, Copy_strategy strategy )
+{
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (bytes == 0)
+	{
+		return;
+	}
+	if (strategy == COPY_AUTO)
+	{
+		strategy = copy_choose( dst, NULL, bytes );
+	}
+	if ((strategy == COPY_INLINE) && (bytes > COPY_INLINE_BYTES))
+	{
+		strategy = COPY_MEMCPY;
+	}
+	if ((strategy == COPY_REP_MOVSB) && (copy_has_erms() == false))
+	{
+		strategy = COPY_MEMCPY;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	switch (strategy)
+	{
+		case COPY_INLINE:
+			fill_inline( dst, value, bytes );
+			break;
+		case COPY_REP_MOVSB:
+			fill_rep_stosb( dst, value, bytes );
+			break;
+		case COPY_STREAM:
+			fill_stream( dst, value, bytes );
+			break;
+		case COPY_PARALLEL:
+			parallel_for_range( 0, bytes, [&]( size_t chunk_begin, size_t chunk_end )
+			{
+				fill_stream( (unsigned char *)dst +chunk_begin, value, chunk_end -chunk_begin );
+			}, Parallel_options( copy_parallel_grain( bytes ) ) );
+			break;
+		default:
+			memset( dst, value, bytes );
+			break;
+	}
+
+	return;
+}	//end function: fill_dispatch | void *, unsigned char, size_t, Copy_strategy
+
+/****************************************************************************
+**	array_copy_bytes | void *, const void *, size_t, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	strategy	COPY_AUTO, or a strategy to force. See STRATEGIES for the fallbacks
+**	RETURN:
+**	DESCRIPTION:
+**	memmove with a choice of strategy. dst and src may overlap.
+**	Copies up to COPY_INLINE_BYTES are inlined into the caller, no call at all
+****************************************************************************/
+
+inline void array_copy_bytes( void *dst, const void *src, size_t bytes, Copy_strategy strategy = COPY_AUTO )
+{
+	if ((bytes <= COPY_INLINE_BYTES) && ((strategy == COPY_AUTO) || (strategy == COPY_INLINE)))
+	{
+		copy_inline( dst, src, bytes );
+		return;
+	}
+	copy_dispatch( dst, src, bytes, strategy );
+}	//end function: array_copy_bytes | void *, const void *, size_t, Copy_strategy
+
+/****************************************************************************
+**	array_fill_bytes | void *, unsigned char, size_t, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	strategy	COPY_REP_MOVSB is rep stosb
+**	RETURN:
+**	DESCRIPTION:
+**	memset with a choice of strategy
+****************************************************************************/
+
+inline void array_fill_bytes( void *dst, unsigned char value, size_t bytes, Copy_strategy strategy = COPY_AUTO )
+{
+	if ((bytes <= COPY_INLINE_BYTES) && ((strategy == COPY_AUTO) || (strategy == COPY_INLINE)))
+	{
+		fill_inline( dst, value, bytes );
+		return;
+	}
+	fill_dispatch( dst, value, bytes, strategy );
+}	//end function: array_fill_bytes | void *, unsigned char, size_t, Copy_strategy
+
+/****************************************************************************
+**	array_copy | T *, const T *, size_t, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	num			elements
+**	RETURN:
+**	DESCRIPTION:
+**	std::copy of trivially copyable elements with a choice of strategy
+****************************************************************************/
+
+template <typename T>
+inline void array_copy( T *dst, const T *src, size_t num, Copy_strategy strategy = COPY_AUTO )
+{
+	static_assert( std::is_trivially_copyable<T>::value == true, "array_copy moves elements as bytes, T must be trivially copyable" );
+
+	array_copy_bytes( (void *)dst, (const void *)src, num *sizeof(T), strategy );
+}	//end function: array_copy | T *, const T *, size_t, Copy_strategy
+
+/****************************************************************************
+**	array_fill | T *, size_t, const T &, Copy_strategy
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	A value of the same byte repeated, as 0 or -1, is array_fill_bytes.
+**	Streaming fills store the first elements by a loop, then the rest in a single fill_stream_pattern,
+**	one per chunk when parallel: the first elements are the pattern, the elements the size of its period.
+**	Otherwise a block of COPY_FILL_BLOCK bytes is filled by a loop and copied over the rest:
+**	the block stays in the L1 cache, only the stores reach memory
+****************************************************************************/
+
+template <typename T>
+inline void array_fill( T *dst, size_t num, const T &value, Copy_strategy strategy = COPY_AUTO )
+{
+	static_assert( std::is_trivially_copyable<T>::value == true, "array_fill writes elements as bytes, T must be trivially copyable" );
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	//Elements of the block
+	const size_t block = (COPY_FILL_BLOCK /sizeof(T) > 0) ?(COPY_FILL_BLOCK /sizeof(T)) :(1);
+	//Elements of the seed of fill_stream_pattern: one element and 32 bytes more
+	const size_t seed = 1 +(32 +sizeof(T) -1) /sizeof(T);
+	const unsigned char *bytes = (const unsigned char *)&value;
+	bool same = true;
+	T tmp( value );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 1;t < sizeof(T);t++)
+	{
+		same = same && (bytes[t] == bytes[0]);
+	}
+	if (same == true)
+	{
+		array_fill_bytes( (void *)dst, bytes[0], num *sizeof(T), strategy );
+		return;
+	}
+	if (strategy == COPY_AUTO)
+	{
+		strategy = copy_choose( dst, NULL, num *sizeof(T) );
+	}
+	if ((strategy == COPY_STREAM) || (strategy == COPY_PARALLEL))
+	{
+		for (t = 0;(t < seed) && (t < num);t++)
+		{
+			dst[t] = tmp;
+		}
+		if (num <= seed)
+		{
+			return;
+		}
+		if (strategy == COPY_STREAM)
+		{
+			fill_stream_pattern( (void *)(dst +seed), (const void *)dst, sizeof(T), (num -seed) *sizeof(T) );
+			return;
+		}
+		//Chunks start on an element: on the first byte of the pattern
+		parallel_for_range( seed, num, [&]( size_t chunk_begin, size_t chunk_end )
+		{
+			fill_stream_pattern( (void *)(dst +chunk_begin), (const void *)dst, sizeof(T), (chunk_end -chunk_begin) *sizeof(T) );
+		}, Parallel_options( std::max( copy_parallel_grain( num *sizeof(T) ) /sizeof(T), (size_t)1 ) ) );
+		return;
+	}
+	for (t = 0;(t < block) && (t < num);t++)
+	{
+		dst[t] = tmp;
+	}
+	for (t = block;t < num;t += block)
+	{
+		array_copy( dst +t, dst, std::min( block, num -t ), strategy );
+	}
+
+	return;
+}	//end function: array_fill | T *, size_t, const T &, Copy_strategy
+
+#endif	//ARRAY_COPY_H_
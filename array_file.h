@@ -0,0 +1,717 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Array File
+*****************************************************************
+**	Self describing binary file of an array, streamed in chunks
+**	C++11 standard, POSIX
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	FORMAT
+**	A header, padding, the elements row-major with no separator.
+**		magic		8 bytes "OBARRAY", zero terminated
+**		version		uint32
+**		dtype		uint8, Array_dtype: i8 u8 i16 u16 i32 u32 i64 u64 f32 f64
+**		endian		uint8, 1 little 2 big. Byte order of the elements and of the header itself
+**		rank		uint8, 1 to ARRAY_FILE_MAX_RANK
+**		reserved	uint8, 0
+**		alignment	uint32, power of two. The elements start on a multiple of it
+**		offset		uint32, byte where the elements start
+**		shape		uint64 x ARRAY_FILE_MAX_RANK. Extents, 0 past rank
+**	The default alignment is a page, so the elements can be mapped by MappedArray: array_file_map().
+**
+**	STREAMING
+**	ArrayFileWriter<T> and ArrayFileReader<T> hold a single chunk of ARRAY_FILE_CHUNK bytes,
+**	whatever the size of the array. A writer takes elements in pieces of any size and writes whole chunks;
+**	a reader hands out the file a chunk at a time, or copies into a buffer of the caller.
+**	Files of the other byte order are swapped by the reader, chunk by chunk.
+**
+**	ERRORS
+**	Errors of the operating system throw std::system_error with errno.
+**	A file that is not an array of T, or a writer closed before all the elements arrived, throw std::runtime_error.
+****************************************************************/
+
+#ifndef ARRAY_FILE_H_
+#define ARRAY_FILE_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uint8_t, uint32_t, uint64_t
+#include <cstring>		//for memcpy, memset, memcmp
+#include <cerrno>		//for errno
+//Standard C++ libraries
+#include <string>		//for std::string
+#include <vector>		//for std::vector
+#include <initializer_list>	//for std::initializer_list
+#include <stdexcept>	//for std::runtime_error
+#include <system_error>	//for std::system_error
+#include <algorithm>	//for std::min
+//POSIX
+#include <fcntl.h>		//for open
+#include <unistd.h>		//for read, write, close, lseek
+//User libraries
+#include "array_view.h"	//for Span
+#include "aligned_array.h"	//for AlignedArray, ALIGNED_PAGE
+#include "mapped_array.h"	//for MappedArray
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Format version written by this code
+#define ARRAY_FILE_VERSION		1
+//Most dimensions an array can have
+#define ARRAY_FILE_MAX_RANK		8
+//Bytes of the buffer of a reader or writer. A multiple of every element size
+#define ARRAY_FILE_CHUNK		((size_t)1 << 20)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Type of the elements
+typedef enum _Array_dtype
+{
+	ARRAY_DTYPE_I8 = 1,
+	ARRAY_DTYPE_U8,
+	ARRAY_DTYPE_I16,
+	ARRAY_DTYPE_U16,
+	ARRAY_DTYPE_I32,
+	ARRAY_DTYPE_U32,
+	ARRAY_DTYPE_I64,
+	ARRAY_DTYPE_U64,
+	ARRAY_DTYPE_F32,
+	ARRAY_DTYPE_F64
+} Array_dtype;
+
+//Byte order of the file
+typedef enum _Array_endian
+{
+	ARRAY_LITTLE_ENDIAN = 1,
+	ARRAY_BIG_ENDIAN = 2
+} Array_endian;
+
+//Header at the start of the file. 88 bytes, no padding between fields
+struct Array_file_header
+{
+	char magic[8];
+	uint32_t version;
+	uint8_t dtype;
+	uint8_t endian;
+	uint8_t rank;
+	uint8_t reserved;
+	uint32_t alignment;
+	uint32_t offset;
+	uint64_t shape[ARRAY_FILE_MAX_RANK];
+};
+
+static_assert( sizeof( Array_file_header ) == 88, "Array_file_header must have no padding" );
+
+//dtype of each element type. No value for the types that have no dtype
+template <typename T> struct Array_dtype_of;
+template <> struct Array_dtype_of<int8_t> { static const Array_dtype value = ARRAY_DTYPE_I8; };
+template <> struct Array_dtype_of<uint8_t> { static const Array_dtype value = ARRAY_DTYPE_U8; };
+template <> struct Array_dtype_of<int16_t> { static const Array_dtype value = ARRAY_DTYPE_I16; };
+template <> struct Array_dtype_of<uint16_t> { static const Array_dtype value = ARRAY_DTYPE_U16; };
+template <> struct Array_dtype_of<int32_t> { static const Array_dtype value = ARRAY_DTYPE_I32; };
+template <> struct Array_dtype_of<uint32_t> { static const Array_dtype value = ARRAY_DTYPE_U32; };
+template <> struct Array_dtype_of<int64_t> { static const Array_dtype value = ARRAY_DTYPE_I64; };
+template <> struct Array_dtype_of<uint64_t> { static const Array_dtype value = ARRAY_DTYPE_U64; };
+template <> struct Array_dtype_of<float> { static const Array_dtype value = ARRAY_DTYPE_F32; };
+template <> struct Array_dtype_of<double> { static const Array_dtype value = ARRAY_DTYPE_F64; };
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	array_file_native_endian | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	byte order of this machine
+**	DESCRIPTION:
+****************************************************************************/
+
+inline Array_endian array_file_native_endian( void )
+{
+	const uint16_t probe = 1;
+
+	return (*(const uint8_t *)&probe == 1) ?(ARRAY_LITTLE_ENDIAN) :(ARRAY_BIG_ENDIAN);
+}	//end function: array_file_native_endian | void
+
+/****************************************************************************
+**	array_file_swap | void *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	data			count elements of elem_bytes each
+**	RETURN:
+**	DESCRIPTION:
+**	Reverse the bytes of each element. Single byte elements are left alone
+****************************************************************************/
+
+inline void array_file_swap( void *data, size_t count, size_t elem_bytes )
+{
+	//fast counters
+	size_t t, b;
+	uint8_t *p = (uint8_t *)data;
+	uint8_t tmp;
+
+	if (elem_bytes <= 1)
+	{
+		return;
+	}
+	for (t = 0;t < count;t++)
+	{
+		for (b = 0;b < elem_bytes /2;b++)
+		{
+			tmp = p[b];
+			p[b] = p[elem_bytes -1 -b];
+			p[elem_bytes -1 -b] = tmp;
+		}
+		p += elem_bytes;
+	}
+
+	return;
+}	//end function: array_file_swap | void *, size_t, size_t
+
+/****************************************************************************
+**	array_file_write_all | int, const void *, size_t, const std::string &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	write() until all bytes are out. Throws on error
+****************************************************************************/
+
+inline void array_file_write_all( int fd, const void *data, size_t bytes, const std::string &path )
+{
+	ssize_t ret;
+	const char *p = (const char *)data;
+
+	while (bytes > 0)
+	{
+		ret = write( fd, p, bytes );
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw std::system_error( errno, std::generic_category(), "write " +path );
+		}
+		p += ret;
+		bytes -= (size_t)ret;
+	}
+
+	return;
+}	//end function: array_file_write_all | int, const void *, size_t, const std::string &
+
+/****************************************************************************
+**	array_file_read_all | int, void *, size_t, const std::string &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	bytes read. Less than asked only at the end of the file
+**	DESCRIPTION:
+****************************************************************************/
+
+inline size_t array_file_read_all( int fd, void *data, size_t bytes, const std::string &path )
+{
+	ssize_t ret;
+	char *p = (char *)data;
+	size_t done = 0;
+
+	while (done < bytes)
+	{
+		ret = read( fd, p +done, bytes -done );
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw std::system_error( errno, std::generic_category(), "read " +path );
+		}
+		if (ret == 0)
+		{
+			break;
+		}
+		done += (size_t)ret;
+	}
+
+	return done;
+}	//end function: array_file_read_all | int, void *, size_t, const std::string &
+
+/****************************************************************************
+**	array_file_read_header | int, const std::string &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	header in the byte order of this machine
+**	DESCRIPTION:
+**	Checks magic, version, rank, alignment. Does not check dtype: the caller knows what it wants
+****************************************************************************/
+
+inline Array_file_header array_file_read_header( int fd, const std::string &path )
+{
+	//fast counter
+	unsigned int t;
+	Array_file_header header;
+
+	if (array_file_read_all( fd, &header, sizeof( header ), path ) != sizeof( header ))
+	{
+		throw std::runtime_error( "array_file: " +path +" is too short for a header" );
+	}
+	if (memcmp( header.magic, "OBARRAY", 8 ) != 0)
+	{
+		throw std::runtime_error( "array_file: " +path +" is not an array file" );
+	}
+	if ((header.endian != ARRAY_LITTLE_ENDIAN) && (header.endian != ARRAY_BIG_ENDIAN))
+	{
+		throw std::runtime_error( "array_file: " +path +" has a bad byte order" );
+	}
+	if (header.endian != array_file_native_endian())
+	{
+		array_file_swap( &header.version, 1, sizeof( header.version ) );
+		array_file_swap( &header.alignment, 1, sizeof( header.alignment ) );
+		array_file_swap( &header.offset, 1, sizeof( header.offset ) );
+		array_file_swap( header.shape, ARRAY_FILE_MAX_RANK, sizeof( header.shape[0] ) );
+	}
+	if (header.version != ARRAY_FILE_VERSION)
+	{
+		throw std::runtime_error( "array_file: " +path +" has an unknown version" );
+	}
+	if ((header.rank < 1) || (header.rank > ARRAY_FILE_MAX_RANK) || (header.offset < sizeof( header )))
+	{
+		throw std::runtime_error( "array_file: " +path +" has a bad header" );
+	}
+	for (t = header.rank;t < ARRAY_FILE_MAX_RANK;t++)
+	{
+		header.shape[t] = 0;
+	}
+
+	return header;
+}	//end function: array_file_read_header | int, const std::string &
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	ArrayFileWriter
+*****************************************************************************
+**	DESCRIPTION:
+**	Writes the header at construction, the elements as they come, checks the count at close()
+****************************************************************************/
+
+template <typename T>
+class ArrayFileWriter
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Create or truncate path. shape: extents, outermost first. alignment: power of two, at most 2^31
+		ArrayFileWriter( const std::string &path, std::initializer_list<uint64_t> shape, uint32_t alignment = ALIGNED_PAGE ) : g_path( path ), g_fd( -1 ), g_size( 1 ), g_written( 0 ), g_used( 0 ), g_chunk( ARRAY_FILE_CHUNK /sizeof(T) )
+		{
+			//fast counter
+			unsigned int t;
+			Array_file_header header;
+			std::vector<char> padding;
+
+			if ((shape.size() < 1) || (shape.size() > ARRAY_FILE_MAX_RANK) || (alignment == 0) || ((alignment & (alignment -1)) != 0) || (alignment > ((uint32_t)1 << 31)))
+			{
+				throw std::runtime_error( "array_file: bad shape or alignment for " +path );
+			}
+			memset( &header, 0, sizeof( header ) );
+			memcpy( header.magic, "OBARRAY", 8 );
+			header.version = ARRAY_FILE_VERSION;
+			header.dtype = (uint8_t)Array_dtype_of<T>::value;
+			header.endian = (uint8_t)array_file_native_endian();
+			header.rank = (uint8_t)shape.size();
+			header.alignment = alignment;
+			header.offset = (uint32_t)((sizeof( header ) +alignment -1) & ~((size_t)alignment -1));
+			t = 0;
+			for (uint64_t extent : shape)
+			{
+				header.shape[t++] = extent;
+				g_size *= (size_t)extent;
+			}
+			g_fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+			if (g_fd < 0)
+			{
+				throw std::system_error( errno, std::generic_category(), "open " +path );
+			}
+			padding.resize( header.offset, 0 );
+			memcpy( padding.data(), &header, sizeof( header ) );
+			try
+			{
+				array_file_write_all( g_fd, padding.data(), padding.size(), g_path );
+			}
+			catch (...)
+			{
+				::close( g_fd );
+				throw;
+			}
+			g_buffer = AlignedArray<T>( g_chunk );
+		}
+
+		ArrayFileWriter( const ArrayFileWriter & ) = delete;
+		ArrayFileWriter &operator=( const ArrayFileWriter & ) = delete;
+
+		//Closes the file. Errors are lost: call close() to see them
+		~ArrayFileWriter( void )
+		{
+			if (g_fd >= 0)
+			{
+				try
+				{
+					flush_buffer();
+				}
+				catch (...)
+				{
+				}
+				::close( g_fd );
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		//Elements of the whole array
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		//Elements accepted so far
+		size_t written( void ) const
+		{
+			return g_written +g_used;
+		}
+
+		//Append count elements. Whole chunks of data skip the buffer
+		void write( const T *data, size_t count )
+		{
+			size_t num;
+
+			if (written() +count > g_size)
+			{
+				throw std::runtime_error( "array_file: more elements than the shape of " +g_path );
+			}
+			while (count > 0)
+			{
+				if ((g_used == 0) && (count >= g_chunk))
+				{
+					num = count -count %g_chunk;
+					array_file_write_all( g_fd, data, num *sizeof(T), g_path );
+					g_written += num;
+				}
+				else
+				{
+					num = std::min( count, g_chunk -g_used );
+					memcpy( g_buffer.data() +g_used, data, num *sizeof(T) );
+					g_used += num;
+					if (g_used == g_chunk)
+					{
+						flush_buffer();
+					}
+				}
+				data += num;
+				count -= num;
+			}
+		}
+
+		void write( Span<const T> data )
+		{
+			write( data.data(), data.size() );
+		}
+
+		//Write what is buffered and close. Throws if fewer elements than the shape arrived
+		void close( void )
+		{
+			if (g_fd < 0)
+			{
+				return;
+			}
+			flush_buffer();
+			if (::close( g_fd ) != 0)
+			{
+				g_fd = -1;
+				throw std::system_error( errno, std::generic_category(), "close " +g_path );
+			}
+			g_fd = -1;
+			if (g_written != g_size)
+			{
+				throw std::runtime_error( "array_file: fewer elements than the shape of " +g_path );
+			}
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		void flush_buffer( void )
+		{
+			if (g_used > 0)
+			{
+				array_file_write_all( g_fd, g_buffer.data(), g_used *sizeof(T), g_path );
+				g_written += g_used;
+				g_used = 0;
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		std::string g_path;
+		int g_fd;
+		//Elements of the shape
+		size_t g_size;
+		//Elements written to the file
+		size_t g_written;
+		//Elements waiting in the buffer
+		size_t g_used;
+		//Elements of a chunk
+		size_t g_chunk;
+		AlignedArray<T> g_buffer;
+};	//end class: ArrayFileWriter
+
+/****************************************************************************
+**	ArrayFileReader
+*****************************************************************************
+**	DESCRIPTION:
+**	Reads and checks the header at construction, then the elements in order
+****************************************************************************/
+
+template <typename T>
+class ArrayFileReader
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		explicit ArrayFileReader( const std::string &path ) : g_path( path ), g_fd( -1 ), g_size( 1 ), g_read( 0 ), g_swap( false ), g_chunk( ARRAY_FILE_CHUNK /sizeof(T) )
+		{
+			//fast counter
+			unsigned int t;
+
+			g_fd = open( path.c_str(), O_RDONLY );
+			if (g_fd < 0)
+			{
+				throw std::system_error( errno, std::generic_category(), "open " +path );
+			}
+			try
+			{
+				g_header = array_file_read_header( g_fd, path );
+				if (g_header.dtype != (uint8_t)Array_dtype_of<T>::value)
+				{
+					throw std::runtime_error( "array_file: " +path +" holds another type" );
+				}
+				if (lseek( g_fd, (off_t)g_header.offset, SEEK_SET ) < 0)
+				{
+					throw std::system_error( errno, std::generic_category(), "lseek " +path );
+				}
+			}
+			catch (...)
+			{
+				::close( g_fd );
+				throw;
+			}
+			for (t = 0;t < g_header.rank;t++)
+			{
+				g_size *= (size_t)g_header.shape[t];
+			}
+			g_swap = (g_header.endian != array_file_native_endian());
+		}
+
+		ArrayFileReader( const ArrayFileReader & ) = delete;
+		ArrayFileReader &operator=( const ArrayFileReader & ) = delete;
+
+		~ArrayFileReader( void )
+		{
+			::close( g_fd );
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		unsigned int rank( void ) const
+		{
+			return g_header.rank;
+		}
+
+		size_t shape( unsigned int dim ) const
+		{
+			return (size_t)g_header.shape[dim];
+		}
+
+		//Elements of the whole array
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		//Elements not yet read
+		size_t remaining( void ) const
+		{
+			return g_size -g_read;
+		}
+
+		//Copy up to count elements into data. Return the elements copied, 0 at the end
+		size_t read( T *data, size_t count )
+		{
+			size_t num = std::min( count, remaining() );
+			size_t got;
+
+			got = array_file_read_all( g_fd, data, num *sizeof(T), g_path ) /sizeof(T);
+			if (got != num)
+			{
+				throw std::runtime_error( "array_file: " +g_path +" is truncated" );
+			}
+			if (g_swap == true)
+			{
+				array_file_swap( data, num, sizeof(T) );
+			}
+			g_read += num;
+
+			return num;
+		}
+
+		//Next chunk of at most ARRAY_FILE_CHUNK bytes, in a buffer of the reader. Empty at the end. Valid until the next call
+		Span<const T> next_chunk( void )
+		{
+			size_t num;
+
+			if (g_buffer.empty() == true)
+			{
+				g_buffer = AlignedArray<T>( g_chunk );
+			}
+			num = read( g_buffer.data(), g_chunk );
+
+			return Span<const T>( g_buffer.data(), num );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		std::string g_path;
+		int g_fd;
+		Array_file_header g_header;
+		//Elements of the shape
+		size_t g_size;
+		//Elements handed out
+		size_t g_read;
+		//File has the other byte order
+		bool g_swap;
+		//Elements of a chunk
+		size_t g_chunk;
+		//Allocated by the first next_chunk
+		AlignedArray<T> g_buffer;
+};	//end class: ArrayFileReader
+
+/****************************************************************************
+**	array_file_save | const std::string &, const T *, std::initializer_list<uint64_t>
+*****************************************************************************
+**	PARAMETER:
+**	data			all the elements of the shape
+**	RETURN:
+**	DESCRIPTION:
+**	Whole array in one call
+****************************************************************************/
+
+template <typename T>
+inline void array_file_save( const std::string &path, const T *data, std::initializer_list<uint64_t> shape )
+{
+	ArrayFileWriter<T> writer( path, shape );
+
+	writer.write( data, writer.size() );
+	writer.close();
+
+	return;
+}	//end function: array_file_save | const std::string &, const T *, std::initializer_list<uint64_t>
+
+/****************************************************************************
+**	array_file_map | const std::string &, Mapped_mode, std::vector<size_t> *
+*****************************************************************************
+**	PARAMETER:
+**	shape		optional. Receives the extents
+**	RETURN:
+**	MappedArray of the elements, no copy
+**	DESCRIPTION:
+**	The file must hold T in the byte order of this machine, with an alignment of at least a page
+****************************************************************************/
+
+template <typename T>
+inline MappedArray<T> array_file_map( const std::string &path, Mapped_mode mode = MAPPED_READ_ONLY, std::vector<size_t> *shape = NULL )
+{
+	//fast counter
+	unsigned int t;
+	int fd;
+	size_t size = 1;
+	Array_file_header header;
+
+	fd = open( path.c_str(), O_RDONLY );
+	if (fd < 0)
+	{
+		throw std::system_error( errno, std::generic_category(), "open " +path );
+	}
+	try
+	{
+		header = array_file_read_header( fd, path );
+	}
+	catch (...)
+	{
+		close( fd );
+		throw;
+	}
+	close( fd );
+	if (header.dtype != (uint8_t)Array_dtype_of<T>::value)
+	{
+		throw std::runtime_error( "array_file: " +path +" holds another type" );
+	}
+	if ((header.endian != array_file_native_endian()) || (header.offset %sysconf( _SC_PAGESIZE ) != 0))
+	{
+		throw std::runtime_error( "array_file: " +path +" cannot be mapped, read it with ArrayFileReader" );
+	}
+	for (t = 0;t < header.rank;t++)
+	{
+		size *= (size_t)header.shape[t];
+		if (shape != NULL)
+		{
+			shape->push_back( (size_t)header.shape[t] );
+		}
+	}
+	MappedArray<T> ret( path, mode, header.offset );
+	if (ret.size() < size)
+	{
+		throw std::runtime_error( "array_file: " +path +" is truncated" );
+	}
+
+	return ret;
+}	//end function: array_file_map | const std::string &, Mapped_mode, std::vector<size_t> *
+
+#endif	//ARRAY_FILE_H_
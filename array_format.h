@@ -0,0 +1,533 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Array Format
+*****************************************************************
+**	Text dump of 1D and 2D arrays through a large buffer
+**	C++11 standard, std::to_chars under C++17
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	The handlers of example.cpp print with cout << array_arg[t] << " | " and end rows with endl.
+**	Each << goes through the locale and the stream state, each endl is a flush: a write() system call per row.
+**	A 10M element array takes seconds.
+**
+**	ArrayFormatter formats into a buffer of FORMAT_BUFFER_BYTES and hands it to the file descriptor
+**	with a single write() each time it fills up:
+**		write( data, size, options )			1D array, one row
+**		write( view, options )					View2d, row after row, any strides
+**		write_text( text, size )				raw text between arrays
+**		write_parallel( ..., parallel_options )	threads format chunks of elements into buffers of their own,
+**												the buffers are written in order. Same text as write
+**		flush()									the destructor flushes too, but swallows errors
+**	array_print( data, size ), array_print( view )	the same to stdout, flushed before returning.
+**												One formatter per thread of FORMAT_PRINT_BYTES, made on the first call and kept
+**
+**	Format_options( separator, row_end ): separator follows every element, the last one of a row included,
+**	row_end follows every row. The default " | " and "\n" give the text of the handlers.
+**
+**	NUMBERS
+**	Integers are written in decimal, char types as numbers too.
+**	Floating point is written with enough digits to read back as the same value.
+**	Under C++17 std::to_chars writes the shortest such text. Under C++11 snprintf %g writes digits10
+**	significant digits, or max_digits10 when strtod does not give the value back.
+**	The two agree on the value, not always on the text: 1e+06 against 1000000.
+**	The C++11 path costs a snprintf and a strtod per value, two snprintf when digits10 is not enough:
+**	double with a long fraction formats at about the speed of ostream, ~700 ns per element against
+**	~120 ns under C++17. The buffer still saves the write() per row. Build with -std=c++17 to dump doubles.
+**	cout prints 6 significant digits instead and loses the rest.
+**
+**	Errors of write() throw std::system_error. Writes to stdout are not ordered with cout:
+**	array_print flushes the C stdout that cout writes into before it starts. Don't mix an ArrayFormatter
+**	on stdout with cout without flushing them.
+****************************************************************/
+
+#ifndef ARRAY_FORMAT_H_
+#define ARRAY_FORMAT_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdio>		//for snprintf, fflush, stdout
+#include <cstdlib>		//for strtod, strtold
+#include <cstring>		//for memcpy, strlen
+#include <unistd.h>		//for STDOUT_FILENO
+//Standard C++ libraries
+#include <limits>		//for std::numeric_limits
+#include <type_traits>	//for std::is_integral, std::is_signed, std::true_type, std::false_type
+#include <algorithm>	//for std::min, std::max
+#if __cplusplus >= 201703L
+#include <charconv>		//for std::to_chars
+#endif
+//User libraries
+#include "array_view.h"	//for View2d
+#include "aligned_array.h"	//for AlignedArray
+#include "parallel.h"	//for ThreadPool, Parallel_options
+#include "array_file.h"	//for array_file_write_all
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Bytes of the buffer of an ArrayFormatter, and of each thread of write_parallel
+#define FORMAT_BUFFER_BYTES		((size_t)1 << 20)
+//Bytes of the buffer of array_print. A console takes a few KB per write(), and the buffer lives as long as the thread
+#define FORMAT_PRINT_BYTES		((size_t)8 << 10)
+//Longest text of a number: 20 digits and a sign for 64 bit integers, 29 characters for long double
+#define FORMAT_MAX_CHARS		32
+//Below this many elements write_parallel formats on the calling thread
+#define FORMAT_PARALLEL_MIN		((size_t)1 << 16)
+//Separators of the handlers of example.cpp
+#define FORMAT_SEPARATOR		" | "
+#define FORMAT_ROW_END			"\n"
+
+//std::to_chars of integers and floating point
+#if defined( __cpp_lib_to_chars )
+	#define FORMAT_TO_CHARS
+#endif
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Text around the elements
+struct Format_options
+{
+	Format_options( const char *separator_arg = FORMAT_SEPARATOR, const char *row_end_arg = FORMAT_ROW_END ) : separator( separator_arg ), row_end( row_end_arg )
+	{
+	}
+
+	//After every element
+	const char *separator;
+	//After every row
+	const char *row_end;
+};
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	format_integer | char *, U, bool
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	one past the last character written
+**	DESCRIPTION:
+**	Two digits per division, from a table of the 100 pairs, written backward then copied
+****************************************************************************/
+
+template <typename U>
+inline char *format_integer( char *dst, U magnitude, bool negative )
+{
+	static const char pairs[] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+	char tmp[FORMAT_MAX_CHARS];
+	char *p = tmp +FORMAT_MAX_CHARS;
+	size_t pair;
+
+	while (magnitude >= 100)
+	{
+		pair = (size_t)(magnitude %100) *2;
+		magnitude /= 100;
+		*--p = pairs[pair +1];
+		*--p = pairs[pair];
+	}
+	if (magnitude >= 10)
+	{
+		*--p = pairs[(size_t)magnitude *2 +1];
+		*--p = pairs[(size_t)magnitude *2];
+	}
+	else
+	{
+		*--p = (char)('0' +magnitude);
+	}
+	if (negative == true)
+	{
+		*--p = '-';
+	}
+	memcpy( dst, p, (size_t)(tmp +FORMAT_MAX_CHARS -p) );
+
+	return dst +(tmp +FORMAT_MAX_CHARS -p);
+}	//end function: format_integer | char *, U, bool
+
+/****************************************************************************
+**	format_float | char *, F
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	C++11. digits10 digits are enough for short values like 0.1, max_digits10 for all of them.
+**	Trying the counts in between would cost a snprintf and a strtod each on values with a long fraction.
+**	This is the cost of C++11 floating point, as slow as ostream on such values: see NUMBERS
+****************************************************************************/
+
+template <typename F>
+inline char *format_float( char *dst, F value )
+{
+	int ret = snprintf( dst, FORMAT_MAX_CHARS, "%.*g", std::numeric_limits<F>::digits10, (double)value );
+
+	if ((F)strtod( dst, NULL ) != value)
+	{
+		ret = snprintf( dst, FORMAT_MAX_CHARS, "%.*g", std::numeric_limits<F>::max_digits10, (double)value );
+	}
+
+	return dst +ret;
+}	//end function: format_float | char *, F
+
+template <>
+inline char *format_float<long double>( char *dst, long double value )
+{
+	int ret = snprintf( dst, FORMAT_MAX_CHARS, "%.*Lg", std::numeric_limits<long double>::digits10, value );
+
+	if (strtold( dst, NULL ) != value)
+	{
+		ret = snprintf( dst, FORMAT_MAX_CHARS, "%.*Lg", std::numeric_limits<long double>::max_digits10, value );
+	}
+
+	return dst +ret;
+}	//end function: format_float | char *, long double
+
+/****************************************************************************
+**	format_value | char *, T
+*****************************************************************************
+**	PARAMETER:
+**	dst			room for FORMAT_MAX_CHARS
+**	RETURN:
+**	one past the last character written
+**	DESCRIPTION:
+**	Integers are widened to 64 bit, so bool and char types print as numbers
+****************************************************************************/
+
+template <typename T>
+inline char *format_value( char *dst, T value, std::true_type )
+{
+	typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type W;
+	W wide = (W)value;
+
+#if defined( FORMAT_TO_CHARS )
+	return std::to_chars( dst, dst +FORMAT_MAX_CHARS, wide ).ptr;
+#else
+	//Negate in unsigned: the magnitude of the most negative value does not fit the signed type
+	return format_integer( dst, (wide < (W)0) ?((unsigned long long)0 -(unsigned long long)wide) :((unsigned long long)wide), (wide < (W)0) );
+#endif
+}	//end function: format_value | char *, T, std::true_type
+
+template <typename T>
+inline char *format_value( char *dst, T value, std::false_type )
+{
+	static_assert( std::is_floating_point<T>::value == true, "array format needs integer or floating point elements" );
+#if defined( FORMAT_TO_CHARS )
+	return std::to_chars( dst, dst +FORMAT_MAX_CHARS, value ).ptr;
+#else
+	return format_float<T>( dst, value );
+#endif
+}	//end function: format_value | char *, T, std::false_type
+
+template <typename T>
+inline char *format_value( char *dst, T value )
+{
+	return format_value( dst, value, typename std::is_integral<T>::type() );
+}	//end function: format_value | char *, T
+
+/****************************************************************************
+**	format_range | char *, View2d<const T>, size_t, size_t, const Format_options &, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	first		index of the first element, counted row after row
+**	num			elements
+**	RETURN:
+**	one past the last character written
+**	DESCRIPTION:
+**	dst must hold num *(FORMAT_MAX_CHARS +separator_size +row_end_size) characters
+****************************************************************************/
+
+template <typename T>
+inline char *format_range( char *dst, View2d<const T> view, size_t first, size_t num, const Format_options &options, size_t separator_size, size_t row_end_size )
+{
+	//fast counters
+	size_t t;
+	size_t row = first /view.cols();
+	size_t col = first %view.cols();
+
+	for (t = 0;t < num;t++)
+	{
+		dst = format_value( dst, view( row, col ) );
+		memcpy( dst, options.separator, separator_size );
+		dst += separator_size;
+		col++;
+		if (col == view.cols())
+		{
+			memcpy( dst, options.row_end, row_end_size );
+			dst += row_end_size;
+			col = 0;
+			row++;
+		}
+	}
+
+	return dst;
+}	//end function: format_range | char *, View2d<const T>, size_t, size_t, const Format_options &, size_t, size_t
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	ArrayFormatter
+*****************************************************************************
+**	DESCRIPTION:
+**	Text of arrays collected in a buffer, written to a file descriptor one full buffer at a time.
+**	The descriptor is not owned: the caller opens and closes it
+****************************************************************************/
+
+class ArrayFormatter
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//capacity_arg is raised to hold at least a few elements
+		explicit ArrayFormatter( int fd_arg = STDOUT_FILENO, size_t capacity_arg = FORMAT_BUFFER_BYTES ) : g_fd( fd_arg ), g_used( 0 )
+		{
+			g_buffer = AlignedArray<char>( std::max( capacity_arg, (size_t)(16 *FORMAT_MAX_CHARS) ) );
+		}
+
+		ArrayFormatter( const ArrayFormatter & ) = delete;
+		ArrayFormatter &operator=( const ArrayFormatter & ) = delete;
+
+		~ArrayFormatter( void )
+		{
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		int fd( void ) const
+		{
+			return g_fd;
+		}
+
+		size_t capacity( void ) const
+		{
+			return g_buffer.size();
+		}
+
+		//One write() of the text collected so far
+		void flush( void )
+		{
+			if (g_used > 0)
+			{
+				//Empty the buffer first: a throw leaves it empty, the destructor does not write the text twice
+				size_t used = g_used;
+				g_used = 0;
+				array_file_write_all( g_fd, g_buffer.data(), used, "array format" );
+			}
+		}
+
+		//Text longer than the room left goes straight to the descriptor
+		void write_text( const char *text, size_t size )
+		{
+			if (g_used +size > g_buffer.size())
+			{
+				flush();
+				if (size > g_buffer.size())
+				{
+					array_file_write_all( g_fd, text, size, "array format" );
+					return;
+				}
+			}
+			memcpy( g_buffer.data() +g_used, text, size );
+			g_used += size;
+		}
+
+		void write_text( const char *text )
+		{
+			write_text( text, strlen( text ) );
+		}
+
+		//A row of size elements
+		template <typename T>
+		void write( const T *data, size_t size, const Format_options &options = Format_options() )
+		{
+			write( View2d<const T>( data, (size > 0) ?(1) :(0), size ), options );
+		}
+
+		//Rows of the view, one after the other
+		template <typename T>
+		void write( View2d<T> view, const Format_options &options = Format_options() )
+		{
+			//fast counter
+			size_t first;
+			size_t separator_size = strlen( options.separator );
+			size_t row_end_size = strlen( options.row_end );
+			size_t per_element = FORMAT_MAX_CHARS +separator_size +row_end_size;
+			size_t num;
+
+			for (first = 0;first < view.size();first += num)
+			{
+				num = std::min( (g_buffer.size() -g_used) /per_element, view.size() -first );
+				if (num == 0)
+				{
+					flush();
+					num = std::min( g_buffer.size() /per_element, view.size() -first );
+				}
+				if (num == 0)
+				{
+					//Separators longer than the buffer: one element at a time
+					write_slow( View2d<const T>( view ), first, options );
+					num = 1;
+					continue;
+				}
+				g_used = format_range( g_buffer.data() +g_used, View2d<const T>( view ), first, num, options, separator_size, row_end_size ) -g_buffer.data();
+			}
+		}
+
+		//Same text as write. Rounds of one chunk per thread, then the chunks are written in order
+		template <typename T>
+		void write_parallel( const T *data, size_t size, const Format_options &options = Format_options(), const Parallel_options &parallel_options = Parallel_options() )
+		{
+			write_parallel( View2d<const T>( data, (size > 0) ?(1) :(0), size ), options, parallel_options );
+		}
+
+		template <typename T>
+		void write_parallel( View2d<T> view, const Format_options &options = Format_options(), const Parallel_options &parallel_options = Parallel_options() )
+		{
+			//fast counters
+			size_t first, t;
+			ThreadPool &pool = parallel_pool( parallel_options );
+			size_t num_tasks = pool.size();
+			size_t separator_size = strlen( options.separator );
+			size_t row_end_size = strlen( options.row_end );
+			size_t per_element = FORMAT_MAX_CHARS +separator_size +row_end_size;
+			size_t chunk = g_buffer.size() /per_element;
+
+			if ((view.size() < FORMAT_PARALLEL_MIN) || (num_tasks < 2) || (chunk == 0))
+			{
+				write( view, options );
+				return;
+			}
+			//A buffer per task. Task 0 uses the one of the formatter
+			flush();
+			AlignedArray<char> buffers( (num_tasks -1) *g_buffer.size() );
+			AlignedArray<size_t> sizes( num_tasks );
+			for (first = 0;first < view.size();first += num_tasks *chunk)
+			{
+				pool.run( num_tasks, [&]( size_t task )
+				{
+					char *dst = (task == 0) ?(g_buffer.data()) :(buffers.data() +(task -1) *g_buffer.size());
+					size_t begin = std::min( first +task *chunk, view.size() );
+					size_t num = std::min( chunk, view.size() -begin );
+
+					sizes[task] = format_range( dst, View2d<const T>( view ), begin, num, options, separator_size, row_end_size ) -dst;
+				} );
+				for (t = 0;t < num_tasks;t++)
+				{
+					array_file_write_all( g_fd, (t == 0) ?(g_buffer.data()) :(buffers.data() +(t -1) *g_buffer.size()), sizes[t], "array format" );
+				}
+			}
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		template <typename T>
+		void write_slow( View2d<const T> view, size_t index, const Format_options &options )
+		{
+			char text[FORMAT_MAX_CHARS];
+
+			write_text( text, format_value( text, view( index /view.cols(), index %view.cols() ) ) -text );
+			write_text( options.separator );
+			if (index %view.cols() == view.cols() -1)
+			{
+				write_text( options.row_end );
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Destination, not owned
+		int g_fd;
+		//Text not yet written
+		AlignedArray<char> g_buffer;
+		size_t g_used;
+};	//end class: ArrayFormatter
+
+/****************************************************************************
+**	array_print_formatter | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	formatter on stdout of the calling thread
+**	DESCRIPTION:
+**	The buffer is allocated once per thread, not once per array_print. It is empty between calls.
+**	Small: it is never freed before the thread ends, and is charged to whatever is running when it is made
+****************************************************************************/
+
+inline ArrayFormatter &array_print_formatter( void )
+{
+	static thread_local ArrayFormatter out( STDOUT_FILENO, FORMAT_PRINT_BYTES );
+
+	return out;
+}	//end function: array_print_formatter | void
+
+/****************************************************************************
+**	array_print | const T *, size_t, const Format_options &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Text of the array on stdout, after whatever cout and printf left in the C stdout buffer
+****************************************************************************/
+
+template <typename T>
+inline void array_print( const T *data, size_t size, const Format_options &options = Format_options() )
+{
+	ArrayFormatter &out = array_print_formatter();
+
+	fflush( stdout );
+	out.write( data, size, options );
+	out.flush();
+
+	return;
+}	//end function: array_print | const T *, size_t, const Format_options &
+
+template <typename T>
+inline void array_print( View2d<T> view, const Format_options &options = Format_options() )
+{
+	ArrayFormatter &out = array_print_formatter();
+
+	fflush( stdout );
+	out.write( view, options );
+	out.flush();
+
+	return;
+}	//end function: array_print | View2d<T>, const Format_options &
+
+#endif	//ARRAY_FORMAT_H_
@@ -0,0 +1,512 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Array View
+*****************************************************************
+**	Non owning views of arrays
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	Passing a std::array by value copies every element on each call
+**	A Span is a pointer and a number of elements. It does not own the elements.
+**		Span<T>			size known at runtime. Pointer and size
+**		Span<T,N>		size known at compile time. Just the pointer
+**	The same Span works over every 1D storage of example.cpp
+**		int array[N], std::array<int,N>		Span<int,N>( array ) or Span<int>( array )
+**		new int[N], malloc( N*sizeof(int) )	Span<int>( pointer, N )
+**	Span<T,N> converts to Span<T>, Span<T> converts to Span<const T>
+**	Only adding const converts, like std::span. A Span<Base> over Derived elements would step by sizeof(Base)
+**
+**	Passing a 2D array to a function either hard codes the number of columns
+**	int array_arg[][5], or passes an untyped pointer and does the index math by hand t*rows+ti
+**	A view is a pointer, the extents and the strides. It does not own the elements.
+**	Copying a view copies five words, never the elements. Pass it by value.
+**
+**	The same View2d works over every 2D storage of example.cpp
+**		int array[R][C]								View2d<int>( array )
+**		std::array<std::array<int,C>,R>				View2d<int>( array )
+**		new int[R*C], malloc( R*C*sizeof(int) )		View2d<int>( pointer, R, C )
+**
+**	STRIDES
+**	Element r,c is at data[r*row_stride +c*col_stride], strides counted in elements
+**	A row-major contiguous R x C array has row_stride=C, col_stride=1
+**	Slicing a view only changes pointer, extents and strides
+**		row( r )					StridedSpan of the C elements of row r, stride col_stride
+**		col( c )					StridedSpan of the R elements of column c, stride row_stride
+**		block( r, c, nr, nc )		View2d of a sub block, same strides
+**		transpose()					View2d with extents and strides swapped
+**
+**	Like std::array::operator[], access is not bound checked
+****************************************************************/
+
+#ifndef ARRAY_VIEW_H_
+#define ARRAY_VIEW_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t, ptrdiff_t
+//Standard C++ libraries
+#include <array>		//for std::array
+#include <type_traits>	//for std::enable_if, std::is_convertible
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Extent of a Span whose size is known only at runtime
+const size_t dynamic_extent = (size_t)-1;
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	Span
+*****************************************************************************
+**	DESCRIPTION:
+**	Extent elements, adjacent. Extent is known at compile time, only the pointer is stored
+****************************************************************************/
+
+template <typename T, size_t Extent = dynamic_extent>
+class Span
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Caller guarantees Extent elements start at data_arg
+		explicit Span( T *data_arg ) : g_data( data_arg )
+		{
+		}
+
+		//C style stack array
+		Span( T (&array_arg)[Extent] ) : g_data( array_arg )
+		{
+		}
+
+		//std::array
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		Span( std::array<U, Extent> &array_arg ) : g_data( array_arg.data() )
+		{
+		}
+
+		template <typename U, typename = typename std::enable_if<std::is_convertible<const U (*)[], T (*)[]>::value>::type>
+		Span( const std::array<U, Extent> &array_arg ) : g_data( array_arg.data() )
+		{
+		}
+
+		//A span of non const elements converts to a span of const elements
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		Span( const Span<U, Extent> &span_arg ) : g_data( span_arg.data() )
+		{
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void ) const
+		{
+			return g_data;
+		}
+
+		static constexpr size_t size( void )
+		{
+			return Extent;
+		}
+
+		static constexpr bool empty( void )
+		{
+			return (Extent == 0);
+		}
+
+		T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		T *end( void ) const
+		{
+			return g_data +Extent;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//First element
+		T *g_data;
+};	//end class: Span
+
+/****************************************************************************
+**	Span | dynamic_extent
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements, adjacent. size is known at runtime
+****************************************************************************/
+
+template <typename T>
+class Span<T, dynamic_extent>
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Empty span
+		Span( void ) : g_data( NULL ), g_size( 0 )
+		{
+		}
+
+		//Pointer and size. new int[N], malloc
+		Span( T *data_arg, size_t size_arg ) : g_data( data_arg ), g_size( size_arg )
+		{
+		}
+
+		//C style stack array
+		template <size_t N>
+		Span( T (&array_arg)[N] ) : g_data( array_arg ), g_size( N )
+		{
+		}
+
+		//std::array
+		template <typename U, size_t N, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		Span( std::array<U, N> &array_arg ) : g_data( array_arg.data() ), g_size( N )
+		{
+		}
+
+		template <typename U, size_t N, typename = typename std::enable_if<std::is_convertible<const U (*)[], T (*)[]>::value>::type>
+		Span( const std::array<U, N> &array_arg ) : g_data( array_arg.data() ), g_size( N )
+		{
+		}
+
+		//Any span, fixed or dynamic, of the same elements or their const
+		template <typename U, size_t N, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		Span( const Span<U, N> &span_arg ) : g_data( span_arg.data() ), g_size( span_arg.size() )
+		{
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		T *end( void ) const
+		{
+			return g_data +g_size;
+		}
+
+		///--------------------------------------------------------------------------
+		///	SLICING
+		///--------------------------------------------------------------------------
+
+		//First num elements
+		Span first( size_t num ) const
+		{
+			return Span( g_data, num );
+		}
+
+		//Last num elements
+		Span last( size_t num ) const
+		{
+			return Span( g_data +(g_size -num), num );
+		}
+
+		//num elements starting from offset
+		Span subspan( size_t offset, size_t num ) const
+		{
+			return Span( g_data +offset, num );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//First element
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+};	//end class: Span | dynamic_extent
+
+/****************************************************************************
+**	StridedSpan
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements, stride elements apart. A row or a column of a View2d
+****************************************************************************/
+
+template <typename T>
+class StridedSpan
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Empty span
+		StridedSpan( void ) : g_data( NULL ), g_size( 0 ), g_stride( 1 )
+		{
+		}
+
+		StridedSpan( T *data_arg, size_t size_arg, ptrdiff_t stride_arg ) : g_data( data_arg ), g_size( size_arg ), g_stride( stride_arg )
+		{
+		}
+
+		//A span of non const elements converts to a span of const elements
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		StridedSpan( const StridedSpan<U> &span_arg ) : g_data( span_arg.data() ), g_size( span_arg.size() ), g_stride( span_arg.stride() )
+		{
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		ptrdiff_t stride( void ) const
+		{
+			return g_stride;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		//Elements are adjacent. data() can be walked as a plain pointer
+		bool is_contiguous( void ) const
+		{
+			return (g_stride == 1);
+		}
+
+		T &operator[]( size_t index ) const
+		{
+			return g_data[ (ptrdiff_t)index *g_stride ];
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//First element
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+		//Distance between elements, in elements
+		ptrdiff_t g_stride;
+};	//end class: StridedSpan
+
+/****************************************************************************
+**	View2d
+*****************************************************************************
+**	DESCRIPTION:
+**	rows x cols elements, element r,c at data[r*row_stride +c*col_stride]
+****************************************************************************/
+
+template <typename T>
+class View2d
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Empty view
+		View2d( void ) : g_data( NULL ), g_rows( 0 ), g_cols( 0 ), g_row_stride( 0 ), g_col_stride( 1 )
+		{
+		}
+
+		//Contiguous row-major block. new int[R*C], malloc, std::vector
+		View2d( T *data_arg, size_t rows_arg, size_t cols_arg ) : g_data( data_arg ), g_rows( rows_arg ), g_cols( cols_arg ), g_row_stride( (ptrdiff_t)cols_arg ), g_col_stride( 1 )
+		{
+		}
+
+		//Explicit strides
+		View2d( T *data_arg, size_t rows_arg, size_t cols_arg, ptrdiff_t row_stride_arg, ptrdiff_t col_stride_arg ) : g_data( data_arg ), g_rows( rows_arg ), g_cols( cols_arg ), g_row_stride( row_stride_arg ), g_col_stride( col_stride_arg )
+		{
+		}
+
+		//C style stack array. Extents come from the type
+		template <size_t R, size_t C>
+		View2d( T (&array_arg)[R][C] ) : g_data( &array_arg[0][0] ), g_rows( R ), g_cols( C ), g_row_stride( (ptrdiff_t)C ), g_col_stride( 1 )
+		{
+		}
+
+		//Nested std::array. Rows are std::array<T,C> laid out one after the other
+		template <typename U, size_t R, size_t C, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		View2d( std::array<std::array<U, C>, R> &array_arg ) : g_data( array_arg[0].data() ), g_rows( R ), g_cols( C ), g_row_stride( (ptrdiff_t)C ), g_col_stride( 1 )
+		{
+			static_assert( sizeof( std::array<U, C> ) == C *sizeof( U ), "std::array rows are padded, nested std::array is not contiguous" );
+		}
+
+		template <typename U, size_t R, size_t C, typename = typename std::enable_if<std::is_convertible<const U (*)[], T (*)[]>::value>::type>
+		View2d( const std::array<std::array<U, C>, R> &array_arg ) : g_data( array_arg[0].data() ), g_rows( R ), g_cols( C ), g_row_stride( (ptrdiff_t)C ), g_col_stride( 1 )
+		{
+			static_assert( sizeof( std::array<U, C> ) == C *sizeof( U ), "std::array rows are padded, nested std::array is not contiguous" );
+		}
+
+		//A view of non const elements converts to a view of const elements
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+		View2d( const View2d<U> &view_arg ) : g_data( view_arg.data() ), g_rows( view_arg.rows() ), g_cols( view_arg.cols() ), g_row_stride( view_arg.row_stride() ), g_col_stride( view_arg.col_stride() )
+		{
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t rows( void ) const
+		{
+			return g_rows;
+		}
+
+		size_t cols( void ) const
+		{
+			return g_cols;
+		}
+
+		size_t size( void ) const
+		{
+			return g_rows *g_cols;
+		}
+
+		ptrdiff_t row_stride( void ) const
+		{
+			return g_row_stride;
+		}
+
+		ptrdiff_t col_stride( void ) const
+		{
+			return g_col_stride;
+		}
+
+		bool empty( void ) const
+		{
+			return ((g_rows == 0) || (g_cols == 0));
+		}
+
+		//Elements of a row are adjacent. row_data() can be walked as a plain pointer
+		bool is_row_contiguous( void ) const
+		{
+			return (g_col_stride == 1);
+		}
+
+		//All elements are adjacent, row after row. data() can be walked as a plain pointer of size() elements
+		bool is_contiguous( void ) const
+		{
+			return ((g_col_stride == 1) && ((g_rows <= 1) || (g_row_stride == (ptrdiff_t)g_cols)));
+		}
+
+		T &operator()( size_t row_arg, size_t col_arg ) const
+		{
+			return g_data[ (ptrdiff_t)row_arg *g_row_stride +(ptrdiff_t)col_arg *g_col_stride ];
+		}
+
+		//First element of a row
+		T *row_data( size_t row_arg ) const
+		{
+			return g_data +(ptrdiff_t)row_arg *g_row_stride;
+		}
+
+		///--------------------------------------------------------------------------
+		///	SLICING
+		///--------------------------------------------------------------------------
+
+		StridedSpan<T> row( size_t row_arg ) const
+		{
+			return StridedSpan<T>( row_data( row_arg ), g_cols, g_col_stride );
+		}
+
+		StridedSpan<T> col( size_t col_arg ) const
+		{
+			return StridedSpan<T>( g_data +(ptrdiff_t)col_arg *g_col_stride, g_rows, g_row_stride );
+		}
+
+		//num_rows x num_cols block whose first element is row_arg, col_arg
+		View2d block( size_t row_arg, size_t col_arg, size_t num_rows, size_t num_cols ) const
+		{
+			return View2d( &(*this)( row_arg, col_arg ), num_rows, num_cols, g_row_stride, g_col_stride );
+		}
+
+		//Rows become columns. No element is moved
+		View2d transpose( void ) const
+		{
+			return View2d( g_data, g_cols, g_rows, g_col_stride, g_row_stride );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Element 0,0
+		T *g_data;
+		//Extents
+		size_t g_rows;
+		size_t g_cols;
+		//Distance between rows and between columns, in elements
+		ptrdiff_t g_row_stride;
+		ptrdiff_t g_col_stride;
+};	//end class: View2d
+
+#endif	//ARRAY_VIEW_H_
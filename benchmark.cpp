@@ -0,0 +1,6840 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Test Arrays - Benchmark
+*****************************************************************
+**	Measure the ways one can make an array in C++
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	example.cpp shows how to make and pass arrays.
+**	This program measures how fast each way actually is.
+**
+**	BUILD
+**		g++ -std=c++11 -O2 -pthread benchmark.cpp -o benchmark
+**		g++ -std=c++11 -O2 -pthread -DALLOC_TRACE benchmark.cpp alloc_trace.cpp -o benchmark_trace
+**	The second one counts every allocation (alloc_trace.h) and prints the count at exit
+**
+**	USAGE
+**		./benchmark [--perf] <suite> [suite arguments]
+**		./benchmark with no arguments lists the suites
+**		--perf adds hardware counters per element to the suites that support them (perf_counters.h)
+**
+**	REPORT
+**	Each measurement is repeated several times. A sample is the time of one repetition
+**	divided by the number of elements it touched.
+**	p10, median and p90 of the samples are reported in ns/element
+**	GB/s is computed from the median. 1 GB/s = 1 byte/ns
+**	With --perf, the layout2d and view2d suites add events per element, summed over all samples:
+**	cycles, instructions, instructions per cycle, L1D, LLC and dTLB misses, branch misses, page faults.
+**	"-" is an event the machine does not count
+**
+****************************************************************/
+
+/****************************************************************
+**	HISTORY VERSION
+****************************************************************
+**
+****************************************************************/
+
+/****************************************************************
+**	KNOWN BUGS
+****************************************************************
+**
+****************************************************************/
+
+/****************************************************************
+**	TODO
+****************************************************************
+**
+****************************************************************/
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstdlib>		//for malloc, free, strtod
+#include <cstdint>		//for uint32_t, uint64_t
+#include <cstring>		//for strcmp, strerror
+#include <cstdio>		//for snprintf
+//Standard C++ libraries
+#include <iostream>		//for cout, endl
+#include <iomanip>		//for setw, setprecision
+#include <array>		//for std::array
+#include <vector>		//for std::vector
+#include <algorithm>	//for std::sort
+#include <chrono>		//for std::chrono::steady_clock
+#include <atomic>		//for std::atomic_signal_fence
+#include <thread>		//for std::thread
+#include <limits>		//for std::numeric_limits
+#include <mutex>		//for std::mutex, std::lock_guard
+#include <fstream>		//for std::ofstream
+#include <string>		//for std::string
+//Linux
+#include <unistd.h>		//for fork, pipe, read, unlink
+#include <fcntl.h>		//for open
+#include <sys/wait.h>	//for wait4
+#include <sys/resource.h>	//for struct rusage
+#include <sched.h>		//for sched_getaffinity, cpu_set_t
+#include <pthread.h>	//for pthread_setaffinity_np, pthread_getaffinity_np
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>	//for AVX2 intrinsics
+#endif
+//User libraries
+#include "heap_2d.h"	//for heap_2d_rows_alloc, heap_2d_block_alloc, heap_2d_table_alloc
+#include "array_view.h"	//for Span, View2d
+#include "arena.h"		//for Arena, ArenaScope, ArenaAllocator
+#include "pool.h"		//for pool_alloc, pool_free
+#include "aligned_array.h"	//for AlignedArray
+#include "simd.h"		//for simd_sum, simd_min_max, simd_dot, simd_scale_add, simd_count_greater
+#include "transpose.h"	//for transpose, transpose_in_place
+#include "gemm.h"		//for gemm
+#include "parallel.h"	//for ThreadPool, parallel_for, parallel_reduce, parallel_transform
+#include "work_stealing.h"	//for parallel_for_rows
+#include "mapped_array.h"	//for MappedArray
+#include "array_file.h"	//for ArrayFileWriter, ArrayFileReader
+#include "small_vector.h"	//for SmallVector
+#include "radix_sort.h"	//for radix_sort, radix_sort_pairs, radix_sort_parallel
+#include "ring_buffer.h"	//for SpscRing, MpmcRing
+#include "soa.h"		//for SoA
+#include "sparse.h"		//for SparseMatrix, sparse_spmv
+#include "array_format.h"	//for ArrayFormatter
+#include "alloc_trace.h"	//for alloc_trace_enabled, AllocTraceScope
+#include "perf_counters.h"	//for PerfCounters, Perf_values
+#include "realloc_vector.h"	//for ReallocVector
+#include "array_copy.h"	//for array_copy_bytes, array_fill_bytes, copy_thresholds
+
+/****************************************************************
+**	NAMESPACES
+****************************************************************/
+
+using std::cout;	//print to console
+using std::cerr;	//print to console
+using std::endl;	//new line
+using std::array;	//stack based array with size and type known at compile time
+using std::vector;	//heap based array with size known at runtime
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Stack and std::array strategies run a batch of arrays so that small sizes are not dominated by the timer overhead
+//The batch is sized to stay around this many bytes
+#define BENCH_BATCH_BYTES		(256 *1024)
+//Default largest array of the storage suite
+#define BENCH_STORAGE_MAX_BYTES	((size_t)1 << 30)
+//Bytes touched by all samples of a measurement. Controls the number of repetitions
+#define BENCH_TARGET_BYTES		((size_t)64 << 20)
+//Arrays made and dropped in a frame of the arena suite
+#define BENCH_ARENA_FRAME_ARRAYS	64
+//Live arrays held by each thread of the pool suite
+#define BENCH_POOL_SLOTS			4096
+//Ints written by each thread in the false sharing measurement of the aligned suite. Half a cache line
+#define BENCH_ALIGNED_CHUNK		8
+//Floating point operations of all samples of a gemm measurement. Controls the number of repetitions
+#define BENCH_GEMM_TARGET_FLOPS	(4e9)
+//Largest side measured with the naive triple loop, beyond that it takes minutes
+#define BENCH_GEMM_NAIVE_MAX		1024
+//Default largest array of the parallel suite
+#define BENCH_PARALLEL_MAX_BYTES	((size_t)256 << 20)
+//Rows of the skewed array of the steal suite cost up to this many times the cheapest one
+#define BENCH_STEAL_SKEW			64
+//Default size of the file of the mmap suite
+#define BENCH_MMAP_BYTES			((size_t)256 << 20)
+//Elements handed to the writer per call in the arrayfile suite, as a producer would
+#define BENCH_ARRAYFILE_PIECE		(64 *1024)
+//Inline capacity of the SmallVector of the smallvec suite
+#define BENCH_SMALLVEC_N			16
+//Vectors made and dropped per sample of the smallvec suite
+#define BENCH_SMALLVEC_CYCLES		4096
+//Largest array of the radix suite. 4G sorts 1G ints and needs 8 GB for the buffers
+#define BENCH_RADIX_MAX_BYTES		((size_t)64 << 20)
+//Slots of the queues of the ring suite, and elements per push_n and pop_n of the batch strategies
+#define BENCH_RING_CAPACITY		1024
+#define BENCH_RING_BATCH			32
+//Elements through the queue per sample, and round trips per sample of the latency test
+#define BENCH_RING_ITEMS			((size_t)1 << 20)
+#define BENCH_RING_TRIPS			((size_t)1 << 14)
+//Largest array of records of the soa suite, in bytes of the AoS layout
+#define BENCH_SOA_MAX_BYTES		((size_t)64 << 20)
+//Default side of the square matrices of the sparse suite. 4096 is 64 MB of dense float
+#define BENCH_SPARSE_SIDE		4096
+//Default largest array of the format suite, and columns of its 2D layout
+#define BENCH_FORMAT_MAX_ELEMENTS	((size_t)1 << 23)
+#define BENCH_FORMAT_COLS		64
+//Largest block of the alloc suite, and blocks allocated before they are freed
+#define BENCH_ALLOC_MAX_BYTES	(64 *1024)
+#define BENCH_ALLOC_BATCH		64
+//Allocations per sample
+#define BENCH_ALLOC_OPS			((size_t)1 << 18)
+//Default largest array of the growth suite. std::vector needs 1.5 times it at once, ReallocVector 1 time
+#define BENCH_GROWTH_MAX_BYTES	((size_t)1 << 30)
+//Elements per append, and per resize, of the growth suite
+#define BENCH_GROWTH_BLOCK		4096
+//Default largest copy of the copy suite. Source and destination: twice this in memory
+#define BENCH_COPY_MAX_BYTES		((size_t)1 << 30)
+//Smallest size of the parallel rows of the copy suite. Below it waking the pool costs more than the copy
+#define BENCH_COPY_PARALLEL_MIN	((size_t)1 << 20)
+//Limits on the number of samples of a measurement
+#define BENCH_MIN_SAMPLES		5
+#define BENCH_MAX_SAMPLES		51
+
+/****************************************************************
+**	MACROS
+****************************************************************/
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Percentiles of a set of samples
+struct Bench_stats
+{
+	double p10;
+	double median;
+	double p90;
+};
+
+//Hardware events of a measurement, summed over its samples
+struct Bench_counters
+{
+	Perf_values sum;
+	double elements;
+};
+
+//A suite is a group of measurements that can be run from command line
+struct Bench_suite
+{
+	const char *name;
+	const char *description;
+	int (*run)( int argc, char *argv[] );
+};
+
+//Record of the soa suite. 32 bytes: a cache line holds two
+struct Soa_particle
+{
+	float x, y, z;
+	float vx, vy, vz;
+	int id;
+	int flags;
+};
+
+//Baseline of the ring suite: the same ring, every operation under a std::mutex
+template <typename T, size_t N>
+class RingMutexQueue
+{
+	public:
+		RingMutexQueue( void ) : g_head( 0 ), g_tail( 0 )
+		{
+		}
+
+		bool push( const T &value )
+		{
+			return (push_n( &value, 1 ) == 1);
+		}
+
+		bool pop( T &value )
+		{
+			return (pop_n( &value, 1 ) == 1);
+		}
+
+		size_t push_n( const T *src, size_t num )
+		{
+			//fast counter
+			size_t t;
+			std::lock_guard<std::mutex> lock( g_mutex );
+
+			num = std::min( num, N -(g_tail -g_head) );
+			for (t = 0;t < num;t++)
+			{
+				g_data[(g_tail +t) %N] = src[t];
+			}
+			g_tail += num;
+
+			return num;
+		}
+
+		size_t pop_n( T *dst, size_t num )
+		{
+			//fast counter
+			size_t t;
+			std::lock_guard<std::mutex> lock( g_mutex );
+
+			num = std::min( num, g_tail -g_head );
+			for (t = 0;t < num;t++)
+			{
+				dst[t] = g_data[(g_head +t) %N];
+			}
+			g_head += num;
+
+			return num;
+		}
+
+	private:
+		std::mutex g_mutex;
+		size_t g_head;
+		size_t g_tail;
+		std::array<T, N> g_data;
+};	//end class: RingMutexQueue
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+///Harness
+//Monotonic time in nanoseconds
+static inline uint64_t bench_now_ns( void );
+//Prevent the compiler from discarding a value or a memory region
+template <typename T>
+static inline void bench_keep( T const &value );
+static inline void bench_clobber( void );
+//Compute percentiles of the samples. Samples are sorted in place
+extern Bench_stats bench_stats( vector<double> &samples );
+//Number of samples given the bytes touched by a single sample
+extern int bench_num_samples( size_t bytes_per_sample );
+//Parse a size with optional K, M, G suffix. Return 0 on failure
+extern size_t bench_parse_size( const char *str );
+//Count hardware events of a sample when run with --perf. Start before t0, stop after t1
+extern void bench_perf_open( PerfCounters &counters );
+static inline void bench_perf_start( void );
+static inline void bench_perf_stop( Bench_counters &counters, double num_elem );
+//Print the header and a row of the report table. counters adds the events per element
+extern void bench_report_header( bool counters = false );
+extern void bench_report_row( const char *strategy, size_t elements, const char *phase, Bench_stats ns_per_elem, double bytes_per_elem, const Bench_counters *counters = NULL );
+static void bench_report_count( double value );
+
+///STORAGE SUITE: C stack, std::array, malloc, new[], std::vector
+extern int bench_storage( int argc, char *argv[] );
+//Kernels shared by all strategies
+static inline void storage_init( int *array_arg, size_t size );
+static inline int storage_read_sequential( const int *array_arg, size_t size );
+static inline int storage_read_random( const int *array_arg, size_t size );
+//One strategy, one size
+template <int N>
+extern void bench_storage_c_stack( void );
+template <int N>
+extern void bench_storage_std_array( void );
+extern void bench_storage_malloc( size_t size );
+extern void bench_storage_new( size_t size );
+extern void bench_storage_vector( size_t size );
+
+///LAYOUT2D SUITE: rows, block and table layouts of heap 2D arrays
+extern int bench_layout2d( int argc, char *argv[] );
+template <typename H>
+static void bench_layout2d_run( const char *layout, size_t rows, size_t cols, H (*alloc_fn)( size_t, size_t ), void (*free_fn)( H, size_t ) );
+
+///VIEW2D SUITE: cost of passing a View2d instead of pointer and dimensions
+extern int bench_view2d( int argc, char *argv[] );
+
+///PASS1D SUITE: cost of a call taking std::array by value vs a Span
+extern int bench_pass1d( int argc, char *argv[] );
+template <size_t S>
+extern void bench_pass1d_run( void );
+
+///ARENA SUITE: allocate-fill-free cycles, arena vs malloc and new
+extern int bench_arena( int argc, char *argv[] );
+extern void bench_arena_run( size_t size );
+
+///POOL SUITE: multi threaded churn of small arrays, pool vs malloc
+extern int bench_pool( int argc, char *argv[] );
+template <typename Alloc, typename Free>
+static void pool_churn( unsigned int seed, size_t num_ops, Alloc alloc_fn, Free free_fn );
+template <typename Alloc, typename Free>
+static double bench_pool_run( unsigned int num_threads, size_t num_ops, Alloc alloc_fn, Free free_fn );
+
+///ALIGNED SUITE: streaming kernels on cache line aligned vs misaligned buffers, false sharing
+extern int bench_aligned( int argc, char *argv[] );
+extern void bench_aligned_run( size_t size );
+extern void bench_aligned_false_sharing( void );
+
+///SIMD SUITE: vectorized kernels of simd.h on each instruction set vs the scalar reference
+extern int bench_simd( int argc, char *argv[] );
+template <typename T>
+static bool simd_check( const char *type_name );
+template <typename T>
+extern void bench_simd_run( const char *type_name, size_t size );
+
+///TRANSPOSE SUITE: naive double loop vs cache blocked transpose, out of place and in place
+extern int bench_transpose( int argc, char *argv[] );
+template <typename T>
+extern void bench_transpose_run( const char *type_name, size_t rows, size_t cols );
+
+///GEMM SUITE: naive triple loop vs tiled multithreaded matrix multiply
+extern int bench_gemm( int argc, char *argv[] );
+template <typename T>
+static bool gemm_check( const char *type_name, size_t m, size_t n, size_t k, unsigned int num_threads );
+template <typename T>
+extern void bench_gemm_run( const char *type_name, size_t side, unsigned int num_threads );
+
+///PARALLEL SUITE: single thread loops vs parallel_for, parallel_reduce, parallel_transform of parallel.h
+extern int bench_parallel( int argc, char *argv[] );
+extern void bench_parallel_run( ThreadPool &pool, size_t size );
+
+///STEAL SUITE: static partition vs dynamic chunks vs work stealing on rows of uneven cost
+extern int bench_steal( int argc, char *argv[] );
+static inline void steal_row_kernel( size_t row, float *row_data, size_t cols, size_t num_rows );
+
+///MMAP SUITE: read() into a heap array vs mapping the file
+extern int bench_mmap( int argc, char *argv[] );
+
+///ARRAYFILE SUITE: streaming array file writer and reader vs fwrite and fread of the whole array
+extern int bench_arrayfile( int argc, char *argv[] );
+
+///SMALLVEC SUITE: push/copy/destroy churn of small arrays, SmallVector vs std::vector
+extern int bench_smallvec( int argc, char *argv[] );
+template <typename V>
+static void bench_smallvec_run( const char *strategy, size_t size );
+
+///RADIX SUITE: std::sort vs LSD radix sort vs parallel radix sort on uniform, skewed, nearly sorted keys
+extern int bench_radix( int argc, char *argv[] );
+static void radix_fill( int *array_arg, size_t size, const char *distribution );
+extern void bench_radix_run( ThreadPool &pool, size_t size, const char *distribution );
+
+///RING SUITE: SPSC and MPMC ring buffers vs a mutex guarded ring, on pinned threads
+extern int bench_ring( int argc, char *argv[] );
+static void ring_pin( unsigned int index );
+template <typename Q>
+static double ring_throughput( Q &queue, size_t num_items, size_t batch, unsigned int num_producers, unsigned int num_consumers );
+template <typename Q>
+static double ring_round_trip( Q &ping, Q &pong, size_t num_trips );
+template <typename Q>
+static void bench_ring_run( const char *strategy, size_t num_items, size_t batch, unsigned int num_producers, unsigned int num_consumers );
+template <typename Q>
+static void bench_ring_latency( const char *strategy );
+
+///SOA SUITE: one field scans and updates on an array of structures vs a SoA
+extern int bench_soa( int argc, char *argv[] );
+extern void bench_soa_run( size_t size );
+
+///SPARSE SUITE: footprint and SpMV GFLOP/s of dense, CSR and CSC across densities
+extern int bench_sparse( int argc, char *argv[] );
+extern void bench_sparse_run( ThreadPool &pool, size_t side, double density );
+
+///FORMAT SUITE: text dump of 1D and 2D arrays, ofstream per element vs ArrayFormatter, serial and parallel
+extern int bench_format( int argc, char *argv[] );
+static std::string format_read_file( const std::string &path );
+template <typename T>
+extern void bench_format_run( ThreadPool &pool, const char *type_name, const std::string &path, size_t size, size_t cols );
+
+///ALLOC SUITE: malloc, operator new and new[] round trips by size, with or without alloc_trace.cpp
+extern int bench_alloc( int argc, char *argv[] );
+template <typename Alloc, typename Free>
+static double alloc_cycle( size_t size, Alloc alloc_fn, Free free_fn );
+extern void bench_alloc_run( size_t size );
+
+///GROWTH SUITE: std::vector vs ReallocVector grown from empty by push_back, append and resize, up to tens of GB
+extern int bench_growth( int argc, char *argv[] );
+static void growth_append( vector<int> &vector_arg, const int *src, size_t num );
+static void growth_append( ReallocVector<int> &vector_arg, const int *src, size_t num );
+static void growth_extend( vector<int> &vector_arg, size_t num );
+static void growth_extend( ReallocVector<int> &vector_arg, size_t num );
+template <typename V>
+static bool bench_growth_run( const char *strategy, size_t size );
+
+///COPY SUITE: memcpy, memmove, std::copy, memset vs each strategy of array_copy by size, and the sizes where each starts to win
+extern int bench_copy( int argc, char *argv[] );
+static void copy_call( bool fill, int row, unsigned char *dst, const unsigned char *src, size_t bytes );
+extern void bench_copy_run( bool fill, size_t bytes, unsigned char *dst, const unsigned char *src, vector< vector<double> > &medians );
+static size_t copy_crossover( const vector<size_t> &sizes, const vector<double> &candidate, const vector<double> &reference );
+
+/****************************************************************
+**	GLOBAL VARIABILE
+****************************************************************/
+
+//Hardware counters of the main thread. NULL without --perf, or when none is available
+static PerfCounters *g_bench_perf = NULL;
+
+//List of suites that can be run from command line
+static const Bench_suite g_bench_suites[] =
+{
+	{ "storage", "alloc/init/read/free of C stack, std::array, malloc, new[], std::vector. Args: [max_bytes]", bench_storage },
+	{ "layout2d", "row-major and column-major traversal of rows, block, table heap 2D layouts. Args: [rows cols]", bench_layout2d },
+	{ "view2d", "sum through raw pointer and index math vs sum through View2d. Args: [rows cols]", bench_view2d },
+	{ "pass1d", "cost of a call taking std::array<int,S> by value vs Span<const int,S> vs Span<const int>", bench_pass1d },
+	{ "arena", "frames of allocate-fill-free cycles with malloc, new[], std::vector and an Arena", bench_arena },
+	{ "pool", "multi threaded alloc/free churn of small arrays, pool vs malloc. Args: [threads] [ops_per_thread]", bench_pool },
+	{ "aligned", "sum/copy/triad on cache line aligned vs misaligned buffers, packed vs padded per thread chunks. Args: [max_bytes]", bench_aligned },
+	{ "simd", "sum/minmax/dot/axpy/count of int, float, double on scalar, SSE4, AVX2, AVX-512. Args: [max_bytes]", bench_simd },
+	{ "transpose", "naive double loop vs cache blocked SIMD transpose, out of place and in place, int and double. Args: [max_side]", bench_transpose },
+	{ "gemm", "naive triple loop vs tiled SIMD multithreaded GEMM, int, float, double, GFLOP/s. Args: [max_side] [threads]", bench_gemm },
+	{ "parallel", "single thread vs thread pool for, reduce, deterministic reduce, transform of int arrays. Args: [max_bytes] [threads]", bench_parallel },
+	{ "steal", "rows of skewed cost on static partition, dynamic chunks and work stealing. Args: [rows cols] [threads]", bench_steal },
+	{ "mmap", "load a file with read() into an aligned array vs MappedArray, then sum it. Args: [bytes] [path]", bench_mmap },
+	{ "arrayfile", "write and read+sum of an int array, ArrayFileWriter/Reader in chunks vs fwrite/fread. Args: [bytes] [path]", bench_arrayfile },
+	{ "smallvec", "push/copy/destroy churn of small int arrays, SmallVector<int,16> vs std::vector, with and without reserve", bench_smallvec },
+	{ "radix", "std::sort vs radix sort, serial, parallel and key-value, of uniform, skewed, nearly sorted ints. Args: [max_bytes] [threads]", bench_radix },
+	{ "ring", "throughput and round trip latency of SpscRing, MpmcRing and a mutex ring, single and batch, pinned threads. Args: [items]", bench_ring },
+	{ "soa", "sum of one field and update of one field of 32 byte records, AoS vs SoA, AoS<->SoA conversion. Args: [max_bytes]", bench_soa },
+	{ "sparse", "memory footprint and y = A*x GFLOP/s of dense SIMD, CSR scalar, CSR and CSC SIMD multithreaded, float, 0.1% to 50% density. Args: [side] [threads]", bench_sparse },
+	{ "format", "text dump of int and double arrays, 1D and 2D, ofstream << per element vs ArrayFormatter, one and many threads. Args: [max_elements] [path] [threads]", bench_format },
+	{ "alloc", "ns per malloc/free, operator new/delete and new[]/delete[] from 16B to 64KB. Build with alloc_trace.cpp to measure the cost of the trace. Args: [max_bytes]", bench_alloc },
+	{ "growth", "int array grown from empty by push_back, append of blocks and resize, std::vector vs ReallocVector (realloc, then mremap). Args: [max_bytes]", bench_growth },
+	{ "copy", "GB/s of memcpy, memmove, std::copy, memset vs inline, rep movsb, non-temporal and multithreaded copy and fill by size, with the crossover sizes. Args: [max_bytes]", bench_copy },
+};
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************
+**	MAIN
+****************************************************************
+**	INPUT:
+**	OUTPUT:
+**	RETURN:
+**	DESCRIPTION:
+**	run the suite named by the first argument
+****************************************************************/
+
+int main( int argc, char *argv[] )
+{
+	///----------------------------------------------------------------
+	///	STATIC VARIABILE
+	///----------------------------------------------------------------
+
+	///----------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///----------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	//number of registered suites
+	size_t num_suites = sizeof( g_bench_suites ) /sizeof( Bench_suite );
+
+	///----------------------------------------------------------------
+	///	CHECK AND INITIALIZATIONS
+	///----------------------------------------------------------------
+
+	cout << "OrangeBot Projects\n" << endl;
+
+	//Options before the suite
+	if ((argc >= 2) && (strcmp( argv[1], "--perf" ) == 0))
+	{
+		//Opened only with --perf, closed at exit
+		static PerfCounters perf_counters;
+		bench_perf_open( perf_counters );
+		argc--;
+		argv++;
+	}
+
+	if (argc < 2)
+	{
+		cout << "USAGE: " << argv[0] << " [--perf] <suite> [suite arguments]" << endl;
+		cout << "SUITES" << endl;
+		for (t = 0;t < num_suites;t++)
+		{
+			cout << g_bench_suites[t].name << " | " << g_bench_suites[t].description << endl;
+		}
+		return 0;
+	}
+
+	///----------------------------------------------------------------
+	///	BODY
+	///----------------------------------------------------------------
+
+	for (t = 0;t < num_suites;t++)
+	{
+		if (strcmp( argv[1], g_bench_suites[t].name ) == 0)
+		{
+			cout << "------------------------" << endl;
+			cout << "SUITE: " << g_bench_suites[t].name << endl;
+			//Suite receives its own arguments. argv[0] is the suite name
+			return g_bench_suites[t].run( argc -1, &argv[1] );
+		}
+	}
+
+	///----------------------------------------------------------------
+	///	FINALIZATIONS
+	///----------------------------------------------------------------
+
+	cerr << "unknown suite: " << argv[1] << endl;
+
+    return -1;
+}	//end function: main
+
+/****************************************************************************
+**	bench_now_ns | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	time in nanoseconds from an arbitrary origin
+**	DESCRIPTION:
+**	steady_clock is monotonic, unlike system_clock
+****************************************************************************/
+
+static inline uint64_t bench_now_ns( void )
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}	//end function: bench_now_ns | void
+
+/****************************************************************************
+**	bench_keep | T const &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	A benchmark whose result is not used is optimized away.
+**	Tell the compiler the value is read by something it can't see
+****************************************************************************/
+
+template <typename T>
+static inline void bench_keep( T const &value )
+{
+#if defined( __GNUC__ )
+	asm volatile( "" : : "r,m"(value) : "memory" );
+#else
+	static volatile T sink;
+	sink = value;
+#endif
+	return;
+}	//end function: bench_keep | T const &
+
+/****************************************************************************
+**	bench_clobber | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Tell the compiler all memory may have been read and written
+**	Writes before the clobber can't be discarded nor moved after it
+****************************************************************************/
+
+static inline void bench_clobber( void )
+{
+#if defined( __GNUC__ )
+	asm volatile( "" : : : "memory" );
+#else
+	std::atomic_signal_fence( std::memory_order_seq_cst );
+#endif
+	return;
+}	//end function: bench_clobber | void
+
+/****************************************************************************
+**	bench_stats | vector<double> &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Nearest rank percentiles. Samples are sorted in place
+****************************************************************************/
+
+Bench_stats bench_stats( vector<double> &samples )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	Bench_stats ret = { 0.0, 0.0, 0.0 };
+	size_t num;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (samples.empty() == true)
+	{
+		return ret;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num = samples.size();
+	std::sort( samples.begin(), samples.end() );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	ret.p10 = samples[ (num -1) *10 /100 ];
+	ret.median = samples[ (num -1) /2 ];
+	ret.p90 = samples[ (num -1) *90 /100 ];
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return ret;
+}	//end function: bench_stats | vector<double> &
+
+/****************************************************************************
+**	bench_num_samples | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Many samples for small arrays, few samples for arrays of gigabytes
+****************************************************************************/
+
+int bench_num_samples( size_t bytes_per_sample )
+{
+	size_t num;
+
+	if (bytes_per_sample == 0)
+	{
+		return BENCH_MAX_SAMPLES;
+	}
+
+	num = BENCH_TARGET_BYTES /bytes_per_sample;
+
+	if (num < BENCH_MIN_SAMPLES)
+	{
+		num = BENCH_MIN_SAMPLES;
+	}
+	else if (num > BENCH_MAX_SAMPLES)
+	{
+		num = BENCH_MAX_SAMPLES;
+	}
+
+	return (int)num;
+}	//end function: bench_num_samples | size_t
+
+/****************************************************************************
+**	bench_parse_size | const char *
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	size in bytes. 0 if the string is not a size
+**	DESCRIPTION:
+**	"4096", "64K", "16M", "1G"
+****************************************************************************/
+
+size_t bench_parse_size( const char *str )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	char *end;
+	double value;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (str == NULL)
+	{
+		return 0;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	value = strtod( str, &end );
+
+	switch (*end)
+	{
+		case 'k':
+		case 'K':
+			value *= 1024.0;
+			break;
+		case 'm':
+		case 'M':
+			value *= 1024.0 *1024.0;
+			break;
+		case 'g':
+		case 'G':
+			value *= 1024.0 *1024.0 *1024.0;
+			break;
+		case '\0':
+			break;
+		default:
+			return 0;
+	}
+
+	if (value < 0.0)
+	{
+		return 0;
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return (size_t)value;
+}	//end function: bench_parse_size | const char *
+
+/****************************************************************************
+**	bench_perf_open | PerfCounters &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Use counters for --perf, when at least one event is open. Print which ones are
+****************************************************************************/
+
+void bench_perf_open( PerfCounters &counters )
+{
+	//fast counter
+	int t;
+
+	if (counters.num_available() == 0)
+	{
+		cout << "Perf counters: none available (" << strerror( counters.error() ) << "). Check /proc/sys/kernel/perf_event_paranoid" << endl;
+		return;
+	}
+	g_bench_perf = &counters;
+	cout << "Perf counters:";
+	for (t = 0;t < PERF_NUM_EVENTS;t++)
+	{
+		if (counters.available( (Perf_event)t ) == true)
+		{
+			cout << " " << PerfCounters::name( (Perf_event)t );
+		}
+	}
+	if (counters.num_available() < PERF_NUM_EVENTS)
+	{
+		cout << " | not available:";
+		for (t = 0;t < PERF_NUM_EVENTS;t++)
+		{
+			if (counters.available( (Perf_event)t ) == false)
+			{
+				cout << " " << PerfCounters::name( (Perf_event)t );
+			}
+		}
+		cout << " (" << strerror( counters.error() ) << ")";
+	}
+	cout << endl;
+
+	return;
+}	//end function: bench_perf_open | PerfCounters &
+
+/****************************************************************************
+**	bench_perf_start | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Nothing without --perf
+****************************************************************************/
+
+static inline void bench_perf_start( void )
+{
+	if (g_bench_perf != NULL)
+	{
+		g_bench_perf->start();
+	}
+}	//end function: bench_perf_start | void
+
+/****************************************************************************
+**	bench_perf_stop | Bench_counters &, double
+*****************************************************************************
+**	PARAMETER:
+**	counters: sums of the measurement. Zero it before the first sample
+**	num_elem: elements touched by the sample
+**	RETURN:
+**	DESCRIPTION:
+**	Add the events since bench_perf_start to the sums
+****************************************************************************/
+
+static inline void bench_perf_stop( Bench_counters &counters, double num_elem )
+{
+	//fast counter
+	int t;
+	Perf_values values;
+
+	if (g_bench_perf != NULL)
+	{
+		g_bench_perf->stop( values );
+		for (t = 0;t < PERF_NUM_EVENTS;t++)
+		{
+			counters.sum.count[t] += values.count[t];
+		}
+		counters.elements += num_elem;
+	}
+}	//end function: bench_perf_stop | Bench_counters &, double
+
+/****************************************************************************
+**	bench_report_header | bool
+*****************************************************************************
+**	PARAMETER:
+**	counters: true for a suite that counts events. Columns only with --perf
+**	RETURN:
+**	DESCRIPTION:
+**	Column names of the report table
+****************************************************************************/
+
+void bench_report_header( bool counters )
+{
+	cout << std::left;
+	cout << std::setw(12) << "strategy" << " | ";
+	cout << std::setw(10) << "elements" << " | ";
+	cout << std::setw(12) << "phase" << " | ";
+	cout << std::setw(10) << "p10 ns/el" << " | ";
+	cout << std::setw(10) << "med ns/el" << " | ";
+	cout << std::setw(10) << "p90 ns/el" << " | ";
+	cout << std::setw(12) << "med ns/array" << " | ";
+	if ((counters == true) && (g_bench_perf != NULL))
+	{
+		cout << std::setw(8) << "med GB/s" << " | ";
+		cout << std::setw(8) << "cyc/el" << " | ";
+		cout << std::setw(8) << "ins/el" << " | ";
+		cout << std::setw(8) << "IPC" << " | ";
+		cout << std::setw(8) << "L1D/el" << " | ";
+		cout << std::setw(8) << "LLC/el" << " | ";
+		cout << std::setw(8) << "dTLB/el" << " | ";
+		cout << std::setw(8) << "brmis/el" << " | ";
+		cout << "pgflt/el" << endl;
+	}
+	else
+	{
+		cout << "med GB/s" << endl;
+	}
+	cout << std::right;
+
+	return;
+}	//end function: bench_report_header | bool
+
+/****************************************************************************
+**	bench_report_row | const char *, size_t, const char *, Bench_stats, double, const Bench_counters *
+*****************************************************************************
+**	PARAMETER:
+**	counters: NULL, or events of the samples. Printed only with --perf
+**	RETURN:
+**	DESCRIPTION:
+**	One row of the report table. GB/s is bytes per element over ns per element.
+**	Events per element are the sums over the samples divided by the elements of the samples
+****************************************************************************/
+
+void bench_report_row( const char *strategy, size_t elements, const char *phase, Bench_stats ns_per_elem, double bytes_per_elem, const Bench_counters *counters )
+{
+	//fast counter
+	int t;
+	double gbps;
+	double per_elem[PERF_NUM_EVENTS];
+
+	gbps = (ns_per_elem.median > 0.0) ?(bytes_per_elem /ns_per_elem.median) :(0.0);
+
+	cout << std::left;
+	cout << std::setw(12) << strategy << " | ";
+	cout << std::setw(10) << elements << " | ";
+	cout << std::setw(12) << phase << " | ";
+	cout << std::fixed << std::setprecision(4);
+	cout << std::setw(10) << ns_per_elem.p10 << " | ";
+	cout << std::setw(10) << ns_per_elem.median << " | ";
+	cout << std::setw(10) << ns_per_elem.p90 << " | ";
+	cout << std::setprecision(1);
+	cout << std::setw(12) << ns_per_elem.median *(double)elements << " | ";
+	cout << std::setprecision(3);
+	if ((counters != NULL) && (g_bench_perf != NULL) && (counters->elements > 0.0))
+	{
+		for (t = 0;t < PERF_NUM_EVENTS;t++)
+		{
+			per_elem[t] = counters->sum.count[t] /counters->elements;
+		}
+		cout << std::setw(8) << gbps;
+		bench_report_count( per_elem[PERF_CYCLES] );
+		bench_report_count( per_elem[PERF_INSTRUCTIONS] );
+		bench_report_count( per_elem[PERF_INSTRUCTIONS] /per_elem[PERF_CYCLES] );
+		bench_report_count( per_elem[PERF_L1D_MISSES] );
+		bench_report_count( per_elem[PERF_LLC_MISSES] );
+		bench_report_count( per_elem[PERF_DTLB_MISSES] );
+		bench_report_count( per_elem[PERF_BRANCH_MISSES] );
+		bench_report_count( per_elem[PERF_PAGE_FAULTS] );
+		cout << endl;
+	}
+	else
+	{
+		cout << gbps << endl;
+	}
+	cout << std::right;
+	cout.unsetf( std::ios::floatfield );
+
+	return;
+}	//end function: bench_report_row | const char *, size_t, const char *, Bench_stats, double, const Bench_counters *
+
+/****************************************************************************
+**	bench_report_count | double
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	One column of events. NaN, an event not counted, is "-"
+****************************************************************************/
+
+static void bench_report_count( double value )
+{
+	cout << " | " << std::setw(8);
+	if (value != value)
+	{
+		cout << "-";
+	}
+	else
+	{
+		cout << value;
+	}
+
+	return;
+}	//end function: bench_report_count | double
+
+/****************************************************************************
+**	STORAGE SUITE
+*****************************************************************************
+**	Every strategy of example.cpp is measured with the same kernels
+**	PHASES
+**		alloc	get the memory. Stack and std::array need no allocation and report nothing
+**				std::vector can't allocate without value initialization. Its alloc includes zeroing
+**		init	write every element. First touch of fresh heap pages pays the page faults
+**		seq		read every element in order
+**		random	read every element in a pseudo random order
+**		free	give the memory back
+**	Sizes are powers of 4 so that the random order can visit every element exactly once
+****************************************************************************/
+
+/****************************************************************************
+**	storage_init | int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Write every element with a value that depends on the index
+****************************************************************************/
+
+static inline void storage_init( int *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+
+	for (t = 0;t < size;t++)
+	{
+		array_arg[t] = (int)(t ^ 0x5A5A);
+	}
+
+	return;
+}	//end function: storage_init | int *, size_t
+
+/****************************************************************************
+**	storage_read_sequential | const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	sum of the elements
+**	DESCRIPTION:
+****************************************************************************/
+
+static inline int storage_read_sequential( const int *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+	//unsigned so that overflow is defined
+	unsigned int sum = 0;
+
+	for (t = 0;t < size;t++)
+	{
+		sum += (unsigned int)array_arg[t];
+	}
+
+	return (int)sum;
+}	//end function: storage_read_sequential | const int *, size_t
+
+/****************************************************************************
+**	storage_read_random | const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	size must be a power of two
+**	RETURN:
+**	sum of the elements
+**	DESCRIPTION:
+**	The index is a linear congruential generator modulo size.
+**	With multiplier 1 mod 4 and odd increment it has full period:
+**	every element is read exactly once, in an order the prefetcher can't follow.
+**	The index does not depend on the loaded data, so loads can overlap
+****************************************************************************/
+
+static inline int storage_read_random( const int *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+	size_t index = 0;
+	size_t mask = size -1;
+	unsigned int sum = 0;
+
+	for (t = 0;t < size;t++)
+	{
+		index = (index *1664525 +1013904223) & mask;
+		sum += (unsigned int)array_arg[index];
+	}
+
+	return (int)sum;
+}	//end function: storage_read_random | const int *, size_t
+
+/****************************************************************************
+**	bench_storage | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest array in bytes. Default 1G
+**	RETURN:
+**	DESCRIPTION:
+**	Run every strategy from 16 elements up to the largest size
+**	Stack strategies stop at 1MB. The default stack of a thread is 8MB
+****************************************************************************/
+
+int bench_storage( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	size_t max_bytes = BENCH_STORAGE_MAX_BYTES;
+	size_t max_elem;
+	size_t size;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes < 16 *sizeof(int))
+		{
+			cerr << "bad max_bytes: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	max_elem = max_bytes /sizeof(int);
+	cout << "Largest array: " << max_elem << " elements | " << max_elem *sizeof(int) << " bytes" << endl;
+	bench_report_header();
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//Stack based. Size must be known at compile time, one instance per size
+	if (max_elem >= (1 << 4))	{ bench_storage_c_stack<1 << 4>(); bench_storage_std_array<1 << 4>(); }
+	if (max_elem >= (1 << 6))	{ bench_storage_c_stack<1 << 6>(); bench_storage_std_array<1 << 6>(); }
+	if (max_elem >= (1 << 8))	{ bench_storage_c_stack<1 << 8>(); bench_storage_std_array<1 << 8>(); }
+	if (max_elem >= (1 << 10))	{ bench_storage_c_stack<1 << 10>(); bench_storage_std_array<1 << 10>(); }
+	if (max_elem >= (1 << 12))	{ bench_storage_c_stack<1 << 12>(); bench_storage_std_array<1 << 12>(); }
+	if (max_elem >= (1 << 14))	{ bench_storage_c_stack<1 << 14>(); bench_storage_std_array<1 << 14>(); }
+	if (max_elem >= (1 << 16))	{ bench_storage_c_stack<1 << 16>(); bench_storage_std_array<1 << 16>(); }
+	if (max_elem >= (1 << 18))	{ bench_storage_c_stack<1 << 18>(); bench_storage_std_array<1 << 18>(); }
+
+	//Heap based. Size is known at runtime
+	for (size = 16;size <= max_elem;size *= 4)
+	{
+		bench_storage_malloc( size );
+		bench_storage_new( size );
+		bench_storage_vector( size );
+		//Don't overflow on the last step
+		if (size > max_elem /4)
+		{
+			break;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_storage | int, char *[]
+
+/****************************************************************************
+**	bench_storage_c_stack | void
+*****************************************************************************
+**	PARAMETER:
+**	N number of elements of the array
+**	RETURN:
+**	DESCRIPTION:
+**	A batch of K C style stack arrays of N elements
+**	The batch is a local, so there is nothing to allocate and nothing to free
+****************************************************************************/
+
+template <int N>
+void bench_storage_c_stack( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Number of arrays in the batch
+	static const int K = (N *sizeof(int) >= BENCH_BATCH_BYTES) ?(1) :(BENCH_BATCH_BYTES /(N *sizeof(int)));
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s, k;
+	int num_samples;
+	uint64_t t0, t1;
+	vector<double> init, seq, rnd;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_samples = bench_num_samples( (size_t)K *N *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		//The batch
+		int my_stack_array[K][N];
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			storage_init( my_stack_array[k], N );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		init.push_back( (double)(t1 -t0) /((double)K *N) );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			bench_keep( storage_read_sequential( my_stack_array[k], N ) );
+		}
+		t1 = bench_now_ns();
+		seq.push_back( (double)(t1 -t0) /((double)K *N) );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			bench_keep( storage_read_random( my_stack_array[k], N ) );
+		}
+		t1 = bench_now_ns();
+		rnd.push_back( (double)(t1 -t0) /((double)K *N) );
+	}
+
+	bench_report_row( "c_stack", N, "init", bench_stats( init ), sizeof(int) );
+	bench_report_row( "c_stack", N, "seq", bench_stats( seq ), sizeof(int) );
+	bench_report_row( "c_stack", N, "random", bench_stats( rnd ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_storage_c_stack | void
+
+/****************************************************************************
+**	bench_storage_std_array | void
+*****************************************************************************
+**	PARAMETER:
+**	N number of elements of the array
+**	RETURN:
+**	DESCRIPTION:
+**	Same as bench_storage_c_stack with std::array
+****************************************************************************/
+
+template <int N>
+void bench_storage_std_array( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Number of arrays in the batch
+	static const int K = (N *sizeof(int) >= BENCH_BATCH_BYTES) ?(1) :(BENCH_BATCH_BYTES /(N *sizeof(int)));
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s, k;
+	int num_samples;
+	uint64_t t0, t1;
+	vector<double> init, seq, rnd;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_samples = bench_num_samples( (size_t)K *N *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		//The batch
+		array<array<int,N>,K> my_stack_array;
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			storage_init( my_stack_array[k].data(), my_stack_array[k].size() );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		init.push_back( (double)(t1 -t0) /((double)K *N) );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			bench_keep( storage_read_sequential( my_stack_array[k].data(), my_stack_array[k].size() ) );
+		}
+		t1 = bench_now_ns();
+		seq.push_back( (double)(t1 -t0) /((double)K *N) );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < K;k++)
+		{
+			bench_keep( storage_read_random( my_stack_array[k].data(), my_stack_array[k].size() ) );
+		}
+		t1 = bench_now_ns();
+		rnd.push_back( (double)(t1 -t0) /((double)K *N) );
+	}
+
+	bench_report_row( "std_array", N, "init", bench_stats( init ), sizeof(int) );
+	bench_report_row( "std_array", N, "seq", bench_stats( seq ), sizeof(int) );
+	bench_report_row( "std_array", N, "random", bench_stats( rnd ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_storage_std_array | void
+
+/****************************************************************************
+**	bench_storage_heap | size_t, Alloc, Free
+*****************************************************************************
+**	PARAMETER:
+**	size number of elements of each array
+**	alloc_fn	int *(size_t) return an array of size elements. NULL on failure
+**	free_fn		void(int *) give the array back
+**	RETURN:
+**	DESCRIPTION:
+**	Common body of the malloc and new[] strategies
+**	A batch of arrays is allocated, initialized, read and freed, phase by phase
+****************************************************************************/
+
+template <typename Alloc, typename Free>
+static void bench_storage_heap( const char *strategy, size_t size, Alloc alloc_fn, Free free_fn )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s;
+	size_t k;
+	//Number of arrays in the batch
+	size_t num_batch;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	vector<int *> batch;
+	vector<double> alloc, init, seq, rnd, release;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_batch = (size *sizeof(int) >= BENCH_BATCH_BYTES) ?(1) :(BENCH_BATCH_BYTES /(size *sizeof(int)));
+	num_samples = bench_num_samples( num_batch *size *sizeof(int) );
+	num_elem = (double)num_batch *(double)size;
+	batch.resize( num_batch, NULL );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			batch[k] = alloc_fn( size );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		alloc.push_back( (double)(t1 -t0) /num_elem );
+
+		for (k = 0;k < num_batch;k++)
+		{
+			if (batch[k] == NULL)
+			{
+				cerr << strategy << " failed to allocate " << size << " elements" << endl;
+				exit(-1);
+			}
+		}
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			storage_init( batch[k], size );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		init.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			bench_keep( storage_read_sequential( batch[k], size ) );
+		}
+		t1 = bench_now_ns();
+		seq.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			bench_keep( storage_read_random( batch[k], size ) );
+		}
+		t1 = bench_now_ns();
+		rnd.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			free_fn( batch[k] );
+			batch[k] = NULL;
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		release.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( strategy, size, "alloc", bench_stats( alloc ), sizeof(int) );
+	bench_report_row( strategy, size, "init", bench_stats( init ), sizeof(int) );
+	bench_report_row( strategy, size, "seq", bench_stats( seq ), sizeof(int) );
+	bench_report_row( strategy, size, "random", bench_stats( rnd ), sizeof(int) );
+	bench_report_row( strategy, size, "free", bench_stats( release ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_storage_heap | size_t, Alloc, Free
+
+/****************************************************************************
+**	bench_storage_malloc | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	C STYLE, HEAP MALLOC
+****************************************************************************/
+
+static int *storage_malloc( size_t size )
+{
+	return (int *)malloc( size *sizeof(int) );
+}
+
+static void storage_free( int *array_arg )
+{
+	free( array_arg );
+}
+
+void bench_storage_malloc( size_t size )
+{
+	bench_storage_heap( "malloc", size, storage_malloc, storage_free );
+
+	return;
+}	//end function: bench_storage_malloc | size_t
+
+/****************************************************************************
+**	bench_storage_new | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	C++ STYLE, HEAP NEW
+**	new int[] does not initialize the elements
+****************************************************************************/
+
+static int *storage_new( size_t size )
+{
+	return new int[size];
+}
+
+static void storage_delete( int *array_arg )
+{
+	delete[] array_arg;
+}
+
+void bench_storage_new( size_t size )
+{
+	bench_storage_heap( "new[]", size, storage_new, storage_delete );
+
+	return;
+}	//end function: bench_storage_new | size_t
+
+/****************************************************************************
+**	bench_storage_vector | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	STD::VECTOR, HEAP NEW
+**	resize allocates and zeroes the elements. There is no way to skip the zeroing
+**	swap with an empty vector is the only way to be sure the memory is released
+****************************************************************************/
+
+void bench_storage_vector( size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s;
+	size_t k;
+	size_t num_batch;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	vector< vector<int> > batch;
+	vector<double> alloc, init, seq, rnd, release;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_batch = (size *sizeof(int) >= BENCH_BATCH_BYTES) ?(1) :(BENCH_BATCH_BYTES /(size *sizeof(int)));
+	num_samples = bench_num_samples( num_batch *size *sizeof(int) );
+	num_elem = (double)num_batch *(double)size;
+	batch.resize( num_batch );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			batch[k].resize( size );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		alloc.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			storage_init( batch[k].data(), batch[k].size() );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		init.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			bench_keep( storage_read_sequential( batch[k].data(), batch[k].size() ) );
+		}
+		t1 = bench_now_ns();
+		seq.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			bench_keep( storage_read_random( batch[k].data(), batch[k].size() ) );
+		}
+		t1 = bench_now_ns();
+		rnd.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (k = 0;k < num_batch;k++)
+		{
+			vector<int>().swap( batch[k] );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		release.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( "vector", size, "alloc", bench_stats( alloc ), sizeof(int) );
+	bench_report_row( "vector", size, "init", bench_stats( init ), sizeof(int) );
+	bench_report_row( "vector", size, "seq", bench_stats( seq ), sizeof(int) );
+	bench_report_row( "vector", size, "random", bench_stats( rnd ), sizeof(int) );
+	bench_report_row( "vector", size, "free", bench_stats( release ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_storage_vector | size_t
+
+/****************************************************************************
+**	LAYOUT2D SUITE
+*****************************************************************************
+**	The three heap 2D layouts of heap_2d.h
+**		rows	array of pointers to separately allocated rows
+**		block	single block, index computed by hand
+**		table	single allocation, pointers to rows followed by the elements
+**	PHASES
+**		alloc	get the memory
+**		init	write every element, row-major
+**		row		read every element, row-major. Consecutive elements are adjacent in memory
+**		col		read every element, column-major. Consecutive elements are a row apart
+**		free	give the memory back
+**	rows and table pay a pointer load per row (row-major) or per element (column-major)
+**	column-major pays a cache miss per element once a column of cache lines does not fit in cache
+****************************************************************************/
+
+/****************************************************************************
+**	layout2d_init | int **, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Overloaded for the pointer to rows layouts and the block layout
+****************************************************************************/
+
+static inline void layout2d_init( int **array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			array_arg[t][ti] = (int)(t ^ ti);
+		}
+	}
+
+	return;
+}	//end function: layout2d_init | int **, size_t, size_t
+
+static inline void layout2d_init( int *array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			array_arg[t*cols +ti] = (int)(t ^ ti);
+		}
+	}
+
+	return;
+}	//end function: layout2d_init | int *, size_t, size_t
+
+/****************************************************************************
+**	layout2d_sum_row_major | int **, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	sum of the elements
+**	DESCRIPTION:
+**	Inner loop walks a row
+****************************************************************************/
+
+static inline int layout2d_sum_row_major( int **array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			sum += (unsigned int)array_arg[t][ti];
+		}
+	}
+
+	return (int)sum;
+}	//end function: layout2d_sum_row_major | int **, size_t, size_t
+
+static inline int layout2d_sum_row_major( int *array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			sum += (unsigned int)array_arg[t*cols +ti];
+		}
+	}
+
+	return (int)sum;
+}	//end function: layout2d_sum_row_major | int *, size_t, size_t
+
+/****************************************************************************
+**	layout2d_sum_col_major | int **, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	sum of the elements
+**	DESCRIPTION:
+**	Inner loop walks a column
+****************************************************************************/
+
+static inline int layout2d_sum_col_major( int **array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (ti = 0;ti < cols;ti++)
+	{
+		for (t = 0;t < rows;t++)
+		{
+			sum += (unsigned int)array_arg[t][ti];
+		}
+	}
+
+	return (int)sum;
+}	//end function: layout2d_sum_col_major | int **, size_t, size_t
+
+static inline int layout2d_sum_col_major( int *array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (ti = 0;ti < cols;ti++)
+	{
+		for (t = 0;t < rows;t++)
+		{
+			sum += (unsigned int)array_arg[t*cols +ti];
+		}
+	}
+
+	return (int)sum;
+}	//end function: layout2d_sum_col_major | int *, size_t, size_t
+
+//Adapt the free functions of heap_2d.h to a common signature
+static void layout2d_block_free( int *array_arg, size_t rows )
+{
+	(void)rows;
+	free( array_arg );
+}
+
+static void layout2d_table_free( int **array_arg, size_t rows )
+{
+	(void)rows;
+	free( array_arg );
+}
+
+/****************************************************************************
+**	bench_layout2d | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1], argv[2] optional. Rows and columns. Default is a list of shapes
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_layout2d( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Square, tall and wide shapes
+	static const size_t default_shapes[][2] =
+	{
+		{ 256, 256 },
+		{ 1024, 1024 },
+		{ 4096, 4096 },
+		{ 65536, 64 },
+		{ 64, 65536 },
+	};
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	vector< array<size_t,2> > shapes;
+	array<size_t,2> shape;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 3)
+	{
+		shape[0] = bench_parse_size( argv[1] );
+		shape[1] = bench_parse_size( argv[2] );
+		if ((shape[0] == 0) || (shape[1] == 0))
+		{
+			cerr << "bad shape: " << argv[1] << " x " << argv[2] << endl;
+			return -1;
+		}
+		shapes.push_back( shape );
+	}
+	else
+	{
+		for (t = 0;t < sizeof( default_shapes ) /sizeof( default_shapes[0] );t++)
+		{
+			shape[0] = default_shapes[t][0];
+			shape[1] = default_shapes[t][1];
+			shapes.push_back( shape );
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < shapes.size();t++)
+	{
+		cout << "Shape: " << shapes[t][0] << " rows x " << shapes[t][1] << " cols" << endl;
+		bench_report_header( true );
+		bench_layout2d_run<int **>( "rows", shapes[t][0], shapes[t][1], heap_2d_rows_alloc, heap_2d_rows_free );
+		bench_layout2d_run<int *>( "block", shapes[t][0], shapes[t][1], heap_2d_block_alloc, layout2d_block_free );
+		bench_layout2d_run<int **>( "table", shapes[t][0], shapes[t][1], heap_2d_table_alloc, layout2d_table_free );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_layout2d | int, char *[]
+
+/****************************************************************************
+**	bench_layout2d_run | const char *, size_t, size_t, H (*)( size_t, size_t ), void (*)( H, size_t )
+*****************************************************************************
+**	PARAMETER:
+**	H handle of the layout. int ** for rows and table, int * for block
+**	RETURN:
+**	DESCRIPTION:
+**	Measure one layout, one shape. A fresh array is allocated for each sample
+****************************************************************************/
+
+template <typename H>
+static void bench_layout2d_run( const char *layout, size_t rows, size_t cols, H (*alloc_fn)( size_t, size_t ), void (*free_fn)( H, size_t ) )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	H my_heap_array;
+	vector<double> alloc, init, row, col, release;
+	Bench_counters c_alloc = {}, c_init = {}, c_row = {}, c_col = {}, c_release = {};
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_elem = (double)rows *(double)cols;
+	num_samples = bench_num_samples( rows *cols *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		bench_perf_start();
+		t0 = bench_now_ns();
+		my_heap_array = alloc_fn( rows, cols );
+		bench_clobber();
+		t1 = bench_now_ns();
+		bench_perf_stop( c_alloc, num_elem );
+		alloc.push_back( (double)(t1 -t0) /num_elem );
+
+		if (my_heap_array == NULL)
+		{
+			cerr << layout << " failed to allocate " << rows << " x " << cols << endl;
+			exit(-1);
+		}
+
+		bench_perf_start();
+		t0 = bench_now_ns();
+		layout2d_init( my_heap_array, rows, cols );
+		bench_clobber();
+		t1 = bench_now_ns();
+		bench_perf_stop( c_init, num_elem );
+		init.push_back( (double)(t1 -t0) /num_elem );
+
+		bench_perf_start();
+		t0 = bench_now_ns();
+		bench_keep( layout2d_sum_row_major( my_heap_array, rows, cols ) );
+		t1 = bench_now_ns();
+		bench_perf_stop( c_row, num_elem );
+		row.push_back( (double)(t1 -t0) /num_elem );
+
+		bench_perf_start();
+		t0 = bench_now_ns();
+		bench_keep( layout2d_sum_col_major( my_heap_array, rows, cols ) );
+		t1 = bench_now_ns();
+		bench_perf_stop( c_col, num_elem );
+		col.push_back( (double)(t1 -t0) /num_elem );
+
+		bench_perf_start();
+		t0 = bench_now_ns();
+		free_fn( my_heap_array, rows );
+		bench_clobber();
+		t1 = bench_now_ns();
+		bench_perf_stop( c_release, num_elem );
+		release.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( layout, rows *cols, "alloc", bench_stats( alloc ), sizeof(int), &c_alloc );
+	bench_report_row( layout, rows *cols, "init", bench_stats( init ), sizeof(int), &c_init );
+	bench_report_row( layout, rows *cols, "row", bench_stats( row ), sizeof(int), &c_row );
+	bench_report_row( layout, rows *cols, "col", bench_stats( col ), sizeof(int), &c_col );
+	bench_report_row( layout, rows *cols, "free", bench_stats( release ), sizeof(int), &c_release );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_layout2d_run | const char *, size_t, size_t, H (*)( size_t, size_t ), void (*)( H, size_t )
+
+/****************************************************************************
+**	VIEW2D SUITE
+*****************************************************************************
+**	The same 2D sum written four ways over the same heap block
+**		raw			int *, rows, cols and index math by hand, as c_style_stack_2d_handler_pointer
+**		view		View2d, walks each row through row_data() when rows are contiguous
+**		view_elem	View2d, every element through operator()( r, c )
+**		view_T		View2d of the transpose, walks columns of the block
+**	raw and view should match: the view costs nothing to pass nor to index
+****************************************************************************/
+
+/****************************************************************************
+**	view2d_sum_raw | const int *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Index math by hand
+****************************************************************************/
+
+static int view2d_sum_raw( const int *array_arg, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			sum += (unsigned int)array_arg[t*cols +ti];
+		}
+	}
+
+	return (int)sum;
+}	//end function: view2d_sum_raw | const int *, size_t, size_t
+
+/****************************************************************************
+**	view2d_sum | View2d<const int>
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Kernel written once for any storage
+**	Contiguous rows are walked as plain pointers, which the compiler vectorizes
+****************************************************************************/
+
+static int view2d_sum( View2d<const int> array_arg )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+	const int *row;
+
+	if (array_arg.is_row_contiguous() == true)
+	{
+		for (t = 0;t < array_arg.rows();t++)
+		{
+			row = array_arg.row_data( t );
+			for (ti = 0;ti < array_arg.cols();ti++)
+			{
+				sum += (unsigned int)row[ti];
+			}
+		}
+	}
+	else
+	{
+		for (t = 0;t < array_arg.rows();t++)
+		{
+			for (ti = 0;ti < array_arg.cols();ti++)
+			{
+				sum += (unsigned int)array_arg( t, ti );
+			}
+		}
+	}
+
+	return (int)sum;
+}	//end function: view2d_sum | View2d<const int>
+
+/****************************************************************************
+**	view2d_sum_elem | View2d<const int>
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Every element through operator(). Strides are runtime values
+****************************************************************************/
+
+static int view2d_sum_elem( View2d<const int> array_arg )
+{
+	//fast counters
+	size_t t, ti;
+	unsigned int sum = 0;
+
+	for (t = 0;t < array_arg.rows();t++)
+	{
+		for (ti = 0;ti < array_arg.cols();ti++)
+		{
+			sum += (unsigned int)array_arg( t, ti );
+		}
+	}
+
+	return (int)sum;
+}	//end function: view2d_sum_elem | View2d<const int>
+
+/****************************************************************************
+**	bench_view2d | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1], argv[2] optional. Rows and columns. Default 64x64 (in cache) and 2048x2048 (out of cache)
+**	RETURN:
+**	DESCRIPTION:
+**	Results of the four kernels are compared. A mismatch is an error
+****************************************************************************/
+
+int bench_view2d( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	static const size_t default_shapes[][2] =
+	{
+		{ 64, 64 },
+		{ 2048, 2048 },
+	};
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	vector< array<size_t,2> > shapes;
+	array<size_t,2> shape;
+	size_t rows, cols;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	int sum_raw, sum_view, sum_elem, sum_t;
+	int *my_heap_array;
+	View2d<const int> my_view;
+	vector<double> raw, view, elem, view_t;
+	Bench_counters c_raw, c_view, c_elem, c_view_t;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 3)
+	{
+		shape[0] = bench_parse_size( argv[1] );
+		shape[1] = bench_parse_size( argv[2] );
+		if ((shape[0] == 0) || (shape[1] == 0))
+		{
+			cerr << "bad shape: " << argv[1] << " x " << argv[2] << endl;
+			return -1;
+		}
+		shapes.push_back( shape );
+	}
+	else
+	{
+		for (t = 0;t < sizeof( default_shapes ) /sizeof( default_shapes[0] );t++)
+		{
+			shape[0] = default_shapes[t][0];
+			shape[1] = default_shapes[t][1];
+			shapes.push_back( shape );
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < shapes.size();t++)
+	{
+		rows = shapes[t][0];
+		cols = shapes[t][1];
+		num_elem = (double)rows *(double)cols;
+		num_samples = bench_num_samples( rows *cols *sizeof(int) );
+
+		my_heap_array = heap_2d_block_alloc( rows, cols );
+		if (my_heap_array == NULL)
+		{
+			cerr << "failed to allocate " << rows << " x " << cols << endl;
+			return -1;
+		}
+		layout2d_init( my_heap_array, rows, cols );
+		my_view = View2d<const int>( my_heap_array, rows, cols );
+
+		raw.clear();
+		view.clear();
+		elem.clear();
+		view_t.clear();
+		c_raw = c_view = c_elem = c_view_t = Bench_counters();
+
+		for (s = 0;s < num_samples;s++)
+		{
+			bench_perf_start();
+			t0 = bench_now_ns();
+			sum_raw = view2d_sum_raw( my_heap_array, rows, cols );
+			bench_keep( sum_raw );
+			t1 = bench_now_ns();
+			bench_perf_stop( c_raw, num_elem );
+			raw.push_back( (double)(t1 -t0) /num_elem );
+
+			bench_perf_start();
+			t0 = bench_now_ns();
+			sum_view = view2d_sum( my_view );
+			bench_keep( sum_view );
+			t1 = bench_now_ns();
+			bench_perf_stop( c_view, num_elem );
+			view.push_back( (double)(t1 -t0) /num_elem );
+
+			bench_perf_start();
+			t0 = bench_now_ns();
+			sum_elem = view2d_sum_elem( my_view );
+			bench_keep( sum_elem );
+			t1 = bench_now_ns();
+			bench_perf_stop( c_elem, num_elem );
+			elem.push_back( (double)(t1 -t0) /num_elem );
+
+			bench_perf_start();
+			t0 = bench_now_ns();
+			sum_t = view2d_sum( my_view.transpose() );
+			bench_keep( sum_t );
+			t1 = bench_now_ns();
+			bench_perf_stop( c_view_t, num_elem );
+			view_t.push_back( (double)(t1 -t0) /num_elem );
+
+			if ((sum_view != sum_raw) || (sum_elem != sum_raw) || (sum_t != sum_raw))
+			{
+				cerr << "sum mismatch | raw: " << sum_raw << " | view: " << sum_view << " | view_elem: " << sum_elem << " | view_T: " << sum_t << endl;
+				free( my_heap_array );
+				return -1;
+			}
+		}
+
+		cout << "Shape: " << rows << " rows x " << cols << " cols" << endl;
+		bench_report_header( true );
+		bench_report_row( "raw", rows *cols, "sum", bench_stats( raw ), sizeof(int), &c_raw );
+		bench_report_row( "view", rows *cols, "sum", bench_stats( view ), sizeof(int), &c_view );
+		bench_report_row( "view_elem", rows *cols, "sum", bench_stats( elem ), sizeof(int), &c_elem );
+		bench_report_row( "view_T", rows *cols, "sum", bench_stats( view_t ), sizeof(int), &c_view_t );
+
+		free( my_heap_array );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_view2d | int, char *[]
+
+/****************************************************************************
+**	PASS1D SUITE
+*****************************************************************************
+**	A handler that does a constant amount of work, three elements, called three ways
+**		by_value	std::array<int,S> by value. The call copies S elements
+**		span_S		Span<const int,S>. The call passes a pointer
+**		span		Span<const int>. The call passes a pointer and a size
+**	The handler is called through a volatile function pointer: the compiler can't
+**	inline it nor trim the copy to the three elements it reads
+**	"med ns/array" is the cost of one call. by_value grows with S, spans do not
+****************************************************************************/
+
+template <size_t S>
+static int pass1d_by_value( array<int,S> array_arg )
+{
+	return array_arg[0] +array_arg[S/2] +array_arg[S-1];
+}
+
+template <size_t S>
+static int pass1d_span_s( Span<const int,S> array_arg )
+{
+	return array_arg[0] +array_arg[S/2] +array_arg[S-1];
+}
+
+static int pass1d_span( Span<const int> array_arg )
+{
+	return array_arg[0] +array_arg[array_arg.size()/2] +array_arg[array_arg.size()-1];
+}
+
+/****************************************************************************
+**	bench_pass1d | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	S must be known at compile time, one instance per size
+****************************************************************************/
+
+int bench_pass1d( int argc, char *argv[] )
+{
+	(void)argc;
+	(void)argv;
+
+	bench_report_header();
+	bench_pass1d_run<1 << 4>();
+	bench_pass1d_run<1 << 8>();
+	bench_pass1d_run<1 << 12>();
+	bench_pass1d_run<1 << 16>();
+	bench_pass1d_run<1 << 18>();
+
+	return 0;
+}	//end function: bench_pass1d | int, char *[]
+
+/****************************************************************************
+**	bench_pass1d_run | void
+*****************************************************************************
+**	PARAMETER:
+**	S number of elements of the array
+**	RETURN:
+**	DESCRIPTION:
+**	Each sample makes many calls so that small arrays are not dominated by the timer
+****************************************************************************/
+
+template <size_t S>
+void bench_pass1d_run( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Static storage. Big arrays would not fit the stack of the caller plus a copy
+	static array<int,S> my_array;
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s;
+	size_t c;
+	size_t num_calls;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	int sum;
+	vector<double> by_value, span_s, span;
+	//Called through volatile pointers so the calls can't be inlined
+	int (* volatile by_value_fn)( array<int,S> ) = pass1d_by_value<S>;
+	int (* volatile span_s_fn)( Span<const int,S> ) = pass1d_span_s<S>;
+	int (* volatile span_fn)( Span<const int> ) = pass1d_span;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	storage_init( my_array.data(), S );
+	num_calls = ((1 << 22) /S > 16) ?((1 << 22) /S) :(16);
+	num_samples = bench_num_samples( num_calls *S *sizeof(int) );
+	num_elem = (double)num_calls *(double)S;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		sum = 0;
+		t0 = bench_now_ns();
+		for (c = 0;c < num_calls;c++)
+		{
+			sum += by_value_fn( my_array );
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		by_value.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (c = 0;c < num_calls;c++)
+		{
+			sum += span_s_fn( my_array );
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		span_s.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (c = 0;c < num_calls;c++)
+		{
+			sum += span_fn( my_array );
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		span.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( "by_value", S, "call", bench_stats( by_value ), sizeof(int) );
+	bench_report_row( "span_S", S, "call", bench_stats( span_s ), sizeof(int) );
+	bench_report_row( "span", S, "call", bench_stats( span ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_pass1d_run | void
+
+/****************************************************************************
+**	ARENA SUITE
+*****************************************************************************
+**	A frame makes BENCH_ARENA_FRAME_ARRAYS arrays, fills them, sums them and drops them all
+**		malloc			malloc each array, free each array
+**		new[]			new[] each array, delete[] each array
+**		arena			allocate each array from an Arena, ArenaScope drops them at the end of the frame
+**		vector			std::vector each array
+**		vector_arena	std::vector with ArenaAllocator, ArenaScope drops them at the end of the frame
+**	"med ns/array" is the cost of making, filling, reading and dropping one array
+****************************************************************************/
+
+/****************************************************************************
+**	bench_arena | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_arena( int argc, char *argv[] )
+{
+	//fast counter
+	size_t size;
+
+	(void)argc;
+	(void)argv;
+
+	bench_report_header();
+	for (size = 16;size <= 65536;size *= 16)
+	{
+		bench_arena_run( size );
+	}
+
+	return 0;
+}	//end function: bench_arena | int, char *[]
+
+/****************************************************************************
+**	arena_frame_fill | int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	sum of the array
+**	DESCRIPTION:
+**	The work done on each array of a frame
+****************************************************************************/
+
+static inline int arena_frame_fill( int *array_arg, size_t size )
+{
+	storage_init( array_arg, size );
+	return storage_read_sequential( array_arg, size );
+}	//end function: arena_frame_fill | int *, size_t
+
+/****************************************************************************
+**	bench_arena_run | size_t
+*****************************************************************************
+**	PARAMETER:
+**	size elements of each array
+**	RETURN:
+**	DESCRIPTION:
+**	The arena lives across frames, like it would in a request loop
+****************************************************************************/
+
+void bench_arena_run( size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s;
+	size_t f, k;
+	int num_samples;
+	//Frames per sample
+	size_t num_frames;
+	uint64_t t0, t1;
+	double num_elem;
+	unsigned int sum;
+	int *batch[BENCH_ARENA_FRAME_ARRAYS];
+	Arena my_arena;
+	vector<double> t_malloc, t_new, t_arena, t_vector, t_vector_arena;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_frames = (BENCH_TARGET_BYTES /16) /(BENCH_ARENA_FRAME_ARRAYS *size *sizeof(int));
+	if (num_frames < 1)
+	{
+		num_frames = 1;
+	}
+	num_samples = bench_num_samples( num_frames *BENCH_ARENA_FRAME_ARRAYS *size *sizeof(int) );
+	num_elem = (double)num_frames *BENCH_ARENA_FRAME_ARRAYS *(double)size;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		sum = 0;
+		t0 = bench_now_ns();
+		for (f = 0;f < num_frames;f++)
+		{
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				batch[k] = (int *)malloc( size *sizeof(int) );
+				if (batch[k] == NULL)
+				{
+					cerr << "malloc failed" << endl;
+					exit(-1);
+				}
+				sum += (unsigned int)arena_frame_fill( batch[k], size );
+			}
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				free( batch[k] );
+			}
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		t_malloc.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (f = 0;f < num_frames;f++)
+		{
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				batch[k] = new int[size];
+				sum += (unsigned int)arena_frame_fill( batch[k], size );
+			}
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				delete[] batch[k];
+			}
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		t_new.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (f = 0;f < num_frames;f++)
+		{
+			ArenaScope my_scope( my_arena );
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				batch[k] = my_arena.allocate_array<int>( size );
+				if (batch[k] == NULL)
+				{
+					cerr << "arena failed" << endl;
+					exit(-1);
+				}
+				sum += (unsigned int)arena_frame_fill( batch[k], size );
+			}
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		t_arena.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (f = 0;f < num_frames;f++)
+		{
+			vector< vector<int> > my_vectors( BENCH_ARENA_FRAME_ARRAYS );
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				my_vectors[k].resize( size );
+				sum += (unsigned int)arena_frame_fill( my_vectors[k].data(), size );
+			}
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		t_vector.push_back( (double)(t1 -t0) /num_elem );
+
+		sum = 0;
+		t0 = bench_now_ns();
+		for (f = 0;f < num_frames;f++)
+		{
+			ArenaScope my_scope( my_arena );
+			//The outer vector draws from the arena too
+			typedef vector<int, ArenaAllocator<int> > Arena_vector;
+			vector<Arena_vector, ArenaAllocator<Arena_vector> > my_vectors( BENCH_ARENA_FRAME_ARRAYS, Arena_vector( ArenaAllocator<int>( my_arena ) ), ArenaAllocator<Arena_vector>( my_arena ) );
+			for (k = 0;k < BENCH_ARENA_FRAME_ARRAYS;k++)
+			{
+				my_vectors[k].resize( size );
+				sum += (unsigned int)arena_frame_fill( my_vectors[k].data(), size );
+			}
+		}
+		bench_keep( sum );
+		t1 = bench_now_ns();
+		t_vector_arena.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( "malloc", size, "frame", bench_stats( t_malloc ), sizeof(int) );
+	bench_report_row( "new[]", size, "frame", bench_stats( t_new ), sizeof(int) );
+	bench_report_row( "arena", size, "frame", bench_stats( t_arena ), sizeof(int) );
+	bench_report_row( "vector", size, "frame", bench_stats( t_vector ), sizeof(int) );
+	bench_report_row( "vector_arena", size, "frame", bench_stats( t_vector_arena ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_arena_run | size_t
+
+/****************************************************************************
+**	POOL SUITE
+*****************************************************************************
+**	Each thread holds BENCH_POOL_SLOTS live arrays. An operation picks a slot at random,
+**	frees the array in it and allocates a new one of one of a few fixed sizes.
+**	Each strategy runs in a child process so that its peak RSS is its own
+**		malloc		glibc malloc/free
+**		pool		pool_alloc/pool_free of pool.h
+**	Throughput is in millions of operations (one free + one alloc) per second, all threads together
+****************************************************************************/
+
+/****************************************************************************
+**	pool_churn | unsigned int, size_t, Alloc, Free
+*****************************************************************************
+**	PARAMETER:
+**	alloc_fn	void *( size_t bytes )
+**	free_fn		void ( void *, size_t bytes )
+**	RETURN:
+**	DESCRIPTION:
+**	Body of a thread. Touches first and last element of each array like a real user would
+****************************************************************************/
+
+template <typename Alloc, typename Free>
+static void pool_churn( unsigned int seed, size_t num_ops, Alloc alloc_fn, Free free_fn )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//The few fixed sizes of the arrays, in elements
+	static const size_t sizes[] = { 4, 11, 16, 64, 250, 1000 };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	size_t slot;
+	unsigned int x = seed;
+	unsigned int check = 0;
+	vector<int *> live( BENCH_POOL_SLOTS, (int *)NULL );
+	vector<size_t> live_size( BENCH_POOL_SLOTS, 0 );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < num_ops;t++)
+	{
+		x = x *1664525 +1013904223;
+		slot = (x >> 8) %BENCH_POOL_SLOTS;
+		if (live[slot] != NULL)
+		{
+			check += (unsigned int)live[slot][0];
+			free_fn( live[slot], live_size[slot] *sizeof(int) );
+		}
+		live_size[slot] = sizes[ (x >> 24) %(sizeof( sizes ) /sizeof( sizes[0] )) ];
+		live[slot] = (int *)alloc_fn( live_size[slot] *sizeof(int) );
+		if (live[slot] == NULL)
+		{
+			cerr << "allocation failed" << endl;
+			exit(-1);
+		}
+		live[slot][0] = (int)t;
+		live[slot][ live_size[slot] -1 ] = (int)t;
+	}
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < BENCH_POOL_SLOTS;t++)
+	{
+		if (live[t] != NULL)
+		{
+			free_fn( live[t], live_size[t] *sizeof(int) );
+		}
+	}
+	bench_keep( check );
+
+	return;
+}	//end function: pool_churn | unsigned int, size_t, Alloc, Free
+
+/****************************************************************************
+**	bench_pool_run | unsigned int, size_t, Alloc, Free
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	millions of operations per second
+**	DESCRIPTION:
+**	Run num_threads churn threads to completion
+****************************************************************************/
+
+template <typename Alloc, typename Free>
+static double bench_pool_run( unsigned int num_threads, size_t num_ops, Alloc alloc_fn, Free free_fn )
+{
+	//fast counter
+	unsigned int t;
+	uint64_t t0, t1;
+	vector<std::thread> threads;
+
+	t0 = bench_now_ns();
+	for (t = 0;t < num_threads;t++)
+	{
+		threads.push_back( std::thread( pool_churn<Alloc, Free>, 12345u +t *7919u, num_ops, alloc_fn, free_fn ) );
+	}
+	for (t = 0;t < num_threads;t++)
+	{
+		threads[t].join();
+	}
+	t1 = bench_now_ns();
+
+	return (double)num_threads *(double)num_ops *1000.0 /(double)(t1 -t0);
+}	//end function: bench_pool_run | unsigned int, size_t, Alloc, Free
+
+//Signatures shared by malloc and pool
+static void *pool_bench_malloc( size_t size )
+{
+	return malloc( size );
+}
+
+static void pool_bench_free( void *ptr, size_t size )
+{
+	(void)size;
+	free( ptr );
+}
+
+/****************************************************************************
+**	bench_pool | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Threads. Default the number of hardware threads, at least 4
+**	argv[2] optional. Operations per thread. Default 2M
+**	RETURN:
+**	DESCRIPTION:
+**	Child process runs the samples and sends the throughputs through a pipe
+**	Parent reads the peak RSS of the child from wait4
+****************************************************************************/
+
+int bench_pool( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	static const char *strategies[] = { "malloc", "pool" };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	unsigned int num_threads;
+	size_t num_ops = 2000000;
+	int num_samples = BENCH_MIN_SAMPLES;
+	int fd[2];
+	pid_t pid;
+	int status;
+	struct rusage usage;
+	vector<double> samples;
+	Bench_stats stats;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	num_threads = std::thread::hardware_concurrency();
+	if (num_threads < 4)
+	{
+		num_threads = 4;
+	}
+	if (argc >= 2)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		num_ops = bench_parse_size( argv[2] );
+	}
+	if ((num_threads == 0) || (num_ops == 0))
+	{
+		cerr << "bad arguments" << endl;
+		return -1;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << "Threads: " << num_threads << " | Operations per thread: " << num_ops << endl;
+	cout << std::left;
+	cout << std::setw(12) << "strategy" << " | ";
+	cout << std::setw(10) << "p10 Mop/s" << " | ";
+	cout << std::setw(10) << "med Mop/s" << " | ";
+	cout << std::setw(10) << "p90 Mop/s" << " | ";
+	cout << "peak RSS MB" << endl;
+	cout << std::right;
+
+	for (t = 0;t < sizeof( strategies ) /sizeof( strategies[0] );t++)
+	{
+		if (pipe( fd ) != 0)
+		{
+			cerr << "pipe failed" << endl;
+			return -1;
+		}
+		cout.flush();
+		pid = fork();
+		if (pid < 0)
+		{
+			cerr << "fork failed" << endl;
+			return -1;
+		}
+		//Child. Runs the samples, writes them, exits
+		if (pid == 0)
+		{
+			close( fd[0] );
+			for (s = 0;s < num_samples;s++)
+			{
+				double mops = (t == 0) ?(bench_pool_run( num_threads, num_ops, pool_bench_malloc, pool_bench_free )) :(bench_pool_run( num_threads, num_ops, pool_alloc, pool_free ));
+				if (write( fd[1], &mops, sizeof( mops ) ) != (ssize_t)sizeof( mops ))
+				{
+					_exit( 1 );
+				}
+			}
+			close( fd[1] );
+			_exit( 0 );
+		}
+		//Parent. Collects the samples, then the peak RSS
+		close( fd[1] );
+		samples.clear();
+		for (s = 0;s < num_samples;s++)
+		{
+			double mops;
+			if (read( fd[0], &mops, sizeof( mops ) ) != (ssize_t)sizeof( mops ))
+			{
+				break;
+			}
+			samples.push_back( mops );
+		}
+		close( fd[0] );
+		if ((wait4( pid, &status, 0, &usage ) != pid) || (WIFEXITED( status ) == 0) || (WEXITSTATUS( status ) != 0))
+		{
+			cerr << strategies[t] << " child failed" << endl;
+			return -1;
+		}
+
+		stats = bench_stats( samples );
+		cout << std::left << std::fixed << std::setprecision(2);
+		cout << std::setw(12) << strategies[t] << " | ";
+		cout << std::setw(10) << stats.p10 << " | ";
+		cout << std::setw(10) << stats.median << " | ";
+		cout << std::setw(10) << stats.p90 << " | ";
+		//ru_maxrss is in KB on Linux
+		cout << (double)usage.ru_maxrss /1024.0 << endl;
+		cout << std::right;
+		cout.unsetf( std::ios::floatfield );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_pool | int, char *[]
+
+/****************************************************************************
+**	ALIGNED SUITE
+*****************************************************************************
+**	Same buffers at different distances from a cache line boundary
+**		align64		first element on a cache line. AlignedArray default
+**		off4		one int past a cache line
+**		off16		16 bytes past a cache line. All malloc promises
+**		off32		32 bytes past a cache line. Aligned for AVX2, not for AVX-512
+**	KERNELS. 8 ints per step with unaligned AVX2 loads and stores, so an offset shows as split loads
+**		sum		read a
+**		copy	b = a
+**		triad	c = a +3*b
+**	Without AVX2 the kernels are scalar and the offset should make no difference
+**
+**	FALSE SHARING
+**	Each thread repeatedly writes its own chunk of 8 ints of a shared array
+**		packed	chunks next to each other. Two threads share each cache line
+**		padded	each chunk on its own cache line, AlignedArray of cache line sized chunks
+**	Reported in ns per write, all threads together
+****************************************************************************/
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+
+/****************************************************************************
+**	aligned_sum_avx2 | const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Compiled for AVX2 whatever the -m flags. Call only if the CPU has it
+****************************************************************************/
+
+__attribute__(( target( "avx2" ) ))
+static int aligned_sum_avx2( const int *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+	__m256i acc = _mm256_setzero_si256();
+	int lanes[8];
+	int ret = 0;
+
+	for (t = 0;t +8 <= size;t += 8)
+	{
+		acc = _mm256_add_epi32( acc, _mm256_loadu_si256( (const __m256i *)(array_arg +t) ) );
+	}
+	_mm256_storeu_si256( (__m256i *)lanes, acc );
+	for (int l = 0;l < 8;l++)
+	{
+		ret += lanes[l];
+	}
+	for (;t < size;t++)
+	{
+		ret += array_arg[t];
+	}
+
+	return ret;
+}	//end function: aligned_sum_avx2 | const int *, size_t
+
+/****************************************************************************
+**	aligned_copy_avx2 | int *, const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+__attribute__(( target( "avx2" ) ))
+static void aligned_copy_avx2( int *dst, const int *src, size_t size )
+{
+	//fast counter
+	size_t t;
+
+	for (t = 0;t +8 <= size;t += 8)
+	{
+		_mm256_storeu_si256( (__m256i *)(dst +t), _mm256_loadu_si256( (const __m256i *)(src +t) ) );
+	}
+	for (;t < size;t++)
+	{
+		dst[t] = src[t];
+	}
+
+	return;
+}	//end function: aligned_copy_avx2 | int *, const int *, size_t
+
+/****************************************************************************
+**	aligned_triad_avx2 | int *, const int *, const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	dst = a +3*b
+****************************************************************************/
+
+__attribute__(( target( "avx2" ) ))
+static void aligned_triad_avx2( int *dst, const int *a, const int *b, size_t size )
+{
+	//fast counter
+	size_t t;
+	__m256i vb;
+
+	for (t = 0;t +8 <= size;t += 8)
+	{
+		vb = _mm256_loadu_si256( (const __m256i *)(b +t) );
+		//3*b as b +2*b, no multiply needed
+		vb = _mm256_add_epi32( vb, _mm256_slli_epi32( vb, 1 ) );
+		_mm256_storeu_si256( (__m256i *)(dst +t), _mm256_add_epi32( _mm256_loadu_si256( (const __m256i *)(a +t) ), vb ) );
+	}
+	for (;t < size;t++)
+	{
+		dst[t] = a[t] +3*b[t];
+	}
+
+	return;
+}	//end function: aligned_triad_avx2 | int *, const int *, const int *, size_t
+
+#endif
+
+/****************************************************************************
+**	aligned_sum | const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	AVX2 kernel when the CPU has it, scalar otherwise. Same for copy and triad
+****************************************************************************/
+
+static int aligned_sum( const int *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+	int ret = 0;
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	if (__builtin_cpu_supports( "avx2" ))
+	{
+		return aligned_sum_avx2( array_arg, size );
+	}
+#endif
+	for (t = 0;t < size;t++)
+	{
+		ret += array_arg[t];
+	}
+
+	return ret;
+}	//end function: aligned_sum | const int *, size_t
+
+static void aligned_copy( int *dst, const int *src, size_t size )
+{
+	//fast counter
+	size_t t;
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	if (__builtin_cpu_supports( "avx2" ))
+	{
+		aligned_copy_avx2( dst, src, size );
+		return;
+	}
+#endif
+	for (t = 0;t < size;t++)
+	{
+		dst[t] = src[t];
+	}
+
+	return;
+}	//end function: aligned_copy | int *, const int *, size_t
+
+static void aligned_triad( int *dst, const int *a, const int *b, size_t size )
+{
+	//fast counter
+	size_t t;
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	if (__builtin_cpu_supports( "avx2" ))
+	{
+		aligned_triad_avx2( dst, a, b, size );
+		return;
+	}
+#endif
+	for (t = 0;t < size;t++)
+	{
+		dst[t] = a[t] +3*b[t];
+	}
+
+	return;
+}	//end function: aligned_triad | int *, const int *, const int *, size_t
+
+/****************************************************************************
+**	bench_aligned | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Bytes of the largest array. Default 64M
+**	RETURN:
+**	DESCRIPTION:
+**	Array sizes fit L1, L2 and then main memory
+****************************************************************************/
+
+int bench_aligned( int argc, char *argv[] )
+{
+	//fast counter
+	size_t bytes;
+	size_t max_bytes = BENCH_TARGET_BYTES;
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes == 0)
+		{
+			cerr << "bad size: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	cout << "Kernels: " << ((__builtin_cpu_supports( "avx2" )) ?("AVX2") :("scalar")) << endl;
+#else
+	cout << "Kernels: scalar" << endl;
+#endif
+	bench_report_header();
+	for (bytes = 16 *1024;bytes <= max_bytes;bytes *= 16)
+	{
+		bench_aligned_run( bytes /sizeof(int) );
+	}
+	bench_aligned_false_sharing();
+
+	return 0;
+}	//end function: bench_aligned | int, char *[]
+
+/****************************************************************************
+**	bench_aligned_run | size_t
+*****************************************************************************
+**	PARAMETER:
+**	size elements of each array
+**	RETURN:
+**	DESCRIPTION:
+**	One page aligned allocation per array, with room for the largest offset.
+**	The offsets are then taken from the same memory, so only the alignment changes
+****************************************************************************/
+
+void bench_aligned_run( size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Offsets in bytes from a cache line boundary
+	static const size_t offsets[] = { 0, 4, 16, 32 };
+	static const char *names[] = { "align64", "off4", "off16", "off32" };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t o;
+	int s, r;
+	int num_samples;
+	//Kernel calls per sample, so small arrays are not dominated by the timer
+	int num_reps;
+	uint64_t t0, t1;
+	double num_elem;
+	int *a, *b, *c;
+	int sum, check;
+	vector<double> t_sum, t_copy, t_triad;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	//Extra ints cover the largest offset
+	AlignedArray<int, ALIGNED_PAGE> buf_a( size +16 ), buf_b( size +16 ), buf_c( size +16 );
+	//The clobber in the loops covers only memory the compiler knows escaped
+	bench_keep( buf_a.data() );
+	bench_keep( buf_b.data() );
+	bench_keep( buf_c.data() );
+	num_reps = (int)(BENCH_BATCH_BYTES /(size *sizeof(int)));
+	if (num_reps < 1)
+	{
+		num_reps = 1;
+	}
+	num_samples = bench_num_samples( (size_t)num_reps *size *sizeof(int) );
+	num_elem = (double)num_reps *(double)size;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (o = 0;o < sizeof( offsets ) /sizeof( offsets[0] );o++)
+	{
+		a = (int *)((char *)buf_a.data() +offsets[o]);
+		b = (int *)((char *)buf_b.data() +offsets[o]);
+		c = (int *)((char *)buf_c.data() +offsets[o]);
+		storage_init( a, size );
+		storage_init( b, size );
+		check = storage_read_sequential( a, size );
+		t_sum.clear();
+		t_copy.clear();
+		t_triad.clear();
+
+		for (s = 0;s < num_samples;s++)
+		{
+			sum = 0;
+			t0 = bench_now_ns();
+			for (r = 0;r < num_reps;r++)
+			{
+				sum += aligned_sum( a, size );
+				bench_clobber();
+			}
+			bench_keep( sum );
+			t1 = bench_now_ns();
+			t_sum.push_back( (double)(t1 -t0) /num_elem );
+			if (sum != check *num_reps)
+			{
+				cerr << "sum mismatch at " << names[o] << endl;
+				exit(-1);
+			}
+
+			t0 = bench_now_ns();
+			for (r = 0;r < num_reps;r++)
+			{
+				aligned_copy( c, a, size );
+				bench_clobber();
+			}
+			t1 = bench_now_ns();
+			t_copy.push_back( (double)(t1 -t0) /num_elem );
+
+			t0 = bench_now_ns();
+			for (r = 0;r < num_reps;r++)
+			{
+				aligned_triad( c, a, b, size );
+				bench_clobber();
+			}
+			t1 = bench_now_ns();
+			t_triad.push_back( (double)(t1 -t0) /num_elem );
+		}
+		if (c[size -1] != a[size -1] +3*b[size -1])
+		{
+			cerr << "triad mismatch at " << names[o] << endl;
+			exit(-1);
+		}
+
+		bench_report_row( names[o], size, "sum", bench_stats( t_sum ), sizeof(int) );
+		bench_report_row( names[o], size, "copy", bench_stats( t_copy ), 2 *sizeof(int) );
+		bench_report_row( names[o], size, "triad", bench_stats( t_triad ), 3 *sizeof(int) );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_aligned_run | size_t
+
+/****************************************************************************
+**	aligned_chunk_writer | volatile int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Body of a thread. volatile keeps every write in memory instead of a register
+****************************************************************************/
+
+static void aligned_chunk_writer( volatile int *chunk, size_t num_writes )
+{
+	//fast counters
+	size_t t;
+	int l;
+
+	for (t = 0;t < num_writes;t += BENCH_ALIGNED_CHUNK)
+	{
+		for (l = 0;l < BENCH_ALIGNED_CHUNK;l++)
+		{
+			chunk[l] = chunk[l] +1;
+		}
+	}
+
+	return;
+}	//end function: aligned_chunk_writer | volatile int *, size_t
+
+/****************************************************************************
+**	bench_aligned_false_sharing | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Threads: number of hardware threads, at least 2
+****************************************************************************/
+
+void bench_aligned_false_sharing( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Chunk padded to a cache line
+	struct alignas(ALIGNED_CACHE_LINE) Padded_chunk
+	{
+		int data[BENCH_ALIGNED_CHUNK];
+	};
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	unsigned int t;
+	int s;
+	unsigned int num_threads;
+	size_t num_writes = 4000000;
+	uint64_t t0, t1;
+	double num_elem;
+	vector<std::thread> threads;
+	vector<double> t_packed, t_padded;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_threads = std::thread::hardware_concurrency();
+	if (num_threads < 2)
+	{
+		num_threads = 2;
+	}
+	AlignedArray<int> packed( num_threads *BENCH_ALIGNED_CHUNK, 0 );
+	AlignedArray<Padded_chunk> padded( num_threads, Padded_chunk() );
+	num_elem = (double)num_threads *(double)num_writes;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < BENCH_MIN_SAMPLES;s++)
+	{
+		t0 = bench_now_ns();
+		for (t = 0;t < num_threads;t++)
+		{
+			threads.push_back( std::thread( aligned_chunk_writer, packed.data() +t *BENCH_ALIGNED_CHUNK, num_writes ) );
+		}
+		for (t = 0;t < num_threads;t++)
+		{
+			threads[t].join();
+		}
+		t1 = bench_now_ns();
+		threads.clear();
+		t_packed.push_back( (double)(t1 -t0) /num_elem );
+
+		t0 = bench_now_ns();
+		for (t = 0;t < num_threads;t++)
+		{
+			threads.push_back( std::thread( aligned_chunk_writer, padded[t].data, num_writes ) );
+		}
+		for (t = 0;t < num_threads;t++)
+		{
+			threads[t].join();
+		}
+		t1 = bench_now_ns();
+		threads.clear();
+		t_padded.push_back( (double)(t1 -t0) /num_elem );
+	}
+
+	bench_report_row( "packed", num_threads, "false_share", bench_stats( t_packed ), sizeof(int) );
+	bench_report_row( "padded", num_threads, "false_share", bench_stats( t_padded ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_aligned_false_sharing | void
+
+/****************************************************************************
+**	SIMD SUITE
+*****************************************************************************
+**	Kernels of simd.h on every instruction set the CPU has, from the scalar reference up
+**		sum		minmax		dot		axpy (y = s*x +y)		count (elements > threshold)
+**	Before measuring, every instruction set is checked against the scalar reference
+**	on all sizes from 0 to 99, to exercise the tails, with extreme int values.
+**	int results must be bit exact. float results must be within rounding of the reference
+**	The instruction set in use is restored at the end
+****************************************************************************/
+
+/****************************************************************************
+**	simd_close | double, double
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Equal within the rounding of a float sum of up to a few thousand elements
+****************************************************************************/
+
+static bool simd_close( double a, double b, double magnitude )
+{
+	double diff = (a > b) ?(a -b) :(b -a);
+
+	return (diff <= 1e-4 *magnitude +1e-6);
+}	//end function: simd_close | double, double
+
+/****************************************************************************
+**	simd_check | const char *
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	false and a message on the first mismatch
+**	DESCRIPTION:
+**	Values are small pseudo random numbers with INT_MAX and INT_MIN sprinkled in for int,
+**	so the sums and products exercise the wrap around
+****************************************************************************/
+
+template <typename T>
+static bool simd_check( const char *type_name )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t size, t;
+	int isa;
+	uint32_t seed = 12345;
+	const bool is_int = (std::numeric_limits<T>::is_integer == true);
+	T a[100], b[100], y_ref[100], y[100];
+	T min_ref = 0, max_ref = 0, min = 0, max = 0;
+	double magnitude;
+	bool ok, ret_ref, ret;
+	Simd_isa best = simd_detect();
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (size = 0;size < 100;size++)
+	{
+		magnitude = 0.0;
+		for (t = 0;t < size;t++)
+		{
+			seed = seed *1664525u +1013904223u;
+			a[t] = (T)((int)(seed >> 16) -32768);
+			seed = seed *1664525u +1013904223u;
+			b[t] = (T)((int)(seed >> 20) -2048);
+			y_ref[t] = (T)(int)t;
+			if ((is_int == true) && (t %13 == 5))
+			{
+				a[t] = (t %2 == 0) ?(std::numeric_limits<T>::max()) :(std::numeric_limits<T>::lowest());
+			}
+			magnitude += ((a[t] < 0) ?(-(double)a[t]) :((double)a[t])) *4096.0;
+		}
+		simd_scale_add_scalar<T>( y_ref, a, (T)3, size );
+		ret_ref = simd_min_max_scalar<T>( a, size, min_ref, max_ref );
+
+		for (isa = SIMD_SSE4;isa <= best;isa++)
+		{
+			simd_set_isa( (Simd_isa)isa );
+			for (t = 0;t < size;t++)
+			{
+				y[t] = (T)(int)t;
+			}
+			simd_scale_add<T>( y, a, (T)3, size );
+			ret = simd_min_max<T>( a, size, min, max );
+			if (is_int == true)
+			{
+				ok = (simd_sum<T>( a, size ) == simd_sum_scalar<T>( a, size ));
+				ok = ok && (simd_dot<T>( a, b, size ) == simd_dot_scalar<T>( a, b, size ));
+				ok = ok && (memcmp( y, y_ref, size *sizeof(T) ) == 0);
+			}
+			else
+			{
+				ok = simd_close( (double)simd_sum<T>( a, size ), (double)simd_sum_scalar<T>( a, size ), magnitude );
+				ok = ok && simd_close( (double)simd_dot<T>( a, b, size ), (double)simd_dot_scalar<T>( a, b, size ), magnitude );
+				for (t = 0;t < size;t++)
+				{
+					ok = ok && simd_close( (double)y[t], (double)y_ref[t], 4.0 *(double)((y_ref[t] < 0) ?(-y_ref[t]) :(y_ref[t])) );
+				}
+			}
+			ok = ok && (ret == ret_ref) && ((ret == false) || ((min == min_ref) && (max == max_ref)));
+			ok = ok && (simd_count_greater<T>( a, size, (T)0 ) == simd_count_greater_scalar<T>( a, size, (T)0 ));
+			if (ok == false)
+			{
+				cerr << "simd mismatch: " << type_name << " " << simd_isa_name( (Simd_isa)isa ) << " size " << size << endl;
+				return false;
+			}
+		}
+	}
+	simd_set_isa( best );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return true;
+}	//end function: simd_check | const char *
+
+/****************************************************************************
+**	bench_simd | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Bytes of the largest array. Default 64M
+**	RETURN:
+**	DESCRIPTION:
+**	Arrays of 16K, 1M and 64M bytes: L1, L2 or L3, main memory
+****************************************************************************/
+
+int bench_simd( int argc, char *argv[] )
+{
+	//fast counter
+	size_t bytes;
+	size_t max_bytes = BENCH_TARGET_BYTES;
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes == 0)
+		{
+			cerr << "bad size: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	cout << "Best instruction set: " << simd_isa_name( simd_detect() ) << endl;
+	if ((simd_check<int>( "int" ) == false) || (simd_check<float>( "float" ) == false) || (simd_check<double>( "double" ) == false))
+	{
+		return -1;
+	}
+	cout << "Check against scalar reference: OK" << endl;
+
+	bench_report_header();
+	for (bytes = 16 *1024;bytes <= max_bytes;bytes *= 64)
+	{
+		bench_simd_run<int>( "i32", bytes /sizeof(int) );
+		bench_simd_run<float>( "f32", bytes /sizeof(float) );
+		bench_simd_run<double>( "f64", bytes /sizeof(double) );
+	}
+
+	return 0;
+}	//end function: bench_simd | int, char *[]
+
+/****************************************************************************
+**	bench_simd_run | const char *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	type_name	prefix of the phase column
+**	RETURN:
+**	DESCRIPTION:
+**	Every kernel on every instruction set, same arrays
+****************************************************************************/
+
+template <typename T>
+void bench_simd_run( const char *type_name, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int isa, op, s, r;
+	size_t t;
+	int num_samples;
+	int num_reps;
+	uint64_t t0, t1;
+	double num_elem;
+	T min, max;
+	char phase[32];
+	static const char *op_names[] = { "sum", "minmax", "dot", "axpy", "count" };
+	//Bytes read and written per element by each kernel
+	static const double op_bytes[] = { 1.0, 1.0, 2.0, 3.0, 1.0 };
+	Simd_isa best = simd_detect();
+	vector<double> samples;
+	//volatile: the compiler can't see the scale is 1 and fold the scalar axpy
+	volatile int scale = 1;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<T> a( size ), b( size ), y( size );
+	for (t = 0;t < size;t++)
+	{
+		a[t] = (T)(int)(t %1000);
+		b[t] = (T)(int)(t %7);
+		y[t] = (T)0;
+	}
+	//The clobber in the loop covers only memory the compiler knows escaped
+	bench_keep( a.data() );
+	bench_keep( b.data() );
+	bench_keep( y.data() );
+	num_reps = (int)(BENCH_BATCH_BYTES /(size *sizeof(T)));
+	if (num_reps < 1)
+	{
+		num_reps = 1;
+	}
+	num_samples = bench_num_samples( (size_t)num_reps *size *sizeof(T) );
+	num_elem = (double)num_reps *(double)size;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (op = 0;op < 5;op++)
+	{
+		snprintf( phase, sizeof( phase ), "%s %s", type_name, op_names[op] );
+		for (isa = SIMD_SCALAR;isa <= best;isa++)
+		{
+			simd_set_isa( (Simd_isa)isa );
+			samples.clear();
+			for (s = 0;s < num_samples;s++)
+			{
+				t0 = bench_now_ns();
+				for (r = 0;r < num_reps;r++)
+				{
+					switch (op)
+					{
+						case 0:
+							bench_keep( simd_sum<T>( a.data(), size ) );
+							break;
+						case 1:
+							simd_min_max<T>( a.data(), size, min, max );
+							bench_keep( min );
+							bench_keep( max );
+							break;
+						case 2:
+							bench_keep( simd_dot<T>( a.data(), b.data(), size ) );
+							break;
+						case 3:
+							simd_scale_add<T>( y.data(), a.data(), (T)scale, size );
+							break;
+						default:
+							bench_keep( simd_count_greater<T>( a.data(), size, (T)500 ) );
+							break;
+					}
+					bench_clobber();
+				}
+				t1 = bench_now_ns();
+				samples.push_back( (double)(t1 -t0) /num_elem );
+			}
+			bench_report_row( simd_isa_name( (Simd_isa)isa ), size, phase, bench_stats( samples ), op_bytes[op] *sizeof(T) );
+		}
+	}
+	simd_set_isa( best );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_simd_run | const char *, size_t
+
+/****************************************************************************
+**	TRANSPOSE SUITE
+*****************************************************************************
+**	Square and non square arrays of int and double
+**		naive		double loop, read a row, write a column
+**		blocked		transpose() of transpose.h, tiles and SIMD micro blocks
+**		in_place	transpose_in_place(). Tiles for square arrays, cycle following otherwise
+**	GB/s counts each element read once and written once.
+**	blocked and in_place are checked against naive before measuring
+****************************************************************************/
+
+/****************************************************************************
+**	transpose_naive | const T *, T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	The reference, as anyone would write it first
+****************************************************************************/
+
+template <typename T>
+static void transpose_naive( const T *src, T *dst, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t r, c;
+
+	for (r = 0;r < rows;r++)
+	{
+		for (c = 0;c < cols;c++)
+		{
+			dst[c *rows +r] = src[r *cols +c];
+		}
+	}
+
+	return;
+}	//end function: transpose_naive | const T *, T *, size_t, size_t
+
+/****************************************************************************
+**	bench_transpose | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Side of the largest square array. Default 4096
+**	RETURN:
+**	DESCRIPTION:
+**	Sides 256, 1024, 4096: L2, L3, main memory for int.
+**	Each square comes with a non square array of about the same size, rows = side/2, cols = side*2 +3
+****************************************************************************/
+
+int bench_transpose( int argc, char *argv[] )
+{
+	//fast counter
+	size_t side;
+	size_t max_side = 4096;
+
+	if (argc >= 2)
+	{
+		max_side = bench_parse_size( argv[1] );
+		if (max_side == 0)
+		{
+			cerr << "bad side: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	cout << "Instruction set: " << simd_isa_name( simd_isa() ) << endl;
+	bench_report_header();
+	for (side = 256;side <= max_side;side *= 4)
+	{
+		bench_transpose_run<int>( "i32", side, side );
+		bench_transpose_run<int>( "i32", side /2, side *2 +3 );
+		bench_transpose_run<double>( "f64", side, side );
+		bench_transpose_run<double>( "f64", side /2, side *2 +3 );
+	}
+
+	return 0;
+}	//end function: bench_transpose | int, char *[]
+
+/****************************************************************************
+**	bench_transpose_run | const char *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	type_name	prefix of the phase column
+**	RETURN:
+**	DESCRIPTION:
+**	The phase column holds the type and the shape
+****************************************************************************/
+
+template <typename T>
+void bench_transpose_run( const char *type_name, size_t rows, size_t cols )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	size_t num = rows *cols;
+	char phase[32];
+	vector<double> t_naive, t_blocked, t_in_place;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<T> src( num ), dst( num ), ref( num );
+	for (t = 0;t < num;t++)
+	{
+		src[t] = (T)(int)t;
+	}
+	bench_keep( src.data() );
+	bench_keep( dst.data() );
+	bench_keep( ref.data() );
+	snprintf( phase, sizeof( phase ), "%s %zux%zu", type_name, rows, cols );
+	num_samples = bench_num_samples( 2 *num *sizeof(T) );
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	transpose_naive( src.data(), ref.data(), rows, cols );
+	transpose( src.data(), dst.data(), rows, cols );
+	if (memcmp( dst.data(), ref.data(), num *sizeof(T) ) != 0)
+	{
+		cerr << "transpose mismatch " << phase << endl;
+		exit(-1);
+	}
+	memcpy( dst.data(), src.data(), num *sizeof(T) );
+	transpose_in_place( dst.data(), rows, cols );
+	if (memcmp( dst.data(), ref.data(), num *sizeof(T) ) != 0)
+	{
+		cerr << "transpose_in_place mismatch " << phase << endl;
+		exit(-1);
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		transpose_naive( src.data(), dst.data(), rows, cols );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_naive.push_back( (double)(t1 -t0) /(double)num );
+
+		t0 = bench_now_ns();
+		transpose( src.data(), dst.data(), rows, cols );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_blocked.push_back( (double)(t1 -t0) /(double)num );
+
+		//Transposing back and forth keeps the shape of the array the same for every sample
+		t0 = bench_now_ns();
+		transpose_in_place( dst.data(), cols, rows );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_in_place.push_back( (double)(t1 -t0) /(double)num );
+	}
+
+	bench_report_row( "naive", num, phase, bench_stats( t_naive ), 2 *sizeof(T) );
+	bench_report_row( "blocked", num, phase, bench_stats( t_blocked ), 2 *sizeof(T) );
+	bench_report_row( "in_place", num, phase, bench_stats( t_in_place ), 2 *sizeof(T) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_transpose_run | const char *, size_t, size_t
+
+/****************************************************************************
+**	GEMM SUITE
+*****************************************************************************
+**	C = A*B with square matrices of int, float and double, side from 64 up
+**		naive	triple loop i, j, k. Reads B by columns
+**		gemm	gemm() of gemm.h. Packed panels, SIMD micro kernel, threads over tiles of C
+**	GFLOP/s counts 2*side^3 operations, a multiply and an add, for int as well.
+**	gemm is checked against naive before measuring: bit exact for int, within rounding for float and double
+****************************************************************************/
+
+/****************************************************************************
+**	gemm_naive | const T *, const T *, T *, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	The reference. int is summed as unsigned, same wrap around as gemm
+****************************************************************************/
+
+template <typename T>
+static void gemm_naive( const T *a, const T *b, T *c, size_t m, size_t n, size_t k )
+{
+	typedef typename Gemm_lane<T>::type U;
+	//fast counters
+	size_t i, j, p;
+	U acc;
+
+	for (i = 0;i < m;i++)
+	{
+		for (j = 0;j < n;j++)
+		{
+			acc = U();
+			for (p = 0;p < k;p++)
+			{
+				acc += (U)a[i *k +p] *(U)b[p *n +j];
+			}
+			c[i *n +j] = (T)acc;
+		}
+	}
+
+	return;
+}	//end function: gemm_naive | const T *, const T *, T *, size_t, size_t, size_t
+
+/****************************************************************************
+**	gemm_fill | T *, size_t, uint32_t &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Small pseudo random values in [-8, 8]. Large enough that int wraps on long sums
+****************************************************************************/
+
+template <typename T>
+static void gemm_fill( T *a, size_t size, uint32_t &seed )
+{
+	//fast counter
+	size_t t;
+
+	for (t = 0;t < size;t++)
+	{
+		seed = seed *1664525 +1013904223;
+		a[t] = (T)((int)(seed >> 24) %17 -8);
+	}
+
+	return;
+}	//end function: gemm_fill | T *, size_t, uint32_t &
+
+/****************************************************************************
+**	gemm_check | const char *, size_t, size_t, size_t, unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	false and a message on the first mismatch
+**	DESCRIPTION:
+**	Float error grows with k: the tolerance is relative to the sum of the magnitudes of the products
+****************************************************************************/
+
+template <typename T>
+static bool gemm_check( const char *type_name, size_t m, size_t n, size_t k, unsigned int num_threads )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	uint32_t seed = 12345;
+	double diff;
+	//Products of values in [-8, 8] are at most 64
+	double tolerance = (std::numeric_limits<T>::is_integer == true) ?(0.0) :(64.0 *(double)k *(double)std::numeric_limits<T>::epsilon() *4.0);
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<T> a( m *k ), b( k *n ), c( m *n, (T)1 ), ref( m *n );
+	gemm_fill( a.data(), m *k, seed );
+	gemm_fill( b.data(), k *n, seed );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	gemm_naive( a.data(), b.data(), ref.data(), m, n, k );
+	gemm( a.data(), b.data(), c.data(), m, n, k, num_threads );
+	for (t = 0;t < m *n;t++)
+	{
+		diff = (double)c[t] -(double)ref[t];
+		if ((diff > tolerance) || (-diff > tolerance))
+		{
+			cerr << "gemm mismatch " << type_name << " " << simd_isa_name( simd_isa() ) << " " << m << "x" << n << "x" << k << " at " << t << ": " << c[t] << " != " << ref[t] << endl;
+			return false;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return true;
+}	//end function: gemm_check | const char *, size_t, size_t, size_t, unsigned int
+
+/****************************************************************************
+**	bench_gemm | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Side of the largest matrix. Default 2048, up to 8192 takes minutes
+**	argv[2] optional. Threads of gemm. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+**	First checks shapes that hit every edge case of the tiles on every instruction set,
+**	then measures on the best instruction set
+****************************************************************************/
+
+int bench_gemm( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//m, n, k. Partial micro tiles, partial tiles of C, more than one slice of k
+	static const size_t shapes[][3] =
+	{
+		{ 1, 1, 1 }, { 7, 5, 3 }, { 67, 45, 33 }, { GEMM_MC +1, GEMM_NC +1, GEMM_KC +1 }, { 200, 2 *GEMM_NC +3, 2 *GEMM_KC +5 }
+	};
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t side, t;
+	int isa;
+	size_t max_side = 2048;
+	unsigned int num_threads = std::thread::hardware_concurrency();
+	bool ok = true;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_side = bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[2] );
+	}
+	if ((max_side == 0) || (num_threads == 0))
+	{
+		cerr << "bad arguments" << endl;
+		return -1;
+	}
+
+	for (isa = SIMD_SCALAR;isa <= (int)simd_detect();isa++)
+	{
+		simd_set_isa( (Simd_isa)isa );
+		for (t = 0;t < sizeof( shapes ) /sizeof( shapes[0] );t++)
+		{
+			ok = ok && gemm_check<int>( "i32", shapes[t][0], shapes[t][1], shapes[t][2], num_threads );
+			ok = ok && gemm_check<float>( "f32", shapes[t][0], shapes[t][1], shapes[t][2], num_threads );
+			ok = ok && gemm_check<double>( "f64", shapes[t][0], shapes[t][1], shapes[t][2], num_threads );
+		}
+	}
+	simd_set_isa( simd_detect() );
+	if (ok == false)
+	{
+		return -1;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << "Instruction set: " << simd_isa_name( simd_isa() ) << " | Threads: " << num_threads << endl;
+	cout << std::left;
+	cout << std::setw(10) << "strategy" << " | ";
+	cout << std::setw(12) << "phase" << " | ";
+	cout << std::setw(11) << "p10 GFLOP/s" << " | ";
+	cout << std::setw(11) << "med GFLOP/s" << " | ";
+	cout << "p90 GFLOP/s" << endl;
+	cout << std::right;
+	for (side = 64;side <= max_side;side *= 2)
+	{
+		bench_gemm_run<int>( "i32", side, num_threads );
+		bench_gemm_run<float>( "f32", side, num_threads );
+		bench_gemm_run<double>( "f64", side, num_threads );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_gemm | int, char *[]
+
+/****************************************************************************
+**	bench_gemm_run | const char *, size_t, unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	type_name	prefix of the phase column
+**	RETURN:
+**	DESCRIPTION:
+**	Sides up to BENCH_GEMM_NAIVE_MAX also run naive, and gemm is checked against it
+****************************************************************************/
+
+template <typename T>
+void bench_gemm_run( const char *type_name, size_t side, unsigned int num_threads )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int s, r;
+	int num_samples;
+	uint64_t t0, t1;
+	size_t num = side *side;
+	double flops = 2.0 *(double)side *(double)side *(double)side;
+	bool run_naive = (side <= BENCH_GEMM_NAIVE_MAX);
+	uint32_t seed = 54321;
+	char phase[32];
+	Bench_stats stats;
+	vector<double> t_naive, t_gemm;
+	const char *strategies[] = { "naive", "gemm" };
+	vector<double> *samples[] = { &t_naive, &t_gemm };
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<T> a( num ), b( num ), c( num ), ref( num );
+	gemm_fill( a.data(), num, seed );
+	gemm_fill( b.data(), num, seed );
+	bench_keep( a.data() );
+	bench_keep( b.data() );
+	bench_keep( c.data() );
+	bench_keep( ref.data() );
+	snprintf( phase, sizeof( phase ), "%s %zu", type_name, side );
+	num_samples = (int)(BENCH_GEMM_TARGET_FLOPS /flops);
+	num_samples = (num_samples < BENCH_MIN_SAMPLES) ?(BENCH_MIN_SAMPLES) :(num_samples);
+	num_samples = (num_samples > BENCH_MAX_SAMPLES) ?(BENCH_MAX_SAMPLES) :(num_samples);
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		if (run_naive == true)
+		{
+			t0 = bench_now_ns();
+			gemm_naive( a.data(), b.data(), ref.data(), side, side, side );
+			bench_clobber();
+			t1 = bench_now_ns();
+			t_naive.push_back( flops /(double)(t1 -t0) );
+		}
+
+		t0 = bench_now_ns();
+		gemm( a.data(), b.data(), c.data(), side, side, side, num_threads );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_gemm.push_back( flops /(double)(t1 -t0) );
+	}
+	//Products of values in [-8, 8]: float sums are exact as long as they stay below 2^24
+	if ((run_naive == true) && (memcmp( c.data(), ref.data(), num *sizeof(T) ) != 0))
+	{
+		cerr << "gemm mismatch " << phase << endl;
+		exit(-1);
+	}
+
+	for (r = 0;r < 2;r++)
+	{
+		if (samples[r]->empty() == true)
+		{
+			continue;
+		}
+		stats = bench_stats( *samples[r] );
+		cout << std::left << std::fixed << std::setprecision(2);
+		cout << std::setw(10) << strategies[r] << " | ";
+		cout << std::setw(12) << phase << " | ";
+		cout << std::setw(11) << stats.p10 << " | ";
+		cout << std::setw(11) << stats.median << " | ";
+		cout << stats.p90 << endl;
+		cout << std::right;
+		cout.unsetf( std::ios::floatfield );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_gemm_run | const char *, size_t, unsigned int
+
+/****************************************************************************
+**	PARALLEL SUITE
+*****************************************************************************
+**	The same pass over an int array on one thread and on the thread pool
+**		for			x = x*3 +1 in place
+**		reduce		sum into int64
+**		reduce_det	sum into int64, deterministic chunks
+**		transform	float copy scaled by 0.5
+**	The pool is started before measuring. Small arrays show the cost of waking it
+****************************************************************************/
+
+/****************************************************************************
+**	bench_parallel | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest array in bytes. Default BENCH_PARALLEL_MAX_BYTES
+**	argv[2] optional. Threads of the pool. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_parallel( int argc, char *argv[] )
+{
+	//fast counter
+	size_t bytes;
+	size_t max_bytes = BENCH_PARALLEL_MAX_BYTES;
+	unsigned int num_threads = 0;
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[2] );
+		if (num_threads == 0)
+		{
+			cerr << "bad threads: " << argv[2] << endl;
+			return -1;
+		}
+	}
+	if (max_bytes == 0)
+	{
+		cerr << "bad size: " << argv[1] << endl;
+		return -1;
+	}
+
+	ThreadPool pool( num_threads );
+	cout << "Threads: " << pool.size() << endl;
+	bench_report_header();
+	for (bytes = 64 *1024;bytes <= max_bytes;bytes *= 16)
+	{
+		bench_parallel_run( pool, bytes /sizeof(int) );
+	}
+
+	return 0;
+}	//end function: bench_parallel | int, char *[]
+
+/****************************************************************************
+**	bench_parallel_run | ThreadPool &, size_t
+*****************************************************************************
+**	PARAMETER:
+**	size		elements of the array
+**	RETURN:
+**	DESCRIPTION:
+**	Results of the pool are checked against the single thread ones
+****************************************************************************/
+
+void bench_parallel_run( ThreadPool &pool, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	int64_t sum_serial = 0, sum_pool = 0, sum_det = 0;
+	vector<double> t_for_serial, t_for_pool, t_sum_serial, t_sum_pool, t_sum_det, t_tr_serial, t_tr_pool;
+	Parallel_options options( 0, false, &pool );
+	Parallel_options options_det( 0, true, &pool );
+	auto step = []( int &x ) { x = x *3 +1; };
+	auto add = []( int64_t acc, int64_t x ) { return acc +x; };
+	auto half = []( int x ) { return (float)x *0.5f; };
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<int> a( size );
+	AlignedArray<float> f( size ), f_ref( size );
+	storage_init( a.data(), size );
+	bench_keep( a.data() );
+	bench_keep( f.data() );
+	bench_keep( f_ref.data() );
+	num_samples = bench_num_samples( 2 *size *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		for (t = 0;t < size;t++)
+		{
+			step( a[t] );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_for_serial.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		parallel_for( a, step, options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_for_pool.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		sum_serial = 0;
+		for (t = 0;t < size;t++)
+		{
+			sum_serial += a[t];
+		}
+		bench_keep( sum_serial );
+		t1 = bench_now_ns();
+		t_sum_serial.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		sum_pool = parallel_reduce( a, (int64_t)0, add, options );
+		bench_keep( sum_pool );
+		t1 = bench_now_ns();
+		t_sum_pool.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		sum_det = parallel_reduce( a, (int64_t)0, add, options_det );
+		bench_keep( sum_det );
+		t1 = bench_now_ns();
+		t_sum_det.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		for (t = 0;t < size;t++)
+		{
+			f_ref[t] = half( a[t] );
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_tr_serial.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		parallel_transform( a, f, half, options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_tr_pool.push_back( (double)(t1 -t0) /(double)size );
+	}
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if ((sum_pool != sum_serial) || (sum_det != sum_serial) || (memcmp( f.data(), f_ref.data(), size *sizeof(float) ) != 0))
+	{
+		cerr << "parallel mismatch " << size << endl;
+		exit(-1);
+	}
+
+	bench_report_row( "serial", size, "for", bench_stats( t_for_serial ), 2 *sizeof(int) );
+	bench_report_row( "pool", size, "for", bench_stats( t_for_pool ), 2 *sizeof(int) );
+	bench_report_row( "serial", size, "reduce", bench_stats( t_sum_serial ), sizeof(int) );
+	bench_report_row( "pool", size, "reduce", bench_stats( t_sum_pool ), sizeof(int) );
+	bench_report_row( "pool", size, "reduce_det", bench_stats( t_sum_det ), sizeof(int) );
+	bench_report_row( "serial", size, "transform", bench_stats( t_tr_serial ), sizeof(int) +sizeof(float) );
+	bench_report_row( "pool", size, "transform", bench_stats( t_tr_pool ), sizeof(int) +sizeof(float) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_parallel_run | ThreadPool &, size_t
+
+/****************************************************************************
+**	STEAL SUITE
+*****************************************************************************
+**	A rows x cols float array where the cost of a row depends on its index.
+**	The first rows cost BENCH_STEAL_SKEW passes, cost falls to one pass at the end, as the rows
+**	of a triangular or sparse matrix do
+**		serial		one thread
+**		static		one chunk of rows per thread, as one would split the loop by hand
+**		dynamic		parallel_for_range of parallel.h, a few equal chunks per thread
+**		steal		parallel_for_rows of work_stealing.h
+**	Each strategy runs on its own copy of the array. The copies are compared at the end
+****************************************************************************/
+
+/****************************************************************************
+**	steal_row_kernel | size_t, float *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	A few arithmetic passes over a row. Passes decrease from BENCH_STEAL_SKEW to 1 with the square of the row
+****************************************************************************/
+
+static inline void steal_row_kernel( size_t row, float *row_data, size_t cols, size_t num_rows )
+{
+	//fast counters
+	size_t pass, c;
+	double left = (double)(num_rows -row) /(double)num_rows;
+	size_t num_passes = 1 +(size_t)((BENCH_STEAL_SKEW -1) *left *left);
+
+	for (pass = 0;pass < num_passes;pass++)
+	{
+		for (c = 0;c < cols;c++)
+		{
+			row_data[c] = row_data[c] *0.999f +1.0f;
+		}
+	}
+
+	return;
+}	//end function: steal_row_kernel | size_t, float *, size_t, size_t
+
+/****************************************************************************
+**	bench_steal | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1], argv[2] optional. Rows and columns. Default 4096 x 1024
+**	argv[3] optional. Threads of the pool. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+**	ns/el counts every element once, whatever the number of passes over its row
+****************************************************************************/
+
+int bench_steal( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t, r;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	size_t rows = 4096;
+	size_t cols = 1024;
+	unsigned int num_threads = 0;
+	char phase[32];
+	vector<double> samples[4];
+	const char *strategies[] = { "serial", "static", "dynamic", "steal" };
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 3)
+	{
+		rows = bench_parse_size( argv[1] );
+		cols = bench_parse_size( argv[2] );
+	}
+	if (argc >= 4)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[3] );
+		if (num_threads == 0)
+		{
+			cerr << "bad threads: " << argv[3] << endl;
+			return -1;
+		}
+	}
+	if ((rows == 0) || (cols == 0))
+	{
+		cerr << "bad arguments" << endl;
+		return -1;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	ThreadPool pool( num_threads );
+	//Static: exactly one chunk per thread
+	Parallel_options options_static( (rows +pool.size() -1) /pool.size(), false, &pool );
+	Parallel_options options_dynamic( 0, false, &pool );
+	Parallel_options options_steal( 0, false, &pool );
+	vector<AlignedArray<float>> copies;
+	for (t = 0;t < 4;t++)
+	{
+		copies.push_back( AlignedArray<float>( rows *cols, 1.0f ) );
+		bench_keep( copies[t].data() );
+	}
+	//Every sample does rows *cols *average passes of work
+	num_samples = bench_num_samples( rows *cols *sizeof(float) *BENCH_STEAL_SKEW /3 );
+	snprintf( phase, sizeof( phase ), "%zux%zu", rows, cols );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << "Threads: " << pool.size() << " | Cost of the first row: " << BENCH_STEAL_SKEW << " x the last" << endl;
+	for (s = 0;s < num_samples;s++)
+	{
+		for (t = 0;t < 4;t++)
+		{
+			float *data = copies[t].data();
+			auto rows_fn = [&]( size_t row_begin, size_t row_end )
+			{
+				//fast counter
+				size_t r;
+
+				for (r = row_begin;r < row_end;r++)
+				{
+					steal_row_kernel( r, data +r *cols, cols, rows );
+				}
+			};
+			t0 = bench_now_ns();
+			if (t == 0)
+			{
+				rows_fn( 0, rows );
+			}
+			else if (t == 1)
+			{
+				parallel_for_range( 0, rows, rows_fn, options_static );
+			}
+			else if (t == 2)
+			{
+				parallel_for_range( 0, rows, rows_fn, options_dynamic );
+			}
+			else
+			{
+				parallel_for_rows( copies[t].view( rows, cols ), [&]( size_t row, StridedSpan<float> elements )
+				{
+					steal_row_kernel( row, &elements[0], elements.size(), rows );
+				}, options_steal );
+			}
+			bench_clobber();
+			t1 = bench_now_ns();
+			samples[t].push_back( (double)(t1 -t0) /(double)(rows *cols) );
+		}
+	}
+	for (t = 1;t < 4;t++)
+	{
+		for (r = 0;r < rows *cols;r++)
+		{
+			if (copies[t][r] != copies[0][r])
+			{
+				cerr << strategies[t] << " mismatch at " << r << endl;
+				return -1;
+			}
+		}
+	}
+
+	bench_report_header();
+	for (t = 0;t < 4;t++)
+	{
+		bench_report_row( strategies[t], rows *cols, phase, bench_stats( samples[t] ), sizeof(float) );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_steal | int, char *[]
+
+/****************************************************************************
+**	MMAP SUITE
+*****************************************************************************
+**	A file of ints, in the page cache after the first sample
+**		read		AlignedArray of the size of the file, filled by read()
+**		mmap		MappedArray, MAPPED_READ_ONLY, advise( MAPPED_SEQUENTIAL )
+**		populate	MappedArray, advise( MAPPED_WILLNEED ) before the sum
+**	Phases
+**		load		from open to the first element available
+**		load+sum	same, plus a sum of all the elements. Mapping pays its page faults here
+**	Peak memory is not measured: read uses the page cache plus the array, mmap only the page cache
+****************************************************************************/
+
+/****************************************************************************
+**	bench_mmap | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Bytes of the file. Default BENCH_MMAP_BYTES
+**	argv[2] optional. Path of the file. Default /tmp/bench_mmap.bin. Removed at the end
+**	RETURN:
+**	DESCRIPTION:
+**	The file is written through a read-write MappedArray, which also exercises flush()
+****************************************************************************/
+
+int bench_mmap( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1, t2;
+	size_t bytes = BENCH_MMAP_BYTES;
+	std::string path = "/tmp/bench_mmap.bin";
+	size_t size;
+	int64_t sum_ref = 0;
+	int64_t sum;
+	int fd;
+	ssize_t ret;
+	size_t done;
+	vector<double> load[3], total[3];
+	const char *strategies[] = { "read", "mmap", "populate" };
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		bytes = bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		path = argv[2];
+	}
+	size = bytes /sizeof(int);
+	if (size == 0)
+	{
+		cerr << "bad size" << endl;
+		return -1;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	try
+	{
+		MappedArray<int> file( path, size, true );
+		storage_init( file.data(), size );
+		for (t = 0;t < size;t++)
+		{
+			sum_ref += file[t];
+		}
+		if (file.flush() == false)
+		{
+			cerr << "msync failed" << endl;
+			return -1;
+		}
+	}
+	catch (const std::system_error &error)
+	{
+		cerr << error.what() << endl;
+		return -1;
+	}
+	num_samples = bench_num_samples( bytes );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		//read(): allocate, copy everything, then use
+		t0 = bench_now_ns();
+		{
+			AlignedArray<int> array( size );
+			fd = open( path.c_str(), O_RDONLY );
+			done = 0;
+			while (done < bytes)
+			{
+				ret = read( fd, (char *)array.data() +done, bytes -done );
+				if (ret <= 0)
+				{
+					break;
+				}
+				done += (size_t)ret;
+			}
+			close( fd );
+			bench_keep( array.data() );
+			t1 = bench_now_ns();
+			sum = storage_read_sequential( array.data(), size );
+			bench_keep( sum );
+			t2 = bench_now_ns();
+		}
+		if (done != bytes)
+		{
+			cerr << "read failed" << endl;
+			return -1;
+		}
+		load[0].push_back( (double)(t1 -t0) /(double)size );
+		total[0].push_back( (double)(t2 -t0) /(double)size );
+
+		//mmap: pages are faulted in by the sum
+		for (t = 1;t < 3;t++)
+		{
+			t0 = bench_now_ns();
+			{
+				MappedArray<int> array( path );
+				array.advise( (t == 1) ?(MAPPED_SEQUENTIAL) :(MAPPED_WILLNEED) );
+				bench_keep( array.data() );
+				t1 = bench_now_ns();
+				sum = storage_read_sequential( array.data(), size );
+				bench_keep( sum );
+				t2 = bench_now_ns();
+			}
+			load[t].push_back( (double)(t1 -t0) /(double)size );
+			total[t].push_back( (double)(t2 -t0) /(double)size );
+		}
+	}
+	//storage_read_sequential sums into int: compare modulo 2^32
+	if ((int)sum != (int)sum_ref)
+	{
+		cerr << "mmap sum mismatch" << endl;
+		return -1;
+	}
+	unlink( path.c_str() );
+
+	bench_report_header();
+	for (t = 0;t < 3;t++)
+	{
+		bench_report_row( strategies[t], size, "load", bench_stats( load[t] ), sizeof(int) );
+		bench_report_row( strategies[t], size, "load+sum", bench_stats( total[t] ), sizeof(int) );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_mmap | int, char *[]
+
+/****************************************************************************
+**	ARRAYFILE SUITE
+*****************************************************************************
+**	An int array written to a file and read back, page cache only, no fsync
+**		stdio		fwrite of the whole array, fread of the whole file into a heap array, then sum
+**		arrayfile	ArrayFileWriter fed BENCH_ARRAYFILE_PIECE elements at a time,
+**					ArrayFileReader::next_chunk summed chunk by chunk. Memory is one chunk
+**	Both include the header and padding of their format: none for stdio
+****************************************************************************/
+
+/****************************************************************************
+**	bench_arrayfile | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Bytes of the array. Default BENCH_MMAP_BYTES
+**	argv[2] optional. Path of the file. Default /tmp/bench_arrayfile.bin. Removed at the end
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_arrayfile( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	size_t bytes = BENCH_MMAP_BYTES;
+	std::string path = "/tmp/bench_arrayfile.bin";
+	size_t size;
+	int sum_ref;
+	int sum;
+	FILE *file;
+	bool ok = true;
+	vector<double> t_write[2], t_read[2];
+	const char *strategies[] = { "stdio", "arrayfile" };
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		bytes = bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		path = argv[2];
+	}
+	size = bytes /sizeof(int);
+	if (size == 0)
+	{
+		cerr << "bad size" << endl;
+		return -1;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<int> src( size );
+	storage_init( src.data(), size );
+	sum_ref = storage_read_sequential( src.data(), size );
+	bench_keep( src.data() );
+	num_samples = bench_num_samples( 2 *bytes );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	try
+	{
+		for (s = 0;s < num_samples;s++)
+		{
+			//stdio
+			t0 = bench_now_ns();
+			file = fopen( path.c_str(), "wb" );
+			ok = ok && (file != NULL) && (fwrite( src.data(), sizeof(int), size, file ) == size);
+			ok = (file != NULL) && (fclose( file ) == 0) && ok;
+			t1 = bench_now_ns();
+			t_write[0].push_back( (double)(t1 -t0) /(double)size );
+
+			t0 = bench_now_ns();
+			{
+				AlignedArray<int> dst( size );
+				file = fopen( path.c_str(), "rb" );
+				ok = ok && (file != NULL) && (fread( dst.data(), sizeof(int), size, file ) == size);
+				if (file != NULL)
+				{
+					fclose( file );
+				}
+				bench_keep( dst.data() );
+				sum = storage_read_sequential( dst.data(), size );
+				bench_keep( sum );
+			}
+			t1 = bench_now_ns();
+			t_read[0].push_back( (double)(t1 -t0) /(double)size );
+			ok = ok && (sum == sum_ref);
+
+			//arrayfile
+			t0 = bench_now_ns();
+			{
+				ArrayFileWriter<int> writer( path, { (uint64_t)size } );
+				for (t = 0;t < size;t += BENCH_ARRAYFILE_PIECE)
+				{
+					writer.write( src.data() +t, std::min( (size_t)BENCH_ARRAYFILE_PIECE, size -t ) );
+				}
+				writer.close();
+			}
+			t1 = bench_now_ns();
+			t_write[1].push_back( (double)(t1 -t0) /(double)size );
+
+			t0 = bench_now_ns();
+			{
+				ArrayFileReader<int> reader( path );
+				sum = 0;
+				for (Span<const int> chunk = reader.next_chunk();chunk.empty() == false;chunk = reader.next_chunk())
+				{
+					sum += storage_read_sequential( chunk.data(), chunk.size() );
+				}
+				bench_keep( sum );
+			}
+			t1 = bench_now_ns();
+			t_read[1].push_back( (double)(t1 -t0) /(double)size );
+			ok = ok && (sum == sum_ref);
+		}
+	}
+	catch (const std::exception &error)
+	{
+		cerr << error.what() << endl;
+		ok = false;
+	}
+	unlink( path.c_str() );
+	if (ok == false)
+	{
+		cerr << "arrayfile failed" << endl;
+		return -1;
+	}
+
+	bench_report_header();
+	for (t = 0;t < 2;t++)
+	{
+		bench_report_row( strategies[t], size, "write", bench_stats( t_write[t] ), sizeof(int) );
+		bench_report_row( strategies[t], size, "read+sum", bench_stats( t_read[t] ), sizeof(int) );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_arrayfile | int, char *[]
+
+/****************************************************************************
+**	SMALLVEC SUITE
+*****************************************************************************
+**	A cycle makes a vector, pushes size ints one by one, copies it, sums the copy, drops both
+**		vector			std::vector<int>
+**		vec_reserve		std::vector<int>, reserve( size ) first: a single allocation per vector
+**		small_vector	SmallVector<int,BENCH_SMALLVEC_N>. No allocation up to N elements
+**	Sizes go past N, where SmallVector moves to the heap
+**	ns/el is per pushed element, alloc and free included
+****************************************************************************/
+
+/****************************************************************************
+**	bench_smallvec | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_smallvec( int argc, char *argv[] )
+{
+	//fast counter
+	size_t size;
+
+	(void)argc;
+	(void)argv;
+	cout << "SmallVector inline capacity: " << BENCH_SMALLVEC_N << endl;
+	bench_report_header();
+	for (size = 2;size <= 8 *BENCH_SMALLVEC_N;size *= 2)
+	{
+		bench_smallvec_run<vector<int>>( "vector", size );
+		bench_smallvec_run<vector<int>>( "vec_reserve", size );
+		bench_smallvec_run<SmallVector<int, BENCH_SMALLVEC_N>>( "small_vector", size );
+	}
+
+	return 0;
+}	//end function: bench_smallvec | int, char *[]
+
+/****************************************************************************
+**	bench_smallvec_run | const char *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	strategy	"vec_reserve" reserves before pushing
+**	RETURN:
+**	DESCRIPTION:
+**	V has push_back, reserve, data, size and a copy constructor
+****************************************************************************/
+
+template <typename V>
+static void bench_smallvec_run( const char *strategy, size_t size )
+{
+	//fast counters
+	size_t cycle, t;
+	int s;
+	int num_samples = BENCH_MAX_SAMPLES;
+	uint64_t t0, t1;
+	bool do_reserve = (strcmp( strategy, "vec_reserve" ) == 0);
+	int check = 0;
+	vector<double> samples;
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		for (cycle = 0;cycle < BENCH_SMALLVEC_CYCLES;cycle++)
+		{
+			V my_vector;
+			if (do_reserve == true)
+			{
+				my_vector.reserve( size );
+			}
+			for (t = 0;t < size;t++)
+			{
+				my_vector.push_back( (int)(t +cycle) );
+			}
+			bench_keep( my_vector.data() );
+			V my_copy( my_vector );
+			bench_keep( my_copy.data() );
+			check += storage_read_sequential( my_copy.data(), my_copy.size() );
+		}
+		t1 = bench_now_ns();
+		samples.push_back( (double)(t1 -t0) /(double)(BENCH_SMALLVEC_CYCLES *size) );
+	}
+	bench_keep( check );
+
+	bench_report_row( strategy, size, "push+copy", bench_stats( samples ), sizeof(int) );
+
+	return;
+}	//end function: bench_smallvec_run | const char *, size_t
+
+/****************************************************************************
+**	RADIX SUITE
+*****************************************************************************
+**	Sort of an int array, one row per strategy and distribution of the keys
+**		std::sort		introsort of the standard library
+**		radix			radix_sort, LSD on one thread
+**		radix_par		radix_sort_parallel on the pool
+**		kv_std			std::stable_sort of std::pair<int,int> by key
+**		kv_radix		radix_sort_pairs of int keys and int values
+**	DISTRIBUTIONS
+**		uniform			every 32 bit value equally likely
+**		skewed			magnitudes spread over powers of two: most keys are small, a few are huge
+**		nearly			sorted, then 1% of the elements swapped at random
+**	Each sample sorts a fresh copy of the same keys. The copy is not timed.
+**	Results of every strategy are checked against std::sort
+****************************************************************************/
+
+/****************************************************************************
+**	bench_radix | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest array in bytes. Default BENCH_RADIX_MAX_BYTES
+**	argv[2] optional. Threads of the pool. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_radix( int argc, char *argv[] )
+{
+	//fast counter
+	size_t size;
+	size_t max_bytes = BENCH_RADIX_MAX_BYTES;
+	unsigned int num_threads = 0;
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+	}
+	if (argc >= 3)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[2] );
+		if (num_threads == 0)
+		{
+			cerr << "bad threads: " << argv[2] << endl;
+			return -1;
+		}
+	}
+	if (max_bytes == 0)
+	{
+		cerr << "bad size: " << argv[1] << endl;
+		return -1;
+	}
+
+	ThreadPool pool( num_threads );
+	cout << "Threads: " << pool.size() << endl;
+	bench_report_header();
+	for (size = 1024;size *sizeof(int) <= max_bytes;size *= 16)
+	{
+		bench_radix_run( pool, size, "uniform" );
+		bench_radix_run( pool, size, "skewed" );
+		bench_radix_run( pool, size, "nearly" );
+	}
+
+	return 0;
+}	//end function: bench_radix | int, char *[]
+
+/****************************************************************************
+**	radix_fill | int *, size_t, const char *
+*****************************************************************************
+**	PARAMETER:
+**	distribution	"uniform", "skewed" or "nearly"
+**	RETURN:
+**	DESCRIPTION:
+**	Fixed seed: every run sorts the same keys
+****************************************************************************/
+
+static void radix_fill( int *array_arg, size_t size, const char *distribution )
+{
+	//fast counter
+	size_t t;
+	uint64_t x = 88172645463325252ULL;
+	uint32_t magnitude;
+
+	for (t = 0;t < size;t++)
+	{
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		if (strcmp( distribution, "uniform" ) == 0)
+		{
+			array_arg[t] = (int)(uint32_t)x;
+		}
+		else if (strcmp( distribution, "skewed" ) == 0)
+		{
+			//shift by 1..31: each power of two is as likely, whatever its width
+			magnitude = (uint32_t)x >> (1 +(x >> 59) %31);
+			array_arg[t] = ((x >> 58) & 1) ?(-(int)magnitude) :((int)magnitude);
+		}
+		else
+		{
+			array_arg[t] = (int)t;
+		}
+	}
+	if (strcmp( distribution, "nearly" ) == 0)
+	{
+		for (t = 0;t < size /100;t++)
+		{
+			x ^= x << 13;
+			x ^= x >> 7;
+			x ^= x << 17;
+			std::swap( array_arg[(x >> 32) %size], array_arg[(uint32_t)x %size] );
+		}
+	}
+
+	return;
+}	//end function: radix_fill | int *, size_t, const char *
+
+/****************************************************************************
+**	bench_radix_run | ThreadPool &, size_t, const char *
+*****************************************************************************
+**	PARAMETER:
+**	size			elements of the array
+**	distribution	see radix_fill
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+void bench_radix_run( ThreadPool &pool, size_t size, const char *distribution )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	bool ok = true;
+	vector<double> t_std, t_radix, t_par, t_kv_std, t_kv_radix;
+	Parallel_options options( 0, false, &pool );
+	vector<std::pair<int,int>> kv( size );
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<int> input( size ), ref( size ), work( size ), values( size );
+	radix_fill( input.data(), size, distribution );
+	memcpy( ref.data(), input.data(), size *sizeof(int) );
+	std::sort( ref.begin(), ref.end() );
+	num_samples = bench_num_samples( size *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		memcpy( work.data(), input.data(), size *sizeof(int) );
+		t0 = bench_now_ns();
+		std::sort( work.begin(), work.end() );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_std.push_back( (double)(t1 -t0) /(double)size );
+
+		memcpy( work.data(), input.data(), size *sizeof(int) );
+		t0 = bench_now_ns();
+		radix_sort( work.data(), size );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_radix.push_back( (double)(t1 -t0) /(double)size );
+		ok = ok && (memcmp( work.data(), ref.data(), size *sizeof(int) ) == 0);
+
+		memcpy( work.data(), input.data(), size *sizeof(int) );
+		t0 = bench_now_ns();
+		radix_sort_parallel( work.data(), size, options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_par.push_back( (double)(t1 -t0) /(double)size );
+		ok = ok && (memcmp( work.data(), ref.data(), size *sizeof(int) ) == 0);
+
+		//Value is the original position: a stable sort gives the same pairs
+		for (t = 0;t < size;t++)
+		{
+			kv[t] = std::pair<int,int>( input[t], (int)t );
+		}
+		t0 = bench_now_ns();
+		std::stable_sort( kv.begin(), kv.end(), []( const std::pair<int,int> &a, const std::pair<int,int> &b )
+		{
+			return (a.first < b.first);
+		} );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_kv_std.push_back( (double)(t1 -t0) /(double)size );
+
+		memcpy( work.data(), input.data(), size *sizeof(int) );
+		for (t = 0;t < size;t++)
+		{
+			values[t] = (int)t;
+		}
+		t0 = bench_now_ns();
+		radix_sort_pairs( work.data(), values.data(), size );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_kv_radix.push_back( (double)(t1 -t0) /(double)size );
+		for (t = 0;t < size;t++)
+		{
+			ok = ok && (work[t] == kv[t].first) && (values[t] == kv[t].second);
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (ok == false)
+	{
+		cerr << "radix mismatch " << distribution << " " << size << endl;
+		exit(-1);
+	}
+
+	bench_report_row( "std::sort", size, distribution, bench_stats( t_std ), sizeof(int) );
+	bench_report_row( "radix", size, distribution, bench_stats( t_radix ), sizeof(int) );
+	bench_report_row( "radix_par", size, distribution, bench_stats( t_par ), sizeof(int) );
+	bench_report_row( "kv_std", size, distribution, bench_stats( t_kv_std ), 2 *sizeof(int) );
+	bench_report_row( "kv_radix", size, distribution, bench_stats( t_kv_radix ), 2 *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_radix_run | ThreadPool &, size_t, const char *
+
+/****************************************************************************
+**	RING SUITE
+*****************************************************************************
+**	Elements go from producer threads to consumer threads through a queue of BENCH_RING_CAPACITY slots
+**		spsc			SpscRing, push and pop one element
+**		spsc_b32		SpscRing, push_n and pop_n of BENCH_RING_BATCH elements
+**		mpmc			MpmcRing, one element
+**		mpmc_b32		MpmcRing, batches
+**		mutex			the same ring with a std::mutex around each operation
+**	PHASES
+**		1p1c			one producer, one consumer. ns/el is the time per element through the queue
+**		2p2c			two producers, two consumers. MPMC and mutex only
+**		round_trip		one thread pushes on a queue, the other pops it and pushes it back on a second queue.
+**						ns/el is the time of one round trip, one element at a time
+**	Each thread is pinned to its own CPU, when there are enough CPUs. A thread that finds the queue full,
+**	or empty, yields: on a single CPU the other thread runs only then
+****************************************************************************/
+
+/****************************************************************************
+**	bench_ring | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Elements through the queue per sample. Default BENCH_RING_ITEMS
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_ring( int argc, char *argv[] )
+{
+	size_t num_items = BENCH_RING_ITEMS;
+	cpu_set_t cpus;
+
+	if (argc >= 2)
+	{
+		num_items = bench_parse_size( argv[1] );
+		if (num_items == 0)
+		{
+			cerr << "bad items: " << argv[1] << endl;
+			return -1;
+		}
+	}
+	CPU_ZERO( &cpus );
+	sched_getaffinity( 0, sizeof(cpus), &cpus );
+	cout << "CPUs: " << CPU_COUNT( &cpus ) << " | Capacity: " << BENCH_RING_CAPACITY << " | Batch: " << BENCH_RING_BATCH << endl;
+
+	bench_report_header();
+	bench_ring_run<SpscRing<uint64_t, BENCH_RING_CAPACITY>>( "spsc", num_items, 1, 1, 1 );
+	bench_ring_run<SpscRing<uint64_t, BENCH_RING_CAPACITY>>( "spsc_b32", num_items, BENCH_RING_BATCH, 1, 1 );
+	bench_ring_run<MpmcRing<uint64_t, BENCH_RING_CAPACITY>>( "mpmc", num_items, 1, 1, 1 );
+	bench_ring_run<MpmcRing<uint64_t, BENCH_RING_CAPACITY>>( "mpmc_b32", num_items, BENCH_RING_BATCH, 1, 1 );
+	bench_ring_run<RingMutexQueue<uint64_t, BENCH_RING_CAPACITY>>( "mutex", num_items, 1, 1, 1 );
+	bench_ring_run<MpmcRing<uint64_t, BENCH_RING_CAPACITY>>( "mpmc", num_items, 1, 2, 2 );
+	bench_ring_run<MpmcRing<uint64_t, BENCH_RING_CAPACITY>>( "mpmc_b32", num_items, BENCH_RING_BATCH, 2, 2 );
+	bench_ring_run<RingMutexQueue<uint64_t, BENCH_RING_CAPACITY>>( "mutex", num_items, 1, 2, 2 );
+	bench_ring_latency<SpscRing<uint64_t, BENCH_RING_CAPACITY>>( "spsc" );
+	bench_ring_latency<MpmcRing<uint64_t, BENCH_RING_CAPACITY>>( "mpmc" );
+	bench_ring_latency<RingMutexQueue<uint64_t, BENCH_RING_CAPACITY>>( "mutex" );
+
+	return 0;
+}	//end function: bench_ring | int, char *[]
+
+/****************************************************************************
+**	ring_pin | unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	index		thread number. Pinned to the index-th CPU the process may run on, modulo their number
+**	RETURN:
+**	DESCRIPTION:
+**	A thread the scheduler moves loses its caches, and two threads on one core take turns
+****************************************************************************/
+
+static void ring_pin( unsigned int index )
+{
+	//fast counter
+	int cpu;
+	cpu_set_t allowed;
+	cpu_set_t one;
+	unsigned int num;
+	unsigned int found = 0;
+
+	CPU_ZERO( &allowed );
+	if (sched_getaffinity( 0, sizeof(allowed), &allowed ) != 0)
+	{
+		return;
+	}
+	num = (unsigned int)CPU_COUNT( &allowed );
+	if (num == 0)
+	{
+		return;
+	}
+	index = index %num;
+	for (cpu = 0;cpu < CPU_SETSIZE;cpu++)
+	{
+		if (CPU_ISSET( cpu, &allowed ))
+		{
+			if (found == index)
+			{
+				CPU_ZERO( &one );
+				CPU_SET( cpu, &one );
+				pthread_setaffinity_np( pthread_self(), sizeof(one), &one );
+				return;
+			}
+			found++;
+		}
+	}
+
+	return;
+}	//end function: ring_pin | unsigned int
+
+/****************************************************************************
+**	ring_throughput | Q &, size_t, size_t, unsigned int, unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	batch		elements per push_n and pop_n. 1: push and pop
+**	RETURN:
+**	ns per element. Negative if the consumers did not get every element
+**	DESCRIPTION:
+**	Producers push 1..num_items split among them, consumers pop and sum until all are popped.
+**	Threads are started and pinned before the clock starts, they wait for a flag
+****************************************************************************/
+
+template <typename Q>
+static double ring_throughput( Q &queue, size_t num_items, size_t batch, unsigned int num_producers, unsigned int num_consumers )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	unsigned int t;
+	uint64_t t0, t1;
+	std::atomic<bool> go( false );
+	std::atomic<size_t> num_popped( 0 );
+	std::atomic<uint64_t> sum( 0 );
+	vector<std::thread> threads;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < num_producers;t++)
+	{
+		threads.push_back( std::thread( [&, t]()
+		{
+			//fast counters
+			size_t i, j;
+			size_t begin = num_items *t /num_producers;
+			size_t end = num_items *(t +1) /num_producers;
+			size_t num;
+			uint64_t buffer[BENCH_RING_BATCH];
+
+			ring_pin( t );
+			while (go.load( std::memory_order_acquire ) == false)
+			{
+				std::this_thread::yield();
+			}
+			for (i = begin;i < end;i += num)
+			{
+				if (batch == 1)
+				{
+					num = (queue.push( (uint64_t)(i +1) ) == true) ?(1) :(0);
+				}
+				else
+				{
+					for (j = 0;j < batch;j++)
+					{
+						buffer[j] = (uint64_t)(i +j +1);
+					}
+					num = queue.push_n( buffer, std::min( batch, end -i ) );
+				}
+				if (num == 0)
+				{
+					std::this_thread::yield();
+				}
+			}
+		} ) );
+	}
+	for (t = 0;t < num_consumers;t++)
+	{
+		threads.push_back( std::thread( [&, t]()
+		{
+			//fast counter
+			size_t j;
+			size_t num;
+			uint64_t acc = 0;
+			uint64_t buffer[BENCH_RING_BATCH];
+
+			ring_pin( num_producers +t );
+			while (go.load( std::memory_order_acquire ) == false)
+			{
+				std::this_thread::yield();
+			}
+			while (num_popped.load( std::memory_order_relaxed ) < num_items)
+			{
+				num = (batch == 1) ?((queue.pop( buffer[0] ) == true) ?(1) :(0)) :(queue.pop_n( buffer, batch ));
+				if (num == 0)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				for (j = 0;j < num;j++)
+				{
+					acc += buffer[j];
+				}
+				num_popped.fetch_add( num, std::memory_order_relaxed );
+			}
+			sum.fetch_add( acc );
+		} ) );
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	t0 = bench_now_ns();
+	go.store( true, std::memory_order_release );
+	for (t = 0;t < threads.size();t++)
+	{
+		threads[t].join();
+	}
+	t1 = bench_now_ns();
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	if (sum.load() != (uint64_t)num_items *(num_items +1) /2)
+	{
+		return -1.0;
+	}
+
+	return (double)(t1 -t0) /(double)num_items;
+}	//end function: ring_throughput | Q &, size_t, size_t, unsigned int, unsigned int
+
+/****************************************************************************
+**	ring_round_trip | Q &, Q &, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	ns per round trip. Negative if an element came back changed
+**	DESCRIPTION:
+**	One element in flight at a time: the time is the latency of the queue, not its throughput
+****************************************************************************/
+
+template <typename Q>
+static double ring_round_trip( Q &ping, Q &pong, size_t num_trips )
+{
+	//fast counter
+	size_t t;
+	uint64_t t0, t1;
+	uint64_t value = 0;
+	bool ok = true;
+	std::atomic<bool> go( false );
+	cpu_set_t caller_cpus;
+
+	CPU_ZERO( &caller_cpus );
+	pthread_getaffinity_np( pthread_self(), sizeof(caller_cpus), &caller_cpus );
+	std::thread echo( [&]()
+	{
+		//fast counter
+		size_t ti;
+		uint64_t element = 0;
+
+		ring_pin( 1 );
+		go.store( true, std::memory_order_release );
+		for (ti = 0;ti < num_trips;ti++)
+		{
+			while (ping.pop( element ) == false)
+			{
+				std::this_thread::yield();
+			}
+			while (pong.push( element +1 ) == false)
+			{
+				std::this_thread::yield();
+			}
+		}
+	} );
+	ring_pin( 0 );
+	while (go.load( std::memory_order_acquire ) == false)
+	{
+		std::this_thread::yield();
+	}
+
+	t0 = bench_now_ns();
+	for (t = 0;t < num_trips;t++)
+	{
+		ping.push( (uint64_t)t *2 );
+		while (pong.pop( value ) == false)
+		{
+			std::this_thread::yield();
+		}
+		ok = ok && (value == (uint64_t)t *2 +1);
+	}
+	t1 = bench_now_ns();
+	echo.join();
+	//The caller is the main thread: give it back its CPUs
+	pthread_setaffinity_np( pthread_self(), sizeof(caller_cpus), &caller_cpus );
+
+	return (ok == true) ?((double)(t1 -t0) /(double)num_trips) :(-1.0);
+}	//end function: ring_round_trip | Q &, Q &, size_t
+
+/****************************************************************************
+**	bench_ring_run | const char *, size_t, size_t, unsigned int, unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	A new queue per sample. Queues are locals: a ring is cache line aligned, which C++11 new ignores
+****************************************************************************/
+
+template <typename Q>
+static void bench_ring_run( const char *strategy, size_t num_items, size_t batch, unsigned int num_producers, unsigned int num_consumers )
+{
+	//fast counter
+	int s;
+	int num_samples = bench_num_samples( num_items *sizeof(uint64_t) );
+	double ns;
+	vector<double> samples;
+	char phase[16];
+
+	for (s = 0;s < num_samples;s++)
+	{
+		Q queue;
+		ns = ring_throughput( queue, num_items, batch, num_producers, num_consumers );
+		if (ns < 0.0)
+		{
+			cerr << "ring lost elements: " << strategy << endl;
+			exit(-1);
+		}
+		samples.push_back( ns );
+	}
+	snprintf( phase, sizeof(phase), "%up%uc", num_producers, num_consumers );
+	bench_report_row( strategy, num_items, phase, bench_stats( samples ), sizeof(uint64_t) );
+
+	return;
+}	//end function: bench_ring_run | const char *, size_t, size_t, unsigned int, unsigned int
+
+template <typename Q>
+static void bench_ring_latency( const char *strategy )
+{
+	//fast counter
+	int s;
+	double ns;
+	vector<double> samples;
+
+	for (s = 0;s < BENCH_MIN_SAMPLES;s++)
+	{
+		Q ping;
+		Q pong;
+		ns = ring_round_trip( ping, pong, BENCH_RING_TRIPS );
+		if (ns < 0.0)
+		{
+			cerr << "ring round trip changed an element: " << strategy << endl;
+			exit(-1);
+		}
+		samples.push_back( ns );
+	}
+	bench_report_row( strategy, BENCH_RING_TRIPS, "round_trip", bench_stats( samples ), sizeof(uint64_t) );
+
+	return;
+}	//end function: bench_ring_latency | const char *
+
+/****************************************************************************
+**	SOA SUITE
+*****************************************************************************
+**	Records of 8 fields, 32 bytes, as an array of Soa_particle (AoS) and as a SoA of 8 arrays
+**	PHASES
+**		sum_x		sum of the x of every record
+**						aos			loop over the records
+**						soa			loop over the array of x
+**						soa_proxy	loop over the records of the SoA, array[t].get<0>()
+**						soa_simd	simd_sum of simd.h on field<0>()
+**		x+=vx		x += vx of every record: two fields read, one written
+**		from_aos	SoA::from_aos of the AoS array, a pointer to member per field
+**		to_aos		SoA::to_aos back into an AoS array
+**	GB/s counts only the bytes of the fields used. The AoS loops load whole cache lines, 8 times as many for sum_x
+**	Fields hold small integers: sums are exact whatever the order, and the strategies are compared bit for bit
+****************************************************************************/
+
+/****************************************************************************
+**	bench_soa | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest AoS array in bytes. Default BENCH_SOA_MAX_BYTES
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_soa( int argc, char *argv[] )
+{
+	//fast counter
+	size_t size;
+	size_t max_bytes = BENCH_SOA_MAX_BYTES;
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes == 0)
+		{
+			cerr << "bad size: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	cout << "Record: " << sizeof(Soa_particle) << " bytes" << endl;
+	bench_report_header();
+	for (size = 4096;size *sizeof(Soa_particle) <= max_bytes;size *= 16)
+	{
+		bench_soa_run( size );
+	}
+
+	return 0;
+}	//end function: bench_soa | int, char *[]
+
+/****************************************************************************
+**	bench_soa_run | size_t
+*****************************************************************************
+**	PARAMETER:
+**	size		records
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+void bench_soa_run( size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	typedef SoA<float, float, float, float, float, float, int, int> Particles;
+	//fast counters
+	size_t t;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	float sum_aos = 0.0f, sum_soa = 0.0f, sum_proxy = 0.0f, sum_simd = 0.0f;
+	bool ok = true;
+	vector<double> t_sum_aos, t_sum_soa, t_sum_proxy, t_sum_simd, t_upd_aos, t_upd_soa, t_from, t_to;
+	Particles soa;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<Soa_particle> aos( size ), aos_back( size );
+	for (t = 0;t < size;t++)
+	{
+		aos[t].x = (float)(t & 7);
+		aos[t].y = (float)(t & 3);
+		aos[t].z = 1.0f;
+		aos[t].vx = 1.0f;
+		aos[t].vy = 0.0f;
+		aos[t].vz = -1.0f;
+		aos[t].id = (int)t;
+		aos[t].flags = 0;
+	}
+	num_samples = bench_num_samples( size *sizeof(Soa_particle) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		soa.from_aos( aos.data(), size, &Soa_particle::x, &Soa_particle::y, &Soa_particle::z, &Soa_particle::vx, &Soa_particle::vy, &Soa_particle::vz, &Soa_particle::id, &Soa_particle::flags );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_from.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		soa.to_aos( aos_back.data(), &Soa_particle::x, &Soa_particle::y, &Soa_particle::z, &Soa_particle::vx, &Soa_particle::vy, &Soa_particle::vz, &Soa_particle::id, &Soa_particle::flags );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_to.push_back( (double)(t1 -t0) /(double)size );
+	}
+	ok = ok && (memcmp( aos.data(), aos_back.data(), size *sizeof(Soa_particle) ) == 0);
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		sum_aos = 0.0f;
+		for (t = 0;t < size;t++)
+		{
+			sum_aos += aos[t].x;
+		}
+		bench_keep( sum_aos );
+		t1 = bench_now_ns();
+		t_sum_aos.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		const float *x = soa.data<0>();
+		sum_soa = 0.0f;
+		for (t = 0;t < size;t++)
+		{
+			sum_soa += x[t];
+		}
+		bench_keep( sum_soa );
+		t1 = bench_now_ns();
+		t_sum_soa.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		sum_proxy = 0.0f;
+		for (t = 0;t < size;t++)
+		{
+			sum_proxy += soa[t].get<0>();
+		}
+		bench_keep( sum_proxy );
+		t1 = bench_now_ns();
+		t_sum_proxy.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		sum_simd = simd_sum( soa.field<0>().data(), size );
+		bench_keep( sum_simd );
+		t1 = bench_now_ns();
+		t_sum_simd.push_back( (double)(t1 -t0) /(double)size );
+	}
+	ok = ok && (sum_soa == sum_aos) && (sum_proxy == sum_aos) && (sum_simd == sum_aos);
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		for (t = 0;t < size;t++)
+		{
+			aos[t].x += aos[t].vx;
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_upd_aos.push_back( (double)(t1 -t0) /(double)size );
+
+		t0 = bench_now_ns();
+		float *x = soa.data<0>();
+		const float *vx = soa.data<3>();
+		for (t = 0;t < size;t++)
+		{
+			x[t] += vx[t];
+		}
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_upd_soa.push_back( (double)(t1 -t0) /(double)size );
+	}
+	for (t = 0;t < size;t++)
+	{
+		ok = ok && (soa.get<0>( t ) == aos[t].x);
+	}
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (ok == false)
+	{
+		cerr << "soa mismatch " << size << endl;
+		exit(-1);
+	}
+
+	bench_report_row( "aos", size, "sum_x", bench_stats( t_sum_aos ), sizeof(float) );
+	bench_report_row( "soa", size, "sum_x", bench_stats( t_sum_soa ), sizeof(float) );
+	bench_report_row( "soa_proxy", size, "sum_x", bench_stats( t_sum_proxy ), sizeof(float) );
+	bench_report_row( "soa_simd", size, "sum_x", bench_stats( t_sum_simd ), sizeof(float) );
+	bench_report_row( "aos", size, "x+=vx", bench_stats( t_upd_aos ), 3 *sizeof(float) );
+	bench_report_row( "soa", size, "x+=vx", bench_stats( t_upd_soa ), 3 *sizeof(float) );
+	bench_report_row( "soa", size, "from_aos", bench_stats( t_from ), 2 *sizeof(Soa_particle) );
+	bench_report_row( "soa", size, "to_aos", bench_stats( t_to ), 2 *sizeof(Soa_particle) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_soa_run | size_t
+
+/****************************************************************************
+**	SPARSE SUITE
+*****************************************************************************
+**	y = A*x with A a square float matrix, elements not zero scattered at random, at several densities
+**		dense		simd_dot of simd.h of each row with x, rows split among the threads
+**		csr_scalar	the scalar CSR loop of sparse.h, one thread. The baseline of the gathers
+**		csr			sparse_spmv on CSR: gathers, rows split by work stealing
+**		csc			sparse_spmv on CSC: scatters, partial y per thread
+**	MB is the footprint of the matrix: rows*cols*4 for dense, SparseMatrix::memory_bytes() for the others.
+**	GFLOP/s counts 2*nnz operations for every strategy, dense included: it reports how fast the same
+**	useful work gets done, the multiplications by zero of dense are wasted.
+**	Values and x are small integers: every float sum is exact, the strategies are compared bit for bit
+****************************************************************************/
+
+/****************************************************************************
+**	bench_sparse | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Side of the matrix. Default BENCH_SPARSE_SIDE
+**	argv[2] optional. Threads. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_sparse( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Below 50% CSR of float is smaller than dense
+	static const double densities[] = { 0.001, 0.01, 0.1, 0.5 };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	size_t side = BENCH_SPARSE_SIDE;
+	unsigned int num_threads = 0;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		side = bench_parse_size( argv[1] );
+		if (side == 0)
+		{
+			cerr << "bad side: " << argv[1] << endl;
+			return -1;
+		}
+	}
+	if (argc >= 3)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[2] );
+		if (num_threads == 0)
+		{
+			cerr << "bad threads: " << argv[2] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	ThreadPool pool( num_threads );
+	cout << "Instruction set: " << simd_isa_name( simd_isa() ) << " | Threads: " << pool.size() << " | Side: " << side << endl;
+	cout << std::left;
+	cout << std::setw(10) << "strategy" << " | ";
+	cout << std::setw(12) << "phase" << " | ";
+	cout << std::setw(9) << "MB" << " | ";
+	cout << std::setw(11) << "p10 GFLOP/s" << " | ";
+	cout << std::setw(11) << "med GFLOP/s" << " | ";
+	cout << "p90 GFLOP/s" << endl;
+	cout << std::right;
+	for (t = 0;t < sizeof( densities ) /sizeof( densities[0] );t++)
+	{
+		bench_sparse_run( pool, side, densities[t] );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_sparse | int, char *[]
+
+/****************************************************************************
+**	bench_sparse_run | ThreadPool &, size_t, double
+*****************************************************************************
+**	PARAMETER:
+**	density		fraction of the elements that are not zero
+**	RETURN:
+**	DESCRIPTION:
+**	CSR is built from the dense matrix, CSC converted from CSR
+****************************************************************************/
+
+void bench_sparse_run( ThreadPool &pool, size_t side, double density )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s, r;
+	int num_samples;
+	uint64_t t0, t1;
+	uint32_t seed = 24680;
+	uint32_t threshold = (uint32_t)(density *4294967295.0);
+	double flops;
+	bool ok = true;
+	char phase[32];
+	Bench_stats stats;
+	Parallel_options options( 0, false, &pool );
+	vector<double> t_dense, t_csr_scalar, t_csr, t_csc;
+	const char *strategies[] = { "dense", "csr_scalar", "csr", "csc" };
+	vector<double> *samples[] = { &t_dense, &t_csr_scalar, &t_csr, &t_csc };
+	double megabytes[4];
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<float> dense( side *side ), x( side ), y( side ), ref( side );
+	for (t = 0;t < side *side;t++)
+	{
+		seed = seed *1664525 +1013904223;
+		dense[t] = (seed < threshold) ?((float)(1 +(seed >> 8) %8)) :(0.0f);
+	}
+	for (t = 0;t < side;t++)
+	{
+		x[t] = (float)(t %5);
+	}
+	SparseMatrix<float> csr( View2d<const float>( dense.data(), side, side ), SPARSE_CSR );
+	SparseMatrix<float> csc = csr.convert( SPARSE_CSC );
+	megabytes[0] = (double)(side *side *sizeof(float)) /1048576.0;
+	megabytes[1] = (double)csr.memory_bytes() /1048576.0;
+	megabytes[2] = megabytes[1];
+	megabytes[3] = (double)csc.memory_bytes() /1048576.0;
+	flops = 2.0 *(double)csr.nnz();
+	snprintf( phase, sizeof( phase ), "f32 %g%%", density *100.0 );
+	num_samples = bench_num_samples( side *side *sizeof(float) );
+	sparse_csr_rows_scalar( csr.ptr(), csr.index(), csr.value(), x.data(), ref.data(), 0, side );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		parallel_for_range( 0, side, [&]( size_t row_begin, size_t row_end )
+		{
+			//fast counter
+			size_t row;
+
+			for (row = row_begin;row < row_end;row++)
+			{
+				y[row] = simd_dot( dense.data() +row *side, x.data(), side );
+			}
+		}, options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_dense.push_back( flops /(double)(t1 -t0) );
+	}
+	ok = ok && (memcmp( y.data(), ref.data(), side *sizeof(float) ) == 0);
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		sparse_csr_rows_scalar( csr.ptr(), csr.index(), csr.value(), x.data(), y.data(), 0, side );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_csr_scalar.push_back( flops /(double)(t1 -t0) );
+	}
+	ok = ok && (memcmp( y.data(), ref.data(), side *sizeof(float) ) == 0);
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		sparse_spmv( csr, x.data(), y.data(), options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_csr.push_back( flops /(double)(t1 -t0) );
+	}
+	ok = ok && (memcmp( y.data(), ref.data(), side *sizeof(float) ) == 0);
+
+	for (s = 0;s < num_samples;s++)
+	{
+		t0 = bench_now_ns();
+		sparse_spmv( csc, x.data(), y.data(), options );
+		bench_clobber();
+		t1 = bench_now_ns();
+		t_csc.push_back( flops /(double)(t1 -t0) );
+	}
+	ok = ok && (memcmp( y.data(), ref.data(), side *sizeof(float) ) == 0);
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (ok == false)
+	{
+		cerr << "sparse mismatch " << phase << endl;
+		exit(-1);
+	}
+
+	for (r = 0;r < 4;r++)
+	{
+		stats = bench_stats( *samples[r] );
+		//Dense at 0.1% density is below 0.01 GFLOP/s: three decimals
+		cout << std::left << std::fixed << std::setprecision(3);
+		cout << std::setw(10) << strategies[r] << " | ";
+		cout << std::setw(12) << phase << " | ";
+		cout << std::setw(9) << megabytes[r] << " | ";
+		cout << std::setw(11) << stats.p10 << " | ";
+		cout << std::setw(11) << stats.median << " | ";
+		cout << stats.p90 << endl;
+		cout << std::right;
+		cout.unsetf( std::ios::floatfield );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_sparse_run | ThreadPool &, size_t, double
+
+/****************************************************************************
+**	FORMAT SUITE
+*****************************************************************************
+**	Text of an array written to a file, " | " after each element, a newline after each row
+**		ostream		std::ofstream, << per element and endl per row, as the handlers of example.cpp do with cout
+**		formatter	ArrayFormatter::write. A write() per full buffer
+**		parallel	ArrayFormatter::write_parallel. Threads format chunks, written in order
+**	PHASES
+**		1d			one row
+**		2d			rows of BENCH_FORMAT_COLS elements. ostream flushes each row
+**	GB/s counts the bytes of text. The file is read back after each strategy: the text of formatter and parallel
+**	must be the same, and for int the same as ostream. ostream writes double with 6 digits, the others in full
+****************************************************************************/
+
+/****************************************************************************
+**	bench_format | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest array in elements. Default BENCH_FORMAT_MAX_ELEMENTS
+**	argv[2] optional. Path of the file. Default /tmp/bench_format.txt. Removed at the end
+**	argv[3] optional. Threads of parallel. Default one per hardware thread
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_format( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t size;
+	size_t max_elements = BENCH_FORMAT_MAX_ELEMENTS;
+	std::string path = "/tmp/bench_format.txt";
+	unsigned int num_threads = 0;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_elements = bench_parse_size( argv[1] );
+		if (max_elements == 0)
+		{
+			cerr << "bad size: " << argv[1] << endl;
+			return -1;
+		}
+	}
+	if (argc >= 3)
+	{
+		path = argv[2];
+	}
+	if (argc >= 4)
+	{
+		num_threads = (unsigned int)bench_parse_size( argv[3] );
+		if (num_threads == 0)
+		{
+			cerr << "bad threads: " << argv[3] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	ThreadPool pool( num_threads );
+	cout << "Threads: " << pool.size() << " | File: " << path << endl;
+	bench_report_header();
+	//A max_elements below the first size still gets a row. Fewer than BENCH_FORMAT_COLS elements are a single row
+	for (size = std::min( (size_t)16 *1024, max_elements );size <= max_elements;size *= 8)
+	{
+		bench_format_run<int>( pool, "i32", path, size, size );
+		bench_format_run<int>( pool, "i32", path, size, std::min( (size_t)BENCH_FORMAT_COLS, size ) );
+		bench_format_run<double>( pool, "f64", path, size, std::min( (size_t)BENCH_FORMAT_COLS, size ) );
+	}
+	unlink( path.c_str() );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_format | int, char *[]
+
+/****************************************************************************
+**	format_read_file | const std::string &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+static std::string format_read_file( const std::string &path )
+{
+	std::string ret;
+	char chunk[64 *1024];
+	size_t num;
+	FILE *file = fopen( path.c_str(), "rb" );
+
+	if (file == NULL)
+	{
+		return ret;
+	}
+	while ((num = fread( chunk, 1, sizeof( chunk ), file )) > 0)
+	{
+		ret.append( chunk, num );
+	}
+	fclose( file );
+
+	return ret;
+}	//end function: format_read_file | const std::string &
+
+/****************************************************************************
+**	bench_format_run | ThreadPool &, const char *, const std::string &, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	cols		size: 1d. Otherwise rows of cols elements, size/cols rows
+**	RETURN:
+**	DESCRIPTION:
+**	The file is opened before the clock starts. The time includes the flush and close of the text
+****************************************************************************/
+
+template <typename T>
+void bench_format_run( ThreadPool &pool, const char *type_name, const std::string &path, size_t size, size_t cols )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t, r, c;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	uint32_t seed = 97531;
+	size_t rows = size /cols;
+	int fd;
+	bool ok = true;
+	char phase[32];
+	std::string text_ostream, text_formatter, text_parallel;
+	vector<double> t_ostream, t_formatter, t_parallel;
+	Parallel_options options( 0, false, &pool );
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<T> array_arg( rows *cols );
+	for (t = 0;t < rows *cols;t++)
+	{
+		seed = seed *1664525 +1013904223;
+		//Mixed lengths and signs. double has a fraction
+		array_arg[t] = (T)((int)(seed >> 8) -(1 << 23)) /(T)((std::numeric_limits<T>::is_integer == true) ?(1 +(seed >> 29)) :(1 << (seed >> 29)));
+	}
+	View2d<const T> view( array_arg.data(), rows, cols );
+	snprintf( phase, sizeof( phase ), "%s %s", type_name, (cols == size) ?("1d") :("2d") );
+	num_samples = bench_num_samples( rows *cols *sizeof(T) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (s = 0;s < num_samples;s++)
+	{
+		std::ofstream file( path.c_str(), std::ios::out | std::ios::trunc );
+		t0 = bench_now_ns();
+		for (r = 0;r < rows;r++)
+		{
+			for (c = 0;c < cols;c++)
+			{
+				file << view( r, c ) << " | ";
+			}
+			file << endl;
+		}
+		file.close();
+		t1 = bench_now_ns();
+		t_ostream.push_back( (double)(t1 -t0) /(double)size );
+	}
+	text_ostream = format_read_file( path );
+
+	for (s = 0;s < num_samples;s++)
+	{
+		fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		t0 = bench_now_ns();
+		{
+			ArrayFormatter formatter( fd );
+			formatter.write( view );
+			formatter.flush();
+		}
+		t1 = bench_now_ns();
+		close( fd );
+		t_formatter.push_back( (double)(t1 -t0) /(double)size );
+	}
+	text_formatter = format_read_file( path );
+
+	for (s = 0;s < num_samples;s++)
+	{
+		fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		t0 = bench_now_ns();
+		{
+			ArrayFormatter formatter( fd );
+			formatter.write_parallel( view, Format_options(), options );
+			formatter.flush();
+		}
+		t1 = bench_now_ns();
+		close( fd );
+		t_parallel.push_back( (double)(t1 -t0) /(double)size );
+	}
+	text_parallel = format_read_file( path );
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	ok = ok && (text_formatter.empty() == false) && (text_parallel == text_formatter);
+	ok = ok && ((std::numeric_limits<T>::is_integer == false) || (text_ostream == text_formatter));
+	if (ok == false)
+	{
+		cerr << "format mismatch " << phase << " " << size << endl;
+		exit(-1);
+	}
+
+	bench_report_row( "ostream", size, phase, bench_stats( t_ostream ), (double)text_ostream.size() /(double)size );
+	bench_report_row( "formatter", size, phase, bench_stats( t_formatter ), (double)text_formatter.size() /(double)size );
+	bench_report_row( "parallel", size, phase, bench_stats( t_parallel ), (double)text_parallel.size() /(double)size );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_format_run | ThreadPool &, const char *, const std::string &, size_t, size_t
+
+/****************************************************************************
+**	ALLOC SUITE
+*****************************************************************************
+**	BENCH_ALLOC_BATCH blocks of the same size are allocated, the first byte of each written, then all freed
+**		malloc		malloc and free
+**		new			operator new and operator delete
+**		new[]		new char[] and delete[]
+**	Times are per allocation and its free.
+**	Run it from the benchmark built with alloc_trace.cpp and from the one without: the difference
+**	is the cost of the trace. The suite is a scope of its own in the report at exit
+****************************************************************************/
+
+/****************************************************************************
+**	bench_alloc | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest block in bytes. Default BENCH_ALLOC_MAX_BYTES
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+int bench_alloc( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t size;
+	size_t max_bytes = BENCH_ALLOC_MAX_BYTES;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes == 0)
+		{
+			cerr << "bad size: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	AllocTraceScope scope( "benchmark alloc suite" );
+	cout << "Allocation trace: " << ((alloc_trace_enabled() == true) ?("on") :("off")) << " | Batch: " << BENCH_ALLOC_BATCH << endl;
+	cout << std::left;
+	cout << std::setw(12) << "strategy" << " | ";
+	cout << std::setw(10) << "bytes" << " | ";
+	cout << std::setw(10) << "p10 ns/op" << " | ";
+	cout << std::setw(10) << "med ns/op" << " | ";
+	cout << "p90 ns/op" << endl;
+	cout << std::right;
+	for (size = 16;size <= max_bytes;size *= 4)
+	{
+		bench_alloc_run( size );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_alloc | int, char *[]
+
+//Signatures shared by malloc, operator new and new[]
+static void *alloc_bench_new( size_t size )
+{
+	return ::operator new( size );
+}
+
+static void alloc_bench_delete( void *ptr )
+{
+	::operator delete( ptr );
+}
+
+static void *alloc_bench_new_array( size_t size )
+{
+	return new char[size];
+}
+
+static void alloc_bench_delete_array( void *ptr )
+{
+	delete[] (char *)ptr;
+}
+
+/****************************************************************************
+**	alloc_cycle | size_t, Alloc, Free
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	ns per allocation and free, one sample
+**	DESCRIPTION:
+**	bench_clobber after each batch: the compiler may not remove a block that is never read
+****************************************************************************/
+
+template <typename Alloc, typename Free>
+static double alloc_cycle( size_t size, Alloc alloc_fn, Free free_fn )
+{
+	//fast counters
+	size_t b, k;
+	size_t num_batches = BENCH_ALLOC_OPS /BENCH_ALLOC_BATCH;
+	uint64_t t0, t1;
+	char *batch[BENCH_ALLOC_BATCH];
+
+	t0 = bench_now_ns();
+	for (b = 0;b < num_batches;b++)
+	{
+		for (k = 0;k < BENCH_ALLOC_BATCH;k++)
+		{
+			batch[k] = (char *)alloc_fn( size );
+			if (batch[k] == NULL)
+			{
+				cerr << "allocation failed" << endl;
+				exit(-1);
+			}
+			batch[k][0] = (char)k;
+		}
+		bench_clobber();
+		for (k = 0;k < BENCH_ALLOC_BATCH;k++)
+		{
+			free_fn( batch[k] );
+		}
+	}
+	t1 = bench_now_ns();
+
+	return (double)(t1 -t0) /(double)(num_batches *BENCH_ALLOC_BATCH);
+}	//end function: alloc_cycle | size_t, Alloc, Free
+
+/****************************************************************************
+**	bench_alloc_run | size_t
+*****************************************************************************
+**	PARAMETER:
+**	size: bytes of each block
+**	RETURN:
+**	DESCRIPTION:
+**	One row per strategy
+****************************************************************************/
+
+void bench_alloc_run( size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	static const char *strategies[] = { "malloc", "new", "new[]" };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int s;
+	vector<double> samples;
+	Bench_stats stats;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < sizeof( strategies ) /sizeof( strategies[0] );t++)
+	{
+		samples.clear();
+		//Warm up: the free lists of malloc hold blocks of this size
+		(void)alloc_cycle( size, pool_bench_malloc, free );
+		for (s = 0;s < BENCH_MAX_SAMPLES /2;s++)
+		{
+			if (t == 0)
+			{
+				samples.push_back( alloc_cycle( size, pool_bench_malloc, free ) );
+			}
+			else if (t == 1)
+			{
+				samples.push_back( alloc_cycle( size, alloc_bench_new, alloc_bench_delete ) );
+			}
+			else
+			{
+				samples.push_back( alloc_cycle( size, alloc_bench_new_array, alloc_bench_delete_array ) );
+			}
+		}
+		stats = bench_stats( samples );
+		cout << std::left;
+		cout << std::setw(12) << strategies[t] << " | ";
+		cout << std::setw(10) << size << " | ";
+		cout << std::fixed << std::setprecision(2);
+		cout << std::setw(10) << stats.p10 << " | ";
+		cout << std::setw(10) << stats.median << " | ";
+		cout << stats.p90 << endl;
+		cout << std::right;
+		cout.unsetf( std::ios::floatfield );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_alloc_run | size_t
+
+/****************************************************************************
+**	GROWTH SUITE
+*****************************************************************************
+**	An int array grows from empty, no reserve, to size elements. One row per strategy and phase
+**		vector			std::vector<int>. Each growth allocates, copies the elements and frees the old buffer
+**		realloc_vec		ReallocVector<int>. realloc below REALLOC_VECTOR_MAP_BYTES, mremap above: no copy
+**	PHASES
+**		push			push_back of each element
+**		append			blocks of BENCH_GROWTH_BLOCK elements: insert at the end vs append
+**		resize			resize by a block, then write it. std::vector zeroes the block first,
+**						ReallocVector uses resize_uninitialized
+**	ns/el is per element of the final array, growth included, free excluded.
+**	The last element of each array is checked
+****************************************************************************/
+
+/****************************************************************************
+**	bench_growth | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest array in bytes. Default BENCH_GROWTH_MAX_BYTES. "32G" for tens of GB
+**	RETURN:
+**	DESCRIPTION:
+**	Sizes grow by 16 times. A strategy that runs out of memory stops, the other goes on
+****************************************************************************/
+
+int bench_growth( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t size;
+	size_t max_bytes = BENCH_GROWTH_MAX_BYTES;
+	bool vector_ok = true;
+	bool realloc_ok = true;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes < BENCH_GROWTH_BLOCK *sizeof(int))
+		{
+			cerr << "bad max_bytes: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << "Largest array: " << max_bytes /sizeof(int) << " elements | mremap above " << REALLOC_VECTOR_MAP_BYTES << " bytes" << endl;
+	bench_report_header();
+	for (size = BENCH_GROWTH_BLOCK;size *sizeof(int) <= max_bytes;size *= 16)
+	{
+		if (vector_ok == true)
+		{
+			vector_ok = bench_growth_run<vector<int>>( "vector", size );
+		}
+		if (realloc_ok == true)
+		{
+			realloc_ok = bench_growth_run<ReallocVector<int>>( "realloc_vec", size );
+		}
+		//Don't overflow on the last step
+		if (size > max_bytes /16)
+		{
+			break;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_growth | int, char *[]
+
+//Append of a block, the way each vector does it best
+static void growth_append( vector<int> &vector_arg, const int *src, size_t num )
+{
+	vector_arg.insert( vector_arg.end(), src, src +num );
+}
+
+static void growth_append( ReallocVector<int> &vector_arg, const int *src, size_t num )
+{
+	vector_arg.append( src, num );
+}
+
+//num more elements, about to be written
+static void growth_extend( vector<int> &vector_arg, size_t num )
+{
+	vector_arg.resize( vector_arg.size() +num );
+}
+
+static void growth_extend( ReallocVector<int> &vector_arg, size_t num )
+{
+	vector_arg.resize_uninitialized( vector_arg.size() +num );
+}
+
+/****************************************************************************
+**	bench_growth_run | const char *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	size	elements of the final array. A multiple of BENCH_GROWTH_BLOCK
+**	RETURN:
+**	false when the vector could not grow to size: std::bad_alloc
+**	DESCRIPTION:
+**	V has push_back, data, size, and an overload of growth_append and growth_extend
+****************************************************************************/
+
+template <typename V>
+static bool bench_growth_run( const char *strategy, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t, b;
+	int s;
+	int num_samples;
+	uint64_t t0, t1;
+	double num_elem;
+	int block[BENCH_GROWTH_BLOCK];
+	vector<double> push, append, extend;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_elem = (double)size;
+	num_samples = bench_num_samples( size *sizeof(int) );
+	for (t = 0;t < BENCH_GROWTH_BLOCK;t++)
+	{
+		block[t] = (int)t;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	try
+	{
+		for (s = 0;s < num_samples;s++)
+		{
+			{
+				V my_vector;
+				t0 = bench_now_ns();
+				for (t = 0;t < size;t++)
+				{
+					my_vector.push_back( (int)t );
+				}
+				bench_clobber();
+				t1 = bench_now_ns();
+				push.push_back( (double)(t1 -t0) /num_elem );
+				if ((my_vector.size() != size) || (my_vector.data()[size -1] != (int)(size -1)))
+				{
+					cerr << strategy << " push: wrong last element" << endl;
+					exit(-1);
+				}
+			}
+
+			{
+				V my_vector;
+				t0 = bench_now_ns();
+				for (b = 0;b < size;b += BENCH_GROWTH_BLOCK)
+				{
+					growth_append( my_vector, block, BENCH_GROWTH_BLOCK );
+				}
+				bench_clobber();
+				t1 = bench_now_ns();
+				append.push_back( (double)(t1 -t0) /num_elem );
+				if ((my_vector.size() != size) || (my_vector.data()[size -1] != BENCH_GROWTH_BLOCK -1))
+				{
+					cerr << strategy << " append: wrong last element" << endl;
+					exit(-1);
+				}
+			}
+
+			{
+				V my_vector;
+				int *my_block;
+				t0 = bench_now_ns();
+				for (b = 0;b < size;b += BENCH_GROWTH_BLOCK)
+				{
+					growth_extend( my_vector, BENCH_GROWTH_BLOCK );
+					my_block = my_vector.data() +b;
+					for (t = 0;t < BENCH_GROWTH_BLOCK;t++)
+					{
+						my_block[t] = (int)(b +t);
+					}
+				}
+				bench_clobber();
+				t1 = bench_now_ns();
+				extend.push_back( (double)(t1 -t0) /num_elem );
+				if ((my_vector.size() != size) || (my_vector.data()[size -1] != (int)(size -1)))
+				{
+					cerr << strategy << " resize: wrong last element" << endl;
+					exit(-1);
+				}
+			}
+		}
+	}
+	catch (std::bad_alloc &)
+	{
+		cout << strategy << ": out of memory at " << size << " elements" << endl;
+		return false;
+	}
+
+	bench_report_row( strategy, size, "push", bench_stats( push ), sizeof(int) );
+	bench_report_row( strategy, size, "append", bench_stats( append ), sizeof(int) );
+	bench_report_row( strategy, size, "resize", bench_stats( extend ), sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return true;
+}	//end function: bench_growth_run | const char *, size_t
+
+/****************************************************************************
+**	COPY SUITE
+*****************************************************************************
+**	Copy of bytes bytes from one array to another, sizes doubling from 16 bytes. One row per strategy
+**		memcpy, memmove, std_copy		the C library and std::copy of unsigned char
+**		inline, rep_movsb, stream,		array_copy_bytes forced to COPY_INLINE, COPY_REP_MOVSB, COPY_STREAM,
+**		parallel, auto					COPY_PARALLEL, and left to pick by itself
+**	Then the fills: memset, std_fill, and array_fill_bytes: inline, rep_stosb, stream, parallel, auto.
+**	inline runs up to COPY_INLINE_BYTES only, parallel from BENCH_COPY_PARALLEL_MIN.
+**	Small sizes repeat the copy on the same arrays, which stay in the cache: the time of a copy, not of the memory.
+**	Each strategy is checked against the source once per size.
+**	CROSSOVER
+**	Size from which a strategy is faster than the one before it at every larger size measured:
+**	rep_movsb than memcpy, stream than the best of memcpy and rep_movsb, parallel than stream.
+**	Those are the thresholds of copy_thresholds() for this host
+****************************************************************************/
+
+/****************************************************************************
+**	bench_copy | int, char *[]
+*****************************************************************************
+**	PARAMETER:
+**	argv[1] optional. Largest copy in bytes. Default BENCH_COPY_MAX_BYTES
+**	RETURN:
+**	DESCRIPTION:
+**	The parallel rows run on thread_pool_default(), one thread per hardware thread
+****************************************************************************/
+
+int bench_copy( int argc, char *argv[] )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	static const char *names[2] = { "copy", "fill" };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t;
+	int f;
+	size_t max_bytes = BENCH_COPY_MAX_BYTES;
+	size_t bytes;
+	unsigned char *src, *dst;
+	vector<size_t> sizes;
+	vector< vector<double> > medians[2];
+	vector<double> best;
+	const Copy_thresholds &defaults = copy_thresholds();
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (argc >= 2)
+	{
+		max_bytes = bench_parse_size( argv[1] );
+		if (max_bytes < 16)
+		{
+			cerr << "bad max_bytes: " << argv[1] << endl;
+			return -1;
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	src = (unsigned char *)malloc( max_bytes );
+	dst = (unsigned char *)malloc( max_bytes );
+	if ((src == NULL) || (dst == NULL))
+	{
+		cerr << "failed to allocate 2 x " << max_bytes << " bytes" << endl;
+		free( src );
+		free( dst );
+		return -1;
+	}
+	//Fault every page in before the clock runs
+	for (t = 0;t < max_bytes;t++)
+	{
+		src[t] = (unsigned char)(t *31 +7);
+	}
+	memset( dst, 0, max_bytes );
+	cout << "Threads: " << thread_pool_default().size() << " | ERMS: " << ((copy_has_erms() == true) ?("yes") :("no")) << " | AVX: " << ((copy_has_avx() == true) ?("yes") :("no")) << " | LLC: " << copy_llc_bytes() << " bytes" << endl;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (f = 0;f < 2;f++)
+	{
+		bench_report_header();
+		sizes.clear();
+		for (bytes = 16;bytes <= max_bytes;bytes *= 2)
+		{
+			sizes.push_back( bytes );
+			bench_copy_run( (f == 1), bytes, dst, src, medians[f] );
+			//Don't overflow on the last step
+			if (bytes > max_bytes /2)
+			{
+				break;
+			}
+		}
+	}
+	free( src );
+	free( dst );
+
+	//Rows: 0 library, 1 library (memmove or std::fill), 2 std::copy or nothing, 3 inline, 4 rep movsb, 5 stream, 6 parallel, 7 auto
+	for (f = 0;f < 2;f++)
+	{
+		best.resize( sizes.size() );
+		for (t = 0;t < sizes.size();t++)
+		{
+			best[t] = std::min( medians[f][0][t], medians[f][4][t] );
+		}
+		cout << "Crossover " << names[f] << " | rep_movsb over " << ((f == 0) ?("memcpy") :("memset")) << ": " << copy_crossover( sizes, medians[f][4], medians[f][0] );
+		cout << " | stream over the best of them: " << copy_crossover( sizes, medians[f][5], best );
+		cout << " | parallel over stream: " << copy_crossover( sizes, medians[f][6], medians[f][5] ) << " bytes (0: never)" << endl;
+	}
+	cout << "Thresholds of copy_thresholds() | rep_movsb: " << defaults.movsb << " | stream: " << defaults.stream << " | parallel: " << defaults.parallel << " bytes" << endl;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return 0;
+}	//end function: bench_copy | int, char *[]
+
+/****************************************************************************
+**	copy_call | bool, int, unsigned char *, const unsigned char *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	row		strategy, in the order of the rows of the suite
+**	RETURN:
+**	DESCRIPTION:
+**	A fill writes the byte 0x5A. src is unused
+****************************************************************************/
+
+static void copy_call( bool fill, int row, unsigned char *dst, const unsigned char *src, size_t bytes )
+{
+	static const Copy_strategy strategies[8] = { COPY_MEMCPY, COPY_MEMCPY, COPY_MEMCPY, COPY_INLINE, COPY_REP_MOVSB, COPY_STREAM, COPY_PARALLEL, COPY_AUTO };
+
+	if (fill == false)
+	{
+		switch (row)
+		{
+			case 0:
+				memcpy( dst, src, bytes );
+				break;
+			case 1:
+				memmove( dst, src, bytes );
+				break;
+			case 2:
+				std::copy( src, src +bytes, dst );
+				break;
+			default:
+				array_copy_bytes( dst, src, bytes, strategies[row] );
+				break;
+		}
+	}
+	else
+	{
+		switch (row)
+		{
+			case 0:
+				memset( dst, 0x5A, bytes );
+				break;
+			case 1:
+				std::fill( dst, dst +bytes, (unsigned char)0x5A );
+				break;
+			default:
+				array_fill_bytes( dst, 0x5A, bytes, strategies[row] );
+				break;
+		}
+	}
+
+	return;
+}	//end function: copy_call | bool, int, unsigned char *, const unsigned char *, size_t
+
+/****************************************************************************
+**	bench_copy_run | bool, size_t, unsigned char *, const unsigned char *, vector< vector<double> > &
+*****************************************************************************
+**	PARAMETER:
+**	medians		one vector per row. The median ns per byte of this size is appended, NaN when the row is skipped
+**	RETURN:
+**	DESCRIPTION:
+**	One size, every row. Copies are repeated until a sample moves BENCH_BATCH_BYTES
+****************************************************************************/
+
+void bench_copy_run( bool fill, size_t bytes, unsigned char *dst, const unsigned char *src, vector< vector<double> > &medians )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	static const char *copy_names[8] = { "memcpy", "memmove", "std_copy", "inline", "rep_movsb", "stream", "parallel", "auto" };
+	static const char *fill_names[8] = { "memset", "std_fill", "", "inline", "rep_stosb", "stream", "parallel", "auto" };
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	int row, s;
+	size_t r;
+	size_t num_reps;
+	int num_samples;
+	uint64_t t0, t1;
+	bool skip;
+	vector<double> samples;
+	Bench_stats stats;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	num_reps = (bytes < BENCH_BATCH_BYTES) ?(BENCH_BATCH_BYTES /bytes) :(1);
+	num_samples = bench_num_samples( num_reps *bytes );
+	medians.resize( 8 );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (row = 0;row < 8;row++)
+	{
+		skip = ((fill == true) && (row == 2)) || ((row == 3) && (bytes > COPY_INLINE_BYTES)) || ((row == 6) && (bytes < BENCH_COPY_PARALLEL_MIN));
+		if (skip == true)
+		{
+			medians[row].push_back( std::numeric_limits<double>::quiet_NaN() );
+			continue;
+		}
+		samples.clear();
+		for (s = 0;s < num_samples;s++)
+		{
+			t0 = bench_now_ns();
+			for (r = 0;r < num_reps;r++)
+			{
+				copy_call( fill, row, dst, src, bytes );
+				bench_clobber();
+			}
+			t1 = bench_now_ns();
+			samples.push_back( (double)(t1 -t0) /(double)(num_reps *bytes) );
+		}
+		if (((fill == false) && (memcmp( dst, src, bytes ) != 0)) || ((fill == true) && ((dst[0] != 0x5A) || (dst[bytes /2] != 0x5A) || (dst[bytes -1] != 0x5A))))
+		{
+			cerr << ((fill == true) ?(fill_names[row]) :(copy_names[row])) << " " << bytes << " bytes: wrong result" << endl;
+			exit(-1);
+		}
+		memset( dst, 0, bytes );
+		stats = bench_stats( samples );
+		medians[row].push_back( stats.median );
+		bench_report_row( (fill == true) ?(fill_names[row]) :(copy_names[row]), bytes, (fill == true) ?("fill") :("copy"), stats, 1.0 );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: bench_copy_run | bool, size_t, unsigned char *, const unsigned char *, vector< vector<double> > &
+
+/****************************************************************************
+**	copy_crossover | const vector<size_t> &, const vector<double> &, const vector<double> &
+*****************************************************************************
+**	PARAMETER:
+**	candidate, reference	median ns per byte at each size. NaN: not measured, not compared
+**	RETURN:
+**	smallest size from which candidate is faster than reference at every larger size. 0: never, or only below
+**	DESCRIPTION:
+****************************************************************************/
+
+static size_t copy_crossover( const vector<size_t> &sizes, const vector<double> &candidate, const vector<double> &reference )
+{
+	//fast counter
+	size_t t;
+	size_t ret = 0;
+
+	for (t = 0;t < sizes.size();t++)
+	{
+		//NaN compares false both ways
+		if ((candidate[t] != candidate[t]) || (reference[t] != reference[t]))
+		{
+			continue;
+		}
+		if (candidate[t] < reference[t])
+		{
+			ret = (ret == 0) ?(sizes[t]) :(ret);
+		}
+		else
+		{
+			ret = 0;
+		}
+	}
+
+	return ret;
+}	//end function: copy_crossover | const vector<size_t> &, const vector<double> &, const vector<double> &
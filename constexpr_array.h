@@ -0,0 +1,448 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Constexpr Array
+*****************************************************************
+**	std::array built, sorted and summed at compile time
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	A table filled by a loop at startup costs time on every run, and a static table
+**	with a non constant initializer is filled by a guarded constructor on first use.
+**	A constexpr std::array is computed by the compiler: the elements are written in the
+**	executable (.rodata) and no code runs to initialize them.
+**		constexpr std::array<int,11> sorted = constexpr_sort( permutation );
+**
+**	FUNCTIONS
+**		constexpr_generate<T,N>( fn )		{ fn(0), fn(1), ... fn(N-1) }. Lookup table of a function of the index
+**		constexpr_transform( src, fn )		{ fn(src[0]), fn(src[1]), ... }
+**		constexpr_sort( src, cmp )			stable merge sort, cmp defaults to <
+**		constexpr_prefix_sum( src, op )		{ src[0], src[0]+src[1], ... }, op defaults to +
+**		constexpr_inverse( src )			src is a permutation of 0..N-1: result[src[i]] = i
+**	src is a constexpr C array T[N] or std::array<T,N>. Every function returns std::array<T,N>,
+**	so calls can be chained: constexpr_prefix_sum( constexpr_sort( src ) )
+**
+**	C++11 LIMITS
+**	A C++11 constexpr function is a single return statement: no loops, no local variables,
+**	no assignment. Loops become recursion or a pack expansion over the indexes 0..N-1.
+**	Compilers cap a constant expression:
+**		recursion depth			-fconstexpr-depth, 512 by default
+**		template nesting		-ftemplate-depth, 900 by default
+**		operations				GCC -fconstexpr-ops-limit, 2^25 by default
+**	so every recursion here is log2(N) deep: merge sort splits in halves, the merge finds each
+**	output element by binary search, the prefix sum is a scan in log2(N) passes.
+**		generate, transform		N calls
+**		sort					N log2(N)^2 comparisons
+**		prefix sum				N log2(N) operations. Float sums are added in tree order, not left to right
+**		inverse					N^2 comparisons. A few thousand elements at most
+**	Lambdas are not constexpr before C++17: fn, cmp and op are constexpr functions
+**	or structures with a constexpr operator(), see Const_less and Const_plus.
+**	Const std::array::operator[] is constexpr from C++14. libstdc++ and MSVC declare it constexpr
+**	in C++11 too; elsewhere pass C arrays to these functions in C++11.
+**
+**	Declare the table constexpr at namespace scope, or static constexpr inside a function.
+**	A constexpr local that is not static is a copy on the stack, made at every call.
+**	A value too large for the limits is a compile error, never a runtime cost.
+****************************************************************/
+
+#ifndef CONSTEXPR_ARRAY_H_
+#define CONSTEXPR_ARRAY_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <array>		//for std::array
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Default comparison of constexpr_sort. std::less is constexpr from C++14
+struct Const_less
+{
+	template <typename T>
+	constexpr bool operator()( const T &a, const T &b ) const
+	{
+		return (a < b);
+	}
+};
+
+//Default operation of constexpr_prefix_sum. std::plus is constexpr from C++14
+struct Const_plus
+{
+	template <typename T>
+	constexpr T operator()( const T &a, const T &b ) const
+	{
+		return (a +b);
+	}
+};
+
+//Indexes 0..N-1 as a template parameter pack. std::index_sequence is C++14
+template <size_t... I>
+struct Const_indices
+{
+	typedef Const_indices type;
+};
+
+//Join two index packs, the second shifted after the first
+template <typename A, typename B>
+struct Const_concat;
+
+template <size_t... I, size_t... J>
+struct Const_concat<Const_indices<I...>, Const_indices<J...>>
+{
+	typedef Const_indices<I..., (sizeof...(I) +J)...> type;
+};
+
+//Const_indices<0,...,N-1>. Built in halves, so the template nesting is log2(N)
+template <size_t N>
+struct Const_make_indices
+{
+	typedef typename Const_concat<typename Const_make_indices<N /2>::type, typename Const_make_indices<N -N /2>::type>::type type;
+};
+
+template <>
+struct Const_make_indices<0>
+{
+	typedef Const_indices<> type;
+};
+
+template <>
+struct Const_make_indices<1>
+{
+	typedef Const_indices<0> type;
+};
+
+//Intermediate result. Elements can be read in a C++11 constant expression. One unused element when N is 0
+template <typename T, size_t N>
+struct Const_array
+{
+	T g_data[(N > 0) ?(N) :(1)];
+
+	constexpr const T &operator[]( size_t index ) const
+	{
+		return g_data[index];
+	}
+};
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	const_copy | const Source &, Const_indices<I...>
+*****************************************************************************
+**	PARAMETER:
+**	src			anything with a constexpr operator[]
+**	RETURN:
+**	DESCRIPTION:
+**	const_copy reads any source into a Const_array, const_to_std turns the result into a std::array
+****************************************************************************/
+
+template <typename T, size_t N, typename Source, size_t... I>
+constexpr Const_array<T, N> const_copy( const Source &src, Const_indices<I...> )
+{
+	return Const_array<T, N>{ { src[I]... } };
+}	//end function: const_copy | const Source &, Const_indices<I...>
+
+template <typename T, size_t N, size_t... I>
+constexpr std::array<T, N> const_to_std( const Const_array<T, N> &src, Const_indices<I...> )
+{
+	return std::array<T, N>{ { src[I]... } };
+}	//end function: const_to_std | const Const_array<T, N> &, Const_indices<I...>
+
+/****************************************************************************
+**	const_generate | Fn, Const_indices<I...>
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	One call per index, expanded by the pack
+****************************************************************************/
+
+template <typename T, size_t N, typename Fn, size_t... I>
+constexpr std::array<T, N> const_generate( Fn fn, Const_indices<I...> )
+{
+	return std::array<T, N>{ { static_cast<T>( fn( I ) )... } };
+}	//end function: const_generate | Fn, Const_indices<I...>
+
+template <typename T, size_t N, typename Source, typename Fn, size_t... I>
+constexpr std::array<T, N> const_transform( const Source &src, Fn fn, Const_indices<I...> )
+{
+	return std::array<T, N>{ { static_cast<T>( fn( src[I] ) )... } };
+}	//end function: const_transform | const Source &, Fn, Const_indices<I...>
+
+/****************************************************************************
+**	const_merge_corank | const Const_array<T,N> &, const Const_array<T,M> &, size_t, size_t, size_t, Compare
+*****************************************************************************
+**	PARAMETER:
+**	a, b		sorted halves
+**	index		position in the merged array
+**	lo, hi		range of the search
+**	RETURN:
+**	number of elements of a among the first index elements of the merge
+**	DESCRIPTION:
+**	Binary search, log2(N) deep. Taking j elements of a is right while
+**	a[j-1] is not after b[index-j]. Ties take a first: the merge is stable
+****************************************************************************/
+
+template <typename T, size_t N, size_t M, typename Compare>
+constexpr size_t const_merge_corank( const Const_array<T, N> &a, const Const_array<T, M> &b, size_t index, size_t lo, size_t hi, Compare cmp )
+{
+	return (lo == hi) ?(lo) :
+		((index -(lo +hi +1) /2 >= M) || (cmp( b[index -(lo +hi +1) /2], a[(lo +hi +1) /2 -1] ) == false)) ?
+			(const_merge_corank( a, b, index, (lo +hi +1) /2, hi, cmp )) :
+			(const_merge_corank( a, b, index, lo, (lo +hi +1) /2 -1, cmp ));
+}	//end function: const_merge_corank | const Const_array<T,N> &, const Const_array<T,M> &, size_t, size_t, size_t, Compare
+
+//Element index of the merge, given j elements of a come before it
+template <typename T, size_t N, size_t M, typename Compare>
+constexpr T const_merge_pick( const Const_array<T, N> &a, const Const_array<T, M> &b, size_t index, size_t j, Compare cmp )
+{
+	return ((j < N) && ((index -j >= M) || (cmp( b[index -j], a[j] ) == false))) ?(a[j]) :(b[index -j]);
+}	//end function: const_merge_pick | const Const_array<T,N> &, const Const_array<T,M> &, size_t, size_t, Compare
+
+template <typename T, size_t N, size_t M, typename Compare>
+constexpr T const_merge_at( const Const_array<T, N> &a, const Const_array<T, M> &b, size_t index, Compare cmp )
+{
+	return const_merge_pick( a, b, index, const_merge_corank( a, b, index, (index > M) ?(index -M) :(0), (index < N) ?(index) :(N), cmp ), cmp );
+}	//end function: const_merge_at | const Const_array<T,N> &, const Const_array<T,M> &, size_t, Compare
+
+template <typename T, size_t N, size_t M, typename Compare, size_t... I>
+constexpr Const_array<T, N +M> const_merge( const Const_array<T, N> &a, const Const_array<T, M> &b, Compare cmp, Const_indices<I...> )
+{
+	return Const_array<T, N +M>{ { const_merge_at( a, b, I, cmp )... } };
+}	//end function: const_merge | const Const_array<T,N> &, const Const_array<T,M> &, Compare, Const_indices<I...>
+
+/****************************************************************************
+**	Const_sort<T,N,Compare>::run | const Source &, size_t, Compare
+*****************************************************************************
+**	PARAMETER:
+**	offset		first element of src to sort
+**	RETURN:
+**	N elements of src from offset, sorted
+**	DESCRIPTION:
+**	Merge sort. A structure because functions can't be partially specialized on N
+****************************************************************************/
+
+template <typename T, size_t N, typename Compare>
+struct Const_sort
+{
+	template <typename Source>
+	static constexpr Const_array<T, N> run( const Source &src, size_t offset, Compare cmp )
+	{
+		return const_merge( Const_sort<T, N /2, Compare>::run( src, offset, cmp ), Const_sort<T, N -N /2, Compare>::run( src, offset +N /2, cmp ), cmp, typename Const_make_indices<N>::type() );
+	}
+};
+
+template <typename T, typename Compare>
+struct Const_sort<T, 1, Compare>
+{
+	template <typename Source>
+	static constexpr Const_array<T, 1> run( const Source &src, size_t offset, Compare )
+	{
+		return Const_array<T, 1>{ { src[offset] } };
+	}
+};
+
+template <typename T, typename Compare>
+struct Const_sort<T, 0, Compare>
+{
+	template <typename Source>
+	static constexpr Const_array<T, 0> run( const Source &, size_t, Compare )
+	{
+		return Const_array<T, 0>{ { T() } };
+	}
+};
+
+/****************************************************************************
+**	Const_scan<T,N,D,Op>::run | const Const_array<T,N> &, Op
+*****************************************************************************
+**	PARAMETER:
+**	D			distance of this pass: 1, 2, 4...
+**	RETURN:
+**	DESCRIPTION:
+**	Inclusive scan in log2(N) passes. A pass adds to each element the one D before it.
+**	After the pass of distance D each element holds the sum of the 2D elements ending on it
+****************************************************************************/
+
+template <typename T, size_t N, size_t D, typename Op, size_t... I>
+constexpr Const_array<T, N> const_scan_pass( const Const_array<T, N> &src, Op op, Const_indices<I...> )
+{
+	return Const_array<T, N>{ { ((I >= D) ?(static_cast<T>( op( src[I -D], src[I] ) )) :(src[I]))... } };
+}	//end function: const_scan_pass | const Const_array<T,N> &, Op, Const_indices<I...>
+
+template <typename T, size_t N, size_t D, typename Op, bool DONE = (D >= N)>
+struct Const_scan
+{
+	static constexpr Const_array<T, N> run( const Const_array<T, N> &src, Op op )
+	{
+		return Const_scan<T, N, 2 *D, Op>::run( const_scan_pass<T, N, D>( src, op, typename Const_make_indices<N>::type() ), op );
+	}
+};
+
+template <typename T, size_t N, size_t D, typename Op>
+struct Const_scan<T, N, D, Op, true>
+{
+	static constexpr Const_array<T, N> run( const Const_array<T, N> &src, Op )
+	{
+		return src;
+	}
+};
+
+/****************************************************************************
+**	const_find | const Source &, T, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	lo, hi		range of the search
+**	RETURN:
+**	position of value in src[lo..hi), not_found if missing
+**	DESCRIPTION:
+**	Searches both halves, so it is log2(N) deep. Lowest position wins
+****************************************************************************/
+
+template <typename T, typename Source>
+constexpr size_t const_find( const Source &src, T value, size_t lo, size_t hi, size_t not_found );
+
+//left: result of the search of the first half. Search the second half only if it failed
+template <typename T, typename Source>
+constexpr size_t const_find_right( const Source &src, T value, size_t left, size_t mid, size_t hi, size_t not_found )
+{
+	return (left != not_found) ?(left) :(const_find( src, value, mid, hi, not_found ));
+}	//end function: const_find_right | const Source &, T, size_t, size_t, size_t, size_t
+
+template <typename T, typename Source>
+constexpr size_t const_find( const Source &src, T value, size_t lo, size_t hi, size_t not_found )
+{
+	return (hi -lo == 0) ?(not_found) :
+		(hi -lo == 1) ?((src[lo] == value) ?(lo) :(not_found)) :
+		(const_find_right( src, value, const_find( src, value, lo, lo +(hi -lo) /2, not_found ), lo +(hi -lo) /2, hi, not_found ));
+}	//end function: const_find | const Source &, T, size_t, size_t, size_t
+
+template <typename T, size_t N, typename Source, size_t... I>
+constexpr std::array<T, N> const_inverse( const Source &src, Const_indices<I...> )
+{
+	return std::array<T, N>{ { static_cast<T>( const_find( src, static_cast<T>( I ), 0, N, N ) )... } };
+}	//end function: const_inverse | const Source &, Const_indices<I...>
+
+/****************************************************************************
+**	constexpr_generate<T,N> | Fn
+*****************************************************************************
+**	PARAMETER:
+**	fn			T( size_t index ), constexpr
+**	RETURN:
+**	{ fn(0), fn(1), ... fn(N-1) }
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T, size_t N, typename Fn>
+constexpr std::array<T, N> constexpr_generate( Fn fn )
+{
+	return const_generate<T, N>( fn, typename Const_make_indices<N>::type() );
+}	//end function: constexpr_generate<T,N> | Fn
+
+/****************************************************************************
+**	constexpr_transform | const T (&)[N], Fn
+*****************************************************************************
+**	PARAMETER:
+**	fn			T( T ), constexpr
+**	RETURN:
+**	{ fn(src[0]), fn(src[1]), ... }
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T, size_t N, typename Fn>
+constexpr std::array<T, N> constexpr_transform( const T (&src)[N], Fn fn )
+{
+	return const_transform<T, N>( src, fn, typename Const_make_indices<N>::type() );
+}	//end function: constexpr_transform | const T (&)[N], Fn
+
+template <typename T, size_t N, typename Fn>
+constexpr std::array<T, N> constexpr_transform( const std::array<T, N> &src, Fn fn )
+{
+	return const_transform<T, N>( src, fn, typename Const_make_indices<N>::type() );
+}	//end function: constexpr_transform | const std::array<T,N> &, Fn
+
+/****************************************************************************
+**	constexpr_sort | const T (&)[N], Compare
+*****************************************************************************
+**	PARAMETER:
+**	cmp			bool( T, T ), constexpr strict weak order
+**	RETURN:
+**	src sorted. Equal elements keep their order
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T, size_t N, typename Compare = Const_less>
+constexpr std::array<T, N> constexpr_sort( const T (&src)[N], Compare cmp = Compare() )
+{
+	return const_to_std( Const_sort<T, N, Compare>::run( src, 0, cmp ), typename Const_make_indices<N>::type() );
+}	//end function: constexpr_sort | const T (&)[N], Compare
+
+template <typename T, size_t N, typename Compare = Const_less>
+constexpr std::array<T, N> constexpr_sort( const std::array<T, N> &src, Compare cmp = Compare() )
+{
+	return const_to_std( Const_sort<T, N, Compare>::run( src, 0, cmp ), typename Const_make_indices<N>::type() );
+}	//end function: constexpr_sort | const std::array<T,N> &, Compare
+
+/****************************************************************************
+**	constexpr_prefix_sum | const T (&)[N], Op
+*****************************************************************************
+**	PARAMETER:
+**	op			T( T, T ), constexpr and associative
+**	RETURN:
+**	{ src[0], op(src[0],src[1]), op(op(src[0],src[1]),src[2]), ... }
+**	DESCRIPTION:
+**	Inclusive. The exclusive sum is the inclusive one shifted by one
+****************************************************************************/
+
+template <typename T, size_t N, typename Op = Const_plus>
+constexpr std::array<T, N> constexpr_prefix_sum( const T (&src)[N], Op op = Op() )
+{
+	return const_to_std( Const_scan<T, N, 1, Op>::run( const_copy<T, N>( src, typename Const_make_indices<N>::type() ), op ), typename Const_make_indices<N>::type() );
+}	//end function: constexpr_prefix_sum | const T (&)[N], Op
+
+template <typename T, size_t N, typename Op = Const_plus>
+constexpr std::array<T, N> constexpr_prefix_sum( const std::array<T, N> &src, Op op = Op() )
+{
+	return const_to_std( Const_scan<T, N, 1, Op>::run( const_copy<T, N>( src, typename Const_make_indices<N>::type() ), op ), typename Const_make_indices<N>::type() );
+}	//end function: constexpr_prefix_sum | const std::array<T,N> &, Op
+
+/****************************************************************************
+**	constexpr_inverse | const T (&)[N]
+*****************************************************************************
+**	PARAMETER:
+**	src			permutation of 0..N-1
+**	RETURN:
+**	position of each value: result[src[i]] = i. A value missing from src gets N
+**	DESCRIPTION:
+**	Answers "where is v" with one read instead of a search
+****************************************************************************/
+
+template <typename T, size_t N>
+constexpr std::array<T, N> constexpr_inverse( const T (&src)[N] )
+{
+	return const_inverse<T, N>( src, typename Const_make_indices<N>::type() );
+}	//end function: constexpr_inverse | const T (&)[N]
+
+template <typename T, size_t N>
+constexpr std::array<T, N> constexpr_inverse( const std::array<T, N> &src )
+{
+	return const_inverse<T, N>( src, typename Const_make_indices<N>::type() );
+}	//end function: constexpr_inverse | const std::array<T,N> &
+
+#endif	//CONSTEXPR_ARRAY_H_
@@ -55,6 +55,21 @@
 //Standard C++ libraries
 #include <iostream>		//for cout, endl
 #include <array>		//for std::array
+#include <vector>		//for std::vector
+//User libraries
+#include "heap_2d.h"	//for heap_2d_rows_alloc, heap_2d_block_alloc, heap_2d_table_alloc
+#include "array_view.h"	//for Span, View2d
+#include "arena.h"		//for Arena, ArenaScope, ArenaAllocator
+#include "pool.h"		//for pool_alloc, pool_free, PoolAllocator
+#include "aligned_array.h"	//for AlignedArray
+#include "simd.h"		//for simd_sum, simd_min_max, simd_count_greater
+#include "parallel.h"	//for parallel_for, parallel_reduce
+#include "small_vector.h"	//for SmallVector
+#include "realloc_vector.h"	//for ReallocVector
+#include "array_copy.h"	//for array_copy
+#include "constexpr_array.h"	//for constexpr_sort, constexpr_prefix_sum, constexpr_inverse, constexpr_generate
+#include "array_format.h"	//for array_print
+#include "alloc_trace.h"	//for alloc_trace_scope
 
 /****************************************************************
 **	NAMESPACES
@@ -64,7 +79,8 @@ using std::cout;	//print to console
 using std::cerr;	//print to console
 using std::endl;	//new line
 using std::array;	//stack based array with size and type known at compile time
-using std::memcpy;	//move bytes from one place to the other. Fastest but does no check.
+using std::vector;	//heap based array with size known at runtime
+using std::memcpy;	//move bytes from one place to the other. Fastest for small arrays, but they must not overlap.
 using std::memmove;	//move bytes from one place to the other taking care of overlap
 using std::strcpy;	//copy two strings
 using std::copy;	//copy from palce to place using iterators
@@ -84,6 +100,8 @@ using std::copy;	//copy from palce to place using iterators
 ///C Style, Stack, 1D
 extern void c_style_stack_1d( void );
 extern void c_style_stack_1d_handler( int *array_arg, int size );
+//Pass a span. Pointer and size travel together. Works with every 1D storage
+extern void span_1d_handler( Span<const int> array_arg );
 
 ///C Style, Stack, 2D
 extern void c_style_stack_2d( void );
@@ -92,13 +110,16 @@ extern void c_style_stack_2d( void );
 extern void c_style_stack_2d_handler_pointer( int *array_arg, int size, int rows );
 //	Option 2: pass to the type with the right number of columns
 extern void c_style_stack_2d_handler_type( int array_arg[][5], int size, int rows );
+//	Option 3: pass a view. Pointer, extents and strides travel together. Works with every 2D storage
+extern void view_2d_handler( View2d<const int> array_arg );
 
 ///C++, std::array, stack, 1D
 extern void cpp_std_array_stack_1d( void );
 //	There is no easy way to pass a std:arry as argument. There are two ways to do it.
 //	Option 1: you make a template function template <typename T, std::size_t S>
-template <typename T, int S>
-extern void cpp_std_array_stack_1d_handler_template( std::array<T,S> array_arg );
+//	Taking std::array<T,S> by value copies every element on each call. Take a Span<T,S> instead: only the pointer is passed, S stays in the type
+template <typename T, std::size_t S>
+extern void cpp_std_array_stack_1d_handler_template( Span<T,S> array_arg );
 //	Option 2: you make a function that takes two iterators. Begin and end of the array.
 //template <typename T, std::size_t S>
 //extern void cpp_std_array_stack_1d_handler_iterator( typename std::array<T,S>::iterator begin, typename std::array<T,S>::iterator end );
@@ -111,15 +132,18 @@ extern void cpp_std_array_stack_2d( void );
 //Option 0 is to pass it as you would a C array with pointer and dimensions. I can use the function written before
 //extern void cpp_std_array_stack_1d_handler_pointer( int *array_arg, int num_rows, int num_cols );
 //Option 1 is to use a template specialization to pass the right type
-template <typename T, int R, int C>
-extern void cpp_std_array_stack_2d_handler_template( array<array<int,C>,R> array_arg );
-//Option 2
+//	A Span of R rows, each a std::array<T,C>. No copy, bracers still work
+template <typename T, std::size_t R, std::size_t C>
+extern void cpp_std_array_stack_2d_handler_template( Span<const array<T,C>,R> array_arg );
+//Option 2 is to pass a View2d, see view_2d_handler
 
 ///C STYLE, HEAP MALLOC, 1 DIMENSION
 extern void c_style_heap_1d( void );
 
 ///C STYLE, HEAP MALLOC, 2 DIMENSION
 extern void c_style_heap_2d( void );
+//Array of pointers to rows, either one allocation per row or a single allocation with a table of row pointers
+extern void c_style_heap_2d_handler_rows( int **array_arg, int rows, int cols );
 
 ///C++ STYLE, HEAP NEW, 1 DIMENSION
 extern void cpp_style_heap_1d( void );
@@ -127,6 +151,26 @@ extern void cpp_style_heap_1d( void );
 ///C++ STYLE, HEAP NEW, 2 DIMENSIONS
 extern void cpp_style_heap_2d( void );
 
+///ARENA, HEAP, 1 AND 2 DIMENSIONS
+extern void arena_heap( void );
+
+///POOL, HEAP, 1 DIMENSION
+extern void pool_heap_1d( void );
+
+///ALIGNED, HEAP, 1 AND 2 DIMENSIONS
+extern void aligned_heap( void );
+
+///SMALL VECTOR, STACK THEN HEAP, 1 DIMENSION
+extern void small_vector_1d( void );
+
+///CONSTEXPR, STD::ARRAY, 1 DIMENSION
+//Generator of a table, must be constexpr to run at compile time
+constexpr int square_index( size_t index );
+extern void constexpr_array_1d( void );
+
+///STD::VECTOR, HEAP NEW, 1 DIMENSION
+extern void std_vector_heap_1d( void );
+
 /****************************************************************
 **	GLOBAL VARIABILE
 ****************************************************************/
@@ -172,6 +216,10 @@ int main()
 	//
 	//	DIMENSION
 	//
+	//	ALLOCATIONS
+	//		each section below is a scope of alloc_trace.h
+	//		build with -DALLOC_TRACE and alloc_trace.cpp to get allocations, bytes and peak per section at exit
+	//
 
 	cout << "OrangeBot Projects\n" << endl;
 
@@ -186,6 +234,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C STYLE, STACK, 1 DIMENSION" << endl;
+	alloc_trace_scope( "C STYLE, STACK, 1 DIMENSION" );
 	c_style_stack_1d();
 
 		///----------------------------------------------------------------
@@ -195,6 +244,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C STYLE, STACK, 2 DIMENSIONS" << endl;
+	alloc_trace_scope( "C STYLE, STACK, 2 DIMENSIONS" );
 	c_style_stack_2d();
 
 		///----------------------------------------------------------------
@@ -210,6 +260,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "STD::ARRAY, STACK, 1 DIMENSION" << endl;
+	alloc_trace_scope( "STD::ARRAY, STACK, 1 DIMENSION" );
 	cpp_std_array_stack_1d();
 
 		///----------------------------------------------------------------
@@ -219,6 +270,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "STD::ARRAY, STACK, 2 DIMENSIONS" << endl;
+	alloc_trace_scope( "STD::ARRAY, STACK, 2 DIMENSIONS" );
 	cpp_std_array_stack_2d();
 
 		///----------------------------------------------------------------
@@ -227,6 +279,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C STYLE, HEAP MALLOC, 1 DIMENSION" << endl;
+	alloc_trace_scope( "C STYLE, HEAP MALLOC, 1 DIMENSION" );
 	c_style_heap_1d();
 
 		///----------------------------------------------------------------
@@ -235,6 +288,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C STYLE, HEAP MALLOC, 2 DIMENSIONS" << endl;
+	alloc_trace_scope( "C STYLE, HEAP MALLOC, 2 DIMENSIONS" );
 	c_style_heap_2d();
 
 		///----------------------------------------------------------------
@@ -243,6 +297,7 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C++ STYLE, HEAP NEW, 1 DIMENSION" << endl;
+	alloc_trace_scope( "C++ STYLE, HEAP NEW, 1 DIMENSION" );
 	cpp_style_heap_1d();
 
 		///----------------------------------------------------------------
@@ -251,12 +306,75 @@ int main()
 
 	cout << endl << "------------------------" << endl;
 	cout << "C++ STYLE, HEAP NEW, 2 DIMENSION" << endl;
+	alloc_trace_scope( "C++ STYLE, HEAP NEW, 2 DIMENSION" );
 	cpp_style_heap_2d();
 
+		///----------------------------------------------------------------
+		///	ARENA, HEAP, 1 AND 2 DIMENSIONS
+		///----------------------------------------------------------------
+		//	Many short lived arrays. One big block, allocation bumps a pointer
+		//	All arrays of a scope are given back at once
+
+	cout << endl << "------------------------" << endl;
+	cout << "ARENA, HEAP, 1 AND 2 DIMENSIONS" << endl;
+	alloc_trace_scope( "ARENA, HEAP, 1 AND 2 DIMENSIONS" );
+	arena_heap();
+
+		///----------------------------------------------------------------
+		///	POOL, HEAP, 1 DIMENSION
+		///----------------------------------------------------------------
+		//	Many small arrays of a few sizes, from many threads
+		//	Size is rounded up to a class. Each thread keeps its own free blocks
+
+	cout << endl << "------------------------" << endl;
+	cout << "POOL, HEAP, 1 DIMENSION" << endl;
+	alloc_trace_scope( "POOL, HEAP, 1 DIMENSION" );
+	pool_heap_1d();
+
+		///----------------------------------------------------------------
+		///	ALIGNED, HEAP, 1 AND 2 DIMENSIONS
+		///----------------------------------------------------------------
+		//	First element on a cache line. Vector loads never straddle two lines
+		//	Threads working on different arrays never write the same line
+
+	cout << endl << "------------------------" << endl;
+	cout << "ALIGNED, HEAP, 1 AND 2 DIMENSIONS" << endl;
+	alloc_trace_scope( "ALIGNED, HEAP, 1 AND 2 DIMENSIONS" );
+	aligned_heap();
+
+		///----------------------------------------------------------------
+		///	SMALL VECTOR, STACK THEN HEAP, 1 DIMENSION
+		///----------------------------------------------------------------
+		//	Up to N elements inside the object, like a stack array
+		//	Moves to the heap when it grows past N, like std::vector
+
+	cout << endl << "------------------------" << endl;
+	cout << "SMALL VECTOR, STACK THEN HEAP, 1 DIMENSION" << endl;
+	alloc_trace_scope( "SMALL VECTOR, STACK THEN HEAP, 1 DIMENSION" );
+	small_vector_1d();
+
+		///----------------------------------------------------------------
+		///	CONSTEXPR, STD::ARRAY, 1 DIMENSION
+		///----------------------------------------------------------------
+		//	Tables computed by the compiler. Stored in the executable, no code runs to fill them
+		//	C++11 constexpr functions are a single return statement, see constexpr_array.h for the limits
+
+	cout << endl << "------------------------" << endl;
+	cout << "CONSTEXPR, STD::ARRAY, 1 DIMENSION" << endl;
+	alloc_trace_scope( "CONSTEXPR, STD::ARRAY, 1 DIMENSION" );
+	constexpr_array_1d();
+
 		///----------------------------------------------------------------
 		///	STD::VECTOR, HEAP NEW, 1 DIMENSION
 		///----------------------------------------------------------------
+		//	Size known at runtime, grows as elements are pushed. Frees itself when it goes out of scope
+		//	Growing allocates a new buffer and copies every element into it
+		//	ReallocVector does the same for trivially copyable elements without the copy: realloc, then mremap
 
+	cout << endl << "------------------------" << endl;
+	cout << "STD::VECTOR, HEAP NEW, 1 DIMENSION" << endl;
+	alloc_trace_scope( "STD::VECTOR, HEAP NEW, 1 DIMENSION" );
+	std_vector_heap_1d();
 
 
 	///----------------------------------------------------------------
@@ -313,6 +431,9 @@ void c_style_stack_1d( void )
 	//This needs the pointer to the first element and the size of the array
 	c_style_stack_1d_handler( my_initialized_1d_stack_array, num_elem );
 
+	//Pass a span. Size comes from the type of the array
+	span_1d_handler( my_initialized_1d_stack_array );
+
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
 	///--------------------------------------------------------------------------
@@ -344,8 +465,6 @@ void c_style_stack_1d_handler( int *array_arg, int size )
 	///--------------------------------------------------------------------------
 
 	int num_elem;
-	//fast counter
-	register int t;
 
 	///--------------------------------------------------------------------------
 	///	CHECK
@@ -372,12 +491,68 @@ void c_style_stack_1d_handler( int *array_arg, int size )
 
 	cout << "CONTENT" << endl;
 
-	for (t = 0;t < size;t++)
+	//Formatted into one buffer and written at once, instead of a << per element
+	array_print( array_arg, size );
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: c_style_stack_1d_handler
+
+/****************************************************************************
+**	span_1d_handler | Span<const int>
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	The span carries pointer and size. It does not own the elements.
+**	Pass it by value. The handler does not care what storage is behind the span
+****************************************************************************/
+
+void span_1d_handler( Span<const int> array_arg )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	int min, max;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << ">>pass by span" << endl;
+	cout << "Given size: " << array_arg.size() << endl;
+
+	cout << "CONTENT" << endl;
+
+	array_print( array_arg.data(), array_arg.size() );
+
+	//Pointer and size is all the vectorized kernels need
+	cout << "Sum: " << simd_sum( array_arg.data(), array_arg.size() );
+	if (simd_min_max( array_arg.data(), array_arg.size(), min, max ) == true)
 	{
-		cout << array_arg[t] << " | ";
+		cout << " | Min: " << min << " | Max: " << max;
 	}
-
-	cout << endl;
+	cout << " | Greater than 5: " << simd_count_greater( array_arg.data(), array_arg.size(), 5 ) << endl;
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -388,7 +563,7 @@ void c_style_stack_1d_handler( int *array_arg, int size )
 	///--------------------------------------------------------------------------
 
 	return;
-}	//end function: c_style_stack_1d_handler
+}	//end function: span_1d_handler | Span<const int>
 
 /****************************************************************************
 **	C STYLE, STACK, 2 DIMENSIONS
@@ -438,6 +613,13 @@ void c_style_stack_2d( void )
 	c_style_stack_2d_handler_pointer( &my_initialized_1d_stack_array[0][0], size, rows );
 	//Pass to a function that accept the right type, down to the number of columns
 	c_style_stack_2d_handler_type( my_initialized_1d_stack_array, size, rows );
+	//Pass a view. Extents come from the type of the array
+	view_2d_handler( my_initialized_1d_stack_array );
+	//Views can be sliced without copying the elements
+	cout << "Transpose" << endl;
+	view_2d_handler( View2d<int>( my_initialized_1d_stack_array ).transpose() );
+	cout << "Block of 2 rows x 3 cols starting at 0,1" << endl;
+	view_2d_handler( View2d<int>( my_initialized_1d_stack_array ).block( 0, 1, 2, 3 ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -469,9 +651,6 @@ void c_style_stack_2d_handler_pointer( int *array_arg, int size, int rows )
 	///	LOCAL VARIABILE
 	///--------------------------------------------------------------------------
 
-	//fast counters
-	register int t, ti;
-
 	///--------------------------------------------------------------------------
 	///	CHECK
 	///--------------------------------------------------------------------------
@@ -487,16 +666,8 @@ void c_style_stack_2d_handler_pointer( int *array_arg, int size, int rows )
 	cout << ">>pass by reference to first element" << endl;
 
 	cout << "CONTENT" << endl;
-	for (t = 0;t < size/rows;t++)
-	{
-		for (ti = 0;ti < rows;ti++)
-		{
-			//The array is sequenced into a single vector
-			//Compute the index of the element
-			cout << array_arg[t*rows +ti] << " | ";
-		}
-		cout << endl;
-	}
+	//The array is sequenced into a single vector: size/rows lines of rows elements. Index=t*rows +ti
+	array_print( View2d<const int>( array_arg, size/rows, rows ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -529,9 +700,6 @@ void c_style_stack_2d_handler_type( int array_arg[][5], int size, int rows )
 	///	LOCAL VARIABILE
 	///--------------------------------------------------------------------------
 
-	//fast counters
-	register int t, ti;
-
 	///--------------------------------------------------------------------------
 	///	CHECK
 	///--------------------------------------------------------------------------
@@ -547,16 +715,8 @@ void c_style_stack_2d_handler_type( int array_arg[][5], int size, int rows )
 	cout << ">>pass by using the correct multidimensional type" << endl;
 
 	cout << "CONTENT" << endl;
-	for (t = 0;t < size/rows;t++)
-	{
-		for (ti = 0;ti < rows;ti++)
-		{
-			//The array is sequenced into a single vector
-			//Compute the index of the element
-			cout << array_arg[t][ti] << " | ";
-		}
-		cout << endl;
-	}
+	//array_arg[t] is a row of 5 elements, the rows follow each other
+	array_print( View2d<const int>( array_arg[0], size/rows, rows ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -569,6 +729,57 @@ void c_style_stack_2d_handler_type( int array_arg[][5], int size, int rows )
 	return;
 }	//end function: c_style_stack_2d_handler_type | int [][5]
 
+/****************************************************************************
+**	view_2d_handler | View2d<const int>
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Option 3: the view carries pointer, rows, columns and strides
+**	A view is small and does not own the elements. Pass it by value.
+**	The handler does not care what storage is behind the view
+****************************************************************************/
+
+void view_2d_handler( View2d<const int> array_arg )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << ">>pass by view" << endl;
+	cout << "Rows: " << array_arg.rows() << " | Cols: " << array_arg.cols() << endl;
+
+	cout << "CONTENT" << endl;
+	//The view computes the index of each element from the strides
+	array_print( array_arg );
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: view_2d_handler | View2d<const int>
+
 /****************************************************************************
 **	cpp_std_array_stack_1d
 *****************************************************************************
@@ -602,12 +813,15 @@ void cpp_std_array_stack_1d( void )
 	///	BODY
 	///--------------------------------------------------------------------------
 
-	//Pass array as a whole (pass values). Require template to specialize the handler to the right type.
+	//Pass a span of the array (pass reference). Require template to specialize the handler to the right type.
 	cpp_std_array_stack_1d_handler_template<int,11>( my_initialized_1d_stack_array );
 
 	//Dark magic involving C++ RandomAccessIterator class. Does not require specialization. Pass by reference.
 	cpp_std_array_stack_1d_handler_iterator( my_initialized_1d_stack_array.begin(), my_initialized_1d_stack_array.end() );
 
+	//Pass a span. Same handler as the C style array
+	span_1d_handler( my_initialized_1d_stack_array );
+
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
 	///--------------------------------------------------------------------------
@@ -620,16 +834,17 @@ void cpp_std_array_stack_1d( void )
 }	//end function: cpp_std_array_stack_1d
 
 /****************************************************************************
-**	cpp_std_array_stack_1d_handler_template
+**	cpp_std_array_stack_1d_handler_template | Span<T,S>
 *****************************************************************************
 **	PARAMETER:
 **	RETURN:
 **	DESCRIPTION:
-**
+**	Span<T,S> is just a pointer. S is part of the type
+**	Passing std::array<T,S> by value would copy S elements on every call
 ****************************************************************************/
 
-template <typename T, int S>
-void cpp_std_array_stack_1d_handler_template( array<T, S> array_arg )
+template <typename T, std::size_t S>
+void cpp_std_array_stack_1d_handler_template( Span<T, S> array_arg )
 {
 	///--------------------------------------------------------------------------
 	///	STATIC VARIABILE
@@ -640,8 +855,6 @@ void cpp_std_array_stack_1d_handler_template( array<T, S> array_arg )
 	///--------------------------------------------------------------------------
 
 	int num_elem;
-	//fast counter
-	register int t;
 
 	///--------------------------------------------------------------------------
 	///	CHECK
@@ -655,25 +868,19 @@ void cpp_std_array_stack_1d_handler_template( array<T, S> array_arg )
 	///	BODY
 	///--------------------------------------------------------------------------
 
-	cout << ">>passing std::array to an handling function as a whole" << endl;
+	cout << ">>passing std::array to an handling function as a span" << endl;
 
-	//Try to compute the size anyway. Spoiler: this does not work. It compute the size of the pointer itself
+	//The size is part of the type of the span
 	num_elem = array_arg.size();
 
 	cout << "Given size: " << num_elem << endl;
-	cout << "Cant compute size of this array outside the scope it was declared" << endl;
 
 	array_arg[1] = -99;
-	cout << "element[2]= -99 | content can be edited" << endl;
+	cout << "element[2]= -99 | content can be edited, the caller sees the change" << endl;
 
 	cout << "CONTENT" << endl;
 
-	for (t = 0;t < S;t++)
-	{
-		cout << array_arg[t] << " | ";
-	}
-
-	cout << endl;
+	array_print( array_arg.data(), S );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -684,7 +891,7 @@ void cpp_std_array_stack_1d_handler_template( array<T, S> array_arg )
 	///--------------------------------------------------------------------------
 
 	return;
-}	//end function: cpp_std_array_stack_1d_handler_template
+}	//end function: cpp_std_array_stack_1d_handler_template | Span<T,S>
 
 /****************************************************************************
 **	cpp_std_array_stack_1d_handler_iterator | RandomAccessIterator, RandomAccessIterator
@@ -725,7 +932,8 @@ extern void cpp_std_array_stack_1d_handler_iterator(RandomAccessIterator first,
 	cout << ">>passing std::array iterators to an handling function" << endl;
 
 	cout << "CONTENT" << endl;
-	for (;first <= last;first++)
+	//last is one past the last element
+	for (;first < last;first++)
 	{
 		cout << *first << " | ";
 	}
@@ -783,9 +991,12 @@ void cpp_std_array_stack_2d( void )
 	//Option 0 is to pass it as you would a C array with pointer and dimensions. I can use the function written before
 	c_style_stack_2d_handler_pointer( &my_initialized_1d_stack_array[0][0], 5*2, 5 );
 
-	//Option 1 Pass array as a whole (pass values). Require template to specialize the handler to the right type.
+	//Option 1 Pass a span of the rows (pass reference). Require template to specialize the handler to the right type.
 	cpp_std_array_stack_2d_handler_template<int,2,5>( my_initialized_1d_stack_array );
 
+	//Option 2 Pass a view. Extents come from the type of the array. Same handler as the C style array
+	view_2d_handler( my_initialized_1d_stack_array );
+
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
 	///--------------------------------------------------------------------------
@@ -798,17 +1009,18 @@ void cpp_std_array_stack_2d( void )
 }	//end function: cpp_std_array_stack_2d | void
 
 /****************************************************************************
-**	cpp_std_array_stack_1d_handler_template | std::array<std::array<int,C>,R>
+**	cpp_std_array_stack_2d_handler_template | Span<const std::array<T,C>,R>
 *****************************************************************************
 **	PARAMETER:
 **	RETURN:
 **	DESCRIPTION:
 **	Option 1 is to use a template specialization to pass the right type
 **	Nice because it allows to use bracers without writing translation of address by hand
+**	The span is a pointer to the first row. Rows are not copied
 ****************************************************************************/
 
-template <typename T, int R, int C>
-void cpp_std_array_stack_2d_handler_template( array<array<int,C>,R> array_arg )
+template <typename T, std::size_t R, std::size_t C>
+void cpp_std_array_stack_2d_handler_template( Span<const array<T,C>,R> array_arg )
 {
 	///--------------------------------------------------------------------------
 	///	STATIC VARIABILE
@@ -819,8 +1031,6 @@ void cpp_std_array_stack_2d_handler_template( array<array<int,C>,R> array_arg )
 	///--------------------------------------------------------------------------
 
 	int num_elem;
-	//fast counter
-	register int t, ti;
 
 	///--------------------------------------------------------------------------
 	///	CHECK
@@ -834,25 +1044,17 @@ void cpp_std_array_stack_2d_handler_template( array<array<int,C>,R> array_arg )
 	///	BODY
 	///--------------------------------------------------------------------------
 
-	cout << ">>passing std::array to an handling function as a whole" << endl;
+	cout << ">>passing std::array to an handling function as a span of rows" << endl;
 
-	//Try to compute the size anyway. Spoiler: this does not work. It compute the size of the pointer itself
+	//Number of rows is part of the type of the span
 	num_elem = array_arg.size();
 
-	cout << "Given size: " << num_elem << endl;
-	cout << "Cant compute size of this array outside the scope it was declared" << endl;
+	cout << "Given rows: " << num_elem << endl;
 
 	cout << "CONTENT" << endl;
 
-	for (t = 0;t < R;t++)
-	{
-
-		for (ti = 0;ti < C;ti++)
-		{
-			cout << array_arg[t][ti] << " | ";
-		}
-		cout << endl;
-	}
+	//Rows are std::array<T,C> one after the other: R x C elements from the first one
+	array_print( View2d<const T>( array_arg[0].data(), R, C ) );
 
 	cout << endl;
 
@@ -865,7 +1067,7 @@ void cpp_std_array_stack_2d_handler_template( array<array<int,C>,R> array_arg )
 	///--------------------------------------------------------------------------
 
 	return;
-}	//end function: cpp_std_array_stack_1d_handler_template | std::array<std::array<int,C>,R>
+}	//end function: cpp_std_array_stack_2d_handler_template | Span<const std::array<T,C>,R>
 
 /****************************************************************************
 **	c_style_heap_1d | void
@@ -919,6 +1121,8 @@ void c_style_heap_1d( void )
 
 	//Can reuse the handler written previously
 	c_style_stack_1d_handler( my_heap_array, 11 );
+	//Or wrap pointer and size in a span
+	span_1d_handler( Span<const int>( my_heap_array, 11 ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -945,7 +1149,10 @@ void c_style_heap_1d( void )
 **	DESCRIPTION:
 **	There are two ways of doing things.
 **	Either make an array of pointers to arrays
-**	or make an array and use subscript to
+**	or make an array and use subscript to compute the index of the element
+**	A third way makes a single allocation holding both the pointers and the elements
+**	Rows and columns are variables: they need not be known at compile time
+**	See heap_2d.h for the tradeoffs of each layout
 ****************************************************************************/
 
 void c_style_heap_2d( void )
@@ -958,6 +1165,20 @@ void c_style_heap_2d( void )
 	///	LOCAL VARIABILE
 	///--------------------------------------------------------------------------
 
+	//Content of the array
+	int my_initialized_2d_stack_array[][5] = { { 0, 9, 1, 8, 2 }, { 7, 3, 6, 4, 5 } };
+	//Dimensions. Could come from user input
+	int rows = 2;
+	int cols = 5;
+	//Option 1: array of pointers to rows
+	int **my_heap_rows = NULL;
+	//Option 2: single block with computed subscript
+	int *my_heap_block = NULL;
+	//Option 3: single allocation with table of pointers to rows
+	int **my_heap_table = NULL;
+	//fast counters
+	register int t, ti;
+
 	///--------------------------------------------------------------------------
 	///	CHECK
 	///--------------------------------------------------------------------------
@@ -966,14 +1187,61 @@ void c_style_heap_2d( void )
 	///	INITIALIZATIONS
 	///--------------------------------------------------------------------------
 
+	cout << "Allocate array of pointers to rows with malloc. One malloc per row" << endl;
+	my_heap_rows = heap_2d_rows_alloc( rows, cols );
+	cout << "Allocate single block with malloc" << endl;
+	my_heap_block = heap_2d_block_alloc( rows, cols );
+	cout << "Allocate table of pointers and elements with a single malloc" << endl;
+	my_heap_table = heap_2d_table_alloc( rows, cols );
+
+	if ((my_heap_rows == NULL) || (my_heap_block == NULL) || (my_heap_table == NULL))
+	{
+		cerr << "malloc failed" << endl;
+		exit(-1);
+	}
+
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			//Rows and table can use the double subscript
+			my_heap_rows[t][ti] = my_initialized_2d_stack_array[t][ti];
+			my_heap_table[t][ti] = my_initialized_2d_stack_array[t][ti];
+			//Block must compute the index by hand
+			my_heap_block[t*cols +ti] = my_initialized_2d_stack_array[t][ti];
+		}
+	}
+
 	///--------------------------------------------------------------------------
 	///	BODY
 	///--------------------------------------------------------------------------
 
+	//Option 1: pass the pointers to rows and both dimensions
+	c_style_heap_2d_handler_rows( my_heap_rows, rows, cols );
+
+	//Option 2: a block is what a stack array looks like in memory. Can reuse the handler written previously
+	c_style_stack_2d_handler_pointer( my_heap_block, rows *cols, cols );
+	//A view of the block gives extents to the same handler used for stack arrays
+	view_2d_handler( View2d<int>( my_heap_block, rows, cols ) );
+
+	//Option 3: same type as option 1, same handler
+	c_style_heap_2d_handler_rows( my_heap_table, rows, cols );
+
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
 	///--------------------------------------------------------------------------
 
+	cout << "Deallocate arrays" << endl;
+
+	//Rows must be freed one by one
+	heap_2d_rows_free( my_heap_rows, rows );
+	my_heap_rows = NULL;
+	//Block and table are a single allocation
+	free( my_heap_block );
+	my_heap_block = NULL;
+	free( my_heap_table );
+	my_heap_table = NULL;
+
 	///--------------------------------------------------------------------------
 	///	RETURN
 	///--------------------------------------------------------------------------
@@ -981,6 +1249,65 @@ void c_style_heap_2d( void )
 	return;
 }	//end function: c_style_heap_2d | void
 
+/****************************************************************************
+**	c_style_heap_2d_handler_rows | int **, int, int
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	array_arg[r] is a pointer to row r. Nice because it allows to use bracers
+**	without writing translation of address by hand, even when columns are not known at compile time
+****************************************************************************/
+
+void c_style_heap_2d_handler_rows( int **array_arg, int rows, int cols )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	register int t, ti;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << ">>pass by pointer to pointers to rows" << endl;
+
+	cout << "CONTENT" << endl;
+	for (t = 0;t < rows;t++)
+	{
+		for (ti = 0;ti < cols;ti++)
+		{
+			//First load the pointer to the row, then the element
+			cout << array_arg[t][ti] << " | ";
+		}
+		cout << endl;
+	}
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: c_style_heap_2d_handler_rows | int **, int, int
+
 /****************************************************************************
 **	cpp_style_heap_1d | void
 *****************************************************************************
@@ -1022,8 +1349,8 @@ void cpp_style_heap_1d( void )
 		cerr << "malloc failed" << endl;
 		exit(-1);
 	}
-	//Copy 11 bytes from the constant array to the heap array
-	memmove( my_heap_array, my_initialized_1d_stack_array, 11 *sizeof(int) );
+	//Copy 11 ints from the constant array to the heap array. array_copy picks the strategy by size, see array_copy.h
+	array_copy( my_heap_array, my_initialized_1d_stack_array, 11 );
 
 	///--------------------------------------------------------------------------
 	///	BODY
@@ -1031,6 +1358,8 @@ void cpp_style_heap_1d( void )
 
 	//Can reuse the handler written previously
 	c_style_stack_1d_handler( my_heap_array, 11 );
+	//Or wrap pointer and size in a span
+	span_1d_handler( Span<const int>( my_heap_array, 11 ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -1099,6 +1428,8 @@ void cpp_style_heap_2d( void )
 
 	//Can reuse the handler written previously
 	c_style_stack_2d_handler_pointer( my_heap_array, 10, 5 );
+	//Or wrap pointer and dimensions in a view
+	view_2d_handler( View2d<int>( my_heap_array, 2, 5 ) );
 
 	///--------------------------------------------------------------------------
 	///	FINALIZATIONS
@@ -1118,6 +1449,425 @@ void cpp_style_heap_2d( void )
 }	//end function:
 
 
+/****************************************************************************
+**	arena_heap | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Arrays are allocated from an arena instead of malloc/new
+**	There is no free: the scope gives everything back when it ends
+**	The blocks of the arena are kept. The next scope allocates nothing from the system
+****************************************************************************/
+
+void arena_heap( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Content of the arrays
+	int my_initialized_1d_stack_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+	int my_initialized_2d_stack_array[][5] = { { 0, 9, 1, 8, 2 }, { 7, 3, 6, 4, 5 } };
+	//Arena. Allocates its first block on first use
+	Arena my_arena;
+	//Pointers to arrays
+	int *my_arena_1d_array = NULL;
+	int *my_arena_2d_array = NULL;
+	//fast counter
+	register int t;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//Two frames. The second reuses the memory of the first
+	for (t = 0;t < 2;t++)
+	{
+		//Everything allocated from the arena inside this scope is dropped at the end of it
+		ArenaScope my_scope( my_arena );
+
+		cout << "Frame " << t << " | Allocate arrays from the arena" << endl;
+		my_arena_1d_array = my_arena.allocate_array<int>( 11 );
+		my_arena_2d_array = my_arena.allocate_array<int>( 2 *5 );
+
+		if ((my_arena_1d_array == NULL) || (my_arena_2d_array == NULL))
+		{
+			cerr << "arena failed" << endl;
+			exit(-1);
+		}
+		memmove( my_arena_1d_array, my_initialized_1d_stack_array, 11 *sizeof(int) );
+		memmove( my_arena_2d_array, my_initialized_2d_stack_array, 10 *sizeof(int) );
+
+		//Arena arrays are plain pointers. Can reuse the handlers written previously
+		c_style_stack_1d_handler( my_arena_1d_array, 11 );
+		view_2d_handler( View2d<int>( my_arena_2d_array, 2, 5 ) );
+
+		//std::vector can draw from the arena with an allocator adapter
+		vector<int, ArenaAllocator<int> > my_arena_vector( my_initialized_1d_stack_array, my_initialized_1d_stack_array +11, ArenaAllocator<int>( my_arena ) );
+		span_1d_handler( Span<const int>( my_arena_vector.data(), my_arena_vector.size() ) );
+
+		cout << "Arena holds " << my_arena.capacity() << " bytes. Scope ends, arrays are dropped" << endl;
+	}
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	//Arena destructor frees the blocks
+	my_arena_1d_array = NULL;
+	my_arena_2d_array = NULL;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: arena_heap | void
+
+/****************************************************************************
+**	pool_heap_1d | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Same as c_style_heap_1d with pool_alloc/pool_free instead of malloc/free
+**	Unlike free, pool_free needs the size given to pool_alloc
+****************************************************************************/
+
+void pool_heap_1d( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Content of the array
+	int my_initialized_1d_stack_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+	//Pointer to array
+	int *my_pool_array = NULL;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	cout << "Allocate array with pool_alloc" << endl;
+	my_pool_array = (int *)pool_alloc( 11 *sizeof(int) );
+
+	if (my_pool_array == NULL)
+	{
+		cerr << "pool_alloc failed" << endl;
+		exit(-1);
+	}
+	memmove( my_pool_array, my_initialized_1d_stack_array, 11 *sizeof(int) );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//Can reuse the handler written previously
+	c_style_stack_1d_handler( my_pool_array, 11 );
+
+	//std::vector can draw from the pool with its allocator
+	vector<int, PoolAllocator<int> > my_pool_vector( my_initialized_1d_stack_array, my_initialized_1d_stack_array +11 );
+	span_1d_handler( Span<const int>( my_pool_vector.data(), my_pool_vector.size() ) );
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	cout << "Deallocate array" << endl;
+
+	//Give the block back to the free list of this thread
+	pool_free( my_pool_array, 11 *sizeof(int) );
+	my_pool_array = NULL;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: pool_heap_1d | void
+
+/****************************************************************************
+**	aligned_heap | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	AlignedArray owns its elements like std::vector and frees them when it goes out of scope
+**	The same object is passed to the pointer, Span and View2d handlers
+****************************************************************************/
+
+void aligned_heap( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Content of the array
+	int my_initialized_1d_stack_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	cout << "Allocate array aligned to a cache line" << endl;
+	//Throws std::bad_alloc on failure, like new
+	AlignedArray<int> my_aligned_array( 11 );
+	memmove( my_aligned_array.data(), my_initialized_1d_stack_array, 11 *sizeof(int) );
+	cout << "Address modulo " << my_aligned_array.alignment() << ": " << (size_t)my_aligned_array.data() %my_aligned_array.alignment() << endl;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//Can reuse the handlers written previously
+	c_style_stack_1d_handler( my_aligned_array.data(), (int)my_aligned_array.size() );
+	span_1d_handler( my_aligned_array );
+	//First 10 elements as 2 rows of 5
+	view_2d_handler( my_aligned_array.view( 2, 5 ) );
+
+	//Alignment up to a page
+	AlignedArray<int, 4096> my_page_array( 10, 1 );
+	cout << "Address modulo " << my_page_array.alignment() << ": " << (size_t)my_page_array.data() %my_page_array.alignment() << endl;
+	view_2d_handler( my_page_array.view( 2, 5 ) );
+
+	//Passes over large arrays can use all the threads of the pool
+	AlignedArray<int> my_large_array( 1 << 20 );
+	parallel_for( my_large_array, []( int &x ) { x = 1; } );
+	cout << "Parallel sum of " << my_large_array.size() << " ones: " << parallel_reduce( my_large_array, (long long)0, []( long long acc, long long x ) { return acc +x; } ) << endl;
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	//Elements are freed when the arrays go out of scope
+	cout << "Deallocate arrays" << endl;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: aligned_heap | void
+
+/****************************************************************************
+**	small_vector_1d | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	SmallVector with room for 8 ints in the object. The 9th push moves the elements to the heap
+****************************************************************************/
+
+void small_vector_1d( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	int t;
+	//Content of the array
+	int my_initialized_1d_stack_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+	SmallVector<int, 8> my_small_vector;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < 11;t++)
+	{
+		my_small_vector.push_back( my_initialized_1d_stack_array[t] );
+		cout << "Size: " << my_small_vector.size() << " | Capacity: " << my_small_vector.capacity() << " | " << ((my_small_vector.is_inline() == true) ?("inline") :("heap")) << endl;
+	}
+
+	//Can reuse the handlers written previously
+	c_style_stack_1d_handler( my_small_vector.data(), (int)my_small_vector.size() );
+	span_1d_handler( my_small_vector );
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	//Heap buffer is freed when the vector goes out of scope
+	cout << "Deallocate vector" << endl;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: small_vector_1d | void
+
+/****************************************************************************
+**	square_index | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Lookup table generator. One return statement, as C++11 constexpr requires
+****************************************************************************/
+
+constexpr int square_index( size_t index )
+{
+	return (int)(index *index);
+}	//end function: square_index | size_t
+
+/****************************************************************************
+**	constexpr_array_1d | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	The permutation of c_style_stack_1d, sorted, summed and inverted at compile time
+**	static constexpr: the tables are in .rodata, not copied on the stack at every call
+****************************************************************************/
+
+void constexpr_array_1d( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	//Content of the array
+	static constexpr int my_constexpr_1d_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+	//0, 1, 2... 10
+	static constexpr array<int,11> my_sorted_array = constexpr_sort( my_constexpr_1d_array );
+	//0, 1, 3, 6... 55
+	static constexpr array<int,11> my_prefix_sum_array = constexpr_prefix_sum( my_sorted_array );
+	//Position of each value in my_constexpr_1d_array
+	static constexpr array<int,11> my_position_array = constexpr_inverse( my_constexpr_1d_array );
+	//0, 1, 4, 9... 100
+	static constexpr array<int,11> my_square_array = constexpr_generate<int,11>( square_index );
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	//The tables are constants: the compiler can check them
+	static_assert( my_sorted_array[10] == 10, "sort" );
+	static_assert( my_prefix_sum_array[10] == 55, "prefix sum" );
+	static_assert( my_constexpr_1d_array[my_position_array[9]] == 9, "inverse" );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	cout << "Sorted" << endl;
+	span_1d_handler( my_sorted_array );
+	cout << "Prefix sum" << endl;
+	span_1d_handler( my_prefix_sum_array );
+	cout << "Position of each value" << endl;
+	span_1d_handler( my_position_array );
+	cout << "Squares" << endl;
+	span_1d_handler( my_square_array );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: constexpr_array_1d | void
+
+/****************************************************************************
+**	std_vector_heap_1d | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	std::vector and ReallocVector grown by push_back, no reserve.
+**	Watch the buffer: std::vector moves it at every growth, ReallocVector often keeps it
+****************************************************************************/
+
+void std_vector_heap_1d( void )
+{
+	///--------------------------------------------------------------------------
+	///	STATIC VARIABILE
+	///--------------------------------------------------------------------------
+
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	int t;
+	//Content of the array
+	int my_initialized_1d_stack_array[] = { 0, 10, 9, 1, 8, 2, 7, 3, 6, 4, 5 };
+	vector<int> my_vector;
+	ReallocVector<int> my_realloc_vector;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t < 11;t++)
+	{
+		my_vector.push_back( my_initialized_1d_stack_array[t] );
+		cout << "Size: " << my_vector.size() << " | Capacity: " << my_vector.capacity() << " | Buffer: " << (void *)my_vector.data() << endl;
+	}
+
+	//Can reuse the handlers written previously
+	c_style_stack_1d_handler( my_vector.data(), (int)my_vector.size() );
+	span_1d_handler( Span<const int>( my_vector.data(), my_vector.size() ) );
+
+	for (t = 0;t < 11;t++)
+	{
+		my_realloc_vector.push_back( my_initialized_1d_stack_array[t] );
+		cout << "Size: " << my_realloc_vector.size() << " | Capacity: " << my_realloc_vector.capacity() << " | Buffer: " << (void *)my_realloc_vector.data() << endl;
+	}
+	span_1d_handler( my_realloc_vector );
+
+	//Past REALLOC_VECTOR_MAP_BYTES the buffer becomes a mapping. Elements are not written until they are used
+	my_realloc_vector.resize_uninitialized( REALLOC_VECTOR_MAP_BYTES /sizeof(int) );
+	cout << "Size: " << my_realloc_vector.size() << " | " << ((my_realloc_vector.is_mapped() == true) ?("mapping") :("malloc")) << " | First elements kept: " << my_realloc_vector[0] << " " << my_realloc_vector[1] << " " << my_realloc_vector[2] << endl;
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	//Both buffers are freed when the vectors go out of scope
+	cout << "Deallocate vectors" << endl;
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: std_vector_heap_1d | void
+
 /****************************************************************************
 **
 *****************************************************************************
@@ -0,0 +1,564 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	GEMM
+*****************************************************************
+**	Tiled, multithreaded matrix multiply of contiguous 2D arrays
+**	C++11 standard, GCC or Clang
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	C = A*B. A is m x k, B is k x n, C is m x n, all row-major blocks like new T[R*C].
+**	T is int, float or double. int wraps on overflow like unsigned.
+**
+**	The naive triple loop reads B by columns and reloads everything from memory for every row of C.
+**	Here, in the usual layered way:
+**		C is cut in tiles of GEMM_MC rows x GEMM_NC columns. Threads take tiles from a shared counter
+**		k is cut in slices of GEMM_KC. For each slice the thread packs
+**			the GEMM_KC x GEMM_NC panel of B in strips GEMM_NR wide		stays in L3 / L2
+**			the GEMM_MC x GEMM_KC block of A in strips GEMM_MR tall		stays in L2
+**		a micro kernel computes GEMM_MR x NR elements of C in registers, reading a strip of each
+**	Packing makes the micro kernel read both strips sequentially, with no stride and no tail.
+**	Strips on the edges are padded with zeros; the result of an edge micro tile goes through a small buffer.
+**
+**	The micro kernel is written once with GCC vector extensions, NR is two vectors,
+**	and compiled for SSE (16 byte), AVX2+FMA (32 byte) and AVX-512 (64 byte). simd_isa() of simd.h picks one.
+**	Float results depend on the path: FMA rounds once, the order of the sums changes with the tiles.
+**
+**	THREADS
+**	gemm( a, b, c, m, n, k, num_threads ). 0 threads means all the threads of thread_pool_default().
+**	Each thread of the pool runs a worker with its own packing buffers. Small products run on the caller.
+**	A 1024 x 1024 product is only 11 tiles of 96 x 1024. When there are fewer than GEMM_TILES_PER_THREAD
+**	tiles per thread, tiles are cut narrower, down to a strip, then shorter, down to GEMM_MR rows.
+**	Narrower tiles also pack a smaller panel of B, closer to L2.
+****************************************************************/
+
+#ifndef GEMM_H_
+#define GEMM_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstring>		//for memcpy
+//Standard C++ libraries
+#include <vector>		//for std::vector
+#include <atomic>		//for std::atomic
+#include <algorithm>	//for std::min, std::fill
+//User libraries
+#include "simd.h"		//for simd_isa, Simd_vec, SIMD_INLINE
+#include "aligned_array.h"	//for AlignedArray
+#include "parallel.h"	//for thread_pool_default
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Rows of a micro tile
+#define GEMM_MR		6
+//Rows of a tile of C. Multiple of GEMM_MR. Packed A takes GEMM_MC*GEMM_KC elements
+#define GEMM_MC		96
+//Columns of a tile of C
+#define GEMM_NC		1024
+//Slice of the inner dimension
+#define GEMM_KC		256
+//Elements of a packed block of A: GEMM_MC rows rounded up to whole strips
+#define GEMM_MC_PACKED	(((GEMM_MC +GEMM_MR -1) /GEMM_MR) *GEMM_MR *GEMM_KC)
+//Below this many multiply-adds the product runs on the caller, waking the pool would cost more than it saves
+#define GEMM_MIN_PARALLEL	((size_t)1 << 21)
+//Tiles wanted per worker. A few more tiles than threads keep the last round from running on a few threads
+#define GEMM_TILES_PER_THREAD	4
+
+//FMA fuses a*b +c. fp-contract lets the compiler use it for the vector expression, -std=c++11 turns it off
+#define GEMM_TARGET_AVX2	__attribute__(( target( "avx2,fma" ), optimize( "fp-contract=fast" ) ))
+#define GEMM_TARGET_AVX512	__attribute__(( target( "avx512f,fma" ), optimize( "fp-contract=fast" ) ))
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Arithmetic type of the kernel. int is computed as unsigned: same bits, wraps instead of overflowing
+template <typename T>
+struct Gemm_lane
+{
+	typedef T type;
+};
+
+template <>
+struct Gemm_lane<int>
+{
+	typedef unsigned int type;
+};
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+template <typename T>
+inline void gemm( const T *a, const T *b, T *c, size_t m, size_t n, size_t k, unsigned int num_threads = 0 );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	gemm_pack_a | const T *, size_t, size_t, size_t, T *
+*****************************************************************************
+**	PARAMETER:
+**	a		first element of the block. lda elements from a row to the next
+**	RETURN:
+**	DESCRIPTION:
+**	mc x kc block in strips of GEMM_MR rows. Inside a strip, column after column:
+**	the micro kernel reads GEMM_MR consecutive elements per step of k. Missing rows are zeros
+****************************************************************************/
+
+template <typename T>
+inline void gemm_pack_a( const T *a, size_t lda, size_t mc, size_t kc, T *pa )
+{
+	//fast counters
+	size_t i0, i, p;
+
+	for (i0 = 0;i0 < mc;i0 += GEMM_MR)
+	{
+		for (p = 0;p < kc;p++)
+		{
+			for (i = 0;i < GEMM_MR;i++)
+			{
+				*pa++ = (i0 +i < mc) ?(a[(i0 +i) *lda +p]) :(T());
+			}
+		}
+	}
+
+	return;
+}	//end function: gemm_pack_a | const T *, size_t, size_t, size_t, T *
+
+/****************************************************************************
+**	gemm_pack_b | const T *, size_t, size_t, size_t, size_t, T *
+*****************************************************************************
+**	PARAMETER:
+**	nr		width of a strip, from the micro kernel
+**	RETURN:
+**	DESCRIPTION:
+**	kc x nc panel in strips of nr columns. Inside a strip, row after row. Missing columns are zeros
+****************************************************************************/
+
+template <typename T>
+inline void gemm_pack_b( const T *b, size_t ldb, size_t kc, size_t nc, size_t nr, T *pb )
+{
+	//fast counters
+	size_t j0, j, p;
+
+	for (j0 = 0;j0 < nc;j0 += nr)
+	{
+		for (p = 0;p < kc;p++)
+		{
+			if (j0 +nr <= nc)
+			{
+				memcpy( pb, b +p *ldb +j0, nr *sizeof(T) );
+				pb += nr;
+			}
+			else
+			{
+				for (j = 0;j < nr;j++)
+				{
+					*pb++ = (j0 +j < nc) ?(b[p *ldb +j0 +j]) :(T());
+				}
+			}
+		}
+	}
+
+	return;
+}	//end function: gemm_pack_b | const T *, size_t, size_t, size_t, size_t, T *
+
+/****************************************************************************
+**	gemm_micro_kernel | size_t, const T *, const T *, T *, size_t, bool
+*****************************************************************************
+**	PARAMETER:
+**	pa		strip of packed A, GEMM_MR x kc
+**	pb		strip of packed B, kc x NR
+**	c		GEMM_MR x NR micro tile, ldc elements from a row to the next
+**	first	first slice of k: overwrite c instead of adding to it
+**	RETURN:
+**	DESCRIPTION:
+**	NR = 2 vectors of W bytes. 2*GEMM_MR vector accumulators stay in registers for the whole slice.
+**	Each step of k: two vector loads of B, GEMM_MR broadcasts of A, 2*GEMM_MR multiply-adds.
+**	The loops on the rows must be unrolled, or the accumulators live on the stack
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE void gemm_micro_kernel( size_t kc, const T *pa, const T *pb, T *c, size_t ldc, bool first )
+{
+	typedef typename Gemm_lane<T>::type U;
+	typedef typename Simd_vec<U, W>::type V;
+	const size_t lanes = W /sizeof(T);
+	//fast counters
+	size_t p;
+	int i;
+	V acc0[GEMM_MR], acc1[GEMM_MR];
+	V b0, b1, c0, c1;
+	U a;
+
+#pragma GCC unroll 16
+	for (i = 0;i < GEMM_MR;i++)
+	{
+		acc0[i] = V();
+		acc1[i] = V();
+	}
+	for (p = 0;p < kc;p++)
+	{
+		memcpy( &b0, pb, W );
+		memcpy( &b1, pb +lanes, W );
+#pragma GCC unroll 16
+		for (i = 0;i < GEMM_MR;i++)
+		{
+			a = (U)pa[i];
+			acc0[i] += a *b0;
+			acc1[i] += a *b1;
+		}
+		pa += GEMM_MR;
+		pb += 2 *lanes;
+	}
+#pragma GCC unroll 16
+	for (i = 0;i < GEMM_MR;i++)
+	{
+		if (first == false)
+		{
+			memcpy( &c0, c +i *ldc, W );
+			memcpy( &c1, c +i *ldc +lanes, W );
+			acc0[i] += c0;
+			acc1[i] += c1;
+		}
+		memcpy( c +i *ldc, &acc0[i], W );
+		memcpy( c +i *ldc +lanes, &acc1[i], W );
+	}
+
+	return;
+}	//end function: gemm_micro_kernel | size_t, const T *, const T *, T *, size_t, bool
+
+/****************************************************************************
+**	gemm_macro_kernel | size_t, size_t, size_t, const T *, const T *, T *, size_t, bool
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	mc x nc block of C from packed A and packed B. Micro tiles that stick out of the block
+**	are computed in a buffer and only the part inside is copied to C
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE void gemm_macro_kernel( size_t mc, size_t nc, size_t kc, const T *pa, const T *pb, T *c, size_t ldc, bool first )
+{
+	const size_t nr = 2 *W /sizeof(T);
+	//fast counters
+	size_t ir, jr, i, j;
+	size_t mr_used, nr_used;
+	T edge[GEMM_MR *2 *64 /sizeof(T)];
+
+	for (jr = 0;jr < nc;jr += nr)
+	{
+		nr_used = std::min( nr, nc -jr );
+		for (ir = 0;ir < mc;ir += GEMM_MR)
+		{
+			mr_used = std::min( (size_t)GEMM_MR, mc -ir );
+			if ((mr_used == GEMM_MR) && (nr_used == nr))
+			{
+				gemm_micro_kernel<T, W>( kc, pa +ir *kc, pb +jr *kc, c +ir *ldc +jr, ldc, first );
+			}
+			else
+			{
+				gemm_micro_kernel<T, W>( kc, pa +ir *kc, pb +jr *kc, edge, nr, true );
+				for (i = 0;i < mr_used;i++)
+				{
+					for (j = 0;j < nr_used;j++)
+					{
+						if (first == true)
+						{
+							c[(ir +i) *ldc +jr +j] = edge[i *nr +j];
+						}
+						else
+						{
+							c[(ir +i) *ldc +jr +j] = (T)((typename Gemm_lane<T>::type)c[(ir +i) *ldc +jr +j] +(typename Gemm_lane<T>::type)edge[i *nr +j]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return;
+}	//end function: gemm_macro_kernel | size_t, size_t, size_t, const T *, const T *, T *, size_t, bool
+
+/****************************************************************************
+**	INSTRUCTION SET WRAPPERS
+*****************************************************************************
+**	The macro kernel and the micro kernel are inlined and compiled for the target of the wrapper.
+**	The 16 byte version has no target: it is SSE2 on x86-64, the generic vector code elsewhere
+****************************************************************************/
+
+template <typename T>
+void gemm_macro_16( size_t mc, size_t nc, size_t kc, const T *pa, const T *pb, T *c, size_t ldc, bool first )
+{
+	gemm_macro_kernel<T, 16>( mc, nc, kc, pa, pb, c, ldc, first );
+}
+
+#if defined( SIMD_X86 )
+
+template <typename T>
+GEMM_TARGET_AVX2 void gemm_macro_32( size_t mc, size_t nc, size_t kc, const T *pa, const T *pb, T *c, size_t ldc, bool first )
+{
+	gemm_macro_kernel<T, 32>( mc, nc, kc, pa, pb, c, ldc, first );
+}
+
+template <typename T>
+GEMM_TARGET_AVX512 void gemm_macro_64( size_t mc, size_t nc, size_t kc, const T *pa, const T *pb, T *c, size_t ldc, bool first )
+{
+	gemm_macro_kernel<T, 64>( mc, nc, kc, pa, pb, c, ldc, first );
+}
+
+#endif	//SIMD_X86
+
+/****************************************************************************
+**	gemm_vector_bytes | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	width of the vectors of the micro kernel
+**	DESCRIPTION:
+**	The AVX2 kernel also needs FMA. Every AVX2 CPU so far has it, but it is a separate flag
+****************************************************************************/
+
+inline size_t gemm_vector_bytes( void )
+{
+#if defined( SIMD_X86 )
+	if (simd_isa() >= SIMD_AVX512)
+	{
+		return 64;
+	}
+	if ((simd_isa() >= SIMD_AVX2) && (__builtin_cpu_supports( "fma" )))
+	{
+		return 32;
+	}
+#endif
+
+	return 16;
+}	//end function: gemm_vector_bytes | void
+
+/****************************************************************************
+**	gemm_pack_size | size_t
+*****************************************************************************
+**	PARAMETER:
+**	w		vector width in bytes
+**	RETURN:
+**	elements of the buffer of a thread: packed A, then packed B rounded up to whole strips
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T>
+inline size_t gemm_pack_size( size_t w )
+{
+	const size_t nr = 2 *w /sizeof(T);
+
+	return GEMM_MC_PACKED +((GEMM_NC +nr -1) /nr) *nr *GEMM_KC;
+}	//end function: gemm_pack_size | size_t
+
+/****************************************************************************
+**	gemm_tile_size | size_t, size_t, size_t, unsigned int, size_t &, size_t &
+*****************************************************************************
+**	PARAMETER:
+**	nr			width of a strip, from the micro kernel
+**	mc, nc		output. Rows and columns of a tile of C
+**	RETURN:
+**	DESCRIPTION:
+**	GEMM_MC x GEMM_NC, unless that gives fewer than GEMM_TILES_PER_THREAD tiles per worker.
+**	Then columns are cut first, in whole strips of nr, then rows, in whole strips of GEMM_MR.
+**	Packing costs one element per row or column of a tile, so the tile stays as big as the workers allow
+****************************************************************************/
+
+inline void gemm_tile_size( size_t m, size_t n, size_t nr, unsigned int num_threads, size_t &mc, size_t &nc )
+{
+	const size_t tiles_wanted = (size_t)num_threads *GEMM_TILES_PER_THREAD;
+	size_t tiles_m = (m +GEMM_MC -1) /GEMM_MC;
+	size_t tiles_n;
+
+	mc = GEMM_MC;
+	nc = GEMM_NC;
+	if ((num_threads <= 1) || (tiles_m *((n +nc -1) /nc) >= tiles_wanted))
+	{
+		return;
+	}
+	//Columns of C in as many tiles as the rows leave missing, whole strips
+	tiles_n = (tiles_wanted +tiles_m -1) /tiles_m;
+	nc = (n +tiles_n -1) /tiles_n;
+	nc = std::min( (size_t)GEMM_NC, std::max( nr, (nc +nr -1) /nr *nr ) );
+	tiles_n = (n +nc -1) /nc;
+	//Still short: rows too
+	if (tiles_m *tiles_n < tiles_wanted)
+	{
+		tiles_m = (tiles_wanted +tiles_n -1) /tiles_n;
+		mc = (m +tiles_m -1) /tiles_m;
+		mc = std::min( (size_t)GEMM_MC, std::max( (size_t)GEMM_MR, (mc +GEMM_MR -1) /GEMM_MR *GEMM_MR ) );
+	}
+
+	return;
+}	//end function: gemm_tile_size | size_t, size_t, size_t, unsigned int, size_t &, size_t &
+
+/****************************************************************************
+**	gemm_worker | const T *, const T *, T *, size_t, size_t, size_t, size_t, size_t, size_t, T *, T *, std::atomic<size_t> &
+*****************************************************************************
+**	PARAMETER:
+**	w			vector width in bytes
+**	mc_tile		rows of a tile of C, see gemm_tile_size
+**	nc_tile		columns of a tile of C
+**	pa, pb		buffers of this thread for packed A and packed B, see gemm_pack_size
+**	next_tile	shared counter of the tiles of C
+**	RETURN:
+**	DESCRIPTION:
+**	Body of a thread. Takes tiles until there are none left
+****************************************************************************/
+
+template <typename T>
+inline void gemm_worker( const T *a, const T *b, T *c, size_t m, size_t n, size_t k, size_t w, size_t mc_tile, size_t nc_tile, T *pa, T *pb, std::atomic<size_t> &next_tile )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	const size_t nr = 2 *w /sizeof(T);
+	const size_t tiles_n = (n +nc_tile -1) /nc_tile;
+	const size_t num_tiles = ((m +mc_tile -1) /mc_tile) *tiles_n;
+	//fast counters
+	size_t tile, pc;
+	size_t ic, jc, mc, nc, kc;
+	void (*macro)( size_t, size_t, size_t, const T *, const T *, T *, size_t, bool ) = gemm_macro_16<T>;
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+#if defined( SIMD_X86 )
+	if (w == 64)
+	{
+		macro = gemm_macro_64<T>;
+	}
+	else if (w == 32)
+	{
+		macro = gemm_macro_32<T>;
+	}
+#endif
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (tile = next_tile++;tile < num_tiles;tile = next_tile++)
+	{
+		ic = (tile /tiles_n) *mc_tile;
+		jc = (tile %tiles_n) *nc_tile;
+		mc = std::min( mc_tile, m -ic );
+		nc = std::min( nc_tile, n -jc );
+		for (pc = 0;pc < k;pc += GEMM_KC)
+		{
+			kc = std::min( (size_t)GEMM_KC, k -pc );
+			gemm_pack_b( b +pc *n +jc, n, kc, nc, nr, pb );
+			gemm_pack_a( a +ic *k +pc, k, mc, kc, pa );
+			macro( mc, nc, kc, pa, pb, c +ic *n +jc, n, (pc == 0) );
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: gemm_worker | const T *, const T *, T *, size_t, size_t, size_t, size_t, size_t, size_t, T *, T *, std::atomic<size_t> &
+
+/****************************************************************************
+**	gemm | const T *, const T *, T *, size_t, size_t, size_t, unsigned int
+*****************************************************************************
+**	PARAMETER:
+**	a				m x k
+**	b				k x n
+**	c				m x n. Overwritten. Must not overlap a or b
+**	num_threads		workers. 0: size of thread_pool_default()
+**	RETURN:
+**	DESCRIPTION:
+**	Tiles are cut for the workers, see gemm_tile_size. No more workers than tiles. Buffers of all workers are allocated up front: std::bad_alloc reaches the caller
+****************************************************************************/
+
+template <typename T>
+inline void gemm( const T *a, const T *b, T *c, size_t m, size_t n, size_t k, unsigned int num_threads )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	size_t w = gemm_vector_bytes();
+	size_t mc_tile, nc_tile, num_tiles;
+	std::atomic<size_t> next_tile( 0 );
+	size_t pack_size = gemm_pack_size<T>( w );
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if ((m == 0) || (n == 0))
+	{
+		return;
+	}
+	if (k == 0)
+	{
+		std::fill( c, c +m *n, T() );
+		return;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	if (num_threads == 0)
+	{
+		num_threads = thread_pool_default().size();
+	}
+	if ((num_threads < 1) || (m *n *k < GEMM_MIN_PARALLEL))
+	{
+		num_threads = 1;
+	}
+	gemm_tile_size( m, n, 2 *w /sizeof(T), num_threads, mc_tile, nc_tile );
+	num_tiles = ((m +mc_tile -1) /mc_tile) *((n +nc_tile -1) /nc_tile);
+	if ((size_t)num_threads > num_tiles)
+	{
+		num_threads = (unsigned int)num_tiles;
+	}
+
+	AlignedArray<T> packed( pack_size *num_threads );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//A task per worker, each with its own buffer
+	thread_pool_default().run( num_threads, [&]( size_t worker )
+	{
+		T *pa = packed.data() +worker *pack_size;
+		gemm_worker<T>( a, b, c, m, n, k, w, mc_tile, nc_tile, pa, pa +GEMM_MC_PACKED, next_tile );
+	} );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: gemm | const T *, const T *, T *, size_t, size_t, size_t, unsigned int
+
+#endif	//GEMM_H_
@@ -0,0 +1,173 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Heap 2D
+*****************************************************************
+**	Allocate two dimensional arrays whose size is known at runtime
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	new int[R][C] and int array[R][C] need C known at compile time.
+**	When both dimensions are only known at runtime there are three ways:
+**
+**	ROWS
+**		An array of R pointers, each pointing to a separately allocated row.
+**		array[r][c] syntax. R+1 allocations. Rows are scattered in memory,
+**		reading an element costs a pointer load first.
+**	BLOCK
+**		A single block of R*C elements. Index=r*C+c computed by hand.
+**		One allocation. Rows are contiguous, nothing to chase.
+**	TABLE
+**		A single allocation holding the R row pointers followed by the R*C elements.
+**		array[r][c] syntax like ROWS, contiguous like BLOCK, one free.
+**
+**	All functions return NULL if the allocation fails
+****************************************************************/
+
+#ifndef HEAP_2D_H_
+#define HEAP_2D_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstdlib>		//for malloc, free
+#include <cstddef>		//for size_t
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	heap_2d_rows_alloc | size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	array of rows pointers. NULL on failure
+**	DESCRIPTION:
+**	ROWS layout. One malloc for the pointers, one malloc per row
+****************************************************************************/
+
+inline int **heap_2d_rows_alloc( size_t rows, size_t cols )
+{
+	//fast counter
+	size_t t;
+	int **array_ret;
+
+	array_ret = (int **)malloc( rows *sizeof(int *) );
+	if (array_ret == NULL)
+	{
+		return NULL;
+	}
+
+	for (t = 0;t < rows;t++)
+	{
+		array_ret[t] = (int *)malloc( cols *sizeof(int) );
+		if (array_ret[t] == NULL)
+		{
+			//Give back the rows allocated so far
+			while (t > 0)
+			{
+				t--;
+				free( array_ret[t] );
+			}
+			free( array_ret );
+			return NULL;
+		}
+	}
+
+	return array_ret;
+}	//end function: heap_2d_rows_alloc | size_t, size_t
+
+/****************************************************************************
+**	heap_2d_rows_free | int **, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Free each row, then the pointers
+****************************************************************************/
+
+inline void heap_2d_rows_free( int **array_arg, size_t rows )
+{
+	//fast counter
+	size_t t;
+
+	if (array_arg == NULL)
+	{
+		return;
+	}
+
+	for (t = 0;t < rows;t++)
+	{
+		free( array_arg[t] );
+	}
+	free( array_arg );
+
+	return;
+}	//end function: heap_2d_rows_free | int **, size_t
+
+/****************************************************************************
+**	heap_2d_block_alloc | size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	pointer to the first element. NULL on failure
+**	DESCRIPTION:
+**	BLOCK layout. Element r,c is at index r*cols+c
+**	Free with free()
+****************************************************************************/
+
+inline int *heap_2d_block_alloc( size_t rows, size_t cols )
+{
+	return (int *)malloc( rows *cols *sizeof(int) );
+}	//end function: heap_2d_block_alloc | size_t, size_t
+
+/****************************************************************************
+**	heap_2d_table_alloc | size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	array of rows pointers. NULL on failure
+**	DESCRIPTION:
+**	TABLE layout. The row pointers come first, then the elements row after row
+**	The pointers of a table have the size and alignment of the elements of a malloc
+**	so the elements that follow them are aligned.
+**	Free with free()
+****************************************************************************/
+
+inline int **heap_2d_table_alloc( size_t rows, size_t cols )
+{
+	//fast counter
+	size_t t;
+	int **array_ret;
+	int *elements;
+
+	array_ret = (int **)malloc( rows *sizeof(int *) +rows *cols *sizeof(int) );
+	if (array_ret == NULL)
+	{
+		return NULL;
+	}
+
+	//Elements start right after the last row pointer
+	elements = (int *)(array_ret +rows);
+	for (t = 0;t < rows;t++)
+	{
+		array_ret[t] = elements +t *cols;
+	}
+
+	return array_ret;
+}	//end function: heap_2d_table_alloc | size_t, size_t
+
+#endif	//HEAP_2D_H_
@@ -0,0 +1,346 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Mapped Array
+*****************************************************************
+**	Array backed by a file through mmap
+**	C++11 standard, POSIX
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	Loading a file with read() copies it from the page cache into the array:
+**	the file is in memory twice and the whole file is read before the first element is used.
+**	MappedArray<T> maps the file instead. Elements are the pages of the page cache,
+**	loaded on first touch, shared with every other process mapping the file.
+**
+**	MODES
+**		MAPPED_READ_ONLY	PROT_READ. Writing an element is a segmentation fault
+**		MAPPED_READ_WRITE	MAP_SHARED. Writes go to the file. flush() waits for them to reach the disk
+**		MAPPED_PRIVATE		MAP_PRIVATE. Writes copy the page and never reach the file
+**	MappedArray( path, mode, offset )	maps an existing file from byte offset, a multiple of the page size.
+**										size() = (file bytes -offset) /sizeof(T)
+**	MappedArray( path, size, create )	creates or resizes the file to size elements, maps it read-write
+**
+**	It plugs into the handlers of example.cpp like AlignedArray
+**		data(), size()				int *, int handlers
+**		Span<T>, Span<const T>		implicit conversion
+**		view( rows, cols )			View2d<T> of the elements as a row-major block
+**	advise( MAPPED_SEQUENTIAL ) doubles the read-ahead of the kernel, MAPPED_RANDOM turns it off,
+**	MAPPED_WILLNEED starts reading the whole file in the background.
+**
+**	T must be trivially copyable: elements are the bytes of the file, no constructor runs.
+**	Errors of open, fstat, ftruncate and mmap throw std::system_error with errno.
+**	Move only: a mapping has one owner, unmapped by the destructor.
+****************************************************************/
+
+#ifndef MAPPED_ARRAY_H_
+#define MAPPED_ARRAY_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cerrno>		//for errno
+//Standard C++ libraries
+#include <string>		//for std::string
+#include <system_error>	//for std::system_error
+#include <type_traits>	//for std::is_trivially_copyable
+//POSIX
+#include <fcntl.h>		//for open
+#include <unistd.h>		//for close, ftruncate
+#include <sys/mman.h>	//for mmap, munmap, madvise, msync
+#include <sys/stat.h>	//for fstat
+//User libraries
+#include "array_view.h"	//for Span, View2d
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//How the file is mapped
+typedef enum _Mapped_mode
+{
+	MAPPED_READ_ONLY,
+	MAPPED_READ_WRITE,
+	MAPPED_PRIVATE
+} Mapped_mode;
+
+//Access pattern hint for madvise
+typedef enum _Mapped_advice
+{
+	MAPPED_NORMAL,
+	MAPPED_SEQUENTIAL,
+	MAPPED_RANDOM,
+	MAPPED_WILLNEED,
+	MAPPED_DONTNEED
+} Mapped_advice;
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	MappedArray
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements of T, the bytes of a file. A trailing partial element of the file is not mapped
+****************************************************************************/
+
+template <typename T>
+class MappedArray
+{
+	static_assert( std::is_trivially_copyable<T>::value == true, "MappedArray elements are raw bytes of the file" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//No file
+		MappedArray( void ) : g_data( NULL ), g_size( 0 ), g_mode( MAPPED_READ_ONLY )
+		{
+		}
+
+		//Map an existing file, skipping offset bytes. offset is a multiple of the page size, as for mmap
+		explicit MappedArray( const std::string &path, Mapped_mode mode = MAPPED_READ_ONLY, size_t offset = 0 ) : g_data( NULL ), g_size( 0 ), g_mode( mode )
+		{
+			int fd;
+			struct stat info;
+			size_t file_bytes;
+
+			fd = open( path.c_str(), (mode == MAPPED_READ_WRITE) ?(O_RDWR) :(O_RDONLY) );
+			if (fd < 0)
+			{
+				throw std::system_error( errno, std::generic_category(), "open " +path );
+			}
+			if (fstat( fd, &info ) != 0)
+			{
+				close_and_throw( fd, "fstat " +path );
+			}
+			file_bytes = (size_t)info.st_size;
+			map( fd, (file_bytes > offset) ?((file_bytes -offset) /sizeof(T)) :(0), offset, path );
+		}
+
+		//Map a file of size elements, read-write. create: make the file if missing. Grows or truncates it
+		MappedArray( const std::string &path, size_t size_arg, bool create ) : g_data( NULL ), g_size( 0 ), g_mode( MAPPED_READ_WRITE )
+		{
+			int fd;
+
+			fd = open( path.c_str(), (create == true) ?(O_RDWR | O_CREAT) :(O_RDWR), 0644 );
+			if (fd < 0)
+			{
+				throw std::system_error( errno, std::generic_category(), "open " +path );
+			}
+			if (ftruncate( fd, (off_t)(size_arg *sizeof(T)) ) != 0)
+			{
+				close_and_throw( fd, "ftruncate " +path );
+			}
+			map( fd, size_arg, 0, path );
+		}
+
+		MappedArray( const MappedArray & ) = delete;
+		MappedArray &operator=( const MappedArray & ) = delete;
+
+		//Steal the mapping. noexcept, or std::vector copies on growth
+		MappedArray( MappedArray &&array_arg ) noexcept : g_data( array_arg.g_data ), g_size( array_arg.g_size ), g_mode( array_arg.g_mode )
+		{
+			array_arg.g_data = NULL;
+			array_arg.g_size = 0;
+		}
+
+		MappedArray &operator=( MappedArray &&array_arg ) noexcept
+		{
+			if (this != &array_arg)
+			{
+				unmap();
+				g_data = array_arg.g_data;
+				g_size = array_arg.g_size;
+				g_mode = array_arg.g_mode;
+				array_arg.g_data = NULL;
+				array_arg.g_size = 0;
+			}
+			return *this;
+		}
+
+		~MappedArray( void )
+		{
+			unmap();
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void )
+		{
+			return g_data;
+		}
+
+		const T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		Mapped_mode mode( void ) const
+		{
+			return g_mode;
+		}
+
+		T &operator[]( size_t index )
+		{
+			return g_data[index];
+		}
+
+		const T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T *begin( void )
+		{
+			return g_data;
+		}
+
+		T *end( void )
+		{
+			return g_data +g_size;
+		}
+
+		const T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		const T *end( void ) const
+		{
+			return g_data +g_size;
+		}
+
+		//Hint the access pattern to the kernel. false if madvise fails
+		bool advise( Mapped_advice advice )
+		{
+			static const int flags[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+
+			if (g_data == NULL)
+			{
+				return true;
+			}
+
+			return (madvise( (void *)g_data, g_size *sizeof(T), flags[advice] ) == 0);
+		}
+
+		//Write the changed pages to the file. wait false: schedule the writes and return. Only MAPPED_READ_WRITE has anything to write
+		bool flush( bool wait = true )
+		{
+			if ((g_data == NULL) || (g_mode != MAPPED_READ_WRITE))
+			{
+				return true;
+			}
+
+			return (msync( (void *)g_data, g_size *sizeof(T), (wait == true) ?(MS_SYNC) :(MS_ASYNC) ) == 0);
+		}
+
+		///--------------------------------------------------------------------------
+		///	VIEWS
+		///--------------------------------------------------------------------------
+
+		operator Span<T>( void )
+		{
+			return Span<T>( g_data, g_size );
+		}
+
+		operator Span<const T>( void ) const
+		{
+			return Span<const T>( g_data, g_size );
+		}
+
+		//Elements as a rows x cols row-major block. rows*cols must not exceed size()
+		View2d<T> view( size_t rows, size_t cols )
+		{
+			return View2d<T>( g_data, rows, cols );
+		}
+
+		View2d<const T> view( size_t rows, size_t cols ) const
+		{
+			return View2d<const T>( g_data, rows, cols );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		static void close_and_throw( int fd, const std::string &what )
+		{
+			int error = errno;
+
+			close( fd );
+			throw std::system_error( error, std::generic_category(), what );
+		}
+
+		//Map size elements of the open file from byte offset, then close it: the mapping keeps the file alive
+		void map( int fd, size_t size_arg, size_t offset, const std::string &path )
+		{
+			void *ret;
+			int prot = (g_mode == MAPPED_READ_ONLY) ?(PROT_READ) :(PROT_READ | PROT_WRITE);
+			int flags = (g_mode == MAPPED_READ_WRITE) ?(MAP_SHARED) :(MAP_PRIVATE);
+
+			//mmap of zero bytes fails. An empty file is an empty array
+			if (size_arg > 0)
+			{
+				ret = mmap( NULL, size_arg *sizeof(T), prot, flags, fd, (off_t)offset );
+				if (ret == MAP_FAILED)
+				{
+					close_and_throw( fd, "mmap " +path );
+				}
+				g_data = (T *)ret;
+				g_size = size_arg;
+			}
+			close( fd );
+		}
+
+		void unmap( void )
+		{
+			if (g_data != NULL)
+			{
+				munmap( (void *)g_data, g_size *sizeof(T) );
+			}
+			g_data = NULL;
+			g_size = 0;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//First element, page aligned
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+		Mapped_mode g_mode;
+};	//end class: MappedArray
+
+#endif	//MAPPED_ARRAY_H_
@@ -0,0 +1,570 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Parallel
+*****************************************************************
+**	Persistent thread pool with parallel for, reduce and transform over arrays
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	Starting threads costs tens of microseconds, more than a pass over a small array.
+**	ThreadPool starts its threads once and keeps them waiting on a condition variable.
+**	run( num_tasks, fn ) wakes them, calls fn( task ) for each task on whichever thread is free,
+**	and returns when all tasks are done. The caller runs tasks too: a pool of N threads starts N-1.
+**
+**	ALGORITHMS
+**	Arrays are cut in chunks of grain elements, a chunk is a task.
+**		parallel_for( data, size, fn )				fn( T & ) on each element
+**		parallel_for_range( begin, end, fn )		fn( chunk_begin, chunk_end ) on each chunk of indexes
+**		parallel_reduce( data, size, identity, op )	op( op( identity, a[0] ), a[1] )... per chunk, then op( partial, partial )
+**		parallel_transform( src, size, dst, fn )	dst[i] = fn( src[i] )
+**	Each takes raw pointer and size, or anything with data() and size():
+**	std::array, std::vector, Span, AlignedArray.
+**
+**	OPTIONS
+**	Parallel_options( grain, deterministic, pool )
+**		grain			elements per task. 0: a few tasks per thread, at least PARALLEL_MIN_GRAIN elements
+**		deterministic	reduce: chunks of fixed size, partials combined in order of chunk.
+**						Float sums are then the same bits whatever the number of threads.
+**						Otherwise chunks depend on the number of threads, results are the same only for the same pool
+**		pool			NULL: thread_pool_default(), one thread per hardware thread
+**
+**	Exceptions thrown by a task are caught, remaining tasks still run, the first exception is rethrown by run.
+**	run called from inside a task runs its tasks on the calling thread, one after the other.
+**	So does run while another thread has a job on the same pool: thread_pool_default() is shared
+**	by gemm, sparse_spmv, array_copy... called from threads of the application that know nothing of each other.
+****************************************************************/
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <vector>		//for std::vector
+#include <thread>		//for std::thread
+#include <atomic>		//for std::atomic
+#include <mutex>		//for std::mutex, std::unique_lock
+#include <condition_variable>	//for std::condition_variable
+#include <exception>	//for std::exception_ptr
+#include <type_traits>	//for std::remove_reference
+#include <algorithm>	//for std::min
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Smallest automatic chunk. Below this the cost of a task is comparable to the work
+#define PARALLEL_MIN_GRAIN		4096
+//Automatic chunking makes this many tasks per thread, so a slow thread does not hold the others
+#define PARALLEL_TASKS_PER_THREAD	4
+//Chunk of a deterministic reduce when no grain is given. Does not depend on the machine
+#define PARALLEL_REDUCE_GRAIN	65536
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	ThreadPool
+*****************************************************************************
+**	DESCRIPTION:
+**	size() threads counting the caller of run. One job at a time: a run from another thread
+**	while the pool is busy runs its tasks on its own thread
+****************************************************************************/
+
+class ThreadPool
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//num_threads 0: one per hardware thread
+		explicit ThreadPool( unsigned int num_threads = 0 ) : g_size( num_threads ), g_stop( false ), g_generation( 0 ), g_num_finished( 0 ), g_num_tasks( 0 ), g_next_task( 0 ), g_fn( NULL ), g_ctx( NULL )
+		{
+			//fast counter
+			unsigned int t;
+
+			if (g_size == 0)
+			{
+				g_size = std::thread::hardware_concurrency();
+			}
+			if (g_size == 0)
+			{
+				g_size = 1;
+			}
+			for (t = 1;t < g_size;t++)
+			{
+				g_workers.push_back( std::thread( &ThreadPool::worker, this ) );
+			}
+		}
+
+		ThreadPool( const ThreadPool & ) = delete;
+		ThreadPool &operator=( const ThreadPool & ) = delete;
+
+		~ThreadPool( void )
+		{
+			//fast counter
+			size_t t;
+
+			{
+				std::unique_lock<std::mutex> lock( g_mutex );
+				g_stop = true;
+			}
+			g_wake.notify_all();
+			for (t = 0;t < g_workers.size();t++)
+			{
+				g_workers[t].join();
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		//Threads including the caller
+		unsigned int size( void ) const
+		{
+			return g_size;
+		}
+
+		//Call fn( task ) for task in [0, num_tasks). Returns when all calls returned
+		template <typename Fn>
+		void run( size_t num_tasks, Fn &&fn )
+		{
+			typedef typename std::remove_reference<Fn>::type F;
+			//fast counter
+			size_t t;
+			std::exception_ptr error;
+			//Held from publishing the job until the workers are done with it
+			std::unique_lock<std::mutex> run_lock( g_run_mutex, std::defer_lock );
+
+			//One task, no workers, called from a task, or the pool busy with the job of another thread: no one to share with
+			if ((num_tasks <= 1) || (g_workers.empty() == true) || (in_task() == true) || (run_lock.try_lock() == false))
+			{
+				//Same contract as the workers: every task runs, the first exception is rethrown
+				for (t = 0;t < num_tasks;t++)
+				{
+					try
+					{
+						fn( t );
+					}
+					catch (...)
+					{
+						if (!error)
+						{
+							error = std::current_exception();
+						}
+					}
+				}
+				if (error)
+				{
+					std::rethrow_exception( error );
+				}
+				return;
+			}
+			//Publish the job and wake the workers
+			{
+				std::unique_lock<std::mutex> lock( g_mutex );
+				g_fn = &ThreadPool::call<F>;
+				g_ctx = (void *)&fn;
+				g_num_tasks = num_tasks;
+				g_next_task.store( 0 );
+				g_num_finished = 0;
+				g_error = std::exception_ptr();
+				g_generation++;
+			}
+			g_wake.notify_all();
+			work( g_fn, g_ctx, num_tasks );
+			//Every worker must be done with this job before fn goes out of scope
+			{
+				std::unique_lock<std::mutex> lock( g_mutex );
+				while (g_num_finished < g_workers.size())
+				{
+					g_idle.wait( lock );
+				}
+				error = g_error;
+				g_fn = NULL;
+				g_ctx = NULL;
+			}
+			if (error)
+			{
+				std::rethrow_exception( error );
+			}
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		template <typename F>
+		static void call( void *ctx, size_t task )
+		{
+			(*(F *)ctx)( task );
+		}
+
+		//True on a thread that is running a task of any pool
+		static bool &in_task( void )
+		{
+			static thread_local bool flag = false;
+			return flag;
+		}
+
+		//Take tasks until there are none left
+		void work( void (*fn)( void *, size_t ), void *ctx, size_t num_tasks )
+		{
+			size_t task;
+
+			in_task() = true;
+			for (task = g_next_task++;task < num_tasks;task = g_next_task++)
+			{
+				try
+				{
+					fn( ctx, task );
+				}
+				catch (...)
+				{
+					std::unique_lock<std::mutex> lock( g_mutex );
+					if (!g_error)
+					{
+						g_error = std::current_exception();
+					}
+				}
+			}
+			in_task() = false;
+		}
+
+		//Body of a worker thread. Sleeps between jobs
+		void worker( void )
+		{
+			size_t seen = 0;
+			void (*fn)( void *, size_t );
+			void *ctx;
+			size_t num_tasks;
+
+			std::unique_lock<std::mutex> lock( g_mutex );
+			while (true)
+			{
+				while ((g_stop == false) && (g_generation == seen))
+				{
+					g_wake.wait( lock );
+				}
+				if (g_stop == true)
+				{
+					return;
+				}
+				seen = g_generation;
+				fn = g_fn;
+				ctx = g_ctx;
+				num_tasks = g_num_tasks;
+				lock.unlock();
+				work( fn, ctx, num_tasks );
+				lock.lock();
+				g_num_finished++;
+				if (g_num_finished == g_workers.size())
+				{
+					g_idle.notify_one();
+				}
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Threads including the caller of run
+		unsigned int g_size;
+		std::vector<std::thread> g_workers;
+		//Owned by the run whose job the workers have
+		std::mutex g_run_mutex;
+		//Guards everything below but g_next_task
+		std::mutex g_mutex;
+		//Workers wait here for a job
+		std::condition_variable g_wake;
+		//run waits here for the workers to finish
+		std::condition_variable g_idle;
+		bool g_stop;
+		//Incremented by each run. A worker joins a job once
+		size_t g_generation;
+		//Workers done with the current job
+		size_t g_num_finished;
+		//Current job
+		size_t g_num_tasks;
+		std::atomic<size_t> g_next_task;
+		void (*g_fn)( void *, size_t );
+		void *g_ctx;
+		//First exception thrown by a task of the current job
+		std::exception_ptr g_error;
+};	//end class: ThreadPool
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//How an algorithm cuts the array and where it runs
+struct Parallel_options
+{
+	Parallel_options( size_t grain_arg = 0, bool deterministic_arg = false, ThreadPool *pool_arg = NULL ) : grain( grain_arg ), deterministic( deterministic_arg ), pool( pool_arg )
+	{
+	}
+
+	//Elements per task. 0: automatic
+	size_t grain;
+	//reduce: fixed chunks combined in order, same result whatever the threads
+	bool deterministic;
+	//NULL: thread_pool_default()
+	ThreadPool *pool;
+};
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	thread_pool_default | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	pool with one thread per hardware thread. Started on first use, stopped at exit
+**	DESCRIPTION:
+****************************************************************************/
+
+inline ThreadPool &thread_pool_default( void )
+{
+	static ThreadPool pool;
+
+	return pool;
+}	//end function: thread_pool_default | void
+
+/****************************************************************************
+**	parallel_pool | const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+inline ThreadPool &parallel_pool( const Parallel_options &options )
+{
+	return (options.pool != NULL) ?(*options.pool) :(thread_pool_default());
+}	//end function: parallel_pool | const Parallel_options &
+
+/****************************************************************************
+**	parallel_grain | size_t, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	size		elements of the array
+**	RETURN:
+**	elements per chunk, at least one
+**	DESCRIPTION:
+**	Given grain, else PARALLEL_REDUCE_GRAIN for deterministic, else from the number of threads
+****************************************************************************/
+
+inline size_t parallel_grain( size_t size, const Parallel_options &options )
+{
+	size_t num_tasks;
+	size_t grain;
+
+	if (options.grain > 0)
+	{
+		return options.grain;
+	}
+	if (options.deterministic == true)
+	{
+		return PARALLEL_REDUCE_GRAIN;
+	}
+	num_tasks = (size_t)parallel_pool( options ).size() *PARALLEL_TASKS_PER_THREAD;
+	grain = (size +num_tasks -1) /num_tasks;
+
+	return (grain < PARALLEL_MIN_GRAIN) ?(PARALLEL_MIN_GRAIN) :(grain);
+}	//end function: parallel_grain | size_t, const Parallel_options &
+
+/****************************************************************************
+**	parallel_for_range | size_t, size_t, Fn, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	fn			void( size_t chunk_begin, size_t chunk_end )
+**	RETURN:
+**	DESCRIPTION:
+**	The building block of the others. A chunk is a plain loop the compiler can vectorize
+****************************************************************************/
+
+template <typename Fn>
+inline void parallel_for_range( size_t begin, size_t end, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	size_t grain;
+	size_t num_chunks;
+
+	if (end <= begin)
+	{
+		return;
+	}
+	grain = parallel_grain( end -begin, options );
+	num_chunks = (end -begin +grain -1) /grain;
+	parallel_pool( options ).run( num_chunks, [&]( size_t chunk )
+	{
+		size_t chunk_begin = begin +chunk *grain;
+		fn( chunk_begin, std::min( chunk_begin +grain, end ) );
+	} );
+
+	return;
+}	//end function: parallel_for_range | size_t, size_t, Fn, const Parallel_options &
+
+/****************************************************************************
+**	parallel_for | T *, size_t, Fn, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	fn			void( T & )
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T, typename Fn>
+inline void parallel_for( T *data, size_t size, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	parallel_for_range( 0, size, [&]( size_t chunk_begin, size_t chunk_end )
+	{
+		//fast counter
+		size_t t;
+
+		for (t = chunk_begin;t < chunk_end;t++)
+		{
+			fn( data[t] );
+		}
+	}, options );
+
+	return;
+}	//end function: parallel_for | T *, size_t, Fn, const Parallel_options &
+
+//std::array, std::vector, Span, AlignedArray
+template <typename Array, typename Fn>
+inline void parallel_for( Array &array, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	parallel_for( array.data(), array.size(), fn, options );
+}
+
+/****************************************************************************
+**	parallel_reduce | const T *, size_t, R, Op, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	identity	neutral element of op: 0 for a sum, 1 for a product
+**	op			R( R, const T & ) to fold a chunk and R( R, R ) to combine the partials
+**	RETURN:
+**	identity for an empty array
+**	DESCRIPTION:
+**	One partial per chunk, combined on the caller in order of chunk.
+**	op must be associative, as + is for int; float + is only nearly so, hence the deterministic option
+****************************************************************************/
+
+template <typename T, typename R, typename Op>
+inline R parallel_reduce( const T *data, size_t size, R identity, Op op, const Parallel_options &options = Parallel_options() )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	size_t grain;
+	size_t num_chunks;
+	R ret = identity;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (size == 0)
+	{
+		return identity;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	grain = parallel_grain( size, options );
+	num_chunks = (size +grain -1) /grain;
+	std::vector<R> partial( num_chunks, identity );
+	parallel_pool( options ).run( num_chunks, [&]( size_t chunk )
+	{
+		//fast counter
+		size_t t;
+		size_t chunk_end = std::min( (chunk +1) *grain, size );
+		R acc = identity;
+
+		for (t = chunk *grain;t < chunk_end;t++)
+		{
+			acc = op( acc, data[t] );
+		}
+		partial[chunk] = acc;
+	} );
+	for (t = 0;t < num_chunks;t++)
+	{
+		ret = op( ret, partial[t] );
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return ret;
+}	//end function: parallel_reduce | const T *, size_t, R, Op, const Parallel_options &
+
+//std::array, std::vector, Span, AlignedArray
+template <typename Array, typename R, typename Op>
+inline R parallel_reduce( const Array &array, R identity, Op op, const Parallel_options &options = Parallel_options() )
+{
+	return parallel_reduce( array.data(), array.size(), identity, op, options );
+}
+
+/****************************************************************************
+**	parallel_transform | const T *, size_t, U *, Fn, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	dst			size elements. May be src itself
+**	fn			U( const T & )
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T, typename U, typename Fn>
+inline void parallel_transform( const T *src, size_t size, U *dst, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	parallel_for_range( 0, size, [&]( size_t chunk_begin, size_t chunk_end )
+	{
+		//fast counter
+		size_t t;
+
+		for (t = chunk_begin;t < chunk_end;t++)
+		{
+			dst[t] = fn( src[t] );
+		}
+	}, options );
+
+	return;
+}	//end function: parallel_transform | const T *, size_t, U *, Fn, const Parallel_options &
+
+//std::array, std::vector, Span, AlignedArray. Transforms as many elements as the smaller of the two holds
+template <typename Src, typename Dst, typename Fn>
+inline void parallel_transform( const Src &src, Dst &dst, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	parallel_transform( src.data(), std::min( (size_t)src.size(), (size_t)dst.size() ), dst.data(), fn, options );
+}
+
+#endif	//PARALLEL_H_
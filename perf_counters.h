@@ -0,0 +1,350 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Perf Counters
+*****************************************************************
+**	Hardware event counts of a code region through Linux perf_event
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	A timing says how long a loop took, not why. Row-major and column-major sums over the same
+**	array differ by cache and TLB misses, a View2d and index math by hand by instructions.
+**	The CPU counts these events. Linux gives the counts through perf_event_open.
+**
+**		PerfCounters my_counters;			opens a counter per event, for the calling thread, user space only
+**		my_counters.start();
+**		...region...
+**		my_counters.stop( my_values );		my_values.count[PERF_CYCLES]... events since start
+**	PerfScope my_scope( my_counters, my_values ) does the same from its constructor to its destructor.
+**
+**	EVENTS
+**		PERF_CYCLES				core cycles
+**		PERF_INSTRUCTIONS		instructions retired. Divided by cycles: instructions per cycle
+**		PERF_L1D_MISSES			L1 data cache read misses
+**		PERF_LLC_MISSES			last level cache misses
+**		PERF_DTLB_MISSES		data TLB read misses
+**		PERF_BRANCH_MISSES		mispredicted branches
+**		PERF_PAGE_FAULTS		page faults, a software event: first touch of a new page
+**
+**	FALLBACK
+**	Each event opens on its own. One the CPU or the kernel does not offer stays closed, the others still count.
+**	A count that could not be taken is NaN: available( event ) is false, or the CPU ran out of counters
+**	for the whole region. Virtual machines often have no hardware events, only page faults.
+**	perf_event_paranoid above 2, or seccomp in a container, closes all of them: error() is the errno.
+**	Off Linux nothing opens.
+**	When there are more events than counters the kernel takes turns. Counts are scaled by the time
+**	each event was actually counted, an estimate.
+**
+**	start and stop read each counter, a system call each: a few us. The counts include a few hundred
+**	instructions of the reads. Start before reading the clock and stop after, regions of 10 us or more.
+****************************************************************/
+
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uint64_t
+#include <cstring>		//for memset
+#include <cerrno>		//for errno
+#include <unistd.h>		//for read, close
+#if defined( __linux__ )
+#include <sys/syscall.h>	//for syscall, __NR_perf_event_open
+#include <linux/perf_event.h>	//for perf_event_attr
+#endif
+//Standard C++ libraries
+#include <limits>		//for std::numeric_limits
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+#if defined( __linux__ )
+#define PERF_COUNTERS_LINUX
+#endif
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+typedef enum _Perf_event
+{
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,
+	PERF_LLC_MISSES,
+	PERF_DTLB_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_PAGE_FAULTS,
+	PERF_NUM_EVENTS
+} Perf_event;
+
+//Events in a region. NaN when an event was not counted, so that sums of regions stay NaN
+typedef struct _Perf_values
+{
+	double count[PERF_NUM_EVENTS];
+} Perf_values;
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	PerfCounters
+*****************************************************************************
+**	DESCRIPTION:
+**	One perf_event file descriptor per event, counting from the constructor on.
+**	start and stop read them: the region is the difference
+****************************************************************************/
+
+class PerfCounters
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//Open every event it can for the calling thread
+		PerfCounters( void ) : g_error( 0 )
+		{
+			//fast counter
+			int t;
+
+			for (t = 0;t < PERF_NUM_EVENTS;t++)
+			{
+				g_fd[t] = open_event( (Perf_event)t );
+				if ((g_fd[t] < 0) && (g_error == 0))
+				{
+					g_error = errno;
+				}
+				g_start[t][0] = 0;
+				g_start[t][1] = 0;
+				g_start[t][2] = 0;
+			}
+		}
+
+		~PerfCounters( void )
+		{
+			//fast counter
+			int t;
+
+			for (t = 0;t < PERF_NUM_EVENTS;t++)
+			{
+				if (g_fd[t] >= 0)
+				{
+					close( g_fd[t] );
+				}
+			}
+		}
+
+		//A file descriptor can't be shared by two owners
+		PerfCounters( const PerfCounters & ) = delete;
+		PerfCounters &operator=( const PerfCounters & ) = delete;
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		bool available( Perf_event event ) const
+		{
+			return (g_fd[event] >= 0);
+		}
+
+		//Events open
+		int num_available( void ) const
+		{
+			//fast counter
+			int t;
+			int ret = 0;
+
+			for (t = 0;t < PERF_NUM_EVENTS;t++)
+			{
+				ret += (g_fd[t] >= 0) ?(1) :(0);
+			}
+
+			return ret;
+		}
+
+		//errno of the first event that did not open, 0 when all did
+		int error( void ) const
+		{
+			return g_error;
+		}
+
+		//Short name, as perf stat spells it
+		static const char *name( Perf_event event )
+		{
+			static const char *names[PERF_NUM_EVENTS] =
+			{
+				"cycles",
+				"instructions",
+				"L1-dcache-load-misses",
+				"cache-misses",
+				"dTLB-load-misses",
+				"branch-misses",
+				"page-faults",
+			};
+
+			return names[event];
+		}
+
+		//Mark the start of a region
+		void start( void )
+		{
+			//fast counter
+			int t;
+
+			for (t = 0;t < PERF_NUM_EVENTS;t++)
+			{
+				read_event( t, g_start[t] );
+			}
+		}
+
+		//Events since start
+		void stop( Perf_values &values )
+		{
+			//fast counter
+			int t;
+			uint64_t now[3];
+
+			for (t = 0;t < PERF_NUM_EVENTS;t++)
+			{
+				values.count[t] = std::numeric_limits<double>::quiet_NaN();
+				if (read_event( t, now ) == true)
+				{
+					//now: count, time enabled, time running
+					uint64_t count = now[0] -g_start[t][0];
+					uint64_t enabled = now[1] -g_start[t][1];
+					uint64_t running = now[2] -g_start[t][2];
+					if (running > 0)
+					{
+						values.count[t] = (double)count *((double)enabled /(double)running);
+					}
+				}
+			}
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		//File descriptor of event, counting. -1 and errno when it can't be opened
+		static int open_event( Perf_event event )
+		{
+			#ifdef PERF_COUNTERS_LINUX
+			//type and config of each event, see man perf_event_open
+			static const uint32_t type[PERF_NUM_EVENTS] =
+			{
+				PERF_TYPE_HARDWARE,
+				PERF_TYPE_HARDWARE,
+				PERF_TYPE_HW_CACHE,
+				PERF_TYPE_HARDWARE,
+				PERF_TYPE_HW_CACHE,
+				PERF_TYPE_HARDWARE,
+				PERF_TYPE_SOFTWARE,
+			};
+			static const uint64_t config[PERF_NUM_EVENTS] =
+			{
+				PERF_COUNT_HW_CPU_CYCLES,
+				PERF_COUNT_HW_INSTRUCTIONS,
+				PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+				PERF_COUNT_HW_CACHE_MISSES,
+				PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+				PERF_COUNT_HW_BRANCH_MISSES,
+				PERF_COUNT_SW_PAGE_FAULTS,
+			};
+			struct perf_event_attr attr;
+
+			memset( &attr, 0, sizeof( attr ) );
+			attr.size = sizeof( attr );
+			attr.type = type[event];
+			attr.config = config[event];
+			//Time enabled and running, to scale when the kernel takes turns
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			//The program, not the kernel working for it: lower perf_event_paranoid needed otherwise
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			//This thread, any CPU, no group
+			return (int)syscall( __NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC );
+			#else
+			(void)event;
+			errno = ENOSYS;
+			return -1;
+			#endif
+		}
+
+		//Count, time enabled, time running of event t. false when closed or the read fails
+		bool read_event( int t, uint64_t value[3] ) const
+		{
+			if (g_fd[t] < 0)
+			{
+				return false;
+			}
+
+			return (read( g_fd[t], value, 3 *sizeof(uint64_t) ) == (ssize_t)(3 *sizeof(uint64_t)));
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//One per event, -1 when closed
+		int g_fd[PERF_NUM_EVENTS];
+		//Count, time enabled, time running at start
+		uint64_t g_start[PERF_NUM_EVENTS][3];
+		int g_error;
+};	//end class: PerfCounters
+
+/****************************************************************************
+**	PerfScope
+*****************************************************************************
+**	DESCRIPTION:
+**	Events from construction to destruction, written to values
+****************************************************************************/
+
+class PerfScope
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		PerfScope( PerfCounters &counters, Perf_values &values ) : g_counters( counters ), g_values( values )
+		{
+			g_counters.start();
+		}
+
+		~PerfScope( void )
+		{
+			g_counters.stop( g_values );
+		}
+
+		PerfScope( const PerfScope & ) = delete;
+		PerfScope &operator=( const PerfScope & ) = delete;
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		PerfCounters &g_counters;
+		Perf_values &g_values;
+};	//end class: PerfScope
+
+#endif	//PERF_COUNTERS_H_
@@ -0,0 +1,536 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Pool
+*****************************************************************
+**	Size class pool allocator for small arrays, many threads
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	Small arrays of a few fixed sizes, allocated and freed by many threads.
+**	Requests are rounded up to a size class. Each class has
+**		a free list per thread. No lock, no atomic on the fast path
+**		a global lock free stack of batches. Threads refill from it and give back to it
+**	A batch is a linked list of POOL_BATCH free blocks of the same class.
+**	When the global stack is empty a slab of POOL_SLAB_SIZE bytes is malloc'd and cut into batches.
+**
+**	C API
+**		pool_alloc( size )			NULL on failure. 16 byte aligned
+**		pool_free( ptr, size )		size must be the one given to pool_alloc, like free_sized of C23
+**	C++ API
+**		PoolAllocator<T>			std allocator. std::vector<int, PoolAllocator<int>>
+**
+**	Size classes go from 16 to 4096 bytes in steps of 1.5x and 2x. Bigger requests go to malloc.
+**	A block freed by another thread goes to the free list of that thread. That is fine:
+**	lists only hold blocks, not ownership. When a thread ends its lists go back to the global stacks.
+**	Slabs are never given back to the system: the pool keeps its peak size.
+**
+**	The global stacks pack a pointer and an ABA tag in a 64 bit word.
+**	This needs user space addresses below 2^48, true on x86-64 and aarch64 Linux.
+****************************************************************/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstdlib>		//for malloc, free
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uint64_t, uintptr_t
+//Standard C++ libraries
+#include <atomic>		//for std::atomic
+#include <new>			//for std::bad_alloc
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Number of size classes
+#define POOL_NUM_CLASSES	16
+//Largest size class. Bigger requests go to malloc
+#define POOL_MAX_SIZE		4096
+//Blocks in a batch moved between a thread and the global stack
+#define POOL_BATCH			32
+//A thread gives a batch back when its list holds more than this many batches
+#define POOL_CACHE_BATCHES	2
+//Bytes malloc'd at once when a class runs dry
+#define POOL_SLAB_SIZE		(256 *1024)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//A free block. Every class is at least 16 bytes, room for two pointers
+struct PoolNode
+{
+	//Next block of the same list or batch
+	PoolNode *next;
+	//Next batch of the global stack. Only meaningful in the first block of a batch
+	PoolNode *next_batch;
+};
+
+//Global state of a class. Own cache line so classes don't false share
+struct alignas(64) PoolClass
+{
+	//Top of the stack of batches. 48 bit pointer, 16 bit ABA tag
+	std::atomic<uint64_t> head;
+	//Slabs malloc'd for this class
+	std::atomic<size_t> num_slabs;
+};
+
+//Free lists of a thread
+struct PoolCache
+{
+	PoolNode *head[POOL_NUM_CLASSES];
+	size_t count[POOL_NUM_CLASSES];
+
+	PoolCache( void );
+	//Thread ends, lists go back to the global stacks
+	~PoolCache( void );
+};
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+//Class of a request, POOL_NUM_CLASSES if too big
+inline size_t pool_class( size_t size );
+//Bytes of the blocks of a class
+inline size_t pool_class_size( size_t size_class );
+//Global state of a class
+inline PoolClass &pool_global( size_t size_class );
+//Free lists of the calling thread
+inline PoolCache &pool_cache( void );
+//Lock free stack of batches
+inline void pool_push_batch( size_t size_class, PoolNode *batch );
+inline PoolNode *pool_pop_batch( size_t size_class );
+//Slow path of pool_alloc: refill the list of the thread
+inline PoolNode *pool_refill( PoolCache &cache, size_t size_class );
+//Slow path of pool_free: give a batch back
+inline void pool_flush( PoolCache &cache, size_t size_class, size_t num );
+//C API
+inline void *pool_alloc( size_t size );
+inline void pool_free( void *ptr, size_t size );
+//Bytes malloc'd by the pool for all classes
+inline size_t pool_slab_bytes( void );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	pool_class | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	index of the size class
+**	DESCRIPTION:
+**	16, 32, 48, 64, then 1.5x and 2x of each power of two: 96, 128, 192, 256 ... 3072, 4096
+****************************************************************************/
+
+inline size_t pool_class( size_t size )
+{
+	size_t p;
+
+	if (size <= 64)
+	{
+		return (size == 0) ?(0) :((size -1) >> 4);
+	}
+	if (size > POOL_MAX_SIZE)
+	{
+		return POOL_NUM_CLASSES;
+	}
+	//size is in (2^p, 2^(p+1)]
+	p = 63 -(size_t)__builtin_clzll( (unsigned long long)(size -1) );
+	//First half goes to 1.5 * 2^p, second half to 2^(p+1)
+	return ((size <= ((size_t)3 << (p -1))) ?(4) :(5)) +2 *(p -6);
+}	//end function: pool_class | size_t
+
+inline size_t pool_class_size( size_t size_class )
+{
+	static const size_t class_size[POOL_NUM_CLASSES] =
+	{
+		16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096
+	};
+
+	return class_size[size_class];
+}	//end function: pool_class_size | size_t
+
+/****************************************************************************
+**	pool_global | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Function local static: a single instance across translation units
+****************************************************************************/
+
+inline PoolClass &pool_global( size_t size_class )
+{
+	static PoolClass classes[POOL_NUM_CLASSES];
+
+	return classes[size_class];
+}	//end function: pool_global | size_t
+
+inline PoolCache &pool_cache( void )
+{
+	static thread_local PoolCache cache;
+
+	return cache;
+}	//end function: pool_cache | void
+
+/****************************************************************************
+**	pool_push_batch | size_t, PoolNode *
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Treiber stack. The tag is bumped on every push and pop so a pop that
+**	read a head that was popped and pushed back meanwhile fails its CAS
+****************************************************************************/
+
+inline void pool_push_batch( size_t size_class, PoolNode *batch )
+{
+	PoolClass &global = pool_global( size_class );
+	uint64_t old_head, new_head;
+
+	old_head = global.head.load( std::memory_order_relaxed );
+	do
+	{
+		batch->next_batch = (PoolNode *)(uintptr_t)(old_head & 0xFFFFFFFFFFFFull);
+		new_head = ((uint64_t)(uintptr_t)batch) | ((old_head +((uint64_t)1 << 48)) & 0xFFFF000000000000ull);
+	}
+	while (global.head.compare_exchange_weak( old_head, new_head, std::memory_order_release, std::memory_order_relaxed ) == false);
+
+	return;
+}	//end function: pool_push_batch | size_t, PoolNode *
+
+/****************************************************************************
+**	pool_pop_batch | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	first block of a batch. NULL if the stack is empty
+**	DESCRIPTION:
+**	Reading next_batch of a block another thread may already own is safe:
+**	slabs are never freed, and the tag makes the CAS fail if the head changed
+****************************************************************************/
+
+inline PoolNode *pool_pop_batch( size_t size_class )
+{
+	PoolClass &global = pool_global( size_class );
+	uint64_t old_head, new_head;
+	PoolNode *batch;
+
+	old_head = global.head.load( std::memory_order_acquire );
+	do
+	{
+		batch = (PoolNode *)(uintptr_t)(old_head & 0xFFFFFFFFFFFFull);
+		if (batch == NULL)
+		{
+			return NULL;
+		}
+		new_head = ((uint64_t)(uintptr_t)batch->next_batch & 0xFFFFFFFFFFFFull) | ((old_head +((uint64_t)1 << 48)) & 0xFFFF000000000000ull);
+	}
+	while (global.head.compare_exchange_weak( old_head, new_head, std::memory_order_acquire, std::memory_order_acquire ) == false);
+
+	return batch;
+}	//end function: pool_pop_batch | size_t
+
+/****************************************************************************
+**	pool_refill | PoolCache &, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	head of the refilled list. NULL if malloc failed
+**	DESCRIPTION:
+**	Pop a batch. If there is none cut a new slab into batches, keep one, push the others
+****************************************************************************/
+
+inline PoolNode *pool_refill( PoolCache &cache, size_t size_class )
+{
+	//fast counters
+	size_t t, ti;
+	size_t block_size;
+	size_t num_blocks;
+	size_t num;
+	char *slab;
+	PoolNode *batch;
+	PoolNode *node;
+
+	batch = pool_pop_batch( size_class );
+	if (batch == NULL)
+	{
+		block_size = pool_class_size( size_class );
+		slab = (char *)malloc( POOL_SLAB_SIZE );
+		if (slab == NULL)
+		{
+			return NULL;
+		}
+		pool_global( size_class ).num_slabs.fetch_add( 1, std::memory_order_relaxed );
+		num_blocks = POOL_SLAB_SIZE /block_size;
+
+		//Link the blocks of each batch. The first batch stays with the thread
+		for (t = 0;t < num_blocks;t += POOL_BATCH)
+		{
+			num = (num_blocks -t < POOL_BATCH) ?(num_blocks -t) :(POOL_BATCH);
+			for (ti = 0;ti < num;ti++)
+			{
+				node = (PoolNode *)(slab +(t +ti) *block_size);
+				node->next = (ti +1 < num) ?((PoolNode *)(slab +(t +ti +1) *block_size)) :(NULL);
+			}
+			if (t > 0)
+			{
+				pool_push_batch( size_class, (PoolNode *)(slab +t *block_size) );
+			}
+		}
+		batch = (PoolNode *)slab;
+	}
+
+	//Count the blocks of the batch
+	num = 0;
+	for (node = batch;node != NULL;node = node->next)
+	{
+		num++;
+	}
+	cache.head[size_class] = batch;
+	cache.count[size_class] = num;
+
+	return batch;
+}	//end function: pool_refill | PoolCache &, size_t
+
+/****************************************************************************
+**	pool_flush | PoolCache &, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	num blocks to give back, at most the count of the list
+**	RETURN:
+**	DESCRIPTION:
+**	Detach num blocks from the top of the list of the thread, push them as a batch
+****************************************************************************/
+
+inline void pool_flush( PoolCache &cache, size_t size_class, size_t num )
+{
+	//fast counter
+	size_t t;
+	PoolNode *batch;
+	PoolNode *last;
+
+	if (num == 0)
+	{
+		return;
+	}
+
+	batch = cache.head[size_class];
+	last = batch;
+	for (t = 1;t < num;t++)
+	{
+		last = last->next;
+	}
+	cache.head[size_class] = last->next;
+	cache.count[size_class] -= num;
+	last->next = NULL;
+	pool_push_batch( size_class, batch );
+
+	return;
+}	//end function: pool_flush | PoolCache &, size_t, size_t
+
+/****************************************************************************
+**	PoolCache | void
+*****************************************************************************
+**	DESCRIPTION:
+**	Constructed on first use by each thread, destroyed when the thread ends
+****************************************************************************/
+
+inline PoolCache::PoolCache( void )
+{
+	//fast counter
+	size_t t;
+
+	for (t = 0;t < POOL_NUM_CLASSES;t++)
+	{
+		head[t] = NULL;
+		count[t] = 0;
+	}
+}
+
+inline PoolCache::~PoolCache( void )
+{
+	//fast counter
+	size_t t;
+
+	for (t = 0;t < POOL_NUM_CLASSES;t++)
+	{
+		while (count[t] > 0)
+		{
+			pool_flush( *this, t, (count[t] < POOL_BATCH) ?(count[t]) :(POOL_BATCH) );
+		}
+	}
+}
+
+/****************************************************************************
+**	pool_alloc | size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	block of at least size bytes, 16 byte aligned. NULL on failure
+**	DESCRIPTION:
+****************************************************************************/
+
+inline void *pool_alloc( size_t size )
+{
+	size_t size_class;
+	PoolNode *node;
+
+	size_class = pool_class( size );
+	if (size_class >= POOL_NUM_CLASSES)
+	{
+		return malloc( size );
+	}
+
+	PoolCache &cache = pool_cache();
+	node = cache.head[size_class];
+	if (node == NULL)
+	{
+		node = pool_refill( cache, size_class );
+		if (node == NULL)
+		{
+			return NULL;
+		}
+	}
+	cache.head[size_class] = node->next;
+	cache.count[size_class]--;
+
+	return node;
+}	//end function: pool_alloc | size_t
+
+/****************************************************************************
+**	pool_free | void *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	size given to pool_alloc
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+inline void pool_free( void *ptr, size_t size )
+{
+	size_t size_class;
+	PoolNode *node;
+
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	size_class = pool_class( size );
+	if (size_class >= POOL_NUM_CLASSES)
+	{
+		free( ptr );
+		return;
+	}
+
+	PoolCache &cache = pool_cache();
+	node = (PoolNode *)ptr;
+	node->next = cache.head[size_class];
+	cache.head[size_class] = node;
+	cache.count[size_class]++;
+
+	//Too many blocks held by this thread, give a batch back
+	if (cache.count[size_class] > POOL_CACHE_BATCHES *POOL_BATCH)
+	{
+		pool_flush( cache, size_class, POOL_BATCH );
+	}
+
+	return;
+}	//end function: pool_free | void *, size_t
+
+inline size_t pool_slab_bytes( void )
+{
+	//fast counter
+	size_t t;
+	size_t ret = 0;
+
+	for (t = 0;t < POOL_NUM_CLASSES;t++)
+	{
+		ret += pool_global( t ).num_slabs.load( std::memory_order_relaxed ) *POOL_SLAB_SIZE;
+	}
+
+	return ret;
+}	//end function: pool_slab_bytes | void
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	PoolAllocator
+*****************************************************************************
+**	DESCRIPTION:
+**	C++11 allocator over pool_alloc/pool_free. Stateless, all instances are equal
+**	Throws std::bad_alloc on failure, as std containers expect
+****************************************************************************/
+
+template <typename T>
+class PoolAllocator
+{
+	public:
+		typedef T value_type;
+
+		PoolAllocator( void )
+		{
+		}
+
+		template <typename U>
+		PoolAllocator( const PoolAllocator<U> & )
+		{
+		}
+
+		T *allocate( size_t num )
+		{
+			T *ret;
+
+			if (num > (size_t)-1 /sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			ret = (T *)pool_alloc( num *sizeof(T) );
+			if (ret == NULL)
+			{
+				throw std::bad_alloc();
+			}
+			return ret;
+		}
+
+		void deallocate( T *data_arg, size_t num )
+		{
+			pool_free( data_arg, num *sizeof(T) );
+		}
+};	//end class: PoolAllocator
+
+template <typename T, typename U>
+inline bool operator==( const PoolAllocator<T> &, const PoolAllocator<U> & )
+{
+	return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=( const PoolAllocator<T> &, const PoolAllocator<U> & )
+{
+	return false;
+}
+
+#endif	//POOL_H_
@@ -0,0 +1,575 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Radix Sort
+*****************************************************************
+**	LSD radix sort of integer arrays, key-value and multithreaded
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	std::sort compares: N log2(N) comparisons, and a branch it can't predict on random keys.
+**	A radix sort never compares. Each pass reads the array once and moves every key to the
+**	bucket of one 8 bit digit of the key: sizeof(T) passes, whatever N.
+**
+**	FUNCTIONS
+**		radix_sort( data, size )						sort of any integer type, signed or unsigned
+**		radix_sort_pairs( keys, values, size )			sort keys, values follow their key. Stable
+**		radix_sort_parallel( data, size, options )		multithreaded, for large arrays
+**	Raw pointer and size, like c_style_stack_1d_handler, or anything with data() and size().
+**
+**	LSD
+**	One pass counts the digits of every byte of the keys. Then from the lowest digit up,
+**	each pass moves the keys to a second buffer of N elements in order of digit, stable.
+**	A digit that is the same for every key moves nothing and is skipped:
+**	keys in 0..255 sort in one pass, nearly sorted keys cost the same as random ones.
+**	Signed keys have the sign bit flipped, so negative keys come before positive ones.
+**
+**	PARALLEL
+**	Threads count the highest digit that is not the same for every key, each on its chunk,
+**	and move their chunk into 256 buckets. Each bucket is then sorted by LSD on the lower digits
+**	as an independent task, largest first. A bucket too large for one thread, as with skewed keys,
+**	is split again the same way. Arrays below RADIX_PARALLEL_MIN are sorted by radix_sort.
+**
+**	The second buffer is allocated on each call: std::bad_alloc as new[]
+**	Arrays below RADIX_SMALL are sorted by insertion.
+****************************************************************/
+
+#ifndef RADIX_SORT_H_
+#define RADIX_SORT_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstring>		//for memcpy, memset
+//Standard C++ libraries
+#include <vector>		//for std::vector
+#include <algorithm>	//for std::sort, std::min, std::max
+#include <utility>		//for std::move
+#include <type_traits>	//for std::is_integral, std::make_unsigned
+//User libraries
+#include "aligned_array.h"	//for AlignedArray
+#include "parallel.h"	//for ThreadPool, Parallel_options
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Bits of a digit. 256 counters fit in L1
+#define RADIX_BITS			8
+#define RADIX_BUCKETS		(1 << RADIX_BITS)
+//Below this insertion sort is faster than counting 256 buckets
+#define RADIX_SMALL			64
+//Below this radix_sort_parallel runs radix_sort on the calling thread
+#define RADIX_PARALLEL_MIN	((size_t)1 << 20)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Unsigned key of T with the same order. Signed T has the sign bit flipped
+template <typename T>
+struct Radix_key
+{
+	static_assert( std::is_integral<T>::value == true, "radix sort needs integer keys" );
+
+	typedef typename std::make_unsigned<T>::type type;
+
+	static type get( T value )
+	{
+		return (std::is_signed<T>::value == true) ?((type)value ^ ((type)1 << (8 *sizeof(T) -1))) :((type)value);
+	}
+
+	static size_t digit( T value, size_t index )
+	{
+		return (size_t)((get( value ) >> (RADIX_BITS *index)) & (RADIX_BUCKETS -1));
+	}
+};
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+template <typename T>
+inline void radix_sort( T *data, size_t size );
+template <typename K, typename V>
+inline void radix_sort_pairs( K *keys, V *values, size_t size );
+template <typename T>
+inline void radix_sort_parallel( T *data, size_t size, const Parallel_options &options = Parallel_options() );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	radix_insertion_sort | T *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Small arrays. Stable
+****************************************************************************/
+
+template <typename T>
+inline void radix_insertion_sort( T *data, size_t size )
+{
+	//fast counters
+	size_t t, ti;
+	T key;
+
+	for (t = 1;t < size;t++)
+	{
+		key = data[t];
+		for (ti = t;(ti > 0) && (key < data[ti -1]);ti--)
+		{
+			data[ti] = data[ti -1];
+		}
+		data[ti] = key;
+	}
+
+	return;
+}	//end function: radix_insertion_sort | T *, size_t
+
+//Values move with their key
+template <typename K, typename V>
+inline void radix_insertion_sort( K *keys, V *values, size_t size )
+{
+	//fast counters
+	size_t t, ti;
+	K key;
+
+	for (t = 1;t < size;t++)
+	{
+		key = keys[t];
+		V value( std::move( values[t] ) );
+		for (ti = t;(ti > 0) && (key < keys[ti -1]);ti--)
+		{
+			keys[ti] = keys[ti -1];
+			values[ti] = std::move( values[ti -1] );
+		}
+		keys[ti] = key;
+		values[ti] = std::move( value );
+	}
+
+	return;
+}	//end function: radix_insertion_sort | K *, V *, size_t
+
+/****************************************************************************
+**	radix_histogram | const T *, size_t, size_t, size_t (*)[RADIX_BUCKETS]
+*****************************************************************************
+**	PARAMETER:
+**	num_digits		count digits 0..num_digits-1
+**	count			num_digits rows of RADIX_BUCKETS counters, cleared here
+**	RETURN:
+**	DESCRIPTION:
+**	One read of the array counts every digit
+****************************************************************************/
+
+template <typename T>
+inline void radix_histogram( const T *data, size_t size, size_t num_digits, size_t (*count)[RADIX_BUCKETS] )
+{
+	//fast counters
+	size_t t, d;
+	typename Radix_key<T>::type key;
+
+	memset( (void *)count, 0, num_digits *RADIX_BUCKETS *sizeof(size_t) );
+	for (t = 0;t < size;t++)
+	{
+		key = Radix_key<T>::get( data[t] );
+		for (d = 0;d < num_digits;d++)
+		{
+			count[d][(key >> (RADIX_BITS *d)) & (RADIX_BUCKETS -1)]++;
+		}
+	}
+
+	return;
+}	//end function: radix_histogram | const T *, size_t, size_t, size_t (*)[RADIX_BUCKETS]
+
+//Turn the counters of a digit into the first position of each bucket. false if one bucket holds every key
+inline bool radix_offsets( size_t *count, size_t size )
+{
+	//fast counter
+	size_t b;
+	size_t sum = 0;
+	size_t num;
+
+	for (b = 0;b < RADIX_BUCKETS;b++)
+	{
+		num = count[b];
+		if (num == size)
+		{
+			return false;
+		}
+		count[b] = sum;
+		sum += num;
+	}
+
+	return true;
+}	//end function: radix_offsets | size_t *, size_t
+
+/****************************************************************************
+**	radix_lsd | T *, T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	data, tmp		keys and a buffer of as many elements
+**	num_digits		sort on digits 0..num_digits-1. Higher digits must already be equal
+**	RETURN:
+**	data or tmp, whichever holds the sorted keys
+**	DESCRIPTION:
+**	Passes alternate between the buffers. Digits equal for every key are skipped
+****************************************************************************/
+
+template <typename T>
+inline T *radix_lsd( T *data, T *tmp, size_t size, size_t num_digits )
+{
+	//fast counters
+	size_t t, d;
+	size_t count[sizeof(T)][RADIX_BUCKETS];
+	T *src = data;
+	T *dst = tmp;
+	T *swap;
+
+	if (size < RADIX_SMALL)
+	{
+		radix_insertion_sort( data, size );
+		return data;
+	}
+
+	radix_histogram( data, size, num_digits, count );
+	for (d = 0;d < num_digits;d++)
+	{
+		if (radix_offsets( count[d], size ) == true)
+		{
+			for (t = 0;t < size;t++)
+			{
+				dst[count[d][Radix_key<T>::digit( src[t], d )]++] = src[t];
+			}
+			swap = src;
+			src = dst;
+			dst = swap;
+		}
+	}
+
+	return src;
+}	//end function: radix_lsd | T *, T *, size_t, size_t
+
+/****************************************************************************
+**	radix_sort | T *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	After an odd number of passes the keys are in the buffer: copy them back
+****************************************************************************/
+
+template <typename T>
+inline void radix_sort( T *data, size_t size )
+{
+	T *ret;
+
+	if (size < RADIX_SMALL)
+	{
+		radix_insertion_sort( data, size );
+		return;
+	}
+
+	AlignedArray<T> tmp( size );
+	ret = radix_lsd( data, tmp.data(), size, sizeof(T) );
+	if (ret != data)
+	{
+		memcpy( (void *)data, (const void *)ret, size *sizeof(T) );
+	}
+
+	return;
+}	//end function: radix_sort | T *, size_t
+
+//std::array, std::vector, Span, AlignedArray
+template <typename Array>
+inline void radix_sort( Array &array )
+{
+	radix_sort( array.data(), array.size() );
+}
+
+/****************************************************************************
+**	radix_sort_pairs | K *, V *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	keys		integers
+**	values		any movable type, moved with their key
+**	RETURN:
+**	DESCRIPTION:
+**	Same passes as radix_sort, each moves the key and its value. Keys that are equal keep their order
+****************************************************************************/
+
+template <typename K, typename V>
+inline void radix_sort_pairs( K *keys, V *values, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t t, d;
+	size_t count[sizeof(K)][RADIX_BUCKETS];
+	size_t pos;
+	K *src_key = keys;
+	V *src_value = values;
+	K *dst_key;
+	V *dst_value;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (size < RADIX_SMALL)
+	{
+		radix_insertion_sort( keys, values, size );
+		return;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	AlignedArray<K> tmp_keys( size );
+	AlignedArray<V> tmp_values( size );
+	dst_key = tmp_keys.data();
+	dst_value = tmp_values.data();
+	radix_histogram( keys, size, sizeof(K), count );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (d = 0;d < sizeof(K);d++)
+	{
+		if (radix_offsets( count[d], size ) == true)
+		{
+			for (t = 0;t < size;t++)
+			{
+				pos = count[d][Radix_key<K>::digit( src_key[t], d )]++;
+				dst_key[pos] = src_key[t];
+				dst_value[pos] = std::move( src_value[t] );
+			}
+			std::swap( src_key, dst_key );
+			std::swap( src_value, dst_value );
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	FINALIZATIONS
+	///--------------------------------------------------------------------------
+
+	if (src_key != keys)
+	{
+		memcpy( (void *)keys, (const void *)src_key, size *sizeof(K) );
+		std::move( src_value, src_value +size, values );
+	}
+
+	return;
+}	//end function: radix_sort_pairs | K *, V *, size_t
+
+/****************************************************************************
+**	radix_parallel_step | T *, T *, size_t, size_t, ThreadPool &
+*****************************************************************************
+**	PARAMETER:
+**	data, tmp		keys and a buffer of as many elements
+**	num_digits		digits num_digits and up are already equal for every key
+**	RETURN:
+**	DESCRIPTION:
+**	1) threads find the digits that differ among keys, and take the highest one
+**	2) each thread counts that digit in its chunk
+**	3) each thread moves its chunk to tmp. Chunk c of bucket b goes after chunks 0..c-1 of bucket b
+**	4) buckets too large for one thread are split again by the next digit, the others are tasks of radix_lsd
+**	Keys end in data
+****************************************************************************/
+
+template <typename T>
+inline void radix_parallel_step( T *data, T *tmp, size_t size, size_t num_digits, ThreadPool &pool )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	typedef typename Radix_key<T>::type Key;
+	//fast counters
+	size_t c, b, t;
+	size_t num_chunks = std::min( (size_t)pool.size() *PARALLEL_TASKS_PER_THREAD, size /RADIX_SMALL +1 );
+	size_t chunk = (size +num_chunks -1) /num_chunks;
+	size_t big = std::max( RADIX_PARALLEL_MIN, size /pool.size() );
+	size_t digit;
+	size_t sum;
+	Key first = Radix_key<T>::get( data[0] );
+	Key diff = 0;
+	std::vector<Key> chunk_diff( num_chunks, 0 );
+	std::vector<size_t> count( num_chunks *RADIX_BUCKETS, 0 );
+	size_t begin[RADIX_BUCKETS +1];
+	size_t order[RADIX_BUCKETS];
+	size_t num_small = 0;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	//Bits that differ from the first key
+	pool.run( num_chunks, [&]( size_t task )
+	{
+		//fast counter
+		size_t ti;
+		Key acc = 0;
+
+		for (ti = task *chunk;ti < std::min( (task +1) *chunk, size );ti++)
+		{
+			acc |= Radix_key<T>::get( data[ti] ) ^ first;
+		}
+		chunk_diff[task] = acc;
+	} );
+	for (c = 0;c < num_chunks;c++)
+	{
+		diff |= chunk_diff[c];
+	}
+	//Highest digit that differs. None: every key is the same
+	for (digit = num_digits;(digit > 0) && (((diff >> (RADIX_BITS *(digit -1))) & (RADIX_BUCKETS -1)) == 0);digit--)
+	{
+	}
+	if (digit == 0)
+	{
+		return;
+	}
+	digit--;
+
+	//Count the digit of each chunk
+	pool.run( num_chunks, [&]( size_t task )
+	{
+		//fast counter
+		size_t ti;
+		size_t *chunk_count = &count[task *RADIX_BUCKETS];
+
+		for (ti = task *chunk;ti < std::min( (task +1) *chunk, size );ti++)
+		{
+			chunk_count[Radix_key<T>::digit( data[ti], digit )]++;
+		}
+	} );
+
+	//Position of chunk c in bucket b, bucket by bucket
+	sum = 0;
+	for (b = 0;b < RADIX_BUCKETS;b++)
+	{
+		begin[b] = sum;
+		for (c = 0;c < num_chunks;c++)
+		{
+			t = count[c *RADIX_BUCKETS +b];
+			count[c *RADIX_BUCKETS +b] = sum;
+			sum += t;
+		}
+	}
+	begin[RADIX_BUCKETS] = size;
+
+	//Move each chunk to its buckets
+	pool.run( num_chunks, [&]( size_t task )
+	{
+		//fast counter
+		size_t ti;
+		size_t *chunk_count = &count[task *RADIX_BUCKETS];
+
+		for (ti = task *chunk;ti < std::min( (task +1) *chunk, size );ti++)
+		{
+			tmp[chunk_count[Radix_key<T>::digit( data[ti], digit )]++] = data[ti];
+		}
+	} );
+
+	//Large buckets split again with every thread, in tmp. Then they go back to data
+	for (b = 0;b < RADIX_BUCKETS;b++)
+	{
+		if ((begin[b +1] -begin[b] > big) && (digit > 0))
+		{
+			radix_parallel_step( tmp +begin[b], data +begin[b], begin[b +1] -begin[b], digit, pool );
+			Parallel_options options( 0, false, &pool );
+			parallel_for_range( begin[b], begin[b +1], [&]( size_t chunk_begin, size_t chunk_end )
+			{
+				memcpy( (void *)(data +chunk_begin), (const void *)(tmp +chunk_begin), (chunk_end -chunk_begin) *sizeof(T) );
+			}, options );
+		}
+		else
+		{
+			order[num_small] = b;
+			num_small++;
+		}
+	}
+
+	//Small buckets are tasks, largest first so a large one does not start last
+	std::sort( order, order +num_small, [&]( size_t x, size_t y )
+	{
+		return (begin[x +1] -begin[x] > begin[y +1] -begin[y]);
+	} );
+	pool.run( num_small, [&]( size_t task )
+	{
+		size_t bucket = order[task];
+		size_t num = begin[bucket +1] -begin[bucket];
+		T *ret;
+
+		if (num == 0)
+		{
+			return;
+		}
+		ret = radix_lsd( tmp +begin[bucket], data +begin[bucket], num, digit );
+		if (ret != data +begin[bucket])
+		{
+			memcpy( (void *)(data +begin[bucket]), (const void *)ret, num *sizeof(T) );
+		}
+	} );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: radix_parallel_step | T *, T *, size_t, size_t, ThreadPool &
+
+/****************************************************************************
+**	radix_sort_parallel | T *, size_t, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	options		pool of Parallel_options. grain and deterministic are not used
+**	RETURN:
+**	DESCRIPTION:
+**	The result is the same as radix_sort whatever the number of threads
+****************************************************************************/
+
+template <typename T>
+inline void radix_sort_parallel( T *data, size_t size, const Parallel_options &options )
+{
+	ThreadPool &pool = parallel_pool( options );
+
+	if ((size < RADIX_PARALLEL_MIN) || (pool.size() < 2))
+	{
+		radix_sort( data, size );
+		return;
+	}
+
+	AlignedArray<T> tmp( size );
+	radix_parallel_step( data, tmp.data(), size, sizeof(T), pool );
+
+	return;
+}	//end function: radix_sort_parallel | T *, size_t, const Parallel_options &
+
+//std::array, std::vector, Span, AlignedArray
+template <typename Array>
+inline void radix_sort_parallel( Array &array, const Parallel_options &options = Parallel_options() )
+{
+	radix_sort_parallel( array.data(), array.size(), options );
+}
+
+#endif	//RADIX_SORT_H_
@@ -0,0 +1,586 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Realloc Vector
+*****************************************************************
+**	Vector of trivially copyable elements that grows with realloc and mremap
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	std::vector grows by allocating a new buffer, copying every element into it and freeing the old one.
+**	For an int array of 8 GB the last push_back that grows copies 4 GB and needs 12 GB at once.
+**	An int has no constructor to run: the bytes can stay where they are and the buffer can grow around them.
+**	ReallocVector<T> does that for trivially copyable T.
+**
+**	GROWTH
+**	Below REALLOC_VECTOR_MAP_BYTES the buffer comes from malloc and grows with realloc. realloc extends
+**	the block in place when the memory after it is free, and copies otherwise.
+**	From REALLOC_VECTOR_MAP_BYTES up the buffer is an anonymous mapping of its own, and grows with
+**	mremap( MREMAP_MAYMOVE ): the kernel moves the page tables, not the bytes. Growing never copies,
+**	whatever the size, and the old and new buffer never exist at the same time.
+**	Off Linux there is no mremap and large buffers grow with realloc too.
+**	Capacity doubles when full: push_back is amortized O(1) without reserve.
+**
+**	The element access and growth of std::vector, for T without constructors worth running. Beyond it
+**		append( ptr, num )			push_back of num elements with one memcpy
+**		resize_uninitialized( num )	new elements are not written. Cheaper than resize when they are about to be
+**		is_mapped()					the buffer is a mapping of its own
+**		shrink_to_fit()				gives back the capacity past size, with mremap for a mapping
+**	A ReallocVector converts to Span<T> and Span<const T>. A copy allocates only the size, not the capacity.
+**	Moves swap the pointer and are noexcept: a std::vector of ReallocVector moves them when it grows.
+**
+**	resize value initializes the new elements. A fresh page of a mapping is already zero: when T with a
+**	trivial default constructor is value initialized to zero bytes, resize only writes the elements that
+**	were used before. The pages of the rest are touched for the first time when the elements are.
+**	malloc, realloc, mmap or mremap failing throws std::bad_alloc, and leaves the vector as it was.
+****************************************************************/
+
+#ifndef REALLOC_VECTOR_H_
+#define REALLOC_VECTOR_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdlib>		//for malloc, realloc, free
+#include <cstring>		//for memcpy, memset
+//Standard C++ libraries
+#include <new>			//for std::bad_alloc, placement new
+#include <utility>		//for std::forward
+#include <type_traits>	//for std::is_trivially_copyable, std::is_trivially_default_constructible
+#include <initializer_list>	//for std::initializer_list
+//POSIX
+#if defined( __linux__ )
+#include <unistd.h>		//for sysconf
+#include <sys/mman.h>	//for mmap, mremap, munmap
+#endif
+//User libraries
+#include "array_view.h"	//for Span
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+#if defined( __linux__ )
+#define REALLOC_VECTOR_MREMAP
+#endif
+
+//Buffers of this many bytes or more are a mapping of their own. Crossing it copies the elements once
+#ifndef REALLOC_VECTOR_MAP_BYTES
+#define REALLOC_VECTOR_MAP_BYTES	((size_t)1 << 20)
+#endif
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	ReallocVector
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements in a buffer of capacity, malloc or mapping
+****************************************************************************/
+
+template <typename T>
+class ReallocVector
+{
+	static_assert( std::is_trivially_copyable<T>::value == true, "ReallocVector moves elements as bytes, T must be trivially copyable" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		ReallocVector( void ) : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+		}
+
+		//size value initialized elements, like std::vector
+		explicit ReallocVector( size_t size_arg ) : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+			resize( size_arg );
+		}
+
+		ReallocVector( size_t size_arg, const T &value ) : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+			resize( size_arg, value );
+		}
+
+		ReallocVector( std::initializer_list<T> list ) : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+			append( list.begin(), list.size() );
+		}
+
+		ReallocVector( const ReallocVector &vector_arg ) : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+			append( vector_arg.g_data, vector_arg.g_size );
+		}
+
+		//Steal the buffer
+		ReallocVector( ReallocVector &&vector_arg ) noexcept : g_data( NULL ), g_size( 0 ), g_capacity( 0 ), g_mapped( false ), g_used( 0 )
+		{
+			steal( vector_arg );
+		}
+
+		~ReallocVector( void )
+		{
+			release();
+		}
+
+		ReallocVector &operator=( const ReallocVector &vector_arg )
+		{
+			if (this != &vector_arg)
+			{
+				clear();
+				append( vector_arg.g_data, vector_arg.g_size );
+			}
+			return *this;
+		}
+
+		ReallocVector &operator=( ReallocVector &&vector_arg ) noexcept
+		{
+			if (this != &vector_arg)
+			{
+				release();
+				steal( vector_arg );
+			}
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void )
+		{
+			return g_data;
+		}
+
+		const T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		size_t capacity( void ) const
+		{
+			return g_capacity;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		//The buffer is a mapping of its own, grown by mremap
+		bool is_mapped( void ) const
+		{
+			return g_mapped;
+		}
+
+		T &operator[]( size_t index )
+		{
+			return g_data[index];
+		}
+
+		const T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T &front( void )
+		{
+			return g_data[0];
+		}
+
+		T &back( void )
+		{
+			return g_data[g_size -1];
+		}
+
+		const T &front( void ) const
+		{
+			return g_data[0];
+		}
+
+		const T &back( void ) const
+		{
+			return g_data[g_size -1];
+		}
+
+		T *begin( void )
+		{
+			return g_data;
+		}
+
+		T *end( void )
+		{
+			return g_data +g_size;
+		}
+
+		const T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		const T *end( void ) const
+		{
+			return g_data +g_size;
+		}
+
+		//Room for capacity_arg elements. Never shrinks
+		void reserve( size_t capacity_arg )
+		{
+			if (capacity_arg > g_capacity)
+			{
+				set_capacity( capacity_arg );
+			}
+		}
+
+		//Capacity down to size. A mapping shrinks in place, below REALLOC_VECTOR_MAP_BYTES the elements go back to malloc
+		void shrink_to_fit( void )
+		{
+			if (g_capacity > g_size)
+			{
+				set_capacity( g_size );
+			}
+		}
+
+		void push_back( const T &value )
+		{
+			//value may be an element of this vector: copy it before growing moves the buffer
+			if (g_size == g_capacity)
+			{
+				T tmp( value );
+				grow( g_size +1 );
+				g_data[g_size] = tmp;
+			}
+			else
+			{
+				g_data[g_size] = value;
+			}
+			g_size++;
+		}
+
+		template <typename... Args>
+		T &emplace_back( Args &&... args )
+		{
+			T tmp( std::forward<Args>( args )... );
+
+			if (g_size == g_capacity)
+			{
+				grow( g_size +1 );
+			}
+			g_data[g_size] = tmp;
+			g_size++;
+			return g_data[g_size -1];
+		}
+
+		//push_back of num elements. src may point into this vector
+		void append( const T *src, size_t num )
+		{
+			size_t offset;
+
+			if (num == 0)
+			{
+				return;
+			}
+			if (g_size +num > g_capacity)
+			{
+				//Growing moves the buffer, and src with it when it is inside
+				if ((src >= g_data) && (src < g_data +g_size))
+				{
+					offset = src -g_data;
+					grow( g_size +num );
+					src = g_data +offset;
+				}
+				else
+				{
+					grow( g_size +num );
+				}
+			}
+			memcpy( (void *)(g_data +g_size), (const void *)src, num *sizeof(T) );
+			g_size += num;
+		}
+
+		void pop_back( void )
+		{
+			mark_used();
+			g_size--;
+		}
+
+		//Keeps the capacity, like std::vector
+		void clear( void )
+		{
+			mark_used();
+			g_size = 0;
+		}
+
+		//New elements are value initialized
+		void resize( size_t size_arg )
+		{
+			//fast counter
+			size_t t;
+			size_t dirty;
+
+			if (size_arg <= g_size)
+			{
+				mark_used();
+				g_size = size_arg;
+				return;
+			}
+			reserve( size_arg );
+			if (zero_is_value() == true)
+			{
+				//Elements of a mapping past those ever used are still zero
+				dirty = (g_mapped == true) ?(min_size( size_arg, (g_used > g_size) ?(g_used) :(g_size) )) :(size_arg);
+				if (dirty > g_size)
+				{
+					memset( (void *)(g_data +g_size), 0, (dirty -g_size) *sizeof(T) );
+				}
+			}
+			else
+			{
+				for (t = g_size;t < size_arg;t++)
+				{
+					new (g_data +t) T();
+				}
+			}
+			g_size = size_arg;
+		}
+
+		void resize( size_t size_arg, const T &value )
+		{
+			//fast counter
+			size_t t;
+			T tmp( value );
+
+			if (size_arg <= g_size)
+			{
+				mark_used();
+				g_size = size_arg;
+				return;
+			}
+			reserve( size_arg );
+			for (t = g_size;t < size_arg;t++)
+			{
+				g_data[t] = tmp;
+			}
+			g_size = size_arg;
+		}
+
+		//New elements are whatever the buffer holds. Write them before reading them
+		void resize_uninitialized( size_t size_arg )
+		{
+			if (size_arg <= g_size)
+			{
+				mark_used();
+			}
+			else
+			{
+				reserve( size_arg );
+			}
+			g_size = size_arg;
+		}
+
+		///--------------------------------------------------------------------------
+		///	VIEWS
+		///--------------------------------------------------------------------------
+
+		operator Span<T>( void )
+		{
+			return Span<T>( g_data, g_size );
+		}
+
+		operator Span<const T>( void ) const
+		{
+			return Span<const T>( g_data, g_size );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		static size_t min_size( size_t a, size_t b )
+		{
+			return (a < b) ?(a) :(b);
+		}
+
+		//A value initialized T is all zero bytes
+		static constexpr bool zero_is_value( void )
+		{
+			return ((std::is_trivially_default_constructible<T>::value == true) && (std::is_member_pointer<T>::value == false));
+		}
+
+		#ifdef REALLOC_VECTOR_MREMAP
+		//Bytes of the mapping of capacity_arg elements, whole pages
+		static size_t map_bytes( size_t capacity_arg )
+		{
+			static const size_t page = (size_t)sysconf( _SC_PAGESIZE );
+
+			return (capacity_arg *sizeof(T) +page -1) /page *page;
+		}
+		#endif
+
+		//Elements from size up may have been written: remember it before size goes down
+		void mark_used( void )
+		{
+			if (g_size > g_used)
+			{
+				g_used = g_size;
+			}
+		}
+
+		//At least twice the capacity, at least needed
+		void grow( size_t needed )
+		{
+			size_t capacity_arg = 2 *g_capacity;
+
+			if (capacity_arg < needed)
+			{
+				capacity_arg = needed;
+			}
+			set_capacity( capacity_arg );
+		}
+
+		//Buffer of exactly capacity_arg elements, the first size kept. capacity_arg >= size
+		void set_capacity( size_t capacity_arg )
+		{
+			void *ret;
+
+			if (capacity_arg > ((size_t)-1 >> 1) /sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			if (capacity_arg == 0)
+			{
+				release();
+				return;
+			}
+			#ifdef REALLOC_VECTOR_MREMAP
+			if (capacity_arg *sizeof(T) >= REALLOC_VECTOR_MAP_BYTES)
+			{
+				if (g_mapped == true)
+				{
+					//Page tables move, elements stay. Pages past the old end are new and zero
+					ret = mremap( (void *)g_data, map_bytes( g_capacity ), map_bytes( capacity_arg ), MREMAP_MAYMOVE );
+					if (ret == MAP_FAILED)
+					{
+						throw std::bad_alloc();
+					}
+				}
+				else
+				{
+					//Out of malloc: the only copy. The mapping is zero past the elements copied
+					ret = mmap( NULL, map_bytes( capacity_arg ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+					if (ret == MAP_FAILED)
+					{
+						throw std::bad_alloc();
+					}
+					if (g_size > 0)
+					{
+						memcpy( ret, (const void *)g_data, g_size *sizeof(T) );
+					}
+					free( (void *)g_data );
+					g_used = g_size;
+					g_mapped = true;
+				}
+				g_data = (T *)ret;
+				g_capacity = capacity_arg;
+				return;
+			}
+			if (g_mapped == true)
+			{
+				//Shrink below the threshold: back to malloc
+				ret = malloc( capacity_arg *sizeof(T) );
+				if (ret == NULL)
+				{
+					throw std::bad_alloc();
+				}
+				memcpy( ret, (const void *)g_data, g_size *sizeof(T) );
+				munmap( (void *)g_data, map_bytes( g_capacity ) );
+				g_data = (T *)ret;
+				g_capacity = capacity_arg;
+				g_mapped = false;
+				return;
+			}
+			#endif
+			ret = realloc( (void *)g_data, capacity_arg *sizeof(T) );
+			if (ret == NULL)
+			{
+				throw std::bad_alloc();
+			}
+			g_data = (T *)ret;
+			g_capacity = capacity_arg;
+		}
+
+		//Give back the buffer. The vector is empty after
+		void release( void )
+		{
+			#ifdef REALLOC_VECTOR_MREMAP
+			if (g_mapped == true)
+			{
+				munmap( (void *)g_data, map_bytes( g_capacity ) );
+			}
+			else
+			#endif
+			{
+				free( (void *)g_data );
+			}
+			g_data = NULL;
+			g_size = 0;
+			g_capacity = 0;
+			g_mapped = false;
+			g_used = 0;
+		}
+
+		//Take the buffer of vector_arg, which is left empty. This vector must be empty, no buffer
+		void steal( ReallocVector &vector_arg )
+		{
+			g_data = vector_arg.g_data;
+			g_size = vector_arg.g_size;
+			g_capacity = vector_arg.g_capacity;
+			g_mapped = vector_arg.g_mapped;
+			g_used = vector_arg.g_used;
+			vector_arg.g_data = NULL;
+			vector_arg.g_size = 0;
+			vector_arg.g_capacity = 0;
+			vector_arg.g_mapped = false;
+			vector_arg.g_used = 0;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//malloc buffer, mapping, or NULL
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+		size_t g_capacity;
+		//g_data is a mapping
+		bool g_mapped;
+		//Elements of a mapping from max( g_size, g_used ) up were never written: still zero
+		size_t g_used;
+};	//end class: ReallocVector
+
+#endif	//REALLOC_VECTOR_H_
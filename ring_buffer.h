@@ -0,0 +1,397 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Ring Buffer
+*****************************************************************
+**	Bounded lock-free queues on a std::array
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	A queue between threads guarded by a mutex puts both threads to sleep and wakes them
+**	through the kernel when they meet. A ring buffer of fixed capacity needs no lock:
+**	a std::array<T,N>, N a power of two, and two counters that only grow.
+**	Element i is in slot i & (N-1). tail -head is the number of elements.
+**
+**	SpscRing<T,N>		one producer thread, one consumer thread. Wait-free:
+**						push and pop finish in a fixed number of steps, they never retry.
+**						Each side keeps a copy of the counter of the other side and reads
+**						the shared one only when the copy says the ring is full, or empty
+**	MpmcRing<T,N>		any number of producers and consumers. Lock-free, bounded.
+**						Each slot has a sequence number telling whether it is free for the
+**						producer of round k or full for the consumer of round k (Vyukov).
+**						A thread claims slots by compare exchange on the counter, and retries
+**						only when another thread claimed them first
+**
+**	push( value ), pop( value )				false when full, or empty. They never wait
+**	push_n( src, n ), pop_n( dst, n )		as many elements as fit, up to n. Return how many.
+**											One update of the shared counter for the whole batch
+**
+**	The counters of the producers, of the consumers and the slots are on cache lines of their own,
+**	so a producer writing its counter does not evict the one of the consumer.
+**	The ring is aligned to a cache line: C++11 new ignores that alignment. Make it static, a local,
+**	a member, or an element of an AlignedArray.
+**	T must be default constructible and assignable: slots are a std::array<T,N>.
+****************************************************************/
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <array>		//for std::array
+#include <atomic>		//for std::atomic
+#include <utility>		//for std::move
+#include <algorithm>	//for std::min
+//User libraries
+#include "aligned_array.h"	//for ALIGNED_CACHE_LINE
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	SpscRing
+*****************************************************************************
+**	DESCRIPTION:
+**	Up to N elements from one producer thread to one consumer thread
+****************************************************************************/
+
+template <typename T, size_t N>
+class alignas( ALIGNED_CACHE_LINE ) SpscRing
+{
+	static_assert( (N >= 2) && ((N & (N -1)) == 0), "SpscRing capacity must be a power of two" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		SpscRing( void ) : g_head( 0 ), g_tail_cache( 0 ), g_tail( 0 ), g_head_cache( 0 )
+		{
+		}
+
+		//The counters can't move
+		SpscRing( const SpscRing & ) = delete;
+		SpscRing &operator=( const SpscRing & ) = delete;
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		static constexpr size_t capacity( void )
+		{
+			return N;
+		}
+
+		//Exact only when neither side is running
+		size_t size( void ) const
+		{
+			return g_tail.load( std::memory_order_acquire ) -g_head.load( std::memory_order_acquire );
+		}
+
+		bool empty( void ) const
+		{
+			return (size() == 0);
+		}
+
+		//Producer. false when full
+		bool push( const T &value )
+		{
+			size_t tail = g_tail.load( std::memory_order_relaxed );
+
+			if (tail -g_head_cache == N)
+			{
+				g_head_cache = g_head.load( std::memory_order_acquire );
+				if (tail -g_head_cache == N)
+				{
+					return false;
+				}
+			}
+			g_data[tail & (N -1)] = value;
+			g_tail.store( tail +1, std::memory_order_release );
+
+			return true;
+		}
+
+		//Consumer. false when empty
+		bool pop( T &value )
+		{
+			size_t head = g_head.load( std::memory_order_relaxed );
+
+			if (g_tail_cache == head)
+			{
+				g_tail_cache = g_tail.load( std::memory_order_acquire );
+				if (g_tail_cache == head)
+				{
+					return false;
+				}
+			}
+			value = std::move( g_data[head & (N -1)] );
+			g_head.store( head +1, std::memory_order_release );
+
+			return true;
+		}
+
+		//Producer. Push the first elements of src that fit. Return how many
+		size_t push_n( const T *src, size_t num )
+		{
+			//fast counter
+			size_t t;
+			size_t tail = g_tail.load( std::memory_order_relaxed );
+
+			if (N -(tail -g_head_cache) < num)
+			{
+				g_head_cache = g_head.load( std::memory_order_acquire );
+				num = std::min( num, N -(tail -g_head_cache) );
+			}
+			for (t = 0;t < num;t++)
+			{
+				g_data[(tail +t) & (N -1)] = src[t];
+			}
+			g_tail.store( tail +num, std::memory_order_release );
+
+			return num;
+		}
+
+		//Consumer. Pop up to num elements into dst. Return how many
+		size_t pop_n( T *dst, size_t num )
+		{
+			//fast counter
+			size_t t;
+			size_t head = g_head.load( std::memory_order_relaxed );
+
+			if (g_tail_cache -head < num)
+			{
+				g_tail_cache = g_tail.load( std::memory_order_acquire );
+				num = std::min( num, g_tail_cache -head );
+			}
+			for (t = 0;t < num;t++)
+			{
+				dst[t] = std::move( g_data[(head +t) & (N -1)] );
+			}
+			g_head.store( head +num, std::memory_order_release );
+
+			return num;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Consumer line. Next element to pop, and the last tail the consumer saw
+		alignas( ALIGNED_CACHE_LINE ) std::atomic<size_t> g_head;
+		size_t g_tail_cache;
+		//Producer line. Next slot to fill, and the last head the producer saw
+		alignas( ALIGNED_CACHE_LINE ) std::atomic<size_t> g_tail;
+		size_t g_head_cache;
+		//Slots, index modulo N
+		alignas( ALIGNED_CACHE_LINE ) std::array<T, N> g_data;
+};	//end class: SpscRing
+
+/****************************************************************************
+**	MpmcRing
+*****************************************************************************
+**	DESCRIPTION:
+**	Up to N elements from any thread to any thread.
+**	Slot i of round k has sequence k*N +i when free for its producer,
+**	k*N +i +1 when full for its consumer. The consumer frees it for round k+1: (k+1)*N +i
+****************************************************************************/
+
+template <typename T, size_t N>
+class alignas( ALIGNED_CACHE_LINE ) MpmcRing
+{
+	static_assert( (N >= 2) && ((N & (N -1)) == 0), "MpmcRing capacity must be a power of two" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		MpmcRing( void ) : g_head( 0 ), g_tail( 0 )
+		{
+			//fast counter
+			size_t t;
+
+			for (t = 0;t < N;t++)
+			{
+				g_slot[t].sequence.store( t, std::memory_order_relaxed );
+			}
+		}
+
+		MpmcRing( const MpmcRing & ) = delete;
+		MpmcRing &operator=( const MpmcRing & ) = delete;
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		static constexpr size_t capacity( void )
+		{
+			return N;
+		}
+
+		//Exact only when no thread is running
+		size_t size( void ) const
+		{
+			size_t head = g_head.load( std::memory_order_acquire );
+			size_t tail = g_tail.load( std::memory_order_acquire );
+
+			return (tail > head) ?(tail -head) :(0);
+		}
+
+		bool empty( void ) const
+		{
+			return (size() == 0);
+		}
+
+		//false when full
+		bool push( const T &value )
+		{
+			return (push_n( &value, 1 ) == 1);
+		}
+
+		//false when empty
+		bool pop( T &value )
+		{
+			return (pop_n( &value, 1 ) == 1);
+		}
+
+		//Claim the free slots after tail, up to num, fill them. Return how many
+		size_t push_n( const T *src, size_t num )
+		{
+			//fast counter
+			size_t t;
+			size_t tail = g_tail.load( std::memory_order_relaxed );
+			size_t claim;
+
+			if (num == 0)
+			{
+				return 0;
+			}
+			while (true)
+			{
+				claim = count_ready( tail, 0, std::min( num, N ) );
+				if (claim == 0)
+				{
+					//Still full of round k-1: full. Already past tail: another producer claimed it
+					if ((ptrdiff_t)(g_slot[tail & (N -1)].sequence.load( std::memory_order_acquire ) -tail) < 0)
+					{
+						return 0;
+					}
+					tail = g_tail.load( std::memory_order_relaxed );
+				}
+				//Slots seen free stay free until their producer fills them: after the exchange, that is this thread
+				else if (g_tail.compare_exchange_weak( tail, tail +claim, std::memory_order_relaxed, std::memory_order_relaxed ) == true)
+				{
+					break;
+				}
+			}
+			for (t = 0;t < claim;t++)
+			{
+				g_slot[(tail +t) & (N -1)].value = src[t];
+				g_slot[(tail +t) & (N -1)].sequence.store( tail +t +1, std::memory_order_release );
+			}
+
+			return claim;
+		}
+
+		//Claim the full slots after head, up to num, empty them into dst. Return how many
+		size_t pop_n( T *dst, size_t num )
+		{
+			//fast counter
+			size_t t;
+			size_t head = g_head.load( std::memory_order_relaxed );
+			size_t claim;
+
+			if (num == 0)
+			{
+				return 0;
+			}
+			while (true)
+			{
+				claim = count_ready( head, 1, std::min( num, N ) );
+				if (claim == 0)
+				{
+					//Not yet filled for this round: empty. Already freed: another consumer claimed it
+					if ((ptrdiff_t)(g_slot[head & (N -1)].sequence.load( std::memory_order_acquire ) -(head +1)) < 0)
+					{
+						return 0;
+					}
+					head = g_head.load( std::memory_order_relaxed );
+				}
+				else if (g_head.compare_exchange_weak( head, head +claim, std::memory_order_relaxed, std::memory_order_relaxed ) == true)
+				{
+					break;
+				}
+			}
+			for (t = 0;t < claim;t++)
+			{
+				dst[t] = std::move( g_slot[(head +t) & (N -1)].value );
+				g_slot[(head +t) & (N -1)].sequence.store( head +t +N, std::memory_order_release );
+			}
+
+			return claim;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		//Consecutive slots from position whose sequence is position +offset, up to num.
+		//offset 0: free for a producer, offset 1: full for a consumer
+		size_t count_ready( size_t position, size_t offset, size_t num ) const
+		{
+			//fast counter
+			size_t t;
+
+			for (t = 0;t < num;t++)
+			{
+				if (g_slot[(position +t) & (N -1)].sequence.load( std::memory_order_acquire ) != position +t +offset)
+				{
+					break;
+				}
+			}
+
+			return t;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		//Next slot to pop, shared by consumers
+		alignas( ALIGNED_CACHE_LINE ) std::atomic<size_t> g_head;
+		//Next slot to fill, shared by producers
+		alignas( ALIGNED_CACHE_LINE ) std::atomic<size_t> g_tail;
+		//Slots, index modulo N
+		alignas( ALIGNED_CACHE_LINE ) std::array<Slot, N> g_slot;
+};	//end class: MpmcRing
+
+#endif	//RING_BUFFER_H_
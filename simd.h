@@ -0,0 +1,932 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	SIMD
+*****************************************************************
+**	Vectorized reduction and transform kernels over 1D arrays
+**	C++11 standard, GCC or Clang
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	A loop over an array handles one element per iteration. A vector instruction handles 4 to 16.
+**	The compiler vectorizes some loops by itself, but not float reductions (order of the sums
+**	would change) and not at -O2 when it needs a tail loop. These kernels are vectorized by hand.
+**
+**	KERNELS. T is int, float or double. A is the accumulator: int64_t for int, T otherwise
+**		simd_sum( a, n )					A		sum of the elements
+**		simd_min_max( a, n, min, max )		bool	false if n is 0, min and max are untouched
+**		simd_dot( a, b, n )					A		sum of a[i]*b[i]
+**		simd_scale_add( y, x, s, n )		void	y[i] = s*x[i] +y[i]
+**		simd_count_greater( a, n, th )		size_t	elements greater than th
+**
+**	DISPATCH
+**	The same kernel is compiled for each instruction set and the best one the CPU has
+**	is chosen at run time. Binary runs everywhere, no -mavx2 needed.
+**		SIMD_SCALAR		plain loop, the reference
+**		SIMD_SSE4		16 byte vectors
+**		SIMD_AVX2		32 byte vectors
+**		SIMD_AVX512		64 byte vectors
+**	simd_set_isa() forces a lower level, e.g. to compare it with the reference.
+**	Non x86 CPUs always use SIMD_SCALAR.
+**
+**	RESULTS
+**	Integer results are bit exact on every path. int arithmetic wraps like unsigned instead of overflowing.
+**	Float sum and dot add in a different order on each path: results differ in the last bits.
+**	Float min/max with NaN elements are unspecified.
+**
+**	Kernels are written once with GCC vector extensions: a + b on two vectors adds lane by lane.
+**	A kernel is inlined into a small wrapper per instruction set, compiled with the target attribute of that set.
+****************************************************************/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for int64_t, uint64_t
+#include <cstring>		//for memcpy
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>	//for the pmuldq intrinsics of the int dot
+#endif
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	#define SIMD_X86
+#endif
+
+//Force inlining of a kernel into the wrapper of an instruction set
+#define SIMD_INLINE			inline __attribute__(( always_inline ))
+//Compile a wrapper for an instruction set
+#define SIMD_TARGET_SSE4	__attribute__(( target( "sse4.2" ) ))
+#define SIMD_TARGET_AVX2	__attribute__(( target( "avx2" ) ))
+#define SIMD_TARGET_AVX512	__attribute__(( target( "avx512f" ) ))
+
+//Count lanes of a comparison in chunks of this many vectors, so the 32 bit counters can't overflow
+#define SIMD_COUNT_CHUNK	((size_t)1 << 30)
+
+/****************************************************************
+**	ENUM
+****************************************************************/
+
+//Instruction sets. Each includes the ones before it
+enum Simd_isa
+{
+	SIMD_SCALAR,
+	SIMD_SSE4,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Accumulator of a type. type is what the kernels return, lane is what they add in
+//lane is unsigned for int so the sums wrap instead of overflowing
+template <typename T>
+struct Simd_acc;
+
+template <>
+struct Simd_acc<int>
+{
+	typedef int64_t type;
+	typedef uint64_t lane;
+	typedef unsigned int wrap;
+};
+
+template <>
+struct Simd_acc<float>
+{
+	typedef float type;
+	typedef float lane;
+	typedef float wrap;
+};
+
+template <>
+struct Simd_acc<double>
+{
+	typedef double type;
+	typedef double lane;
+	typedef double wrap;
+};
+
+//Vector of W bytes of T
+template <typename T, size_t W>
+struct Simd_vec;
+
+//Half a 16 byte vector of int, widened to 16 bytes of int64
+template <typename T>
+struct Simd_vec<T, 8>
+{
+	typedef T type __attribute__(( vector_size( 8 ) ));
+};
+
+template <typename T>
+struct Simd_vec<T, 16>
+{
+	typedef T type __attribute__(( vector_size( 16 ) ));
+};
+
+template <typename T>
+struct Simd_vec<T, 32>
+{
+	typedef T type __attribute__(( vector_size( 32 ) ));
+};
+
+template <typename T>
+struct Simd_vec<T, 64>
+{
+	typedef T type __attribute__(( vector_size( 64 ) ));
+};
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+//Best instruction set of the CPU
+inline Simd_isa simd_detect( void );
+//Instruction set in use
+inline Simd_isa simd_isa( void );
+//Use isa, or the best the CPU has if lower. Return the one in use. Call before starting threads
+inline Simd_isa simd_set_isa( Simd_isa isa );
+inline const char *simd_isa_name( Simd_isa isa );
+//Kernels
+template <typename T>
+inline typename Simd_acc<T>::type simd_sum( const T *array_arg, size_t size );
+template <typename T>
+inline bool simd_min_max( const T *array_arg, size_t size, T &min, T &max );
+template <typename T>
+inline typename Simd_acc<T>::type simd_dot( const T *a, const T *b, size_t size );
+template <typename T>
+inline void simd_scale_add( T *y, const T *x, T scale, size_t size );
+template <typename T>
+inline size_t simd_count_greater( const T *array_arg, size_t size, T threshold );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	simd_detect | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	__builtin_cpu_supports also checks the OS saves the wide registers
+****************************************************************************/
+
+inline Simd_isa simd_detect( void )
+{
+#if defined( SIMD_X86 )
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports( "avx512f" ))
+	{
+		return SIMD_AVX512;
+	}
+	if (__builtin_cpu_supports( "avx2" ))
+	{
+		return SIMD_AVX2;
+	}
+	if (__builtin_cpu_supports( "sse4.2" ))
+	{
+		return SIMD_SSE4;
+	}
+#endif
+
+	return SIMD_SCALAR;
+}	//end function: simd_detect | void
+
+/****************************************************************************
+**	simd_isa_ref | void
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Function local static: detected once, a single instance across translation units
+****************************************************************************/
+
+inline Simd_isa &simd_isa_ref( void )
+{
+	static Simd_isa isa = simd_detect();
+
+	return isa;
+}	//end function: simd_isa_ref | void
+
+inline Simd_isa simd_isa( void )
+{
+	return simd_isa_ref();
+}	//end function: simd_isa | void
+
+inline Simd_isa simd_set_isa( Simd_isa isa )
+{
+	Simd_isa best = simd_detect();
+
+	simd_isa_ref() = (isa < best) ?(isa) :(best);
+
+	return simd_isa_ref();
+}	//end function: simd_set_isa | Simd_isa
+
+inline const char *simd_isa_name( Simd_isa isa )
+{
+	switch (isa)
+	{
+		case SIMD_SSE4:
+			return "sse4";
+		case SIMD_AVX2:
+			return "avx2";
+		case SIMD_AVX512:
+			return "avx512";
+		default:
+			return "scalar";
+	}
+}	//end function: simd_isa_name | Simd_isa
+
+/****************************************************************************
+**	KERNELS
+*****************************************************************************
+**	One body per operation, W is the vector width in bytes. W == 0 is the scalar reference.
+**	Vectors are loaded and stored with memcpy: unaligned, no aliasing trouble, compiles to a single move
+****************************************************************************/
+
+/****************************************************************************
+**	simd_sum_kernel | const T *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Four accumulators: an add waits for the previous add of the same accumulator only
+**	int lanes are widened to 64 bit as they are loaded
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE typename Simd_acc<T>::type simd_sum_kernel( const T *array_arg, size_t size )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	typedef typename Simd_acc<T>::lane L;
+	//Elements in a vector of accumulators. Half a vector of int is loaded and widened to a full vector
+	const size_t lanes = W /sizeof(L);
+	typedef typename Simd_vec<T, lanes *sizeof(T)>::type V;
+	typedef typename Simd_vec<L, W>::type VL;
+	//fast counters
+	size_t t, l;
+	V v0, v1, v2, v3;
+	VL acc0 = {}, acc1 = {}, acc2 = {}, acc3 = {};
+	L ret = 0;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	for (t = 0;t +4 *lanes <= size;t += 4 *lanes)
+	{
+		memcpy( &v0, array_arg +t, sizeof(V) );
+		memcpy( &v1, array_arg +t +lanes, sizeof(V) );
+		memcpy( &v2, array_arg +t +2 *lanes, sizeof(V) );
+		memcpy( &v3, array_arg +t +3 *lanes, sizeof(V) );
+		acc0 += __builtin_convertvector( v0, VL );
+		acc1 += __builtin_convertvector( v1, VL );
+		acc2 += __builtin_convertvector( v2, VL );
+		acc3 += __builtin_convertvector( v3, VL );
+	}
+	for (;t +lanes <= size;t += lanes)
+	{
+		memcpy( &v0, array_arg +t, sizeof(V) );
+		acc0 += __builtin_convertvector( v0, VL );
+	}
+	acc0 = (acc0 +acc1) +(acc2 +acc3);
+	for (l = 0;l < lanes;l++)
+	{
+		ret += acc0[l];
+	}
+	//Tail
+	for (;t < size;t++)
+	{
+		ret += (L)array_arg[t];
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return (typename Simd_acc<T>::type)ret;
+}	//end function: simd_sum_kernel | const T *, size_t
+
+/****************************************************************************
+**	simd_min_max_kernel | const T *, size_t, T &, T &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Lane wise min and max, then min and max of the lanes
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE bool simd_min_max_kernel( const T *array_arg, size_t size, T &min, T &max )
+{
+	typedef typename Simd_vec<T, W>::type V;
+	const size_t lanes = W /sizeof(T);
+	//fast counters
+	size_t t, l;
+	V v, vmin, vmax;
+	T ret_min, ret_max;
+
+	if (size < lanes)
+	{
+		return false;
+	}
+
+	memcpy( &vmin, array_arg, W );
+	vmax = vmin;
+	for (t = lanes;t +lanes <= size;t += lanes)
+	{
+		memcpy( &v, array_arg +t, W );
+		vmin = (v < vmin) ?(v) :(vmin);
+		vmax = (v > vmax) ?(v) :(vmax);
+	}
+	ret_min = vmin[0];
+	ret_max = vmax[0];
+	for (l = 1;l < lanes;l++)
+	{
+		ret_min = (vmin[l] < ret_min) ?(vmin[l]) :(ret_min);
+		ret_max = (vmax[l] > ret_max) ?(vmax[l]) :(ret_max);
+	}
+	for (;t < size;t++)
+	{
+		ret_min = (array_arg[t] < ret_min) ?(array_arg[t]) :(ret_min);
+		ret_max = (array_arg[t] > ret_max) ?(array_arg[t]) :(ret_max);
+	}
+	min = ret_min;
+	max = ret_max;
+
+	return true;
+}	//end function: simd_min_max_kernel | const T *, size_t, T &, T &
+
+/****************************************************************************
+**	simd_dot_kernel | const T *, const T *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	int products are computed in 64 bit, they never lose bits
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE typename Simd_acc<T>::type simd_dot_kernel( const T *a, const T *b, size_t size )
+{
+	typedef typename Simd_acc<T>::lane L;
+	const size_t lanes = W /sizeof(L);
+	typedef typename Simd_vec<T, lanes *sizeof(T)>::type V;
+	typedef typename Simd_vec<L, W>::type VL;
+	//fast counters
+	size_t t, l;
+	V va0, vb0, va1, vb1;
+	VL acc0 = {}, acc1 = {};
+	L ret = 0;
+
+	for (t = 0;t +2 *lanes <= size;t += 2 *lanes)
+	{
+		memcpy( &va0, a +t, sizeof(V) );
+		memcpy( &vb0, b +t, sizeof(V) );
+		memcpy( &va1, a +t +lanes, sizeof(V) );
+		memcpy( &vb1, b +t +lanes, sizeof(V) );
+		acc0 += __builtin_convertvector( va0, VL ) *__builtin_convertvector( vb0, VL );
+		acc1 += __builtin_convertvector( va1, VL ) *__builtin_convertvector( vb1, VL );
+	}
+	for (;t +lanes <= size;t += lanes)
+	{
+		memcpy( &va0, a +t, sizeof(V) );
+		memcpy( &vb0, b +t, sizeof(V) );
+		acc0 += __builtin_convertvector( va0, VL ) *__builtin_convertvector( vb0, VL );
+	}
+	acc0 += acc1;
+	for (l = 0;l < lanes;l++)
+	{
+		ret += acc0[l];
+	}
+	for (;t < size;t++)
+	{
+		ret += (L)a[t] *(L)b[t];
+	}
+
+	return (typename Simd_acc<T>::type)ret;
+}	//end function: simd_dot_kernel | const T *, const T *, size_t
+
+/****************************************************************************
+**	simd_scale_add_kernel | T *, const T *, T, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	int is computed as unsigned: same bits, wraps instead of overflowing
+**	Multiply then add, like the scalar loop, so float results match it too
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE void simd_scale_add_kernel( T *y, const T *x, T scale, size_t size )
+{
+	typedef typename Simd_acc<T>::wrap U;
+	typedef typename Simd_vec<U, W>::type V;
+	const size_t lanes = W /sizeof(T);
+	//fast counter
+	size_t t;
+	U s = (U)scale;
+	U xs, ys;
+	V vx, vy;
+
+	for (t = 0;t +lanes <= size;t += lanes)
+	{
+		memcpy( &vx, x +t, W );
+		memcpy( &vy, y +t, W );
+		vy = s *vx +vy;
+		memcpy( y +t, &vy, W );
+	}
+	for (;t < size;t++)
+	{
+		memcpy( &xs, x +t, sizeof(T) );
+		memcpy( &ys, y +t, sizeof(T) );
+		ys = s *xs +ys;
+		memcpy( y +t, &ys, sizeof(T) );
+	}
+
+	return;
+}	//end function: simd_scale_add_kernel | T *, const T *, T, size_t
+
+/****************************************************************************
+**	simd_count_greater_kernel | const T *, size_t, T
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	A comparison gives -1 in the lanes where it is true. Subtracting it counts them
+****************************************************************************/
+
+template <typename T, size_t W>
+SIMD_INLINE size_t simd_count_greater_kernel( const T *array_arg, size_t size, T threshold )
+{
+	typedef typename Simd_vec<T, W>::type V;
+	//Type of a comparison: signed int lanes as wide as T
+	typedef decltype( V() > V() ) M;
+	const size_t lanes = W /sizeof(T);
+	//fast counters
+	size_t t, l;
+	size_t end;
+	V v;
+	V vth = V() +threshold;
+	M cnt;
+	size_t ret = 0;
+
+	t = 0;
+	while (t +lanes <= size)
+	{
+		//Flush the lane counters before they can overflow
+		end = (size -t) /lanes;
+		end = t +((end < SIMD_COUNT_CHUNK) ?(end) :(SIMD_COUNT_CHUNK)) *lanes;
+		cnt = M();
+		for (;t < end;t += lanes)
+		{
+			memcpy( &v, array_arg +t, W );
+			cnt -= (v > vth);
+		}
+		for (l = 0;l < lanes;l++)
+		{
+			ret += (size_t)cnt[l];
+		}
+	}
+	for (;t < size;t++)
+	{
+		ret += (array_arg[t] > threshold) ?(1) :(0);
+	}
+
+	return ret;
+}	//end function: simd_count_greater_kernel | const T *, size_t, T
+
+/****************************************************************************
+**	SCALAR REFERENCE
+*****************************************************************************
+**	Plain loops, in the order a reader expects
+****************************************************************************/
+
+template <typename T>
+inline typename Simd_acc<T>::type simd_sum_scalar( const T *array_arg, size_t size )
+{
+	//fast counter
+	size_t t;
+	typename Simd_acc<T>::lane ret = 0;
+
+	for (t = 0;t < size;t++)
+	{
+		ret += (typename Simd_acc<T>::lane)array_arg[t];
+	}
+
+	return (typename Simd_acc<T>::type)ret;
+}	//end function: simd_sum_scalar | const T *, size_t
+
+template <typename T>
+inline bool simd_min_max_scalar( const T *array_arg, size_t size, T &min, T &max )
+{
+	//fast counter
+	size_t t;
+
+	if (size == 0)
+	{
+		return false;
+	}
+	min = array_arg[0];
+	max = array_arg[0];
+	for (t = 1;t < size;t++)
+	{
+		min = (array_arg[t] < min) ?(array_arg[t]) :(min);
+		max = (array_arg[t] > max) ?(array_arg[t]) :(max);
+	}
+
+	return true;
+}	//end function: simd_min_max_scalar | const T *, size_t, T &, T &
+
+template <typename T>
+inline typename Simd_acc<T>::type simd_dot_scalar( const T *a, const T *b, size_t size )
+{
+	typedef typename Simd_acc<T>::lane L;
+	//fast counter
+	size_t t;
+	L ret = 0;
+
+	for (t = 0;t < size;t++)
+	{
+		ret += (L)a[t] *(L)b[t];
+	}
+
+	return (typename Simd_acc<T>::type)ret;
+}	//end function: simd_dot_scalar | const T *, const T *, size_t
+
+template <typename T>
+inline void simd_scale_add_scalar( T *y, const T *x, T scale, size_t size )
+{
+	typedef typename Simd_acc<T>::wrap U;
+	//fast counter
+	size_t t;
+	U s = (U)scale;
+	U xs, ys;
+
+	for (t = 0;t < size;t++)
+	{
+		memcpy( &xs, x +t, sizeof(T) );
+		memcpy( &ys, y +t, sizeof(T) );
+		ys = s *xs +ys;
+		memcpy( y +t, &ys, sizeof(T) );
+	}
+
+	return;
+}	//end function: simd_scale_add_scalar | T *, const T *, T, size_t
+
+template <typename T>
+inline size_t simd_count_greater_scalar( const T *array_arg, size_t size, T threshold )
+{
+	//fast counter
+	size_t t;
+	size_t ret = 0;
+
+	for (t = 0;t < size;t++)
+	{
+		ret += (array_arg[t] > threshold) ?(1) :(0);
+	}
+
+	return ret;
+}	//end function: simd_count_greater_scalar | const T *, size_t, T
+
+/****************************************************************************
+**	INSTRUCTION SET WRAPPERS
+*****************************************************************************
+**	The kernel is inlined and compiled for the target of the wrapper
+****************************************************************************/
+
+#if defined( SIMD_X86 )
+
+template <typename T>
+SIMD_TARGET_SSE4 typename Simd_acc<T>::type simd_sum_sse4( const T *array_arg, size_t size )
+{
+	return simd_sum_kernel<T, 16>( array_arg, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX2 typename Simd_acc<T>::type simd_sum_avx2( const T *array_arg, size_t size )
+{
+	return simd_sum_kernel<T, 32>( array_arg, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX512 typename Simd_acc<T>::type simd_sum_avx512( const T *array_arg, size_t size )
+{
+	return simd_sum_kernel<T, 64>( array_arg, size );
+}
+
+template <typename T>
+SIMD_TARGET_SSE4 bool simd_min_max_sse4( const T *array_arg, size_t size, T &min, T &max )
+{
+	return simd_min_max_kernel<T, 16>( array_arg, size, min, max );
+}
+
+template <typename T>
+SIMD_TARGET_AVX2 bool simd_min_max_avx2( const T *array_arg, size_t size, T &min, T &max )
+{
+	return simd_min_max_kernel<T, 32>( array_arg, size, min, max );
+}
+
+template <typename T>
+SIMD_TARGET_AVX512 bool simd_min_max_avx512( const T *array_arg, size_t size, T &min, T &max )
+{
+	return simd_min_max_kernel<T, 64>( array_arg, size, min, max );
+}
+
+template <typename T>
+SIMD_TARGET_SSE4 typename Simd_acc<T>::type simd_dot_sse4( const T *a, const T *b, size_t size )
+{
+	return simd_dot_kernel<T, 16>( a, b, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX2 typename Simd_acc<T>::type simd_dot_avx2( const T *a, const T *b, size_t size )
+{
+	return simd_dot_kernel<T, 32>( a, b, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX512 typename Simd_acc<T>::type simd_dot_avx512( const T *a, const T *b, size_t size )
+{
+	return simd_dot_kernel<T, 64>( a, b, size );
+}
+
+/****************************************************************************
+**	simd_dot_sse4 | const int *, const int *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	int dot needs a signed 32x32 -> 64 bit multiply. x86 has it (pmuldq), but the compiler
+**	turns a product of widened vectors into a full 64x64 multiply, three instructions per lane.
+**	These specializations of the wrappers use the instruction directly.
+**	pmuldq multiplies the low 32 bits of each 64 bit lane: the even elements.
+**	Shifting each 64 bit lane right by 32 brings the odd elements down
+****************************************************************************/
+
+template <>
+inline SIMD_TARGET_SSE4 int64_t simd_dot_sse4<int>( const int *a, const int *b, size_t size )
+{
+	//fast counter
+	size_t t;
+	__m128i va, vb;
+	__m128i acc_even = _mm_setzero_si128(), acc_odd = _mm_setzero_si128();
+	uint64_t lanes[2];
+	uint64_t ret;
+
+	for (t = 0;t +4 <= size;t += 4)
+	{
+		va = _mm_loadu_si128( (const __m128i *)(a +t) );
+		vb = _mm_loadu_si128( (const __m128i *)(b +t) );
+		acc_even = _mm_add_epi64( acc_even, _mm_mul_epi32( va, vb ) );
+		acc_odd = _mm_add_epi64( acc_odd, _mm_mul_epi32( _mm_srli_epi64( va, 32 ), _mm_srli_epi64( vb, 32 ) ) );
+	}
+	_mm_storeu_si128( (__m128i *)lanes, _mm_add_epi64( acc_even, acc_odd ) );
+	ret = lanes[0] +lanes[1];
+	for (;t < size;t++)
+	{
+		ret += (uint64_t)a[t] *(uint64_t)b[t];
+	}
+
+	return (int64_t)ret;
+}	//end function: simd_dot_sse4 | const int *, const int *, size_t
+
+template <>
+inline SIMD_TARGET_AVX2 int64_t simd_dot_avx2<int>( const int *a, const int *b, size_t size )
+{
+	//fast counters
+	size_t t, l;
+	__m256i va, vb;
+	__m256i acc_even = _mm256_setzero_si256(), acc_odd = _mm256_setzero_si256();
+	uint64_t lanes[4];
+	uint64_t ret = 0;
+
+	for (t = 0;t +8 <= size;t += 8)
+	{
+		va = _mm256_loadu_si256( (const __m256i *)(a +t) );
+		vb = _mm256_loadu_si256( (const __m256i *)(b +t) );
+		acc_even = _mm256_add_epi64( acc_even, _mm256_mul_epi32( va, vb ) );
+		acc_odd = _mm256_add_epi64( acc_odd, _mm256_mul_epi32( _mm256_srli_epi64( va, 32 ), _mm256_srli_epi64( vb, 32 ) ) );
+	}
+	_mm256_storeu_si256( (__m256i *)lanes, _mm256_add_epi64( acc_even, acc_odd ) );
+	for (l = 0;l < 4;l++)
+	{
+		ret += lanes[l];
+	}
+	for (;t < size;t++)
+	{
+		ret += (uint64_t)a[t] *(uint64_t)b[t];
+	}
+
+	return (int64_t)ret;
+}	//end function: simd_dot_avx2 | const int *, const int *, size_t
+
+template <>
+inline SIMD_TARGET_AVX512 int64_t simd_dot_avx512<int>( const int *a, const int *b, size_t size )
+{
+	//fast counters
+	size_t t, l;
+	__m512i va, vb;
+	__m512i acc_even = _mm512_setzero_si512(), acc_odd = _mm512_setzero_si512();
+	uint64_t lanes[8];
+	uint64_t ret = 0;
+
+	for (t = 0;t +16 <= size;t += 16)
+	{
+		va = _mm512_loadu_si512( (const void *)(a +t) );
+		vb = _mm512_loadu_si512( (const void *)(b +t) );
+		//maskz forms with all lanes on: same instructions, but GCC 12 warns on the plain forms
+		acc_even = _mm512_add_epi64( acc_even, _mm512_maskz_mul_epi32( 0xFF, va, vb ) );
+		acc_odd = _mm512_add_epi64( acc_odd, _mm512_maskz_mul_epi32( 0xFF, _mm512_maskz_srli_epi64( 0xFF, va, 32 ), _mm512_maskz_srli_epi64( 0xFF, vb, 32 ) ) );
+	}
+	_mm512_storeu_si512( (void *)lanes, _mm512_add_epi64( acc_even, acc_odd ) );
+	for (l = 0;l < 8;l++)
+	{
+		ret += lanes[l];
+	}
+	for (;t < size;t++)
+	{
+		ret += (uint64_t)a[t] *(uint64_t)b[t];
+	}
+
+	return (int64_t)ret;
+}	//end function: simd_dot_avx512 | const int *, const int *, size_t
+
+template <typename T>
+SIMD_TARGET_SSE4 void simd_scale_add_sse4( T *y, const T *x, T scale, size_t size )
+{
+	simd_scale_add_kernel<T, 16>( y, x, scale, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX2 void simd_scale_add_avx2( T *y, const T *x, T scale, size_t size )
+{
+	simd_scale_add_kernel<T, 32>( y, x, scale, size );
+}
+
+template <typename T>
+SIMD_TARGET_AVX512 void simd_scale_add_avx512( T *y, const T *x, T scale, size_t size )
+{
+	simd_scale_add_kernel<T, 64>( y, x, scale, size );
+}
+
+template <typename T>
+SIMD_TARGET_SSE4 size_t simd_count_greater_sse4( const T *array_arg, size_t size, T threshold )
+{
+	return simd_count_greater_kernel<T, 16>( array_arg, size, threshold );
+}
+
+template <typename T>
+SIMD_TARGET_AVX2 size_t simd_count_greater_avx2( const T *array_arg, size_t size, T threshold )
+{
+	return simd_count_greater_kernel<T, 32>( array_arg, size, threshold );
+}
+
+template <typename T>
+SIMD_TARGET_AVX512 size_t simd_count_greater_avx512( const T *array_arg, size_t size, T threshold )
+{
+	return simd_count_greater_kernel<T, 64>( array_arg, size, threshold );
+}
+
+#endif	//SIMD_X86
+
+/****************************************************************************
+**	DISPATCH
+*****************************************************************************
+**	Pick the wrapper of the instruction set in use. The kernels work on whole arrays,
+**	a switch per call costs nothing next to them
+****************************************************************************/
+
+template <typename T>
+inline typename Simd_acc<T>::type simd_sum( const T *array_arg, size_t size )
+{
+	switch (simd_isa())
+	{
+#if defined( SIMD_X86 )
+		case SIMD_AVX512:
+			return simd_sum_avx512<T>( array_arg, size );
+		case SIMD_AVX2:
+			return simd_sum_avx2<T>( array_arg, size );
+		case SIMD_SSE4:
+			return simd_sum_sse4<T>( array_arg, size );
+#endif
+		default:
+			return simd_sum_scalar<T>( array_arg, size );
+	}
+}	//end function: simd_sum | const T *, size_t
+
+template <typename T>
+inline bool simd_min_max( const T *array_arg, size_t size, T &min, T &max )
+{
+	switch (simd_isa())
+	{
+#if defined( SIMD_X86 )
+		//Arrays shorter than a vector go to the scalar loop
+		case SIMD_AVX512:
+			if (simd_min_max_avx512<T>( array_arg, size, min, max ) == true)
+			{
+				return true;
+			}
+			break;
+		case SIMD_AVX2:
+			if (simd_min_max_avx2<T>( array_arg, size, min, max ) == true)
+			{
+				return true;
+			}
+			break;
+		case SIMD_SSE4:
+			if (simd_min_max_sse4<T>( array_arg, size, min, max ) == true)
+			{
+				return true;
+			}
+			break;
+#endif
+		default:
+			break;
+	}
+
+	return simd_min_max_scalar<T>( array_arg, size, min, max );
+}	//end function: simd_min_max | const T *, size_t, T &, T &
+
+template <typename T>
+inline typename Simd_acc<T>::type simd_dot( const T *a, const T *b, size_t size )
+{
+	switch (simd_isa())
+	{
+#if defined( SIMD_X86 )
+		case SIMD_AVX512:
+			return simd_dot_avx512<T>( a, b, size );
+		case SIMD_AVX2:
+			return simd_dot_avx2<T>( a, b, size );
+		case SIMD_SSE4:
+			return simd_dot_sse4<T>( a, b, size );
+#endif
+		default:
+			return simd_dot_scalar<T>( a, b, size );
+	}
+}	//end function: simd_dot | const T *, const T *, size_t
+
+template <typename T>
+inline void simd_scale_add( T *y, const T *x, T scale, size_t size )
+{
+	switch (simd_isa())
+	{
+#if defined( SIMD_X86 )
+		case SIMD_AVX512:
+			simd_scale_add_avx512<T>( y, x, scale, size );
+			return;
+		case SIMD_AVX2:
+			simd_scale_add_avx2<T>( y, x, scale, size );
+			return;
+		case SIMD_SSE4:
+			simd_scale_add_sse4<T>( y, x, scale, size );
+			return;
+#endif
+		default:
+			simd_scale_add_scalar<T>( y, x, scale, size );
+			return;
+	}
+}	//end function: simd_scale_add | T *, const T *, T, size_t
+
+template <typename T>
+inline size_t simd_count_greater( const T *array_arg, size_t size, T threshold )
+{
+	switch (simd_isa())
+	{
+#if defined( SIMD_X86 )
+		case SIMD_AVX512:
+			return simd_count_greater_avx512<T>( array_arg, size, threshold );
+		case SIMD_AVX2:
+			return simd_count_greater_avx2<T>( array_arg, size, threshold );
+		case SIMD_SSE4:
+			return simd_count_greater_sse4<T>( array_arg, size, threshold );
+#endif
+		default:
+			return simd_count_greater_scalar<T>( array_arg, size, threshold );
+	}
+}	//end function: simd_count_greater | const T *, size_t, T
+
+#endif	//SIMD_H_
@@ -0,0 +1,553 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Small Vector
+*****************************************************************
+**	Vector with room for N elements inside the object, heap beyond
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	std::array and C arrays have a size fixed at compile time and cost nothing to make.
+**	std::vector grows without limit but calls the heap on the first push_back.
+**	Most arrays are small, a few are not.
+**	SmallVector<T,N> keeps up to N elements in a buffer inside the object:
+**	on the stack for a local variable, no allocation at all.
+**	The N+1th element moves all of them to the heap, and from then on it grows like std::vector.
+**
+**	Interface is a subset of std::vector: push_back, emplace_back, pop_back, resize, reserve, clear,
+**	data, size, capacity, operator[], front, back, begin, end. is_inline() tells where the elements are.
+**	It plugs into the handlers of example.cpp through data(), size() and the implicit Span conversion.
+**
+**	Trivially copyable T are copied and moved with memcpy. Other T are moved one by one.
+**	Moving a vector on the heap steals its buffer. Moving an inline vector moves its elements: O(N).
+**	Moves are noexcept when the moves of T are: std::vector<SmallVector> then moves them when it grows, instead of copying.
+**	Allocation throws std::bad_alloc, like std::vector.
+**	A copy or constructor of T that throws destroys the elements built so far: constructors free the buffer,
+**	resize leaves the vector as it was, copy assignment leaves it empty.
+****************************************************************/
+
+#ifndef SMALL_VECTOR_H_
+#define SMALL_VECTOR_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstring>		//for memcpy
+//Standard C++ libraries
+#include <new>			//for placement new, operator new
+#include <utility>		//for std::move, std::move_if_noexcept, std::forward
+#include <type_traits>	//for std::is_trivially_copyable, std::aligned_storage, std::is_nothrow_move_constructible
+#include <initializer_list>	//for std::initializer_list
+//User libraries
+#include "array_view.h"	//for Span
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	SmallVector
+*****************************************************************************
+**	DESCRIPTION:
+**	size elements, inline while they fit in N
+****************************************************************************/
+
+template <typename T, size_t N>
+class SmallVector
+{
+	static_assert( N > 0, "SmallVector needs room for at least one inline element" );
+
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		SmallVector( void ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+		}
+
+		//size value initialized elements, like std::vector
+		explicit SmallVector( size_t size_arg ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+			resize( size_arg );
+		}
+
+		SmallVector( size_t size_arg, const T &value ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+			resize( size_arg, value );
+		}
+
+		SmallVector( std::initializer_list<T> list ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+			reserve( list.size() );
+			try
+			{
+				copy_construct( g_data, list.begin(), list.size() );
+			}
+			catch (...)
+			{
+				//No destructor runs for a half built object
+				release();
+				throw;
+			}
+			g_size = list.size();
+		}
+
+		SmallVector( const SmallVector &vector_arg ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+			reserve( vector_arg.g_size );
+			try
+			{
+				copy_construct( g_data, vector_arg.g_data, vector_arg.g_size );
+			}
+			catch (...)
+			{
+				release();
+				throw;
+			}
+			g_size = vector_arg.g_size;
+		}
+
+		//Steal a heap buffer, move inline elements
+		SmallVector( SmallVector &&vector_arg ) noexcept( std::is_nothrow_move_constructible<T>::value ) : g_data( inline_data() ), g_size( 0 ), g_capacity( N )
+		{
+			steal( vector_arg );
+		}
+
+		~SmallVector( void )
+		{
+			destroy( g_data, g_size );
+			release();
+		}
+
+		SmallVector &operator=( const SmallVector &vector_arg )
+		{
+			if (this != &vector_arg)
+			{
+				clear();
+				reserve( vector_arg.g_size );
+				copy_construct( g_data, vector_arg.g_data, vector_arg.g_size );
+				g_size = vector_arg.g_size;
+			}
+			return *this;
+		}
+
+		SmallVector &operator=( SmallVector &&vector_arg ) noexcept( std::is_nothrow_move_constructible<T>::value )
+		{
+			if (this != &vector_arg)
+			{
+				clear();
+				release();
+				steal( vector_arg );
+			}
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		T *data( void )
+		{
+			return g_data;
+		}
+
+		const T *data( void ) const
+		{
+			return g_data;
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		size_t capacity( void ) const
+		{
+			return g_capacity;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		//Elements are in the object, not on the heap
+		bool is_inline( void ) const
+		{
+			return (g_data == inline_data());
+		}
+
+		static constexpr size_t inline_capacity( void )
+		{
+			return N;
+		}
+
+		T &operator[]( size_t index )
+		{
+			return g_data[index];
+		}
+
+		const T &operator[]( size_t index ) const
+		{
+			return g_data[index];
+		}
+
+		T &front( void )
+		{
+			return g_data[0];
+		}
+
+		T &back( void )
+		{
+			return g_data[g_size -1];
+		}
+
+		const T &front( void ) const
+		{
+			return g_data[0];
+		}
+
+		const T &back( void ) const
+		{
+			return g_data[g_size -1];
+		}
+
+		T *begin( void )
+		{
+			return g_data;
+		}
+
+		T *end( void )
+		{
+			return g_data +g_size;
+		}
+
+		const T *begin( void ) const
+		{
+			return g_data;
+		}
+
+		const T *end( void ) const
+		{
+			return g_data +g_size;
+		}
+
+		//Room for capacity_arg elements. Never shrinks
+		void reserve( size_t capacity_arg )
+		{
+			if (capacity_arg > g_capacity)
+			{
+				grow( capacity_arg );
+			}
+		}
+
+		void push_back( const T &value )
+		{
+			//value may be an element of this vector: construct it before growing frees the old buffer
+			if (g_size == g_capacity)
+			{
+				T tmp( value );
+				grow( g_size +1 );
+				new (g_data +g_size) T( std::move( tmp ) );
+			}
+			else
+			{
+				new (g_data +g_size) T( value );
+			}
+			g_size++;
+		}
+
+		void push_back( T &&value )
+		{
+			if (g_size == g_capacity)
+			{
+				T tmp( std::move( value ) );
+				grow( g_size +1 );
+				new (g_data +g_size) T( std::move( tmp ) );
+			}
+			else
+			{
+				new (g_data +g_size) T( std::move( value ) );
+			}
+			g_size++;
+		}
+
+		template <typename... Args>
+		T &emplace_back( Args &&... args )
+		{
+			if (g_size == g_capacity)
+			{
+				T tmp( std::forward<Args>( args )... );
+				grow( g_size +1 );
+				new (g_data +g_size) T( std::move( tmp ) );
+			}
+			else
+			{
+				new (g_data +g_size) T( std::forward<Args>( args )... );
+			}
+			g_size++;
+			return g_data[g_size -1];
+		}
+
+		void pop_back( void )
+		{
+			g_size--;
+			g_data[g_size].~T();
+		}
+
+		//Destroy the elements. Keeps the capacity, like std::vector
+		void clear( void )
+		{
+			destroy( g_data, g_size );
+			g_size = 0;
+		}
+
+		//New elements are value initialized
+		void resize( size_t size_arg )
+		{
+			//fast counter
+			size_t t;
+
+			if (size_arg < g_size)
+			{
+				destroy( g_data +size_arg, g_size -size_arg );
+			}
+			else
+			{
+				reserve( size_arg );
+				try
+				{
+					for (t = g_size;t < size_arg;t++)
+					{
+						new (g_data +t) T();
+					}
+				}
+				catch (...)
+				{
+					//Back to the size before
+					destroy( g_data +g_size, t -g_size );
+					throw;
+				}
+			}
+			g_size = size_arg;
+		}
+
+		void resize( size_t size_arg, const T &value )
+		{
+			//fast counter
+			size_t t;
+
+			if (size_arg < g_size)
+			{
+				destroy( g_data +size_arg, g_size -size_arg );
+			}
+			else if (size_arg > g_size)
+			{
+				T tmp( value );
+				reserve( size_arg );
+				try
+				{
+					for (t = g_size;t < size_arg;t++)
+					{
+						new (g_data +t) T( tmp );
+					}
+				}
+				catch (...)
+				{
+					destroy( g_data +g_size, t -g_size );
+					throw;
+				}
+			}
+			g_size = size_arg;
+		}
+
+		///--------------------------------------------------------------------------
+		///	VIEWS
+		///--------------------------------------------------------------------------
+
+		operator Span<T>( void )
+		{
+			return Span<T>( g_data, g_size );
+		}
+
+		operator Span<const T>( void ) const
+		{
+			return Span<const T>( g_data, g_size );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		T *inline_data( void )
+		{
+			return (T *)&g_inline;
+		}
+
+		const T *inline_data( void ) const
+		{
+			return (const T *)&g_inline;
+		}
+
+		static void copy_construct( T *dst, const T *src, size_t num )
+		{
+			//fast counter
+			size_t t;
+
+			if (std::is_trivially_copyable<T>::value == true)
+			{
+				if (num > 0)
+				{
+					memcpy( (void *)dst, (const void *)src, num *sizeof(T) );
+				}
+				return;
+			}
+			try
+			{
+				for (t = 0;t < num;t++)
+				{
+					new (dst +t) T( src[t] );
+				}
+			}
+			catch (...)
+			{
+				//Destroy the copies made, the caller frees the buffer
+				destroy( dst, t );
+				throw;
+			}
+		}
+
+		//Move num elements to uninitialized dst and destroy the originals.
+		//A move that can throw is a copy instead, like std::vector: on a throw the originals are all still there
+		static void relocate( T *dst, T *src, size_t num )
+		{
+			//fast counter
+			size_t t;
+
+			if (std::is_trivially_copyable<T>::value == true)
+			{
+				if (num > 0)
+				{
+					memcpy( (void *)dst, (const void *)src, num *sizeof(T) );
+				}
+				return;
+			}
+			try
+			{
+				for (t = 0;t < num;t++)
+				{
+					new (dst +t) T( std::move_if_noexcept( src[t] ) );
+				}
+			}
+			catch (...)
+			{
+				destroy( dst, t );
+				throw;
+			}
+			destroy( src, num );
+		}
+
+		static void destroy( T *data_arg, size_t num )
+		{
+			//fast counter
+			size_t t;
+
+			if (std::is_trivially_destructible<T>::value == false)
+			{
+				for (t = 0;t < num;t++)
+				{
+					data_arg[t].~T();
+				}
+			}
+		}
+
+		//At least twice the capacity, at least needed. Elements move to a new heap buffer
+		void grow( size_t needed )
+		{
+			size_t capacity_arg = 2 *g_capacity;
+			T *ret;
+
+			if (capacity_arg < needed)
+			{
+				capacity_arg = needed;
+			}
+			if (capacity_arg > (size_t)-1 /sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			ret = (T *)::operator new( capacity_arg *sizeof(T) );
+			try
+			{
+				relocate( ret, g_data, g_size );
+			}
+			catch (...)
+			{
+				::operator delete( (void *)ret );
+				throw;
+			}
+			release();
+			g_data = ret;
+			g_capacity = capacity_arg;
+		}
+
+		//Free the heap buffer, if any, and go back to inline. Elements must already be gone
+		void release( void )
+		{
+			if (is_inline() == false)
+			{
+				::operator delete( (void *)g_data );
+			}
+			g_data = inline_data();
+			g_capacity = N;
+		}
+
+		//Take the elements of vector_arg, which is left empty and inline. This vector must be empty and inline
+		void steal( SmallVector &vector_arg )
+		{
+			if (vector_arg.is_inline() == false)
+			{
+				g_data = vector_arg.g_data;
+				g_capacity = vector_arg.g_capacity;
+				vector_arg.g_data = vector_arg.inline_data();
+				vector_arg.g_capacity = N;
+			}
+			else
+			{
+				relocate( g_data, vector_arg.g_data, vector_arg.g_size );
+			}
+			g_size = vector_arg.g_size;
+			vector_arg.g_size = 0;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Inline buffer or heap buffer
+		T *g_data;
+		//Number of elements
+		size_t g_size;
+		//N while inline
+		size_t g_capacity;
+		//Room for N elements, uninitialized
+		typename std::aligned_storage<sizeof(T) *N, alignof(T)>::type g_inline;
+};	//end class: SmallVector
+
+#endif	//SMALL_VECTOR_H_
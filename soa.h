@@ -0,0 +1,387 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Structure of Arrays
+*****************************************************************
+**	Records stored one array per field
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	An array of structures (AoS) stores the fields of a record next to each other:
+**		struct Particle { float x, y, z; int id; };		Particle array[N];
+**	A loop that reads only x still loads whole records: 4 useful bytes out of every 16,
+**	and the x are 16 bytes apart, so the compiler can't load them in a vector.
+**	A structure of arrays (SoA) stores each field in its own array:
+**		SoA<float, float, float, int> array( N );
+**	A loop over x reads only the x, adjacent, and vectorizes.
+**
+**	SoA<Fields...> keeps one AlignedArray per field, each starting on a cache line.
+**		field<I>()				Span<T> of field I, for the kernels of simd.h and the handlers of example.cpp
+**		data<I>()				pointer to field I
+**		get<I>( index )			field I of record index
+**		operator[]( index )		SoaRef: a record of references, one per field.
+**								ref.get<I>() is the field, ref = std::make_tuple( ... ) writes the record,
+**								ref.value(), or std::tuple<Fields...> value = ref, reads it
+**	AOS INTEROP
+**		from_aos( src, size, &S::x, &S::y... )		resize to size, copy the fields of an array of S, a pointer to member per field
+**		to_aos( dst, &S::x, &S::y... )				copy the fields into an array of S
+**		from_aos( src, size ), to_aos( dst )		the same, records are std::tuple<Fields...>
+**	Conversions make one pass over the records, writing or reading every field array at once.
+**
+**	Like AlignedArray: trivial fields are not initialized, copy is deep, move steals the arrays,
+**	std::bad_alloc on allocation failure.
+****************************************************************/
+
+#ifndef SOA_H_
+#define SOA_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <tuple>		//for std::tuple, std::get, std::tuple_element
+#include <utility>		//for std::move, std::swap
+#include <algorithm>	//for std::min
+#include <type_traits>	//for std::remove_const
+//User libraries
+#include "array_view.h"	//for Span
+#include "aligned_array.h"	//for AlignedArray
+#include "constexpr_array.h"	//for Const_indices, Const_make_indices
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	SoaRef
+*****************************************************************************
+**	DESCRIPTION:
+**	Record index of a SoA, as a tuple of references to its fields.
+**	A proxy: assigning it writes the fields, it does not rebind.
+**	SoaRef<const Fields...> is the record of a const SoA
+****************************************************************************/
+
+template <typename... Fields>
+class SoaRef
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		explicit SoaRef( Fields &... fields ) : g_fields( fields... )
+		{
+		}
+
+		//Copy the fields of another record
+		SoaRef &operator=( const SoaRef &record )
+		{
+			g_fields = record.g_fields;
+			return *this;
+		}
+
+		//Write the fields
+		template <typename... Values>
+		SoaRef &operator=( const std::tuple<Values...> &value )
+		{
+			g_fields = value;
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		template <size_t I>
+		typename std::tuple_element<I, std::tuple<Fields &...>>::type get( void ) const
+		{
+			return std::get<I>( g_fields );
+		}
+
+		//Read the fields, by value
+		std::tuple<typename std::remove_const<Fields>::type...> value( void ) const
+		{
+			return std::tuple<typename std::remove_const<Fields>::type...>( g_fields );
+		}
+
+		template <typename... Values>
+		operator std::tuple<Values...>( void ) const
+		{
+			return std::tuple<Values...>( g_fields );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		std::tuple<Fields &...> g_fields;
+};	//end class: SoaRef
+
+/****************************************************************************
+**	SoA
+*****************************************************************************
+**	DESCRIPTION:
+**	size records of sizeof...(Fields) fields, one aligned array per field
+****************************************************************************/
+
+template <typename... Fields>
+class SoA
+{
+	static_assert( sizeof...(Fields) > 0, "SoA needs at least one field" );
+
+	public:
+		//A record by value
+		typedef std::tuple<Fields...> value_type;
+		typedef SoaRef<Fields...> reference;
+		typedef SoaRef<const Fields...> const_reference;
+		//Type of field I
+		template <size_t I>
+		using field_type = typename std::tuple_element<I, value_type>::type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//No records. Allocates nothing
+		SoA( void ) : g_size( 0 )
+		{
+		}
+
+		//size records. Trivial fields are left uninitialized, like AlignedArray
+		explicit SoA( size_t size_arg ) : g_fields( AlignedArray<Fields>( size_arg )... ), g_size( size_arg )
+		{
+		}
+
+		//Deep copy
+		SoA( const SoA &array_arg ) : g_fields( array_arg.g_fields ), g_size( array_arg.g_size )
+		{
+		}
+
+		//Steal the arrays
+		SoA( SoA &&array_arg ) noexcept : g_fields( std::move( array_arg.g_fields ) ), g_size( array_arg.g_size )
+		{
+			array_arg.g_size = 0;
+		}
+
+		//Copy and swap. The copy is made at the call site, like AlignedArray
+		SoA &operator=( SoA array_arg ) noexcept
+		{
+			std::swap( g_fields, array_arg.g_fields );
+			std::swap( g_size, array_arg.g_size );
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		static constexpr size_t num_fields( void )
+		{
+			return sizeof...(Fields);
+		}
+
+		size_t size( void ) const
+		{
+			return g_size;
+		}
+
+		bool empty( void ) const
+		{
+			return (g_size == 0);
+		}
+
+		template <size_t I>
+		field_type<I> *data( void )
+		{
+			return std::get<I>( g_fields ).data();
+		}
+
+		template <size_t I>
+		const field_type<I> *data( void ) const
+		{
+			return std::get<I>( g_fields ).data();
+		}
+
+		template <size_t I>
+		field_type<I> &get( size_t index )
+		{
+			return std::get<I>( g_fields )[index];
+		}
+
+		template <size_t I>
+		const field_type<I> &get( size_t index ) const
+		{
+			return std::get<I>( g_fields )[index];
+		}
+
+		reference operator[]( size_t index )
+		{
+			return make_reference( index, typename Const_make_indices<sizeof...(Fields)>::type() );
+		}
+
+		const_reference operator[]( size_t index ) const
+		{
+			return make_reference( index, typename Const_make_indices<sizeof...(Fields)>::type() );
+		}
+
+		//Keep the first min( size, size_arg ) records. New trivial fields are uninitialized
+		void resize( size_t size_arg )
+		{
+			if (size_arg != g_size)
+			{
+				resize_fields( size_arg, typename Const_make_indices<sizeof...(Fields)>::type() );
+				g_size = size_arg;
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	AOS INTEROP
+		///--------------------------------------------------------------------------
+
+		//Resize to size_arg and copy the records of src. One pointer to member of S per field, in order of field
+		template <typename S>
+		void from_aos( const S *src, size_t size_arg, Fields S::*... members )
+		{
+			//fast counter
+			size_t t;
+
+			resize( size_arg );
+			for (t = 0;t < size_arg;t++)
+			{
+				store( t, typename Const_make_indices<sizeof...(Fields)>::type(), (src[t].*members)... );
+			}
+		}
+
+		//Copy the records into dst, room for size() records
+		template <typename S>
+		void to_aos( S *dst, Fields S::*... members ) const
+		{
+			//fast counter
+			size_t t;
+
+			for (t = 0;t < g_size;t++)
+			{
+				load( t, typename Const_make_indices<sizeof...(Fields)>::type(), (dst[t].*members)... );
+			}
+		}
+
+		//Records as std::tuple<Fields...>
+		void from_aos( const value_type *src, size_t size_arg )
+		{
+			//fast counter
+			size_t t;
+
+			resize( size_arg );
+			for (t = 0;t < size_arg;t++)
+			{
+				(*this)[t] = src[t];
+			}
+		}
+
+		void to_aos( value_type *dst ) const
+		{
+			//fast counter
+			size_t t;
+
+			for (t = 0;t < g_size;t++)
+			{
+				dst[t] = (*this)[t].value();
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	VIEWS
+		///--------------------------------------------------------------------------
+
+		//Field I of every record, adjacent
+		template <size_t I>
+		Span<field_type<I>> field( void )
+		{
+			return Span<field_type<I>>( data<I>(), g_size );
+		}
+
+		template <size_t I>
+		Span<const field_type<I>> field( void ) const
+		{
+			return Span<const field_type<I>>( data<I>(), g_size );
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		template <size_t... I>
+		reference make_reference( size_t index, Const_indices<I...> )
+		{
+			return reference( std::get<I>( g_fields )[index]... );
+		}
+
+		template <size_t... I>
+		const_reference make_reference( size_t index, Const_indices<I...> ) const
+		{
+			return const_reference( std::get<I>( g_fields )[index]... );
+		}
+
+		//Write the fields of record index. The initializer list runs the assignments in order of field
+		template <size_t... I>
+		void store( size_t index, Const_indices<I...>, const Fields &... values )
+		{
+			int expand[] = { 0, ((void)(std::get<I>( g_fields )[index] = values), 0)... };
+			(void)expand;
+		}
+
+		template <size_t... I>
+		void load( size_t index, Const_indices<I...>, Fields &... values ) const
+		{
+			int expand[] = { 0, ((void)(values = std::get<I>( g_fields )[index]), 0)... };
+			(void)expand;
+		}
+
+		//New array per field, the kept records moved into it
+		template <size_t... I>
+		void resize_fields( size_t size_arg, Const_indices<I...> )
+		{
+			int expand[] = { 0, ((void)resize_field( std::get<I>( g_fields ), size_arg ), 0)... };
+			(void)expand;
+		}
+
+		template <typename T>
+		void resize_field( AlignedArray<T> &array_arg, size_t size_arg )
+		{
+			//fast counter
+			size_t t;
+			AlignedArray<T> ret( size_arg );
+
+			for (t = 0;t < std::min( size_arg, g_size );t++)
+			{
+				ret[t] = std::move( array_arg[t] );
+			}
+			array_arg = std::move( ret );
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//One array per field
+		std::tuple<AlignedArray<Fields>...> g_fields;
+		//Number of records
+		size_t g_size;
+};	//end class: SoA
+
+#endif	//SOA_H_
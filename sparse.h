@@ -0,0 +1,954 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Sparse Matrix
+*****************************************************************
+**	CSR and CSC storage of 2D arrays that are mostly zeros, SpMV
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	A dense rows x cols array stores every element. With 1% of them not zero, 99% of the
+**	memory and of the bandwidth of a pass go to zeros.
+**	Compressed storage keeps only the elements not zero, grouped by row (CSR) or by column (CSC):
+**		ptr		outer+1 offsets. The elements of row r (CSR) or column c (CSC) are ptr[r] .. ptr[r+1]-1
+**		index	nnz inner indexes, column of each element (CSR) or row (CSC), ascending in each row
+**		value	nnz values
+**	Footprint is (outer+1)*8 +nnz*(4 +sizeof(T)) bytes, against rows*cols*sizeof(T) dense.
+**	For float CSR beats dense below a density of about 50%, from there on dense is smaller.
+**
+**	SparseMatrix<T>
+**		SparseMatrix( rows, cols, triplets, num, format )	from num Sparse_triplet in any order.
+**															Duplicates are summed, in order of triplet
+**		SparseMatrix( dense, format )						the elements not zero of a View2d
+**		to_dense( dense )									write back into a rows x cols View2d, zeros included
+**		convert( format )									the same matrix in the other format. One counting pass
+**		at( row, col )										element, 0 when not stored. Binary search of the row
+**		memory_bytes()										footprint of the three arrays
+**	Indexes are 32 bit: rows and cols up to SPARSE_MAX_INDEX. The gathers take signed 32 bit offsets.
+**	Larger dimensions, or coordinates outside the matrix, throw std::out_of_range.
+**
+**	SPMV
+**		sparse_spmv( a, x, y, options )		y = a*x. x has cols elements, y rows elements
+**	CSR: a row is a dot product of value with x gathered at index. The rows are split among the threads
+**	by parallel_for_steal of work_stealing.h: rows have very different lengths, equal chunks of rows don't
+**	balance. AVX2 and AVX512 gather 8 or 16 elements of x per instruction for float and double.
+**	CSC: a column adds value *x[col] to y scattered at index. Each thread adds a range of columns holding
+**	about the same nnz into a y of its own, then the partials are summed. AVX512 scatters: the rows of a column
+**	are distinct, lanes never collide. Other instruction sets run the scalar loop.
+**	A partial covers only the rows its columns touch, and there are at most nnz/rows of them:
+**	the partials never hold more elements than the matrix. A tall very sparse CSC matrix runs on few threads,
+**	convert( SPARSE_CSR ) once for a matrix multiplied many times.
+**	Other types run the scalar loops. Matrices below SPARSE_PARALLEL_MIN elements run on the calling thread.
+**	Float sums are in a different order on each instruction set, the last bits differ.
+****************************************************************/
+
+#ifndef SPARSE_H_
+#define SPARSE_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for uint32_t, INT32_MAX
+//Standard C++ libraries
+#include <vector>		//for std::vector
+#include <algorithm>	//for std::stable_sort, std::lower_bound, std::min, std::max
+#include <utility>		//for std::move, std::swap
+#include <stdexcept>	//for std::out_of_range
+//User libraries
+#include "array_view.h"	//for View2d
+#include "aligned_array.h"	//for AlignedArray
+#include "parallel.h"	//for ThreadPool, Parallel_options, parallel_for_range
+#include "work_stealing.h"	//for parallel_for_steal
+#include "simd.h"		//for simd_isa, SIMD_TARGET_AVX2, SIMD_TARGET_AVX512
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Largest row or column index. Gathers and scatters take signed 32 bit offsets
+#define SPARSE_MAX_INDEX	((size_t)INT32_MAX)
+//Below this many stored elements sparse_spmv runs on the calling thread
+#define SPARSE_PARALLEL_MIN	((size_t)1 << 16)
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Elements grouped by row or by column
+typedef enum _Sparse_format
+{
+	SPARSE_CSR,		//Compressed sparse rows
+	SPARSE_CSC		//Compressed sparse columns
+} Sparse_format;
+
+//An element of a matrix given by coordinates
+template <typename T>
+struct Sparse_triplet
+{
+	size_t row;
+	size_t col;
+	T value;
+};
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	SparseMatrix
+*****************************************************************************
+**	DESCRIPTION:
+**	rows x cols matrix, nnz elements stored in CSR or CSC.
+**	outer is rows for CSR, cols for CSC. inner is the other one
+****************************************************************************/
+
+template <typename T>
+class SparseMatrix
+{
+	public:
+		typedef T value_type;
+
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		//0 x 0. Allocates nothing
+		SparseMatrix( void ) : g_rows( 0 ), g_cols( 0 ), g_format( SPARSE_CSR )
+		{
+		}
+
+		//num triplets in any order. Duplicates are summed. Stored zeros stay stored
+		SparseMatrix( size_t rows_arg, size_t cols_arg, const Sparse_triplet<T> *triplets, size_t num, Sparse_format format_arg = SPARSE_CSR ) : g_rows( rows_arg ), g_cols( cols_arg ), g_format( format_arg )
+		{
+			build( triplets, num );
+		}
+
+		//The elements of dense that are not zero
+		explicit SparseMatrix( View2d<const T> dense, Sparse_format format_arg = SPARSE_CSR ) : g_rows( dense.rows() ), g_cols( dense.cols() ), g_format( format_arg )
+		{
+			build( dense );
+		}
+
+		//Deep copy
+		SparseMatrix( const SparseMatrix &matrix_arg ) : g_rows( matrix_arg.g_rows ), g_cols( matrix_arg.g_cols ), g_format( matrix_arg.g_format ), g_ptr( matrix_arg.g_ptr ), g_index( matrix_arg.g_index ), g_value( matrix_arg.g_value )
+		{
+		}
+
+		//Steal the arrays. The source is left 0 x 0
+		SparseMatrix( SparseMatrix &&matrix_arg ) : g_rows( matrix_arg.g_rows ), g_cols( matrix_arg.g_cols ), g_format( matrix_arg.g_format ), g_ptr( std::move( matrix_arg.g_ptr ) ), g_index( std::move( matrix_arg.g_index ) ), g_value( std::move( matrix_arg.g_value ) )
+		{
+			matrix_arg.g_rows = 0;
+			matrix_arg.g_cols = 0;
+		}
+
+		//Copy and swap
+		SparseMatrix &operator=( SparseMatrix matrix_arg )
+		{
+			std::swap( g_rows, matrix_arg.g_rows );
+			std::swap( g_cols, matrix_arg.g_cols );
+			std::swap( g_format, matrix_arg.g_format );
+			std::swap( g_ptr, matrix_arg.g_ptr );
+			std::swap( g_index, matrix_arg.g_index );
+			std::swap( g_value, matrix_arg.g_value );
+			return *this;
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		size_t rows( void ) const
+		{
+			return g_rows;
+		}
+
+		size_t cols( void ) const
+		{
+			return g_cols;
+		}
+
+		Sparse_format format( void ) const
+		{
+			return g_format;
+		}
+
+		//Stored elements
+		size_t nnz( void ) const
+		{
+			return g_value.size();
+		}
+
+		//Rows for CSR, columns for CSC
+		size_t outer_size( void ) const
+		{
+			return (g_format == SPARSE_CSR) ?(g_rows) :(g_cols);
+		}
+
+		size_t inner_size( void ) const
+		{
+			return (g_format == SPARSE_CSR) ?(g_cols) :(g_rows);
+		}
+
+		//outer_size()+1 offsets. NULL for a 0 x 0 matrix
+		const size_t *ptr( void ) const
+		{
+			return g_ptr.data();
+		}
+
+		const uint32_t *index( void ) const
+		{
+			return g_index.data();
+		}
+
+		//Values can be changed in place, the pattern can't
+		T *value( void )
+		{
+			return g_value.data();
+		}
+
+		const T *value( void ) const
+		{
+			return g_value.data();
+		}
+
+		//Bytes of ptr, index and value
+		size_t memory_bytes( void ) const
+		{
+			return g_ptr.size() *sizeof(size_t) +g_index.size() *sizeof(uint32_t) +g_value.size() *sizeof(T);
+		}
+
+		//Element row, col. 0 when not stored
+		T at( size_t row_arg, size_t col_arg ) const
+		{
+			size_t outer = (g_format == SPARSE_CSR) ?(row_arg) :(col_arg);
+			size_t inner = (g_format == SPARSE_CSR) ?(col_arg) :(row_arg);
+			const uint32_t *begin, *end, *found;
+
+			if ((row_arg >= g_rows) || (col_arg >= g_cols))
+			{
+				throw std::out_of_range( "SparseMatrix: element outside the matrix" );
+			}
+			begin = g_index.data() +g_ptr[outer];
+			end = g_index.data() +g_ptr[outer +1];
+			found = std::lower_bound( begin, end, (uint32_t)inner );
+			return ((found != end) && (*found == inner)) ?(g_value[found -g_index.data()]) :(T());
+		}
+
+		//Write every element into dense, rows x cols, zeros included
+		void to_dense( View2d<T> dense ) const
+		{
+			//fast counters
+			size_t r, c, k;
+			size_t outer;
+
+			for (r = 0;r < g_rows;r++)
+			{
+				for (c = 0;c < g_cols;c++)
+				{
+					dense( r, c ) = T();
+				}
+			}
+			for (outer = 0;outer < outer_size();outer++)
+			{
+				for (k = g_ptr[outer];k < g_ptr[outer +1];k++)
+				{
+					if (g_format == SPARSE_CSR)
+					{
+						dense( outer, g_index[k] ) = g_value[k];
+					}
+					else
+					{
+						dense( g_index[k], outer ) = g_value[k];
+					}
+				}
+			}
+		}
+
+		//The same matrix in format_arg. Elements are moved in order of outer, so inner indexes come out sorted
+		SparseMatrix convert( Sparse_format format_arg ) const
+		{
+			//fast counters
+			size_t outer, k;
+			size_t dst;
+			SparseMatrix ret;
+
+			if (format_arg == g_format)
+			{
+				return *this;
+			}
+			ret.g_rows = g_rows;
+			ret.g_cols = g_cols;
+			ret.g_format = format_arg;
+			ret.g_ptr = AlignedArray<size_t>( inner_size() +1, (size_t)0 );
+			ret.g_index = AlignedArray<uint32_t>( nnz() );
+			ret.g_value = AlignedArray<T>( nnz() );
+			//Count the elements of each new outer, offsets one ahead
+			for (k = 0;k < nnz();k++)
+			{
+				ret.g_ptr[g_index[k] +1]++;
+			}
+			for (outer = 1;outer <= inner_size();outer++)
+			{
+				ret.g_ptr[outer] += ret.g_ptr[outer -1];
+			}
+			//ptr[i] is now the next free slot of new outer i
+			for (outer = 0;outer < outer_size();outer++)
+			{
+				for (k = g_ptr[outer];k < g_ptr[outer +1];k++)
+				{
+					dst = ret.g_ptr[g_index[k]]++;
+					ret.g_index[dst] = (uint32_t)outer;
+					ret.g_value[dst] = g_value[k];
+				}
+			}
+			//Each slot advanced to the start of the next outer: shift back by one
+			for (outer = inner_size();outer > 0;outer--)
+			{
+				ret.g_ptr[outer] = ret.g_ptr[outer -1];
+			}
+			ret.g_ptr[0] = 0;
+
+			return ret;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE METHODS
+		///--------------------------------------------------------------------------
+
+		//An element in the scratch of build
+		struct Entry
+		{
+			uint32_t index;
+			T value;
+		};
+
+		static bool entry_less( const Entry &a, const Entry &b )
+		{
+			return (a.index < b.index);
+		}
+
+		void check_dimensions( void ) const
+		{
+			if ((g_rows > SPARSE_MAX_INDEX) || (g_cols > SPARSE_MAX_INDEX))
+			{
+				throw std::out_of_range( "SparseMatrix: more rows or columns than 32 bit indexes can address" );
+			}
+		}
+
+		//Bucket by outer, sort each bucket by inner, sum the duplicates
+		void build( const Sparse_triplet<T> *triplets, size_t num )
+		{
+			//fast counters
+			size_t t, outer, k;
+			size_t begin, dst;
+			bool csr = (g_format == SPARSE_CSR);
+
+			check_dimensions();
+			for (t = 0;t < num;t++)
+			{
+				if ((triplets[t].row >= g_rows) || (triplets[t].col >= g_cols))
+				{
+					throw std::out_of_range( "SparseMatrix: triplet outside the matrix" );
+				}
+			}
+			g_ptr = AlignedArray<size_t>( outer_size() +1, (size_t)0 );
+			AlignedArray<Entry> scratch( num );
+			//Counting sort by outer, one ahead. Stable: duplicates keep the order of the triplets
+			for (t = 0;t < num;t++)
+			{
+				g_ptr[((csr == true) ?(triplets[t].row) :(triplets[t].col)) +1]++;
+			}
+			for (outer = 1;outer <= outer_size();outer++)
+			{
+				g_ptr[outer] += g_ptr[outer -1];
+			}
+			for (t = 0;t < num;t++)
+			{
+				outer = (csr == true) ?(triplets[t].row) :(triplets[t].col);
+				dst = g_ptr[outer]++;
+				scratch[dst].index = (uint32_t)((csr == true) ?(triplets[t].col) :(triplets[t].row));
+				scratch[dst].value = triplets[t].value;
+			}
+			//g_ptr[outer] is now the end of outer. Sort each one and compact the duplicates toward the front
+			dst = 0;
+			begin = 0;
+			for (outer = 0;outer < outer_size();outer++)
+			{
+				std::stable_sort( scratch.data() +begin, scratch.data() +g_ptr[outer], entry_less );
+				t = dst;
+				for (k = begin;k < g_ptr[outer];k++)
+				{
+					if ((dst > t) && (scratch[dst -1].index == scratch[k].index))
+					{
+						scratch[dst -1].value += scratch[k].value;
+					}
+					else
+					{
+						scratch[dst++] = scratch[k];
+					}
+				}
+				begin = g_ptr[outer];
+				g_ptr[outer] = t;
+			}
+			g_ptr[outer_size()] = dst;
+			g_index = AlignedArray<uint32_t>( dst );
+			g_value = AlignedArray<T>( dst );
+			for (k = 0;k < dst;k++)
+			{
+				g_index[k] = scratch[k].index;
+				g_value[k] = scratch[k].value;
+			}
+		}
+
+		//One pass counts, one pass copies
+		void build( View2d<const T> dense )
+		{
+			//fast counters
+			size_t outer, inner;
+			size_t dst;
+			bool csr = (g_format == SPARSE_CSR);
+
+			check_dimensions();
+			g_ptr = AlignedArray<size_t>( outer_size() +1 );
+			g_ptr[0] = 0;
+			for (outer = 0;outer < outer_size();outer++)
+			{
+				g_ptr[outer +1] = g_ptr[outer];
+				for (inner = 0;inner < inner_size();inner++)
+				{
+					if (((csr == true) ?(dense( outer, inner )) :(dense( inner, outer ))) != T())
+					{
+						g_ptr[outer +1]++;
+					}
+				}
+			}
+			g_index = AlignedArray<uint32_t>( g_ptr[outer_size()] );
+			g_value = AlignedArray<T>( g_ptr[outer_size()] );
+			dst = 0;
+			for (outer = 0;outer < outer_size();outer++)
+			{
+				for (inner = 0;inner < inner_size();inner++)
+				{
+					const T &element = (csr == true) ?(dense( outer, inner )) :(dense( inner, outer ));
+					if (element != T())
+					{
+						g_index[dst] = (uint32_t)inner;
+						g_value[dst] = element;
+						dst++;
+					}
+				}
+			}
+		}
+
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		size_t g_rows;
+		size_t g_cols;
+		Sparse_format g_format;
+		//outer_size()+1 offsets into index and value
+		AlignedArray<size_t> g_ptr;
+		//Inner index of each element, ascending within an outer
+		AlignedArray<uint32_t> g_index;
+		AlignedArray<T> g_value;
+};	//end class: SparseMatrix
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+template <typename T>
+inline void sparse_spmv( const SparseMatrix<T> &a, const T *x, T *y, const Parallel_options &options = Parallel_options() );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	sparse_csr_rows_scalar | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	y[r] = dot of row r with x, for r in row_begin .. row_end-1
+****************************************************************************/
+
+template <typename T>
+inline void sparse_csr_rows_scalar( const size_t *ptr, const uint32_t *index, const T *value, const T *x, T *y, size_t row_begin, size_t row_end )
+{
+	//fast counters
+	size_t r, k;
+	T acc;
+
+	for (r = row_begin;r < row_end;r++)
+	{
+		acc = T();
+		for (k = ptr[r];k < ptr[r +1];k++)
+		{
+			acc += value[k] *x[index[k]];
+		}
+		y[r] = acc;
+	}
+
+	return;
+}	//end function: sparse_csr_rows_scalar | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+
+/****************************************************************************
+**	sparse_csc_cols_scalar | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	y += column c *x[c], for c in col_begin .. col_end-1
+****************************************************************************/
+
+template <typename T>
+inline void sparse_csc_cols_scalar( const size_t *ptr, const uint32_t *index, const T *value, const T *x, T *y, size_t col_begin, size_t col_end )
+{
+	//fast counters
+	size_t c, k;
+	T scale;
+
+	for (c = col_begin;c < col_end;c++)
+	{
+		scale = x[c];
+		for (k = ptr[c];k < ptr[c +1];k++)
+		{
+			y[index[k]] += value[k] *scale;
+		}
+	}
+
+	return;
+}	//end function: sparse_csc_cols_scalar | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+
+/****************************************************************************
+**	INSTRUCTION SET WRAPPERS
+*****************************************************************************
+**	Gathers need intrinsics: vector extensions can't express them.
+**	Whole ranges of rows per call, so the dispatch is paid once per chunk, not per row.
+**	The tail of a row is masked on AVX512, scalar on AVX2
+****************************************************************************/
+
+#if defined( SIMD_X86 )
+
+//The unmasked gathers of GCC start from an undefined vector, which -Wmaybe-uninitialized reports
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+inline SIMD_TARGET_AVX2 void sparse_csr_rows_avx2( const size_t *ptr, const uint32_t *index, const float *value, const float *x, float *y, size_t row_begin, size_t row_end )
+{
+	//fast counters
+	size_t r, k, l;
+	__m256 acc;
+	float lanes[8];
+	float ret;
+
+	for (r = row_begin;r < row_end;r++)
+	{
+		acc = _mm256_setzero_ps();
+		for (k = ptr[r];k +8 <= ptr[r +1];k += 8)
+		{
+			__m256i vi = _mm256_loadu_si256( (const __m256i *)(index +k) );
+			acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_loadu_ps( value +k ), _mm256_i32gather_ps( x, vi, 4 ) ) );
+		}
+		_mm256_storeu_ps( lanes, acc );
+		ret = 0.0f;
+		for (l = 0;l < 8;l++)
+		{
+			ret += lanes[l];
+		}
+		for (;k < ptr[r +1];k++)
+		{
+			ret += value[k] *x[index[k]];
+		}
+		y[r] = ret;
+	}
+
+	return;
+}	//end function: sparse_csr_rows_avx2 | float
+
+inline SIMD_TARGET_AVX2 void sparse_csr_rows_avx2( const size_t *ptr, const uint32_t *index, const double *value, const double *x, double *y, size_t row_begin, size_t row_end )
+{
+	//fast counters
+	size_t r, k, l;
+	__m256d acc;
+	double lanes[4];
+	double ret;
+
+	for (r = row_begin;r < row_end;r++)
+	{
+		acc = _mm256_setzero_pd();
+		for (k = ptr[r];k +4 <= ptr[r +1];k += 4)
+		{
+			__m128i vi = _mm_loadu_si128( (const __m128i *)(index +k) );
+			acc = _mm256_add_pd( acc, _mm256_mul_pd( _mm256_loadu_pd( value +k ), _mm256_i32gather_pd( x, vi, 8 ) ) );
+		}
+		_mm256_storeu_pd( lanes, acc );
+		ret = 0.0;
+		for (l = 0;l < 4;l++)
+		{
+			ret += lanes[l];
+		}
+		for (;k < ptr[r +1];k++)
+		{
+			ret += value[k] *x[index[k]];
+		}
+		y[r] = ret;
+	}
+
+	return;
+}	//end function: sparse_csr_rows_avx2 | double
+
+inline SIMD_TARGET_AVX512 void sparse_csr_rows_avx512( const size_t *ptr, const uint32_t *index, const float *value, const float *x, float *y, size_t row_begin, size_t row_end )
+{
+	//fast counters
+	size_t r, k;
+	__m512 acc;
+	__m512i vi;
+	__mmask16 mask;
+
+	for (r = row_begin;r < row_end;r++)
+	{
+		acc = _mm512_setzero_ps();
+		for (k = ptr[r];k +16 <= ptr[r +1];k += 16)
+		{
+			vi = _mm512_loadu_si512( (const void *)(index +k) );
+			acc = _mm512_fmadd_ps( _mm512_loadu_ps( value +k ), _mm512_i32gather_ps( vi, x, 4 ), acc );
+		}
+		if (k < ptr[r +1])
+		{
+			mask = (__mmask16)((1u << (ptr[r +1] -k)) -1);
+			vi = _mm512_maskz_loadu_epi32( mask, index +k );
+			acc = _mm512_fmadd_ps( _mm512_maskz_loadu_ps( mask, value +k ), _mm512_mask_i32gather_ps( _mm512_setzero_ps(), mask, vi, x, 4 ), acc );
+		}
+		y[r] = _mm512_reduce_add_ps( acc );
+	}
+
+	return;
+}	//end function: sparse_csr_rows_avx512 | float
+
+inline SIMD_TARGET_AVX512 void sparse_csr_rows_avx512( const size_t *ptr, const uint32_t *index, const double *value, const double *x, double *y, size_t row_begin, size_t row_end )
+{
+	//fast counters
+	size_t r, k;
+	__m512d acc;
+	__m256i vi;
+	__mmask8 mask;
+
+	for (r = row_begin;r < row_end;r++)
+	{
+		acc = _mm512_setzero_pd();
+		for (k = ptr[r];k +8 <= ptr[r +1];k += 8)
+		{
+			vi = _mm256_loadu_si256( (const __m256i *)(index +k) );
+			acc = _mm512_fmadd_pd( _mm512_loadu_pd( value +k ), _mm512_i32gather_pd( vi, x, 8 ), acc );
+		}
+		if (k < ptr[r +1])
+		{
+			//Masked 256 bit loads need AVX512VL: load 512 bits masked and keep the low half
+			mask = (__mmask8)((1u << (ptr[r +1] -k)) -1);
+			vi = _mm512_castsi512_si256( _mm512_maskz_loadu_epi32( (__mmask16)mask, index +k ) );
+			acc = _mm512_fmadd_pd( _mm512_maskz_loadu_pd( mask, value +k ), _mm512_mask_i32gather_pd( _mm512_setzero_pd(), mask, vi, x, 8 ), acc );
+		}
+		y[r] = _mm512_reduce_add_pd( acc );
+	}
+
+	return;
+}	//end function: sparse_csr_rows_avx512 | double
+
+//Rows of a column are distinct: the gather, add, scatter of a vector never sees the same row twice
+inline SIMD_TARGET_AVX512 void sparse_csc_cols_avx512( const size_t *ptr, const uint32_t *index, const float *value, const float *x, float *y, size_t col_begin, size_t col_end )
+{
+	//fast counters
+	size_t c, k;
+	__m512 scale, vy;
+	__m512i vi;
+	__mmask16 mask;
+
+	for (c = col_begin;c < col_end;c++)
+	{
+		scale = _mm512_set1_ps( x[c] );
+		for (k = ptr[c];k +16 <= ptr[c +1];k += 16)
+		{
+			vi = _mm512_loadu_si512( (const void *)(index +k) );
+			vy = _mm512_fmadd_ps( _mm512_loadu_ps( value +k ), scale, _mm512_i32gather_ps( vi, y, 4 ) );
+			_mm512_i32scatter_ps( y, vi, vy, 4 );
+		}
+		if (k < ptr[c +1])
+		{
+			mask = (__mmask16)((1u << (ptr[c +1] -k)) -1);
+			vi = _mm512_maskz_loadu_epi32( mask, index +k );
+			vy = _mm512_fmadd_ps( _mm512_maskz_loadu_ps( mask, value +k ), scale, _mm512_mask_i32gather_ps( _mm512_setzero_ps(), mask, vi, y, 4 ) );
+			_mm512_mask_i32scatter_ps( y, mask, vi, vy, 4 );
+		}
+	}
+
+	return;
+}	//end function: sparse_csc_cols_avx512 | float
+
+inline SIMD_TARGET_AVX512 void sparse_csc_cols_avx512( const size_t *ptr, const uint32_t *index, const double *value, const double *x, double *y, size_t col_begin, size_t col_end )
+{
+	//fast counters
+	size_t c, k;
+	__m512d scale, vy;
+	__m256i vi;
+	__mmask8 mask;
+
+	for (c = col_begin;c < col_end;c++)
+	{
+		scale = _mm512_set1_pd( x[c] );
+		for (k = ptr[c];k +8 <= ptr[c +1];k += 8)
+		{
+			vi = _mm256_loadu_si256( (const __m256i *)(index +k) );
+			vy = _mm512_fmadd_pd( _mm512_loadu_pd( value +k ), scale, _mm512_i32gather_pd( vi, y, 8 ) );
+			_mm512_i32scatter_pd( y, vi, vy, 8 );
+		}
+		if (k < ptr[c +1])
+		{
+			mask = (__mmask8)((1u << (ptr[c +1] -k)) -1);
+			vi = _mm512_castsi512_si256( _mm512_maskz_loadu_epi32( (__mmask16)mask, index +k ) );
+			vy = _mm512_fmadd_pd( _mm512_maskz_loadu_pd( mask, value +k ), scale, _mm512_mask_i32gather_pd( _mm512_setzero_pd(), mask, vi, y, 8 ) );
+			_mm512_mask_i32scatter_pd( y, mask, vi, vy, 8 );
+		}
+	}
+
+	return;
+}	//end function: sparse_csc_cols_avx512 | double
+
+#pragma GCC diagnostic pop
+
+#endif	//SIMD_X86
+
+/****************************************************************************
+**	DISPATCH
+*****************************************************************************
+**	Any T: scalar loops. float and double: overloads that pick the wrapper of the instruction set
+****************************************************************************/
+
+template <typename T>
+inline void sparse_csr_rows( const size_t *ptr, const uint32_t *index, const T *value, const T *x, T *y, size_t row_begin, size_t row_end )
+{
+	sparse_csr_rows_scalar<T>( ptr, index, value, x, y, row_begin, row_end );
+}	//end function: sparse_csr_rows | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+
+template <typename T>
+inline void sparse_csc_cols( const size_t *ptr, const uint32_t *index, const T *value, const T *x, T *y, size_t col_begin, size_t col_end )
+{
+	sparse_csc_cols_scalar<T>( ptr, index, value, x, y, col_begin, col_end );
+}	//end function: sparse_csc_cols | const size_t *, const uint32_t *, const T *, const T *, T *, size_t, size_t
+
+#if defined( SIMD_X86 )
+
+inline void sparse_csr_rows( const size_t *ptr, const uint32_t *index, const float *value, const float *x, float *y, size_t row_begin, size_t row_end )
+{
+	switch (simd_isa())
+	{
+		case SIMD_AVX512:
+			sparse_csr_rows_avx512( ptr, index, value, x, y, row_begin, row_end );
+			break;
+		case SIMD_AVX2:
+			sparse_csr_rows_avx2( ptr, index, value, x, y, row_begin, row_end );
+			break;
+		default:
+			sparse_csr_rows_scalar<float>( ptr, index, value, x, y, row_begin, row_end );
+			break;
+	}
+}	//end function: sparse_csr_rows | float
+
+inline void sparse_csr_rows( const size_t *ptr, const uint32_t *index, const double *value, const double *x, double *y, size_t row_begin, size_t row_end )
+{
+	switch (simd_isa())
+	{
+		case SIMD_AVX512:
+			sparse_csr_rows_avx512( ptr, index, value, x, y, row_begin, row_end );
+			break;
+		case SIMD_AVX2:
+			sparse_csr_rows_avx2( ptr, index, value, x, y, row_begin, row_end );
+			break;
+		default:
+			sparse_csr_rows_scalar<double>( ptr, index, value, x, y, row_begin, row_end );
+			break;
+	}
+}	//end function: sparse_csr_rows | double
+
+inline void sparse_csc_cols( const size_t *ptr, const uint32_t *index, const float *value, const float *x, float *y, size_t col_begin, size_t col_end )
+{
+	if (simd_isa() == SIMD_AVX512)
+	{
+		sparse_csc_cols_avx512( ptr, index, value, x, y, col_begin, col_end );
+	}
+	else
+	{
+		sparse_csc_cols_scalar<float>( ptr, index, value, x, y, col_begin, col_end );
+	}
+}	//end function: sparse_csc_cols | float
+
+inline void sparse_csc_cols( const size_t *ptr, const uint32_t *index, const double *value, const double *x, double *y, size_t col_begin, size_t col_end )
+{
+	if (simd_isa() == SIMD_AVX512)
+	{
+		sparse_csc_cols_avx512( ptr, index, value, x, y, col_begin, col_end );
+	}
+	else
+	{
+		sparse_csc_cols_scalar<double>( ptr, index, value, x, y, col_begin, col_end );
+	}
+}	//end function: sparse_csc_cols | double
+
+#endif	//SIMD_X86
+
+/****************************************************************************
+**	sparse_spmv | const SparseMatrix<T> &, const T *, T *, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	x			a.cols() elements
+**	y			a.rows() elements, overwritten. Must not overlap x
+**	options		grain counts rows for CSR. Not used by CSC
+**	RETURN:
+**	DESCRIPTION:
+**	y = a *x
+**	CSC: task t adds the columns holding elements t*nnz/tasks .. (t+1)*nnz/tasks -1.
+**	Task 0 adds into y, the others into a partial y each, summed into y in parallel afterward.
+**	A partial spans the rows from the first to the last its columns touch, only those are zeroed and summed.
+**	No more tasks than 1 +nnz/rows: the partials are at most nnz elements, whatever the number of threads
+****************************************************************************/
+
+template <typename T>
+inline void sparse_spmv( const SparseMatrix<T> &a, const T *x, T *y, const Parallel_options &options )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counter
+	size_t t;
+	ThreadPool &pool = parallel_pool( options );
+	size_t num_tasks = pool.size();
+	size_t rows = a.rows();
+	size_t cols = a.cols();
+	const size_t *ptr = a.ptr();
+	const uint32_t *index = a.index();
+	const T *value = a.value();
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (rows == 0)
+	{
+		return;
+	}
+	//CSC: partials bounded by the size of the matrix
+	if ((a.format() == SPARSE_CSC) && (num_tasks > 1 +a.nnz() /rows))
+	{
+		num_tasks = 1 +a.nnz() /rows;
+	}
+	if ((a.nnz() < SPARSE_PARALLEL_MIN) || (num_tasks < 2))
+	{
+		if (a.format() == SPARSE_CSR)
+		{
+			sparse_csr_rows( ptr, index, value, x, y, 0, rows );
+		}
+		else
+		{
+			for (t = 0;t < rows;t++)
+			{
+				y[t] = T();
+			}
+			sparse_csc_cols( ptr, index, value, x, y, 0, cols );
+		}
+		return;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	if (a.format() == SPARSE_CSR)
+	{
+		parallel_for_steal( 0, rows, [&]( size_t row_begin, size_t row_end )
+		{
+			sparse_csr_rows( ptr, index, value, x, y, row_begin, row_end );
+		}, options );
+		return;
+	}
+
+	//Room for a whole y per partial, uninitialized: the pages of rows no column touches are never used
+	AlignedArray<T> partial( (num_tasks -1) *rows );
+	//Rows [first, last) of each partial
+	std::vector<size_t> first( num_tasks, 0 );
+	std::vector<size_t> last( num_tasks, 0 );
+	pool.run( num_tasks, [&]( size_t task )
+	{
+		//fast counters
+		size_t r, k;
+		size_t col_begin = std::lower_bound( ptr, ptr +cols, task *a.nnz() /num_tasks ) -ptr;
+		size_t col_end = (task == num_tasks -1) ?(cols) :(std::lower_bound( ptr, ptr +cols, (task +1) *a.nnz() /num_tasks ) -ptr);
+		size_t row_first = rows;
+		size_t row_last = 0;
+		T *dst;
+
+		if (task == 0)
+		{
+			for (r = 0;r < rows;r++)
+			{
+				y[r] = T();
+			}
+			sparse_csc_cols( ptr, index, value, x, y, col_begin, col_end );
+			return;
+		}
+		for (k = ptr[col_begin];k < ptr[col_end];k++)
+		{
+			row_first = std::min( row_first, (size_t)index[k] );
+			row_last = std::max( row_last, (size_t)index[k] +1 );
+		}
+		if (row_first >= row_last)
+		{
+			return;
+		}
+		dst = partial.data() +(task -1) *rows;
+		for (r = row_first;r < row_last;r++)
+		{
+			dst[r] = T();
+		}
+		sparse_csc_cols( ptr, index, value, x, dst, col_begin, col_end );
+		first[task] = row_first;
+		last[task] = row_last;
+	} );
+	parallel_for_range( 0, rows, [&]( size_t row_begin, size_t row_end )
+	{
+		//fast counters
+		size_t r, p;
+
+		for (p = 1;p < num_tasks;p++)
+		{
+			for (r = std::max( row_begin, first[p] );r < std::min( row_end, last[p] );r++)
+			{
+				y[r] += partial[(p -1) *rows +r];
+			}
+		}
+	}, options );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: sparse_spmv | const SparseMatrix<T> &, const T *, T *, const Parallel_options &
+
+#endif	//SPARSE_H_
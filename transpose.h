@@ -0,0 +1,581 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Transpose
+*****************************************************************
+**	Cache blocked transpose of 2D arrays, out of place and in place
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	The naive double loop reads a row and writes a column. Every write lands on
+**	a different cache line: for big arrays each element costs a cache miss.
+**	Here the array is cut in TRANSPOSE_BLOCK x TRANSPOSE_BLOCK tiles that fit L1 together with their
+**	destination, and each tile is cut in micro blocks transposed in registers:
+**		4 byte elements		4x4 with SSE, 8x8 with AVX2
+**		8 byte elements		2x2 with SSE, 4x4 with AVX2
+**		other sizes			plain loop inside the tiles
+**	The instruction set follows simd_isa() of simd.h.
+**
+**	OUT OF PLACE
+**		transpose( src, dst, rows, cols )			src rows x cols, dst cols x rows. Must not overlap
+**		transpose( src, dst )						View2d. Fast path if both have contiguous rows
+**		transpose( std::array<std::array<T,C>,R>, std::array<std::array<T,R>,C> )
+**	IN PLACE
+**		transpose_in_place( data, rows, cols )		data becomes cols x rows
+**		transpose_in_place( std::array<std::array<T,N>,N> )
+**	Square arrays swap tiles across the diagonal. Other shapes follow the cycles of the permutation:
+**	element at index i moves to i*rows mod (rows*cols -1). A bit per element marks the ones already moved.
+**	This is much slower than out of place: use it only when memory for a second array is not there.
+****************************************************************/
+
+#ifndef TRANSPOSE_H_
+#define TRANSPOSE_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+//Standard C++ libraries
+#include <array>		//for std::array
+#include <vector>		//for std::vector
+#include <algorithm>	//for std::swap, std::min, std::copy
+#include <type_traits>	//for std::is_trivially_copyable
+//User libraries
+#include "array_view.h"	//for View2d
+#include "simd.h"		//for simd_isa, SIMD_TARGET_AVX2
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Side of a tile in elements. Source and destination tiles of 8 byte elements take 16KB
+#define TRANSPOSE_BLOCK		32
+
+/****************************************************************
+**	PROTOTYPES
+****************************************************************/
+
+template <typename T>
+inline void transpose( const T *src, T *dst, size_t rows, size_t cols );
+template <typename U, typename T>
+inline void transpose( View2d<U> src, View2d<T> dst );
+template <typename T, size_t R, size_t C>
+inline void transpose( const std::array<std::array<T, C>, R> &src, std::array<std::array<T, R>, C> &dst );
+template <typename T>
+inline void transpose_in_place( T *data, size_t rows, size_t cols );
+template <typename T, size_t N>
+inline void transpose_in_place( std::array<std::array<T, N>, N> &data );
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	transpose_tile_scalar | const T *, size_t, T *, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	src_stride, dst_stride	elements from a row to the next
+**	RETURN:
+**	DESCRIPTION:
+**	dst(c,r) = src(r,c) for rows x cols elements. Used for tails and other element sizes
+****************************************************************************/
+
+template <typename T>
+inline void transpose_tile_scalar( const T *src, size_t src_stride, T *dst, size_t dst_stride, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t r, c;
+
+	for (r = 0;r < rows;r++)
+	{
+		for (c = 0;c < cols;c++)
+		{
+			dst[c *dst_stride +r] = src[r *src_stride +c];
+		}
+	}
+
+	return;
+}	//end function: transpose_tile_scalar | const T *, size_t, T *, size_t, size_t, size_t
+
+#if defined( SIMD_X86 )
+
+/****************************************************************************
+**	MICRO KERNELS
+*****************************************************************************
+**	Transpose a square micro block through registers. Elements are moved as bit patterns:
+**	float and double loads are used for any 4 and 8 byte type
+****************************************************************************/
+
+//4x4 of 4 byte elements. SSE is part of x86-64, no dispatch needed
+inline void transpose_micro_sse( const float *src, size_t src_stride, float *dst, size_t dst_stride )
+{
+	__m128 r0 = _mm_loadu_ps( src );
+	__m128 r1 = _mm_loadu_ps( src +src_stride );
+	__m128 r2 = _mm_loadu_ps( src +2 *src_stride );
+	__m128 r3 = _mm_loadu_ps( src +3 *src_stride );
+
+	_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+	_mm_storeu_ps( dst, r0 );
+	_mm_storeu_ps( dst +dst_stride, r1 );
+	_mm_storeu_ps( dst +2 *dst_stride, r2 );
+	_mm_storeu_ps( dst +3 *dst_stride, r3 );
+
+	return;
+}	//end function: transpose_micro_sse | const float *, size_t, float *, size_t
+
+//2x2 of 8 byte elements
+inline void transpose_micro_sse( const double *src, size_t src_stride, double *dst, size_t dst_stride )
+{
+	__m128d r0 = _mm_loadu_pd( src );
+	__m128d r1 = _mm_loadu_pd( src +src_stride );
+
+	_mm_storeu_pd( dst, _mm_unpacklo_pd( r0, r1 ) );
+	_mm_storeu_pd( dst +dst_stride, _mm_unpackhi_pd( r0, r1 ) );
+
+	return;
+}	//end function: transpose_micro_sse | const double *, size_t, double *, size_t
+
+/****************************************************************************
+**	transpose_micro_avx2 | const float *, size_t, float *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	8x8 of 4 byte elements in three rounds
+**		unpack		interleave pairs of rows
+**		shuffle		pick 2x2 blocks from pairs of pairs. Each 128 bit half is now a 4x4 transposed
+**		permute		swap 128 bit halves between rows r and r+4
+****************************************************************************/
+
+SIMD_TARGET_AVX2 inline void transpose_micro_avx2( const float *src, size_t src_stride, float *dst, size_t dst_stride )
+{
+	__m256 r0, r1, r2, r3, r4, r5, r6, r7;
+	__m256 u0, u1, u2, u3, u4, u5, u6, u7;
+	__m256 s0, s1, s2, s3, s4, s5, s6, s7;
+
+	r0 = _mm256_loadu_ps( src );
+	r1 = _mm256_loadu_ps( src +src_stride );
+	r2 = _mm256_loadu_ps( src +2 *src_stride );
+	r3 = _mm256_loadu_ps( src +3 *src_stride );
+	r4 = _mm256_loadu_ps( src +4 *src_stride );
+	r5 = _mm256_loadu_ps( src +5 *src_stride );
+	r6 = _mm256_loadu_ps( src +6 *src_stride );
+	r7 = _mm256_loadu_ps( src +7 *src_stride );
+
+	u0 = _mm256_unpacklo_ps( r0, r1 );
+	u1 = _mm256_unpackhi_ps( r0, r1 );
+	u2 = _mm256_unpacklo_ps( r2, r3 );
+	u3 = _mm256_unpackhi_ps( r2, r3 );
+	u4 = _mm256_unpacklo_ps( r4, r5 );
+	u5 = _mm256_unpackhi_ps( r4, r5 );
+	u6 = _mm256_unpacklo_ps( r6, r7 );
+	u7 = _mm256_unpackhi_ps( r6, r7 );
+
+	s0 = _mm256_shuffle_ps( u0, u2, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	s1 = _mm256_shuffle_ps( u0, u2, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	s2 = _mm256_shuffle_ps( u1, u3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	s3 = _mm256_shuffle_ps( u1, u3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	s4 = _mm256_shuffle_ps( u4, u6, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	s5 = _mm256_shuffle_ps( u4, u6, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	s6 = _mm256_shuffle_ps( u5, u7, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	s7 = _mm256_shuffle_ps( u5, u7, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+	_mm256_storeu_ps( dst, _mm256_permute2f128_ps( s0, s4, 0x20 ) );
+	_mm256_storeu_ps( dst +dst_stride, _mm256_permute2f128_ps( s1, s5, 0x20 ) );
+	_mm256_storeu_ps( dst +2 *dst_stride, _mm256_permute2f128_ps( s2, s6, 0x20 ) );
+	_mm256_storeu_ps( dst +3 *dst_stride, _mm256_permute2f128_ps( s3, s7, 0x20 ) );
+	_mm256_storeu_ps( dst +4 *dst_stride, _mm256_permute2f128_ps( s0, s4, 0x31 ) );
+	_mm256_storeu_ps( dst +5 *dst_stride, _mm256_permute2f128_ps( s1, s5, 0x31 ) );
+	_mm256_storeu_ps( dst +6 *dst_stride, _mm256_permute2f128_ps( s2, s6, 0x31 ) );
+	_mm256_storeu_ps( dst +7 *dst_stride, _mm256_permute2f128_ps( s3, s7, 0x31 ) );
+
+	return;
+}	//end function: transpose_micro_avx2 | const float *, size_t, float *, size_t
+
+//4x4 of 8 byte elements. Unpack pairs of rows, then swap 128 bit halves
+SIMD_TARGET_AVX2 inline void transpose_micro_avx2( const double *src, size_t src_stride, double *dst, size_t dst_stride )
+{
+	__m256d r0 = _mm256_loadu_pd( src );
+	__m256d r1 = _mm256_loadu_pd( src +src_stride );
+	__m256d r2 = _mm256_loadu_pd( src +2 *src_stride );
+	__m256d r3 = _mm256_loadu_pd( src +3 *src_stride );
+	__m256d u0 = _mm256_unpacklo_pd( r0, r1 );
+	__m256d u1 = _mm256_unpackhi_pd( r0, r1 );
+	__m256d u2 = _mm256_unpacklo_pd( r2, r3 );
+	__m256d u3 = _mm256_unpackhi_pd( r2, r3 );
+
+	_mm256_storeu_pd( dst, _mm256_permute2f128_pd( u0, u2, 0x20 ) );
+	_mm256_storeu_pd( dst +dst_stride, _mm256_permute2f128_pd( u1, u3, 0x20 ) );
+	_mm256_storeu_pd( dst +2 *dst_stride, _mm256_permute2f128_pd( u0, u2, 0x31 ) );
+	_mm256_storeu_pd( dst +3 *dst_stride, _mm256_permute2f128_pd( u1, u3, 0x31 ) );
+
+	return;
+}	//end function: transpose_micro_avx2 | const double *, size_t, double *, size_t
+
+/****************************************************************************
+**	transpose_blocked_sse | const T *, size_t, T *, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Tiles of TRANSPOSE_BLOCK, micro blocks of 16 bytes a side, plain loop on the edges
+**	Element size picks the micro kernel. The other branch is never taken
+****************************************************************************/
+
+template <typename T>
+inline void transpose_blocked_sse( const T *src, size_t src_stride, T *dst, size_t dst_stride, size_t rows, size_t cols )
+{
+	//Elements in a side of a micro block
+	const size_t K = 16 /sizeof(T);
+	//fast counters
+	size_t rb, cb, r, c;
+	size_t nr, nc;
+
+	for (rb = 0;rb < rows;rb += TRANSPOSE_BLOCK)
+	{
+		nr = std::min( (size_t)TRANSPOSE_BLOCK, rows -rb );
+		for (cb = 0;cb < cols;cb += TRANSPOSE_BLOCK)
+		{
+			nc = std::min( (size_t)TRANSPOSE_BLOCK, cols -cb );
+			for (r = 0;r +K <= nr;r += K)
+			{
+				for (c = 0;c +K <= nc;c += K)
+				{
+					if (sizeof(T) == 4)
+					{
+						transpose_micro_sse( (const float *)(src +(rb +r) *src_stride +cb +c), src_stride, (float *)(dst +(cb +c) *dst_stride +rb +r), dst_stride );
+					}
+					else
+					{
+						transpose_micro_sse( (const double *)(src +(rb +r) *src_stride +cb +c), src_stride, (double *)(dst +(cb +c) *dst_stride +rb +r), dst_stride );
+					}
+				}
+				//Columns left over on the right of the tile
+				transpose_tile_scalar( src +(rb +r) *src_stride +cb +c, src_stride, dst +(cb +c) *dst_stride +rb +r, dst_stride, K, nc -c );
+			}
+			//Rows left over at the bottom of the tile
+			transpose_tile_scalar( src +(rb +r) *src_stride +cb, src_stride, dst +cb *dst_stride +rb +r, dst_stride, nr -r, nc );
+		}
+	}
+
+	return;
+}	//end function: transpose_blocked_sse | const T *, size_t, T *, size_t, size_t, size_t
+
+//Same as transpose_blocked_sse with 32 byte micro blocks
+template <typename T>
+SIMD_TARGET_AVX2 void transpose_blocked_avx2( const T *src, size_t src_stride, T *dst, size_t dst_stride, size_t rows, size_t cols )
+{
+	const size_t K = 32 /sizeof(T);
+	//fast counters
+	size_t rb, cb, r, c;
+	size_t nr, nc;
+
+	for (rb = 0;rb < rows;rb += TRANSPOSE_BLOCK)
+	{
+		nr = std::min( (size_t)TRANSPOSE_BLOCK, rows -rb );
+		for (cb = 0;cb < cols;cb += TRANSPOSE_BLOCK)
+		{
+			nc = std::min( (size_t)TRANSPOSE_BLOCK, cols -cb );
+			for (r = 0;r +K <= nr;r += K)
+			{
+				for (c = 0;c +K <= nc;c += K)
+				{
+					if (sizeof(T) == 4)
+					{
+						transpose_micro_avx2( (const float *)(src +(rb +r) *src_stride +cb +c), src_stride, (float *)(dst +(cb +c) *dst_stride +rb +r), dst_stride );
+					}
+					else
+					{
+						transpose_micro_avx2( (const double *)(src +(rb +r) *src_stride +cb +c), src_stride, (double *)(dst +(cb +c) *dst_stride +rb +r), dst_stride );
+					}
+				}
+				transpose_tile_scalar( src +(rb +r) *src_stride +cb +c, src_stride, dst +(cb +c) *dst_stride +rb +r, dst_stride, K, nc -c );
+			}
+			transpose_tile_scalar( src +(rb +r) *src_stride +cb, src_stride, dst +cb *dst_stride +rb +r, dst_stride, nr -r, nc );
+		}
+	}
+
+	return;
+}	//end function: transpose_blocked_avx2 | const T *, size_t, T *, size_t, size_t, size_t
+
+#endif	//SIMD_X86
+
+/****************************************************************************
+**	transpose_blocked_scalar | const T *, size_t, T *, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Tiles only. Element sizes other than 4 and 8, and CPUs other than x86
+****************************************************************************/
+
+template <typename T>
+inline void transpose_blocked_scalar( const T *src, size_t src_stride, T *dst, size_t dst_stride, size_t rows, size_t cols )
+{
+	//fast counters
+	size_t rb, cb;
+
+	for (rb = 0;rb < rows;rb += TRANSPOSE_BLOCK)
+	{
+		for (cb = 0;cb < cols;cb += TRANSPOSE_BLOCK)
+		{
+			transpose_tile_scalar( src +rb *src_stride +cb, src_stride, dst +cb *dst_stride +rb, dst_stride, std::min( (size_t)TRANSPOSE_BLOCK, rows -rb ), std::min( (size_t)TRANSPOSE_BLOCK, cols -cb ) );
+		}
+	}
+
+	return;
+}	//end function: transpose_blocked_scalar | const T *, size_t, T *, size_t, size_t, size_t
+
+/****************************************************************************
+**	transpose_strided | const T *, size_t, T *, size_t, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Pick the micro kernels. Elements must be trivially copyable to go through registers
+****************************************************************************/
+
+template <typename T>
+inline void transpose_strided( const T *src, size_t src_stride, T *dst, size_t dst_stride, size_t rows, size_t cols )
+{
+#if defined( SIMD_X86 )
+	if ((std::is_trivially_copyable<T>::value == true) && ((sizeof(T) == 4) || (sizeof(T) == 8)))
+	{
+		if (simd_isa() >= SIMD_AVX2)
+		{
+			transpose_blocked_avx2( src, src_stride, dst, dst_stride, rows, cols );
+			return;
+		}
+		if (simd_isa() >= SIMD_SSE4)
+		{
+			transpose_blocked_sse( src, src_stride, dst, dst_stride, rows, cols );
+			return;
+		}
+	}
+#endif
+	transpose_blocked_scalar( src, src_stride, dst, dst_stride, rows, cols );
+
+	return;
+}	//end function: transpose_strided | const T *, size_t, T *, size_t, size_t, size_t
+
+/****************************************************************************
+**	transpose | const T *, T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	src		rows x cols, row-major
+**	dst		cols x rows, row-major. Must not overlap src
+**	RETURN:
+**	DESCRIPTION:
+****************************************************************************/
+
+template <typename T>
+inline void transpose( const T *src, T *dst, size_t rows, size_t cols )
+{
+	transpose_strided( src, cols, dst, rows, rows, cols );
+
+	return;
+}	//end function: transpose | const T *, T *, size_t, size_t
+
+/****************************************************************************
+**	transpose | View2d<U>, View2d<T>
+*****************************************************************************
+**	PARAMETER:
+**	src		View2d<T> or View2d<const T>
+**	dst		must have src.cols() rows and src.rows() columns, and not overlap src
+**	RETURN:
+**	DESCRIPTION:
+**	Views with contiguous rows (blocks of a bigger array too) take the blocked path.
+**	Other strides take an element by element loop
+****************************************************************************/
+
+template <typename U, typename T>
+inline void transpose( View2d<U> src, View2d<T> dst )
+{
+	//fast counters
+	size_t r, c;
+
+	if (src.empty() == true)
+	{
+		return;
+	}
+	if ((src.is_row_contiguous() == true) && (dst.is_row_contiguous() == true) && (src.row_stride() >= 0) && (dst.row_stride() >= 0))
+	{
+		transpose_strided<T>( src.row_data( 0 ), (size_t)src.row_stride(), dst.row_data( 0 ), (size_t)dst.row_stride(), src.rows(), src.cols() );
+		return;
+	}
+
+	for (r = 0;r < src.rows();r++)
+	{
+		for (c = 0;c < src.cols();c++)
+		{
+			dst( c, r ) = src( r, c );
+		}
+	}
+
+	return;
+}	//end function: transpose | View2d<U>, View2d<T>
+
+/****************************************************************************
+**	transpose | const std::array<std::array<T,C>,R> &, std::array<std::array<T,R>,C> &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Shapes are checked by the compiler
+****************************************************************************/
+
+template <typename T, size_t R, size_t C>
+inline void transpose( const std::array<std::array<T, C>, R> &src, std::array<std::array<T, R>, C> &dst )
+{
+	static_assert( sizeof( std::array<std::array<T, C>, R> ) == R *C *sizeof( T ), "std::array rows are padded, nested std::array is not contiguous" );
+	static_assert( sizeof( std::array<std::array<T, R>, C> ) == R *C *sizeof( T ), "std::array rows are padded, nested std::array is not contiguous" );
+
+	transpose( src[0].data(), dst[0].data(), R, C );
+
+	return;
+}	//end function: transpose | const std::array<std::array<T,C>,R> &, std::array<std::array<T,R>,C> &
+
+/****************************************************************************
+**	transpose_square_in_place | T *, size_t
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Tiles above the diagonal swap with the ones below through a buffer on the stack:
+**	tile (i,j) is transposed into the buffer, tile (j,i) transposed into (i,j), the buffer copied into (j,i).
+**	Diagonal tiles go through the buffer too
+****************************************************************************/
+
+template <typename T>
+inline void transpose_square_in_place( T *data, size_t n )
+{
+	//fast counters
+	size_t rb, cb, r;
+	size_t nr, nc;
+	T tile[TRANSPOSE_BLOCK *TRANSPOSE_BLOCK];
+
+	for (rb = 0;rb < n;rb += TRANSPOSE_BLOCK)
+	{
+		nr = std::min( (size_t)TRANSPOSE_BLOCK, n -rb );
+		for (cb = rb;cb < n;cb += TRANSPOSE_BLOCK)
+		{
+			nc = std::min( (size_t)TRANSPOSE_BLOCK, n -cb );
+			//Tile (rb,cb) is nr x nc. Its transpose, nc x nr, goes in the buffer
+			transpose_strided( data +rb *n +cb, n, tile, nr, nr, nc );
+			if (cb != rb)
+			{
+				//Tile (cb,rb) is nc x nr. Its transpose goes where tile (rb,cb) was
+				transpose_strided( data +cb *n +rb, n, data +rb *n +cb, n, nc, nr );
+			}
+			//Buffer goes to tile (cb,rb)
+			for (r = 0;r < nc;r++)
+			{
+				std::copy( tile +r *nr, tile +(r +1) *nr, data +(cb +r) *n +rb );
+			}
+		}
+	}
+
+	return;
+}	//end function: transpose_square_in_place | T *, size_t
+
+/****************************************************************************
+**	transpose_in_place | T *, size_t, size_t
+*****************************************************************************
+**	PARAMETER:
+**	data	rows x cols, row-major. Becomes cols x rows
+**	RETURN:
+**	DESCRIPTION:
+**	Non square: element at index i goes to i*rows mod (N-1), N = rows*cols.
+**	First and last element never move. Each cycle of the permutation is followed once,
+**	carrying one element. std::vector<bool> holds one bit per element
+****************************************************************************/
+
+template <typename T>
+inline void transpose_in_place( T *data, size_t rows, size_t cols )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	//fast counters
+	size_t start, next;
+	size_t num = rows *cols;
+	T carry;
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if ((rows <= 1) || (cols <= 1))
+	{
+		//A single row or column has the same layout as its transpose
+		return;
+	}
+	if (rows == cols)
+	{
+		transpose_square_in_place( data, rows );
+		return;
+	}
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	std::vector<bool> moved( num, false );
+	for (start = 1;start < num -1;start++)
+	{
+		if (moved[start] == true)
+		{
+			continue;
+		}
+		//Follow the cycle: the element at next goes where the carried one was headed
+		carry = data[start];
+		next = start;
+		do
+		{
+			next = (size_t)(((unsigned long long)next *rows) %(num -1));
+			std::swap( carry, data[next] );
+			moved[next] = true;
+		}
+		while (next != start);
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: transpose_in_place | T *, size_t, size_t
+
+/****************************************************************************
+**	transpose_in_place | std::array<std::array<T,N>,N> &
+*****************************************************************************
+**	PARAMETER:
+**	RETURN:
+**	DESCRIPTION:
+**	Only square: the type of a nested std::array fixes its shape
+****************************************************************************/
+
+template <typename T, size_t N>
+inline void transpose_in_place( std::array<std::array<T, N>, N> &data )
+{
+	static_assert( sizeof( std::array<std::array<T, N>, N> ) == N *N *sizeof( T ), "std::array rows are padded, nested std::array is not contiguous" );
+
+	transpose_square_in_place( data[0].data(), N );
+
+	return;
+}	//end function: transpose_in_place | std::array<std::array<T,N>,N> &
+
+#endif	//TRANSPOSE_H_
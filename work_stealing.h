@@ -0,0 +1,393 @@
+/****************************************************************
+**	OrangeBot Project
+*****************************************************************
+**        /
+**       /
+**      /
+** ______ \
+**         \
+**          \
+*****************************************************************
+**	Work Stealing
+*****************************************************************
+**	Chase-Lev deques and recursive range splitting for uneven loops
+**	C++11 standard
+****************************************************************/
+
+/****************************************************************
+**	DESCRIPTION
+****************************************************************
+**	parallel_for of parallel.h cuts the range in chunks of equal size. When the cost of an element
+**	varies, as rows of a jagged or sparse array do, a thread with the expensive chunks finishes last
+**	and the others wait for it.
+**
+**	Here each thread of the pool owns a deque of ranges. A thread splits its range in halves,
+**	keeps the left half and pushes the right half on the bottom of its deque, until the range
+**	is at most grain long. Then it runs it and takes the next range from the bottom of its deque.
+**	A thread with an empty deque steals from the top of the deque of another thread:
+**	the oldest range, the largest one, which it splits again.
+**	Expensive regions end up split among all threads without any cost estimate.
+**
+**	The deque is the one of Chase and Lev, with the C++11 memory orders of Le, Pop, Cohen and Zappa Nardelli.
+**	Push and take by the owner cost no atomic read-modify-write unless the deque is down to its last range.
+**	Splitting halves the range, so a deque never holds more than log2(size) ranges: the ring has a fixed capacity.
+**
+**		parallel_for_steal( begin, end, fn )	fn( chunk_begin, chunk_end )
+**		parallel_for_rows( view, fn )			fn( row, StridedSpan<T> elements of the row ) for each row of a View2d
+**	Take the Parallel_options of parallel.h. grain counts indexes, or rows. 0: automatic, small.
+**	An exception thrown by fn stops all threads, ranges not yet run are dropped, the exception reaches the caller.
+****************************************************************/
+
+#ifndef WORK_STEALING_H_
+#define WORK_STEALING_H_
+
+/****************************************************************
+**	INCLUDES
+****************************************************************/
+
+//Standard C libraries
+#include <cstddef>		//for size_t
+#include <cstdint>		//for int64_t, uint32_t
+//Standard C++ libraries
+#include <atomic>		//for std::atomic, std::atomic_thread_fence
+#include <thread>		//for std::this_thread::yield
+#include <algorithm>	//for std::min
+//User libraries
+#include "array_view.h"	//for View2d, StridedSpan
+#include "aligned_array.h"	//for AlignedArray
+#include "parallel.h"	//for ThreadPool, Parallel_options
+
+/****************************************************************
+**	DEFINES
+****************************************************************/
+
+//Ranges in a deque. Halving bounds the depth to log2 of the size of the loop, 64 for any size_t
+#define STEAL_CAPACITY		64
+//Automatic grain splits the loop in this many pieces per thread
+#define STEAL_SPLITS_PER_THREAD	64
+//Failed steals before a thief yields its core
+#define STEAL_SPIN			64
+
+/****************************************************************
+**	STRUCTURES
+****************************************************************/
+
+//Half open range of indexes [begin, end)
+struct Steal_range
+{
+	size_t begin;
+	size_t end;
+};
+
+//Result of a steal
+typedef enum _Steal_result
+{
+	STEAL_EMPTY,		//Nothing to steal
+	STEAL_ABORT,		//Lost a race with the owner or another thief. Try again
+	STEAL_SUCCESS
+} Steal_result;
+
+/****************************************************************
+**	CLASSES
+****************************************************************/
+
+/****************************************************************************
+**	ChaseLevDeque
+*****************************************************************************
+**	DESCRIPTION:
+**	push and take from the owner thread only, steal from any thread.
+**	A cache line of its own, so owners do not slow each other down.
+**	Slots are atomics so that a thief reading a slot the owner is rewriting is not a data race;
+**	the thief then loses the compare exchange on top and retries
+****************************************************************************/
+
+class alignas( ALIGNED_CACHE_LINE ) ChaseLevDeque
+{
+	public:
+		///--------------------------------------------------------------------------
+		///	CONSTRUCTORS
+		///--------------------------------------------------------------------------
+
+		ChaseLevDeque( void ) : g_top( 0 ), g_bottom( 0 )
+		{
+		}
+
+		///--------------------------------------------------------------------------
+		///	PUBLIC METHODS
+		///--------------------------------------------------------------------------
+
+		//Owner. false when full
+		bool push( const Steal_range &range )
+		{
+			int64_t b = g_bottom.load( std::memory_order_relaxed );
+			int64_t t = g_top.load( std::memory_order_acquire );
+
+			if (b -t >= STEAL_CAPACITY)
+			{
+				return false;
+			}
+			g_begin[b & (STEAL_CAPACITY -1)].store( range.begin, std::memory_order_relaxed );
+			g_end[b & (STEAL_CAPACITY -1)].store( range.end, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_release );
+			g_bottom.store( b +1, std::memory_order_relaxed );
+
+			return true;
+		}
+
+		//Owner. Most recent range. false when empty
+		bool take( Steal_range &range )
+		{
+			int64_t b = g_bottom.load( std::memory_order_relaxed ) -1;
+			int64_t t;
+			bool ret = true;
+
+			g_bottom.store( b, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			t = g_top.load( std::memory_order_relaxed );
+			if (t > b)
+			{
+				g_bottom.store( b +1, std::memory_order_relaxed );
+				return false;
+			}
+			range.begin = g_begin[b & (STEAL_CAPACITY -1)].load( std::memory_order_relaxed );
+			range.end = g_end[b & (STEAL_CAPACITY -1)].load( std::memory_order_relaxed );
+			//Last range: race the thieves for it
+			if (t == b)
+			{
+				ret = g_top.compare_exchange_strong( t, t +1, std::memory_order_seq_cst, std::memory_order_relaxed );
+				g_bottom.store( b +1, std::memory_order_relaxed );
+			}
+
+			return ret;
+		}
+
+		//Any thread. Oldest range
+		Steal_result steal( Steal_range &range )
+		{
+			int64_t t = g_top.load( std::memory_order_acquire );
+			int64_t b;
+
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			b = g_bottom.load( std::memory_order_acquire );
+			if (t >= b)
+			{
+				return STEAL_EMPTY;
+			}
+			range.begin = g_begin[t & (STEAL_CAPACITY -1)].load( std::memory_order_relaxed );
+			range.end = g_end[t & (STEAL_CAPACITY -1)].load( std::memory_order_relaxed );
+			if (g_top.compare_exchange_strong( t, t +1, std::memory_order_seq_cst, std::memory_order_relaxed ) == false)
+			{
+				return STEAL_ABORT;
+			}
+
+			return STEAL_SUCCESS;
+		}
+
+	private:
+		///--------------------------------------------------------------------------
+		///	PRIVATE VARS
+		///--------------------------------------------------------------------------
+
+		//Next range to steal
+		std::atomic<int64_t> g_top;
+		//Next free slot of the owner
+		std::atomic<int64_t> g_bottom;
+		//Ring of ranges, index modulo STEAL_CAPACITY
+		std::atomic<size_t> g_begin[STEAL_CAPACITY];
+		std::atomic<size_t> g_end[STEAL_CAPACITY];
+};	//end class: ChaseLevDeque
+
+/****************************************************************
+**	FUNCTIONS
+****************************************************************/
+
+/****************************************************************************
+**	steal_worker | size_t, ChaseLevDeque *, size_t, size_t, Steal_range, Fn &, std::atomic<size_t> &, std::atomic<bool> &
+*****************************************************************************
+**	PARAMETER:
+**	id			index of the deque of this worker
+**	root		range the worker starts with. Empty for all but the first
+**	remaining	indexes not yet run, all workers together. The loop is over at zero
+**	failed		set by a worker whose fn threw
+**	RETURN:
+**	DESCRIPTION:
+**	Thieves pick victims with a xorshift generator seeded by their index
+****************************************************************************/
+
+template <typename Fn>
+inline void steal_worker( size_t id, ChaseLevDeque *deques, size_t num_deques, size_t grain, Steal_range root, Fn &fn, std::atomic<size_t> &remaining, std::atomic<bool> &failed )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	Steal_range range = root;
+	Steal_range right;
+	bool have = (range.end > range.begin);
+	uint32_t x = (uint32_t)id *2654435761u +1;
+	size_t victim;
+	unsigned int misses = 0;
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	while (failed.load( std::memory_order_relaxed ) == false)
+	{
+		if (have == true)
+		{
+			//Keep the left half, publish the right half
+			while (range.end -range.begin > grain)
+			{
+				right.begin = range.begin +(range.end -range.begin) /2;
+				right.end = range.end;
+				if (deques[id].push( right ) == false)
+				{
+					break;
+				}
+				range.end = right.begin;
+			}
+			try
+			{
+				fn( range.begin, range.end );
+			}
+			catch (...)
+			{
+				failed.store( true );
+				throw;
+			}
+			remaining.fetch_sub( range.end -range.begin, std::memory_order_acq_rel );
+			have = deques[id].take( range );
+			misses = 0;
+		}
+		else
+		{
+			if (remaining.load( std::memory_order_acquire ) == 0)
+			{
+				break;
+			}
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			victim = x %num_deques;
+			have = ((victim != id) && (deques[victim].steal( range ) == STEAL_SUCCESS));
+			if ((have == false) && (++misses >= STEAL_SPIN))
+			{
+				std::this_thread::yield();
+				misses = 0;
+			}
+		}
+	}
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: steal_worker | size_t, ChaseLevDeque *, size_t, size_t, Steal_range, Fn &, std::atomic<size_t> &, std::atomic<bool> &
+
+/****************************************************************************
+**	parallel_for_steal | size_t, size_t, Fn, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	fn			void( size_t chunk_begin, size_t chunk_end )
+**	RETURN:
+**	DESCRIPTION:
+**	One task of the pool per deque. The first worker starts with the whole range, the others steal.
+**	A pool thread that runs two tasks one after the other is harmless: the second finds the loop over
+****************************************************************************/
+
+template <typename Fn>
+inline void parallel_for_steal( size_t begin, size_t end, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	///--------------------------------------------------------------------------
+	///	LOCAL VARIABILE
+	///--------------------------------------------------------------------------
+
+	ThreadPool &pool = parallel_pool( options );
+	size_t num_deques = pool.size();
+	size_t grain = options.grain;
+	std::atomic<size_t> remaining( end -begin );
+	std::atomic<bool> failed( false );
+
+	///--------------------------------------------------------------------------
+	///	CHECK
+	///--------------------------------------------------------------------------
+
+	if (end <= begin)
+	{
+		return;
+	}
+
+	///--------------------------------------------------------------------------
+	///	INITIALIZATIONS
+	///--------------------------------------------------------------------------
+
+	if (grain == 0)
+	{
+		grain = (end -begin) /(num_deques *STEAL_SPLITS_PER_THREAD);
+	}
+	if (grain == 0)
+	{
+		grain = 1;
+	}
+	//One thread: plain loop, in pieces of grain like the others
+	if (num_deques == 1)
+	{
+		while (begin < end)
+		{
+			fn( begin, std::min( begin +grain, end ) );
+			begin = std::min( begin +grain, end );
+		}
+		return;
+	}
+	AlignedArray<ChaseLevDeque> deques( num_deques );
+
+	///--------------------------------------------------------------------------
+	///	BODY
+	///--------------------------------------------------------------------------
+
+	pool.run( num_deques, [&]( size_t id )
+	{
+		Steal_range root;
+		root.begin = begin;
+		root.end = (id == 0) ?(end) :(begin);
+		steal_worker( id, deques.data(), num_deques, grain, root, fn, remaining, failed );
+	} );
+
+	///--------------------------------------------------------------------------
+	///	RETURN
+	///--------------------------------------------------------------------------
+
+	return;
+}	//end function: parallel_for_steal | size_t, size_t, Fn, const Parallel_options &
+
+/****************************************************************************
+**	parallel_for_rows | View2d<T>, Fn, const Parallel_options &
+*****************************************************************************
+**	PARAMETER:
+**	view		any View2d, also transposed or a block
+**	fn			void( size_t row, StridedSpan<T> elements )
+**	RETURN:
+**	DESCRIPTION:
+**	Rows are split with work stealing, grain counts rows. Each row is run by a single thread
+****************************************************************************/
+
+template <typename T, typename Fn>
+inline void parallel_for_rows( View2d<T> view, Fn fn, const Parallel_options &options = Parallel_options() )
+{
+	parallel_for_steal( 0, view.rows(), [&]( size_t row_begin, size_t row_end )
+	{
+		//fast counter
+		size_t r;
+
+		for (r = row_begin;r < row_end;r++)
+		{
+			fn( r, view.row( r ) );
+		}
+	}, options );
+
+	return;
+}	//end function: parallel_for_rows | View2d<T>, Fn, const Parallel_options &
+
+#endif	//WORK_STEALING_H_